@@ -0,0 +1,847 @@
+#include "asset_pack.h"
+
+#include <string>
+#include <algorithm>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define NOGDI
+#include <windows.h>
+#include <io.h>
+// NOTE(joon) : Old 16 bit leftovers, which clash with the camera members
+#undef near
+#undef far
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#endif
+
+// NOTE(joon) : Pack that ReadAssetFile looks into, 0 if there's none
+static asset_pack *mountedAssetPack;
+
+// NOTE(joon) : Returns false if the file cannot be opened. Empty files succeed with a null data.
+static b32
+MapFile(mapped_file *file, const char *fileName)
+{
+	*file = {};
+
+#if defined(_WIN32)
+	HANDLE fileHandle = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(fileHandle, &fileSize);
+	file->size = (u64)fileSize.QuadPart;
+	file->fileHandle = fileHandle;
+	if (file->size)
+	{
+		file->mappingHandle = CreateFileMappingA(fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+		file->data = file->mappingHandle ? (u8 *)MapViewOfFile(file->mappingHandle, FILE_MAP_READ, 0, 0, 0) : 0;
+		if (!file->data)
+		{
+			if (file->mappingHandle)
+			{
+				CloseHandle(file->mappingHandle);
+			}
+			CloseHandle(fileHandle);
+			*file = {};
+			return false;
+		}
+	}
+#else
+	int fileDescriptor = open(fileName, O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStatus;
+	if (fstat(fileDescriptor, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode))
+	{
+		close(fileDescriptor);
+		return false;
+	}
+	file->size = (u64)fileStatus.st_size;
+	if (file->size)
+	{
+		void *data = mmap(0, (size_t)file->size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if (data == MAP_FAILED)
+		{
+			close(fileDescriptor);
+			*file = {};
+			return false;
+		}
+		file->data = (u8 *)data;
+	}
+	// NOTE(joon) : The mapping keeps the file alive by itself
+	close(fileDescriptor);
+#endif
+
+	return true;
+}
+
+static void
+UnmapFile(mapped_file *file)
+{
+#if defined(_WIN32)
+	if (file->data)
+	{
+		UnmapViewOfFile(file->data);
+	}
+	if (file->mappingHandle)
+	{
+		CloseHandle(file->mappingHandle);
+	}
+	if (file->fileHandle)
+	{
+		CloseHandle(file->fileHandle);
+	}
+#else
+	if (file->data)
+	{
+		munmap(file->data, (size_t)file->size);
+	}
+#endif
+
+	*file = {};
+}
+
+// NOTE(joon) : FNV-1a, '\' is hashed as '/' so that both of the separators find the same entry
+static u64
+HashAssetPath(const char *path)
+{
+	if (path[0] == '.' && (path[1] == '/' || path[1] == '\\'))
+	{
+		path += 2;
+	}
+
+	u64 result = 0xcbf29ce484222325;
+	for (const char *at = path;
+		*at;
+		++at)
+	{
+		char c = (*at == '\\') ? '/' : *at;
+		result ^= (u8)c;
+		result *= 0x100000001b3;
+	}
+
+	return result;
+}
+
+static b32
+IsSameAssetPath(const char *a, const char *b)
+{
+	if (a[0] == '.' && (a[1] == '/' || a[1] == '\\'))
+	{
+		a += 2;
+	}
+	if (b[0] == '.' && (b[1] == '/' || b[1] == '\\'))
+	{
+		b += 2;
+	}
+
+	while (*a && *b)
+	{
+		char aChar = (*a == '\\') ? '/' : *a;
+		char bChar = (*b == '\\') ? '/' : *b;
+		if (aChar != bChar)
+		{
+			return false;
+		}
+		++a;
+		++b;
+	}
+
+	return (*a == *b);
+}
+
+static u32
+HashAssetContent(u8 *data, size_t size)
+{
+	u32 result = 0x811c9dc5;
+	for (size_t byteIndex = 0;
+		byteIndex < size;
+		++byteIndex)
+	{
+		result ^= data[byteIndex];
+		result *= 0x01000193;
+	}
+
+	return result;
+}
+
+/*
+	NOTE(joon) : LZ4 style byte oriented LZ77, which is quick to decode because there's no entropy coding.
+	Each sequence is
+	token(literal length : 4 bits | match length - LZ_MIN_MATCH : 4 bits), [extra literal length], literals,
+	match offset(u16), [extra match length]
+	where 15 in the token means that the length continues with the bytes of 255, until a byte that is less than that.
+	The last sequence only has the literals.
+*/
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 14
+#define LZ_MAX_OFFSET 65535
+#define LZ_LAST_LITERAL_COUNT 5 // the matches stop before these, so the decoder can finish with a literal copy
+
+static void
+PushLZLength(std::vector<u8> *dest, size_t length)
+{
+	while (length >= 255)
+	{
+		dest->push_back(255);
+		length -= 255;
+	}
+	dest->push_back((u8)length);
+}
+
+static void
+PushLZSequence(std::vector<u8> *dest, u8 *literals, size_t literalCount, u32 offset, size_t matchLength)
+{
+	size_t extraMatchLength = (matchLength >= LZ_MIN_MATCH) ? matchLength - LZ_MIN_MATCH : 0;
+	u8 token = (u8)((Minimum(literalCount, (size_t)15) << 4) | (matchLength ? Minimum(extraMatchLength, (size_t)15) : 0));
+	dest->push_back(token);
+	if (literalCount >= 15)
+	{
+		PushLZLength(dest, literalCount - 15);
+	}
+	dest->insert(dest->end(), literals, literals + literalCount);
+
+	if (matchLength)
+	{
+		dest->push_back((u8)(offset & 0xff));
+		dest->push_back((u8)(offset >> 8));
+		if (extraMatchLength >= 15)
+		{
+			PushLZLength(dest, extraMatchLength - 15);
+		}
+	}
+}
+
+static u32
+LoadLZU32(u8 *at)
+{
+	u32 result;
+	memcpy(&result, at, sizeof(result));
+
+	return result;
+}
+
+// NOTE(joon) : Greedy, with a single candidate per hash
+static void
+CompressLZ(u8 *source, size_t size, std::vector<u8> *dest)
+{
+	dest->clear();
+	dest->reserve(size + size/255 + 16);
+
+	std::vector<u32> hashTable(1 << LZ_HASH_BITS, 0xffffffff);
+
+	size_t literalStart = 0;
+	size_t at = 0;
+	size_t matchLimit = (size > LZ_LAST_LITERAL_COUNT + LZ_MIN_MATCH) ? size - LZ_LAST_LITERAL_COUNT - LZ_MIN_MATCH : 0;
+	u32 missCount = 0;
+	while (at < matchLimit)
+	{
+		u32 sequence = LoadLZU32(source + at);
+		u32 hash = (sequence*2654435761u) >> (32 - LZ_HASH_BITS);
+		u32 candidate = hashTable[hash];
+		hashTable[hash] = (u32)at;
+
+		if (candidate != 0xffffffff && at - candidate <= LZ_MAX_OFFSET && LoadLZU32(source + candidate) == sequence)
+		{
+			size_t matchLength = LZ_MIN_MATCH;
+			size_t maxMatchLength = size - LZ_LAST_LITERAL_COUNT - at;
+			while (matchLength < maxMatchLength && source[candidate + matchLength] == source[at + matchLength])
+			{
+				++matchLength;
+			}
+
+			PushLZSequence(dest, source + literalStart, at - literalStart, (u32)(at - candidate), matchLength);
+			at += matchLength;
+			literalStart = at;
+			missCount = 0;
+		}
+		else
+		{
+			// NOTE(joon) : Skips faster through the data that doesn't compress
+			at += 1 + (missCount++ >> 6);
+		}
+	}
+
+	PushLZSequence(dest, source + literalStart, size - literalStart, 0, 0);
+}
+
+// NOTE(joon) : Returns false if the data is broken, never reads or writes outside of the buffers
+static b32
+DecompressLZ(u8 *source, size_t sourceSize, u8 *dest, size_t destSize)
+{
+	u8 *sourceEnd = source + sourceSize;
+	u8 *destAt = dest;
+	u8 *destEnd = dest + destSize;
+
+	while (source < sourceEnd)
+	{
+		u8 token = *source++;
+
+		size_t literalCount = token >> 4;
+		if (literalCount == 15)
+		{
+			u8 extra;
+			do
+			{
+				if (source >= sourceEnd)
+				{
+					return false;
+				}
+				extra = *source++;
+				literalCount += extra;
+			} while (extra == 255);
+		}
+
+		if (literalCount > (size_t)(sourceEnd - source) || literalCount > (size_t)(destEnd - destAt))
+		{
+			return false;
+		}
+		if (literalCount <= 16 && sourceEnd - source >= 16 && destEnd - destAt >= 16)
+		{
+			// NOTE(joon) : Most of the runs are short, and the fixed size copy is much cheaper than the memcpy call.
+			// The bytes after the run are overwritten by the next sequence.
+			memcpy(destAt, source, 16);
+		}
+		else
+		{
+			memcpy(destAt, source, literalCount);
+		}
+		destAt += literalCount;
+		source += literalCount;
+
+		if (source == sourceEnd)
+		{
+			// NOTE(joon) : last sequence
+			break;
+		}
+
+		if (sourceEnd - source < 2)
+		{
+			return false;
+		}
+		size_t offset = source[0] | ((size_t)source[1] << 8);
+		source += 2;
+
+		size_t matchLength = (token & 15);
+		if (matchLength == 15)
+		{
+			u8 extra;
+			do
+			{
+				if (source >= sourceEnd)
+				{
+					return false;
+				}
+				extra = *source++;
+				matchLength += extra;
+			} while (extra == 255);
+		}
+		matchLength += LZ_MIN_MATCH;
+
+		if (offset == 0 || offset > (size_t)(destAt - dest) || matchLength > (size_t)(destEnd - destAt))
+		{
+			return false;
+		}
+
+		u8 *match = destAt - offset;
+		if (offset >= 16 && matchLength <= 16 && destEnd - destAt >= 16)
+		{
+			memcpy(destAt, match, 16);
+		}
+		else if (offset >= matchLength)
+		{
+			memcpy(destAt, match, matchLength);
+		}
+		else if (offset >= 8)
+		{
+			// NOTE(joon) : Overlapping, but each 8 byte copy only reads what is already written
+			size_t copied = 0;
+			for (;
+				copied + 8 <= matchLength;
+				copied += 8)
+			{
+				memcpy(destAt + copied, match + copied, 8);
+			}
+			for (;
+				copied < matchLength;
+				++copied)
+			{
+				destAt[copied] = match[copied];
+			}
+		}
+		else
+		{
+			for (size_t copied = 0;
+				copied < matchLength;
+				++copied)
+			{
+				destAt[copied] = match[copied];
+			}
+		}
+		destAt += matchLength;
+	}
+
+	return (destAt == destEnd);
+}
+
+// NOTE(joon) : Returns false if the file is not a valid pack
+static b32
+OpenAssetPack(asset_pack *pack, const char *fileName)
+{
+	*pack = {};
+	if (!MapFile(&pack->file, fileName))
+	{
+		return false;
+	}
+
+	b32 isValid = false;
+	if (pack->file.size >= sizeof(asset_pack_header))
+	{
+		pack->header = (asset_pack_header *)pack->file.data;
+		u64 tocSize = (u64)pack->header->entryCount*sizeof(asset_pack_entry);
+		isValid = (pack->header->magic == ASSET_PACK_MAGIC &&
+					pack->header->version == ASSET_PACK_VERSION &&
+					pack->header->tocOffset <= pack->file.size &&
+					tocSize + pack->header->pathTableSize <= pack->file.size - pack->header->tocOffset);
+	}
+
+	if (isValid)
+	{
+		pack->entries = (asset_pack_entry *)(pack->file.data + pack->header->tocOffset);
+		pack->paths = (char *)(pack->entries + pack->header->entryCount);
+
+		for (u32 entryIndex = 0;
+			entryIndex < pack->header->entryCount;
+			++entryIndex)
+		{
+			asset_pack_entry *entry = pack->entries + entryIndex;
+			if (entry->offset > pack->file.size || entry->storedSize > pack->file.size - entry->offset ||
+				entry->pathOffset >= pack->header->pathTableSize ||
+				(entry->codec == AssetPackCodec_None && entry->storedSize != entry->size))
+			{
+				isValid = false;
+				break;
+			}
+		}
+
+		// NOTE(joon) : So that the paths can never run past the table
+		isValid &= (pack->header->pathTableSize > 0 && pack->paths[pack->header->pathTableSize - 1] == '\0');
+	}
+
+	if (!isValid)
+	{
+		printf("%s is not a valid asset pack!\n", fileName);
+		UnmapFile(&pack->file);
+		*pack = {};
+	}
+
+	return isValid;
+}
+
+static void
+CloseAssetPack(asset_pack *pack)
+{
+	if (mountedAssetPack == pack)
+	{
+		mountedAssetPack = 0;
+	}
+	UnmapFile(&pack->file);
+	*pack = {};
+}
+
+// NOTE(joon) : Should be called before any asset is read, the pack should stay open while it's mounted
+static void
+MountAssetPack(asset_pack *pack)
+{
+	mountedAssetPack = pack;
+}
+
+// NOTE(joon) : Returns 0 if the pack doesn't have it
+static asset_pack_entry *
+FindAssetPackEntry(asset_pack *pack, const char *path)
+{
+	u64 hash = HashAssetPath(path);
+
+	// NOTE(joon) : first entry with the hash
+	u32 low = 0;
+	u32 high = pack->header->entryCount;
+	while (low < high)
+	{
+		u32 middle = low + (high - low)/2;
+		if (pack->entries[middle].pathHash < hash)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	asset_pack_entry *result = 0;
+	for (u32 entryIndex = low;
+		entryIndex < pack->header->entryCount && pack->entries[entryIndex].pathHash == hash;
+		++entryIndex)
+	{
+		if (IsSameAssetPath(pack->paths + pack->entries[entryIndex].pathOffset, path))
+		{
+			result = pack->entries + entryIndex;
+			break;
+		}
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Reads the entry of the mounted pack, or the loose file if the pack doesn't have it.
+// When shouldSkipPack is true, only the loose file is read(i.e reloading the shaders that are being edited).
+// Can be called from any thread. Returns false if the asset doesn't exist or is broken.
+static b32
+ReadAssetFile(const char *path, asset_file *file, b32 shouldSkipPack = false)
+{
+	file->data = 0;
+	file->size = 0;
+	file->mapping = {};
+	file->storage.clear();
+	file->isFromPack = false;
+
+	asset_pack_entry *entry = (mountedAssetPack && !shouldSkipPack) ? FindAssetPackEntry(mountedAssetPack, path) : 0;
+	if (entry)
+	{
+		u8 *stored = mountedAssetPack->file.data + entry->offset;
+		if (entry->codec == AssetPackCodec_None)
+		{
+			file->data = stored;
+		}
+		else
+		{
+			file->storage.resize((size_t)entry->size);
+			if (entry->codec != AssetPackCodec_LZ ||
+				!DecompressLZ(stored, (size_t)entry->storedSize, file->storage.data(), file->storage.size()))
+			{
+				printf("%s is broken inside the asset pack!\n", path);
+				file->storage.clear();
+				return false;
+			}
+			file->data = file->storage.data();
+		}
+		file->size = (size_t)entry->size;
+		file->isFromPack = true;
+
+		return true;
+	}
+
+	if (!MapFile(&file->mapping, path))
+	{
+		return false;
+	}
+	file->data = file->mapping.data;
+	file->size = (size_t)file->mapping.size;
+
+	return true;
+}
+
+static void
+CloseAssetFile(asset_file *file)
+{
+	UnmapFile(&file->mapping);
+	file->storage.clear();
+	file->storage.shrink_to_fit();
+	file->data = 0;
+	file->size = 0;
+}
+
+// NOTE(joon) : For the shaders, which need the null at the end
+static b32
+ReadAssetText(const char *path, std::string *text, b32 shouldSkipPack = false)
+{
+	asset_file file;
+	if (!ReadAssetFile(path, &file, shouldSkipPack))
+	{
+		return false;
+	}
+	text->assign((char *)file.data, file.size);
+	CloseAssetFile(&file);
+
+	return true;
+}
+
+// NOTE(joon) : Same as stbi_load, but through ReadAssetFile
+static stbi_uc *
+LoadImageAsset(const char *path, int *width, int *height, int *channelCount, int desiredChannelCount)
+{
+	stbi_uc *result = 0;
+
+	asset_file file;
+	if (ReadAssetFile(path, &file))
+	{
+		result = stbi_load_from_memory(file.data, (int)file.size, width, height, channelCount, desiredChannelCount);
+		CloseAssetFile(&file);
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Appends every file under the directory, with '/' as the separator
+static void
+ListFilesInDirectory(std::string directory, std::vector<std::string> *files)
+{
+	while (!directory.empty() && (directory.back() == '/' || directory.back() == '\\'))
+	{
+		directory.pop_back();
+	}
+
+#if defined(_WIN32)
+	_finddata_t findData;
+	intptr_t findHandle = _findfirst((directory + "/*").c_str(), &findData);
+	if (findHandle == -1)
+	{
+		return;
+	}
+	do
+	{
+		if (strcmp(findData.name, ".") == 0 || strcmp(findData.name, "..") == 0)
+		{
+			continue;
+		}
+
+		std::string path = directory + "/" + findData.name;
+		if (findData.attrib & _A_SUBDIR)
+		{
+			ListFilesInDirectory(path, files);
+		}
+		else
+		{
+			files->push_back(path);
+		}
+	} while (_findnext(findHandle, &findData) == 0);
+	_findclose(findHandle);
+#else
+	DIR *dir = opendir(directory.c_str());
+	if (!dir)
+	{
+		return;
+	}
+	for (dirent *dirEntry = readdir(dir);
+		dirEntry;
+		dirEntry = readdir(dir))
+	{
+		if (strcmp(dirEntry->d_name, ".") == 0 || strcmp(dirEntry->d_name, "..") == 0)
+		{
+			continue;
+		}
+
+		std::string path = directory + "/" + dirEntry->d_name;
+		struct stat fileStatus;
+		if (stat(path.c_str(), &fileStatus) != 0)
+		{
+			continue;
+		}
+		if (S_ISDIR(fileStatus.st_mode))
+		{
+			ListFilesInDirectory(path, files);
+		}
+		else if (S_ISREG(fileStatus.st_mode))
+		{
+			files->push_back(path);
+		}
+	}
+	closedir(dir);
+#endif
+}
+
+struct pack_file_job_data
+{
+	std::string *paths;
+	std::vector<u8> *storedData; // one per file
+	asset_pack_entry *entries;
+	b32 *isRead;
+};
+
+static void
+PackFileJob(void *data, u32 start, u32 onePastEnd)
+{
+	pack_file_job_data *jobData = (pack_file_job_data *)data;
+	for (u32 fileIndex = start;
+		fileIndex < onePastEnd;
+		++fileIndex)
+	{
+		asset_pack_entry *entry = jobData->entries + fileIndex;
+		std::vector<u8> *stored = jobData->storedData + fileIndex;
+
+		mapped_file file;
+		jobData->isRead[fileIndex] = MapFile(&file, jobData->paths[fileIndex].c_str());
+		if (!jobData->isRead[fileIndex])
+		{
+			continue;
+		}
+
+		entry->pathHash = HashAssetPath(jobData->paths[fileIndex].c_str());
+		entry->size = file.size;
+		entry->contentHash = HashAssetContent(file.data, (size_t)file.size);
+
+		// NOTE(joon) : Stored as it is when it doesn't get at least a bit smaller, so that the reader can skip the decoding
+		CompressLZ(file.data, (size_t)file.size, stored);
+		if (stored->size() + stored->size()/32 < file.size)
+		{
+			entry->codec = AssetPackCodec_LZ;
+		}
+		else
+		{
+			entry->codec = AssetPackCodec_None;
+			stored->assign(file.data, file.data + file.size);
+		}
+		entry->storedSize = stored->size();
+
+		UnmapFile(&file);
+	}
+}
+
+// NOTE(joon) : Packs every file under the directories. The files are compressed by the workers.
+// Returns false if anything could not be read or written.
+static b32
+BuildAssetPack(job_system *jobSystem, const char *outputFileName, const char **directories, u32 directoryCount)
+{
+	std::vector<std::string> paths;
+	for (u32 directoryIndex = 0;
+		directoryIndex < directoryCount;
+		++directoryIndex)
+	{
+		ListFilesInDirectory(directories[directoryIndex], &paths);
+	}
+	// NOTE(joon) : The output might be inside one of the directories
+	for (u32 pathIndex = 0;
+		pathIndex < paths.size();
+		++pathIndex)
+	{
+		if (IsSameAssetPath(paths[pathIndex].c_str(), outputFileName))
+		{
+			paths.erase(paths.begin() + pathIndex);
+			break;
+		}
+	}
+	if (paths.empty())
+	{
+		printf("Nothing to pack!\n");
+		return false;
+	}
+
+	u32 fileCount = (u32)paths.size();
+	std::vector<std::vector<u8>> storedData(fileCount);
+	std::vector<asset_pack_entry> entries(fileCount);
+	std::vector<b32> isRead(fileCount);
+
+	pack_file_job_data jobData = {};
+	jobData.paths = paths.data();
+	jobData.storedData = storedData.data();
+	jobData.entries = entries.data();
+	jobData.isRead = isRead.data();
+	ParallelFor(jobSystem, PackFileJob, &jobData, "PackFile", fileCount, 1);
+
+	std::string pathTable;
+	u64 offset = sizeof(asset_pack_header);
+	for (u32 fileIndex = 0;
+		fileIndex < fileCount;
+		++fileIndex)
+	{
+		if (!isRead[fileIndex])
+		{
+			printf("Failed to read %s\n", paths[fileIndex].c_str());
+			return false;
+		}
+
+		entries[fileIndex].offset = offset;
+		entries[fileIndex].pathOffset = (u32)pathTable.size();
+		offset += entries[fileIndex].storedSize;
+
+		std::string path = paths[fileIndex];
+		if (path.compare(0, 2, "./") == 0)
+		{
+			path = path.substr(2);
+		}
+		pathTable += path;
+		pathTable.push_back('\0');
+	}
+
+	// NOTE(joon) : Only the TOC is sorted, the data stays in the directory order
+	std::sort(entries.begin(), entries.end(),
+			[](const asset_pack_entry &a, const asset_pack_entry &b) { return a.pathHash < b.pathHash; });
+
+	asset_pack_header header = {};
+	header.magic = ASSET_PACK_MAGIC;
+	header.version = ASSET_PACK_VERSION;
+	header.entryCount = fileCount;
+	header.pathTableSize = (u32)pathTable.size();
+	header.tocOffset = offset;
+
+	FILE *file = fopen(outputFileName, "wb");
+	if (!file)
+	{
+		printf("Failed to write %s\n", outputFileName);
+		return false;
+	}
+	fwrite(&header, sizeof(header), 1, file);
+	u64 uncompressedSize = 0;
+	for (u32 fileIndex = 0;
+		fileIndex < fileCount;
+		++fileIndex)
+	{
+		fwrite(storedData[fileIndex].data(), 1, storedData[fileIndex].size(), file);
+	}
+	fwrite(entries.data(), sizeof(asset_pack_entry), entries.size(), file);
+	fwrite(pathTable.data(), 1, pathTable.size(), file);
+	b32 result = (ferror(file) == 0);
+	fclose(file);
+
+	for (u32 entryIndex = 0;
+		entryIndex < fileCount;
+		++entryIndex)
+	{
+		uncompressedSize += entries[entryIndex].size;
+	}
+	printf("Packed %u files into %s, %.2f MB -> %.2f MB\n", fileCount, outputFileName,
+			uncompressedSize / (1024.0*1024.0), (offset + fileCount*sizeof(asset_pack_entry) + pathTable.size()) / (1024.0*1024.0));
+
+	return result;
+}
+
+// NOTE(joon) : Reads every entry back from the pack, and checks that it matches the hash of the original file
+static b32
+VerifyAssetPack(asset_pack *pack)
+{
+	b32 result = true;
+	for (u32 entryIndex = 0;
+		entryIndex < pack->header->entryCount;
+		++entryIndex)
+	{
+		asset_pack_entry *entry = pack->entries + entryIndex;
+		const char *path = pack->paths + entry->pathOffset;
+
+		asset_pack *previousPack = mountedAssetPack;
+		MountAssetPack(pack);
+		asset_file file;
+		b32 isValid = ReadAssetFile(path, &file) && file.isFromPack && HashAssetContent(file.data, file.size) == entry->contentHash;
+		CloseAssetFile(&file);
+		MountAssetPack(previousPack);
+
+		if (!isValid)
+		{
+			printf("%s doesn't match the original file!\n", path);
+			result = false;
+		}
+	}
+
+	return result;
+}
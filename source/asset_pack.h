@@ -0,0 +1,77 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+// NOTE(joon) : Every asset is read through ReadAssetFile, which looks inside the mounted pack first
+// and then falls back to the loose file. Both of them are memory mapped, so the uncompressed entries
+// and the loose files are never copied, and the compressed entries are decoded once into the asset_file.
+//
+// Pack layout, everything is little endian :
+// asset_pack_header | entry data... | asset_pack_entry[entryCount] | path table
+// The entries are sorted by the path hash, so that the lookup is a binary search.
+
+#define ASSET_PACK_MAGIC 0x4b504c47 // GLPK
+#define ASSET_PACK_VERSION 1
+#define ASSET_PACK_DEFAULT_FILE_NAME "assets.pack"
+
+enum asset_pack_codec
+{
+	AssetPackCodec_None, // stored as it is, because the compression didn't make it smaller(i.e png)
+	AssetPackCodec_LZ, // see CompressLZ
+};
+
+struct asset_pack_header
+{
+	u32 magic;
+	u32 version;
+	u32 entryCount;
+	u32 pathTableSize;
+	u64 tocOffset; // from the start of the file, the path table comes right after the entries
+};
+
+struct asset_pack_entry
+{
+	u64 pathHash; // see HashAssetPath
+	u64 offset; // from the start of the file
+	u64 size; // uncompressed
+	u64 storedSize; // inside the pack
+
+	u32 codec;
+	u32 pathOffset; // inside the path table, null terminated
+	u32 contentHash; // of the uncompressed data, checked by the pack builder & the benchmark
+	u32 padding;
+};
+
+// NOTE(joon) : Read only mapping of the whole file
+struct mapped_file
+{
+	u8 *data;
+	u64 size;
+
+#if defined(_WIN32)
+	void *fileHandle;
+	void *mappingHandle;
+#endif
+};
+
+struct asset_pack
+{
+	mapped_file file;
+
+	asset_pack_header *header;
+	asset_pack_entry *entries;
+	char *paths;
+};
+
+// NOTE(joon) : data stays valid until CloseAssetFile.
+// It points to the pack or the loose file mapping when the bytes are used as they are, or to the storage otherwise.
+struct asset_file
+{
+	u8 *data;
+	size_t size;
+
+	mapped_file mapping; // only for the loose files
+	std::vector<u8> storage; // decompressed entry
+	b32 isFromPack;
+};
+
+#endif
@@ -0,0 +1,518 @@
+#include "async_io.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sched.h>
+#endif
+
+static const char *
+GetAsyncIOBackendName(async_io_backend backend)
+{
+	const char *result = "thread pool";
+	if (backend == AsyncIOBackend_IOUring)
+	{
+		result = "io_uring";
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Returns false if the file cannot be read
+static b32
+ReadWholeFile(const char *fileName, std::vector<u8> *buffer)
+{
+	FILE *file = fopen(fileName, "rb");
+	if (!file)
+	{
+		return false;
+	}
+
+	b32 result = false;
+	if (fseek(file, 0, SEEK_END) == 0)
+	{
+		long fileSize = ftell(file);
+		if (fileSize >= 0 && fseek(file, 0, SEEK_SET) == 0)
+		{
+			buffer->resize((size_t)fileSize);
+			result = (fread(buffer->data(), 1, buffer->size(), file) == buffer->size());
+		}
+	}
+	fclose(file);
+
+	return result;
+}
+
+// NOTE(joon) : Blocking read on a worker, for the thread pool backend & the pack entries
+static void
+AsyncReadJob(void *data, u32 start, u32 onePastEnd)
+{
+	async_read *read = (async_read *)data;
+	if (mountedAssetPack && FindAssetPackEntry(mountedAssetPack, read->path))
+	{
+		read->isValid = ReadAssetFile(read->path, &read->file);
+	}
+	else
+	{
+		read->isValid = ReadWholeFile(read->path, &read->file.storage);
+		read->file.data = read->file.storage.data();
+		read->file.size = read->file.storage.size();
+	}
+}
+
+#if defined(__linux__)
+// NOTE(joon) : glibc doesn't have the wrappers for these
+static int
+IOUringSetup(u32 entryCount, io_uring_params *params)
+{
+	return (int)syscall(__NR_io_uring_setup, entryCount, params);
+}
+
+static int
+IOUringEnter(int ringFileDescriptor, u32 submitCount, u32 minCompleteCount, u32 flags)
+{
+	return (int)syscall(__NR_io_uring_enter, ringFileDescriptor, submitCount, minCompleteCount, flags, 0, 0);
+}
+
+static void
+ShutdownIOUring(async_io *io)
+{
+	if (io->submissionEntries)
+	{
+		munmap(io->submissionEntries, io->submissionEntryCount*sizeof(io_uring_sqe));
+	}
+	if (io->completionRing && io->completionRing != io->submissionRing)
+	{
+		munmap(io->completionRing, io->completionRingSize);
+	}
+	if (io->submissionRing)
+	{
+		munmap(io->submissionRing, io->submissionRingSize);
+	}
+	if (io->ringFileDescriptor >= 0)
+	{
+		close(io->ringFileDescriptor);
+	}
+
+	io->ringFileDescriptor = -1;
+	io->submissionRing = 0;
+	io->completionRing = 0;
+	io->submissionEntries = 0;
+}
+
+// NOTE(joon) : Returns false if the kernel doesn't have io_uring, or doesn't let us use it(i.e seccomp inside the containers)
+static b32
+InitializeIOUring(async_io *io)
+{
+	io->submissionRing = 0;
+	io->completionRing = 0;
+	io->submissionEntries = 0;
+
+	io_uring_params params = {};
+	io->ringFileDescriptor = IOUringSetup(ASYNC_IO_QUEUE_DEPTH, &params);
+	if (io->ringFileDescriptor < 0)
+	{
+		return false;
+	}
+
+	io->submissionRingSize = params.sq_off.array + params.sq_entries*sizeof(u32);
+	io->completionRingSize = params.cq_off.cqes + params.cq_entries*sizeof(io_uring_cqe);
+	b32 isSingleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (isSingleMapping)
+	{
+		io->submissionRingSize = Maximum(io->submissionRingSize, io->completionRingSize);
+		io->completionRingSize = io->submissionRingSize;
+	}
+
+	void *submissionRing = mmap(0, io->submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+								io->ringFileDescriptor, IORING_OFF_SQ_RING);
+	if (submissionRing == MAP_FAILED)
+	{
+		ShutdownIOUring(io);
+		return false;
+	}
+	io->submissionRing = (u8 *)submissionRing;
+
+	if (isSingleMapping)
+	{
+		io->completionRing = io->submissionRing;
+	}
+	else
+	{
+		void *completionRing = mmap(0, io->completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+									io->ringFileDescriptor, IORING_OFF_CQ_RING);
+		if (completionRing == MAP_FAILED)
+		{
+			ShutdownIOUring(io);
+			return false;
+		}
+		io->completionRing = (u8 *)completionRing;
+	}
+
+	io->submissionEntryCount = params.sq_entries;
+	void *submissionEntries = mmap(0, params.sq_entries*sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+									io->ringFileDescriptor, IORING_OFF_SQES);
+	if (submissionEntries == MAP_FAILED)
+	{
+		ShutdownIOUring(io);
+		return false;
+	}
+	io->submissionEntries = (io_uring_sqe *)submissionEntries;
+
+	io->submissionHead = (u32 *)(io->submissionRing + params.sq_off.head);
+	io->submissionTail = (u32 *)(io->submissionRing + params.sq_off.tail);
+	io->submissionArray = (u32 *)(io->submissionRing + params.sq_off.array);
+	io->submissionMask = *(u32 *)(io->submissionRing + params.sq_off.ring_mask);
+
+	io->completionHead = (u32 *)(io->completionRing + params.cq_off.head);
+	io->completionTail = (u32 *)(io->completionRing + params.cq_off.tail);
+	io->completionEntries = (io_uring_cqe *)(io->completionRing + params.cq_off.cqes);
+	io->completionMask = *(u32 *)(io->completionRing + params.cq_off.ring_mask);
+
+	return true;
+}
+
+// NOTE(joon) : State of a loose file read that goes through the ring
+struct io_uring_read
+{
+	async_read *read;
+	int fileDescriptor;
+	size_t readSize; // so far
+	iovec vector; // should stay alive until the kernel is done with the request
+};
+
+// NOTE(joon) : Queues the rest of the file. The caller makes sure that the ring has the space,
+// which it always has as we never have more reads in flight than the entries.
+static void
+QueueIOUringRead(async_io *io, io_uring_read *ringRead, u64 userData)
+{
+	u32 tail = *io->submissionTail;
+	Assert(tail - __atomic_load_n(io->submissionHead, __ATOMIC_ACQUIRE) < io->submissionEntryCount);
+
+	ringRead->vector.iov_base = ringRead->read->file.data + ringRead->readSize;
+	ringRead->vector.iov_len = ringRead->read->file.size - ringRead->readSize;
+
+	u32 entryIndex = tail & io->submissionMask;
+	io_uring_sqe *entry = io->submissionEntries + entryIndex;
+	memset(entry, 0, sizeof(*entry));
+	// NOTE(joon) : readv instead of read, which was added later(5.6)
+	entry->opcode = IORING_OP_READV;
+	entry->fd = ringRead->fileDescriptor;
+	entry->addr = (u64)(uintptr)&ringRead->vector;
+	entry->len = 1;
+	entry->off = ringRead->readSize;
+	entry->user_data = userData;
+
+	io->submissionArray[entryIndex] = entryIndex;
+	__atomic_store_n(io->submissionTail, tail + 1, __ATOMIC_RELEASE);
+}
+
+static void
+FinishIOUringRead(job_system *jobSystem, io_uring_read *ringRead, b32 isValid, job *batch)
+{
+	if (ringRead->fileDescriptor >= 0)
+	{
+		close(ringRead->fileDescriptor);
+		ringRead->fileDescriptor = -1;
+	}
+
+	async_read *read = ringRead->read;
+	read->isValid = isValid;
+	if (read->completion)
+	{
+		SubmitJob(jobSystem, CreateJob(jobSystem, read->completion, read->completionData, "AsyncReadCompletion", batch));
+	}
+}
+
+// NOTE(joon) : user_data of the cancel requests, which can never be a read index
+#define IO_URING_CANCEL_USER_DATA 0xffffffffffffffffull
+
+// NOTE(joon) : Asks the kernel to stop the read with that user_data. The read still posts its own completion
+// (-ECANCELED if it was stopped in time), and the cancel posts one more.
+static void
+QueueIOUringCancel(async_io *io, u64 readUserData)
+{
+	u32 tail = *io->submissionTail;
+	Assert(tail - __atomic_load_n(io->submissionHead, __ATOMIC_ACQUIRE) < io->submissionEntryCount);
+
+	u32 entryIndex = tail & io->submissionMask;
+	io_uring_sqe *entry = io->submissionEntries + entryIndex;
+	memset(entry, 0, sizeof(*entry));
+	entry->opcode = IORING_OP_ASYNC_CANCEL;
+	entry->fd = -1;
+	entry->addr = readUserData;
+	entry->user_data = IO_URING_CANCEL_USER_DATA;
+
+	io->submissionArray[entryIndex] = entryIndex;
+	__atomic_store_n(io->submissionTail, tail + 1, __ATOMIC_RELEASE);
+}
+
+// NOTE(joon) : Opening is still blocking, as openat through the ring needs an even newer kernel.
+// The caller holds the lock of the io, so this thread never runs any other job here(which could start another batch on the same io),
+// and only waits for the kernel while the workers run the completions.
+static void
+ReadFilesWithIOUring(job_system *jobSystem, async_io *io, async_read **reads, u32 readCount, job *batch)
+{
+	std::vector<io_uring_read> ringReads(readCount);
+	u32 nextReadIndex = 0;
+	u32 inFlightCount = 0;
+	u32 finishedCount = 0;
+	u32 unsubmittedCount = 0;
+	u32 cancelCount = 0; // submitted, but their completions are not reaped yet
+	b32 hasFailed = false; // no more reads are started, and the ones in flight are cancelled & drained
+	b32 hasStopped = false;
+	while (finishedCount < readCount || cancelCount)
+	{
+		if (hasFailed && !hasStopped)
+		{
+			// NOTE(joon) : Take back the entries that the kernel didn't see, so that the next batch doesn't submit them
+			u32 tail = *io->submissionTail;
+			for (u32 entryOffset = 1;
+				entryOffset <= unsubmittedCount;
+				++entryOffset)
+			{
+				io_uring_sqe *entry = io->submissionEntries + ((tail - entryOffset) & io->submissionMask);
+				FinishIOUringRead(jobSystem, ringReads.data() + (u32)entry->user_data, false, batch);
+			}
+			__atomic_store_n(io->submissionTail, tail - unsubmittedCount, __ATOMIC_RELEASE);
+			inFlightCount -= unsubmittedCount;
+			finishedCount += unsubmittedCount;
+			unsubmittedCount = 0;
+
+			for (;
+				nextReadIndex < readCount;
+				++nextReadIndex)
+			{
+				io_uring_read *ringRead = ringReads.data() + nextReadIndex;
+				ringRead->read = reads[nextReadIndex];
+				ringRead->fileDescriptor = -1;
+				FinishIOUringRead(jobSystem, ringRead, false, batch);
+				++finishedCount;
+			}
+
+			// NOTE(joon) : The kernel still writes into the files of the reads that it has, so they can't be failed
+			// until their completions come back. The submission ring is empty at this point, so there's space for a cancel
+			// per read, and the completion ring(twice the entries) fits both of them.
+			u32 queuedCancelCount = 0;
+			for (u32 readIndex = 0;
+				readIndex < nextReadIndex;
+				++readIndex)
+			{
+				if (ringReads[readIndex].fileDescriptor >= 0)
+				{
+					QueueIOUringCancel(io, readIndex);
+					++queuedCancelCount;
+				}
+			}
+
+			int submittedCount = queuedCancelCount ? IOUringEnter(io->ringFileDescriptor, queuedCancelCount, 0, 0) : 0;
+			if (submittedCount < 0)
+			{
+				submittedCount = 0;
+			}
+			// NOTE(joon) : The reads finish by themselves without the cancels, just later
+			__atomic_store_n(io->submissionTail, *io->submissionTail - (queuedCancelCount - (u32)submittedCount), __ATOMIC_RELEASE);
+			cancelCount = (u32)submittedCount;
+			hasStopped = true;
+		}
+
+		while (!hasFailed && nextReadIndex < readCount && inFlightCount < io->submissionEntryCount)
+		{
+			io_uring_read *ringRead = ringReads.data() + nextReadIndex;
+			ringRead->read = reads[nextReadIndex];
+			ringRead->fileDescriptor = open(ringRead->read->path, O_RDONLY);
+
+			struct stat fileStatus;
+			if (ringRead->fileDescriptor < 0 || fstat(ringRead->fileDescriptor, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode))
+			{
+				FinishIOUringRead(jobSystem, ringRead, false, batch);
+				++finishedCount;
+			}
+			else if (fileStatus.st_size == 0)
+			{
+				FinishIOUringRead(jobSystem, ringRead, true, batch);
+				++finishedCount;
+			}
+			else
+			{
+				asset_file *file = &ringRead->read->file;
+				file->storage.resize((size_t)fileStatus.st_size);
+				file->data = file->storage.data();
+				file->size = file->storage.size();
+
+				QueueIOUringRead(io, ringRead, nextReadIndex);
+				++inFlightCount;
+				++unsubmittedCount;
+			}
+			++nextReadIndex;
+		}
+
+		if (unsubmittedCount)
+		{
+			int submittedCount = IOUringEnter(io->ringFileDescriptor, unsubmittedCount, 0, 0);
+			if (submittedCount >= 0)
+			{
+				unsubmittedCount -= (u32)submittedCount;
+			}
+			else if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+			{
+				printf("io_uring_enter failed with %d\n", errno);
+				hasFailed = true;
+				continue;
+			}
+		}
+
+		u32 head = *io->completionHead;
+		u32 tail = __atomic_load_n(io->completionTail, __ATOMIC_ACQUIRE);
+		if (head == tail)
+		{
+			if (finishedCount == readCount && !cancelCount)
+			{
+				break;
+			}
+
+			// NOTE(joon) : If everything in flight is still unsubmitted(the ring was busy), just go back and submit again
+			if (inFlightCount + cancelCount > unsubmittedCount &&
+				IOUringEnter(io->ringFileDescriptor, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+			{
+				if (!hasFailed)
+				{
+					printf("io_uring_enter failed with %d while waiting\n", errno);
+					hasFailed = true;
+				}
+				else if (hasStopped)
+				{
+					// NOTE(joon) : The kernel posts the completions without us entering, so keep polling the ring
+					sched_yield();
+				}
+			}
+			continue;
+		}
+
+		for (;
+			head != tail;
+			++head)
+		{
+			io_uring_cqe *completion = io->completionEntries + (head & io->completionMask);
+			if (completion->user_data == IO_URING_CANCEL_USER_DATA)
+			{
+				--cancelCount;
+				continue;
+			}
+
+			u32 readIndex = (u32)completion->user_data;
+			io_uring_read *ringRead = ringReads.data() + readIndex;
+
+			if (!hasFailed && (completion->res == -EINTR || completion->res == -EAGAIN))
+			{
+				QueueIOUringRead(io, ringRead, readIndex);
+				++unsubmittedCount;
+				continue;
+			}
+
+			if (completion->res > 0)
+			{
+				ringRead->readSize += (size_t)completion->res;
+			}
+
+			if (!hasFailed && completion->res > 0 && ringRead->readSize < ringRead->read->file.size)
+			{
+				// NOTE(joon) : short read, the big files are read in a few requests
+				QueueIOUringRead(io, ringRead, readIndex);
+				++unsubmittedCount;
+			}
+			else
+			{
+				// NOTE(joon) : 0 means that the file got shorter after fstat
+				FinishIOUringRead(jobSystem, ringRead, completion->res > 0 && ringRead->readSize == ringRead->read->file.size, batch);
+				--inFlightCount;
+				++finishedCount;
+			}
+		}
+		__atomic_store_n(io->completionHead, head, __ATOMIC_RELEASE);
+	}
+}
+#endif
+
+// NOTE(joon) : Falls back to the thread pool if io_uring is not available, or when shouldUseThreadPool is true
+static void
+InitializeAsyncIO(async_io *io, b32 shouldUseThreadPool = false)
+{
+	io->backend = AsyncIOBackend_ThreadPool;
+#if defined(__linux__)
+	io->ringFileDescriptor = -1;
+	if (!shouldUseThreadPool && InitializeIOUring(io))
+	{
+		io->backend = AsyncIOBackend_IOUring;
+	}
+#endif
+}
+
+static void
+ShutdownAsyncIO(async_io *io)
+{
+#if defined(__linux__)
+	if (io->backend == AsyncIOBackend_IOUring)
+	{
+		ShutdownIOUring(io);
+	}
+#endif
+	io->backend = AsyncIOBackend_ThreadPool;
+}
+
+// NOTE(joon) : Returns when every read and its completion is finished. Each file stays valid until CloseAssetFile,
+// so the completion can either use it and close it, or leave it to the caller.
+// io can be 0, which reads everything with the worker jobs.
+// A completion should never start another batch on the same io, as the batch holds the lock of the io.
+static void
+ReadAssetFilesAsync(job_system *jobSystem, async_io *io, async_read *reads, u32 readCount)
+{
+	job *batch = CreateJob(jobSystem, 0, 0, "AsyncReads");
+
+	std::vector<async_read *> ringReads;
+	for (u32 readIndex = 0;
+		readIndex < readCount;
+		++readIndex)
+	{
+		async_read *read = reads + readIndex;
+		read->file.data = 0;
+		read->file.size = 0;
+		read->file.mapping = {};
+		read->file.storage.clear();
+		read->file.isFromPack = false;
+		read->isValid = false;
+
+		// NOTE(joon) : Pack entries are already mapped, and might need the decoding
+		b32 isInPack = mountedAssetPack && FindAssetPackEntry(mountedAssetPack, read->path);
+		if (io && io->backend == AsyncIOBackend_IOUring && !isInPack)
+		{
+			ringReads.push_back(read);
+		}
+		else
+		{
+			job *readJob = CreateJob(jobSystem, AsyncReadJob, read, "AsyncRead", batch);
+			if (read->completion)
+			{
+				job *completionJob = CreateJob(jobSystem, read->completion, read->completionData, "AsyncReadCompletion", batch);
+				AddJobDependency(readJob, completionJob);
+				SubmitJob(jobSystem, completionJob);
+			}
+			SubmitJob(jobSystem, readJob);
+		}
+	}
+
+#if defined(__linux__)
+	if (!ringReads.empty())
+	{
+		std::lock_guard<std::mutex> guard(io->lock);
+		ReadFilesWithIOUring(jobSystem, io, ringReads.data(), (u32)ringReads.size(), batch);
+	}
+#endif
+
+	// NOTE(joon) : The lock is released by now, so helping with the other jobs here can't come back to the same io
+	SubmitJob(jobSystem, batch);
+	WaitForJob(jobSystem, batch);
+}
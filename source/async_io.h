@@ -0,0 +1,65 @@
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+// NOTE(joon) : Reads a batch of assets at once, and runs the completion of each read as a job as soon as that read is done,
+// so that the parsing of the first files overlaps with the reads of the others.
+// On Linux, every loose file read of the batch is submitted through one io_uring. The thread that submits the batch waits for the kernel
+// while the workers run the completions, and only helps with the jobs once the reads are done and the ring is released.
+// Everything else(other platforms, kernels without io_uring, entries inside the asset pack) is read by the worker jobs instead.
+
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+#define ASYNC_IO_QUEUE_DEPTH 64 // reads in flight at once
+
+enum async_io_backend
+{
+	AsyncIOBackend_ThreadPool,
+	AsyncIOBackend_IOUring,
+};
+
+struct async_read
+{
+	// NOTE(joon) : Filled by the caller
+	const char *path;
+	job_callback *completion; // optional, called with completionData(and 0, 0) even when the read has failed
+	void *completionData;
+
+	// NOTE(joon) : Valid once the completion starts, and until CloseAssetFile
+	asset_file file;
+	b32 isValid;
+};
+
+struct async_io
+{
+	async_io_backend backend;
+
+	// NOTE(joon) : One batch at a time, the ring is shared by every thread that reads
+	std::mutex lock;
+
+#if defined(__linux__)
+	int ringFileDescriptor;
+
+	u8 *submissionRing;
+	size_t submissionRingSize;
+	u8 *completionRing; // same as the submission ring, if the kernel maps them together
+	size_t completionRingSize;
+	io_uring_sqe *submissionEntries;
+
+	u32 *submissionHead;
+	u32 *submissionTail;
+	u32 *submissionArray;
+	u32 submissionMask;
+	u32 submissionEntryCount;
+
+	u32 *completionHead;
+	u32 *completionTail;
+	io_uring_cqe *completionEntries;
+	u32 completionMask;
+#endif
+};
+
+#endif
@@ -0,0 +1,2963 @@
+// NOTE(joon) : Headless benchmarks, run with
+// openGL_playground.exe --benchmark <name> <arguments...>
+// Running without the name runs every benchmark with the default arguments.
+#include <chrono>
+
+typedef int benchmark_function(int argc, char **argv);
+
+struct benchmark_entry
+{
+	const char *name;
+	const char *usage;
+	benchmark_function *function;
+};
+
+static r64
+GetElapsedMilliseconds(std::chrono::steady_clock::time_point start)
+{
+	std::chrono::duration<r64, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+// NOTE(joon) : A quad with the authored texcoords & normals. The second triangle uses the negative indices
+// and a normal that would never be generated(the face normal is +z), so its corners can't be welded with the first one.
+// The last triangle shares its corners with the first one, except the last corner.
+static const char *authoredOBJBenchmarkFile = 
+	"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+	"vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+	"vn 0 0 1\nvn 0 1 0\n"
+	"f 1/1/1 2/2/1 3/3/1\n"
+	"f -4/-4/-1 -2/-2/-1 -1/-1/-1\n"
+	"f 1/1/1 3/3/1 4/4/1\n";
+
+static b32
+CheckAuthoredOBJ(job_system *jobSystem)
+{
+	const char *fileName = "jobs_benchmark_authored.obj";
+	FILE *file = fopen(fileName, "wb");
+	if (!file)
+	{
+		printf("Failed to write %s\n", fileName);
+		return false;
+	}
+	fputs(authoredOBJBenchmarkFile, file);
+	fclose(file);
+
+	mesh mesh;
+	ReadOBJFileLineByLine(jobSystem, &mesh, fileName);
+	remove(fileName);
+
+	// NOTE(joon) : Position & texcoord index(0 based) and the normal of each corner
+	u32 expectedIndices[9] = {0, 1, 2, 0, 2, 3, 0, 2, 3};
+	glm::vec3 expectedNormals[3] = {glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)};
+	// NOTE(joon) : The loader flips v, as our texcoords start from the top of the image
+	glm::vec2 texCoords[4] = {glm::vec2(0.0f, 1.0f), glm::vec2(1.0f, 1.0f), glm::vec2(1.0f, 0.0f), glm::vec2(0.0f, 0.0f)};
+
+	b32 result = (mesh.vertexBuffer.size() == 7 && mesh.indexBuffer.size() == 9 && mesh.hasTexCoords);
+	for (u32 cornerIndex = 0;
+		result && cornerIndex < ArrayCount(expectedIndices);
+		++cornerIndex)
+	{
+		vertex *vertex = mesh.vertexBuffer.data() + mesh.indexBuffer[cornerIndex];
+		result = (glm::length(vertex->normal - expectedNormals[cornerIndex/3]) < 1e-5f) &&
+				(glm::length(vertex->texCoord - texCoords[expectedIndices[cornerIndex]]) < 1e-5f);
+	}
+
+	if (!result)
+	{
+		printf("%s was not welded correctly, or its normals were regenerated!\n", fileName);
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Runs the CPU heavy loading stages with 1 to maxWorkerCount workers,
+// so that we can see how well each of them scales.
+static int
+RunJobSystemBenchmark(int argc, char **argv)
+{
+	u32 maxWorkerCount = Maximum(std::thread::hardware_concurrency(), 1u);
+	if (argc > 0)
+	{
+		maxWorkerCount = Maximum((u32)atoi(argv[0]), 1u);
+	}
+
+	// NOTE(joon) : The load includes the normals, which the loaders generate
+	printf("workers | load(ms) | texcoord(ms) | total(ms) | speedup\n");
+
+	r64 singleWorkerTotal = 0.0;
+	for (u32 workerCount = 1;
+		workerCount <= maxWorkerCount;
+		++workerCount)
+	{
+		job_system jobSystem;
+		InitializeJobSystem(&jobSystem, workerCount);
+
+		std::vector<model> models(ArrayCount(modelFileNames));
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		LoadModels(&jobSystem, models.data(), modelFileNames, (u32)models.size());
+		r64 loadTime = GetElapsedMilliseconds(start);
+
+		start = std::chrono::steady_clock::now();
+		GenerateTexCoordForModels(&jobSystem, models.data(), (u32)models.size(), TextureMappingMethod_Planar, true);
+		GenerateTexCoordForModels(&jobSystem, models.data(), (u32)models.size(), TextureMappingMethod_Cylindrical, true);
+		GenerateTexCoordForModels(&jobSystem, models.data(), (u32)models.size(), TextureMappingMethod_Spherical, false);
+		r64 textureMappingTime = GetElapsedMilliseconds(start);
+
+		ShutdownJobSystem(&jobSystem);
+
+		r64 total = loadTime + textureMappingTime;
+		if (workerCount == 1)
+		{
+			singleWorkerTotal = total;
+		}
+
+		printf("%7u | %8.2f | %12.2f | %9.2f | %6.2fx\n",
+				workerCount, loadTime, textureMappingTime, total, singleWorkerTotal/total);
+	}
+
+	job_system jobSystem;
+	InitializeJobSystem(&jobSystem, maxWorkerCount);
+	int result = CheckAuthoredOBJ(&jobSystem) ? 0 : -1;
+	ShutdownJobSystem(&jobSystem);
+
+	return result;
+}
+
+// NOTE(joon) : Benchmarks that need GL use a hidden window, so they can still run without showing anything.
+// Returns 0 when it fails.
+static GLFWwindow *
+CreateBenchmarkWindow(int width, int height)
+{
+	GLFWwindow *result = 0;
+	if (glfwInit())
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+		result = glfwCreateWindow(width, height, "benchmark", 0, 0);
+		if (result)
+		{
+			glfwMakeContextCurrent(result);
+			glfwSwapInterval(0);
+
+			glewExperimental = true;
+			if (glewInit() != GLEW_OK)
+			{
+				printf("Failed to initialize glew!\n");
+				glfwDestroyWindow(result);
+				result = 0;
+			}
+		}
+		else
+		{
+			printf("Failed to open GLFW window\n");
+		}
+
+		if (!result)
+		{
+			glfwTerminate();
+		}
+	}
+	else
+	{
+		printf("Failed to initialize GLFW\n");
+	}
+
+	return result;
+}
+
+static void
+DestroyBenchmarkWindow(GLFWwindow *window)
+{
+	glfwDestroyWindow(window);
+	glfwTerminate();
+}
+
+struct record_benchmark_job_data
+{
+	command_buffer *commandBuffers;
+	u32 batchSize;
+
+	GLuint vertexArrayID;
+	GLuint vertexBufferID;
+	GLuint indexBufferID;
+	GLuint perObjectUboID;
+};
+
+static void
+RecordBenchmarkCommandsJob(void *data, u32 start, u32 onePastEnd)
+{
+	record_benchmark_job_data *jobData = (record_benchmark_job_data *)data;
+	command_buffer *commandBuffer = jobData->commandBuffers + (start / jobData->batchSize);
+	ResetCommandBuffer(commandBuffer);
+
+	for (u32 drawIndex = start;
+		drawIndex < onePastEnd;
+		++drawIndex)
+	{
+		plain_per_object_ubo ubo = {};
+		ubo.color = glm::vec3((drawIndex & 255) / 255.0f, 0.5f, 0.5f);
+
+		// NOTE(joon) : a tiny triangle somewhere inside the screen
+		r32 x = (drawIndex % 100) / 50.0f - 1.0f;
+		r32 y = ((drawIndex / 100) % 100) / 50.0f - 1.0f;
+		ubo.mvp = glm::translate(glm::vec3(x, y, 0.0f)) * glm::scale(glm::vec3(0.01f, 0.01f, 0.01f));
+		ubo.model = ubo.mvp;
+		ubo.normal = glm::mat4(1.0f);
+
+		PushUpdateUniformBuffer(commandBuffer, jobData->perObjectUboID, 1, &ubo, sizeof(ubo));
+		PushDrawElements(commandBuffer, jobData->vertexArrayID, jobData->vertexBufferID, jobData->indexBufferID, 3);
+	}
+}
+
+// NOTE(joon) : Records drawCount draws from every worker and replays them on the render thread,
+// to see how many commands per second each side can handle.
+static int
+RunCommandBufferBenchmark(int argc, char **argv)
+{
+	u32 drawCount = 100000;
+	u32 iterationCount = 10;
+	if (argc > 0)
+	{
+		drawCount = Maximum((u32)atoi(argv[0]), 1u);
+	}
+	if (argc > 1)
+	{
+		iterationCount = Maximum((u32)atoi(argv[1]), 1u);
+	}
+
+	GLFWwindow *window = CreateBenchmarkWindow(256, 256);
+	if (!window)
+	{
+		return -1;
+	}
+
+	GLuint program = LoadShaders("source/shaders/plain_shader.vert", "source/shaders/plain_shader.frag");
+
+	vertex vertices[3] = {};
+	vertices[0].p = glm::vec3(-1, -1, 0);
+	vertices[1].p = glm::vec3(1, -1, 0);
+	vertices[2].p = glm::vec3(0, 1, 0);
+	u32 indices[3] = {0, 1, 2};
+
+	record_benchmark_job_data jobData = {};
+	glGenVertexArrays(1, &jobData.vertexArrayID);
+	glBindVertexArray(jobData.vertexArrayID);
+	glGenBuffers(1, &jobData.vertexBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, jobData.vertexBufferID);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vertex), (void *)offsetof(vertex, p));
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(vertex), (void *)offsetof(vertex, normal));
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), (void *)offsetof(vertex, texCoord));
+	glGenBuffers(1, &jobData.indexBufferID);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, jobData.indexBufferID);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+	glBindVertexArray(0);
+
+	glGenBuffers(1, &jobData.perObjectUboID);
+	glBindBuffer(GL_UNIFORM_BUFFER, jobData.perObjectUboID);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(plain_per_object_ubo), 0, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	job_system jobSystem;
+	InitializeJobSystem(&jobSystem, 0);
+
+	// NOTE(joon) : the first buffer is for the frame setup
+	std::vector<command_buffer> commandBuffers(MAX_COMMAND_BUFFER_PER_FRAME);
+	for (u32 bufferIndex = 0;
+		bufferIndex < commandBuffers.size();
+		++bufferIndex)
+	{
+		InitializeCommandBuffer(&commandBuffers[bufferIndex], 64*1024);
+	}
+	jobData.commandBuffers = commandBuffers.data() + 1;
+	jobData.batchSize = GetParallelForBatchSize(&jobSystem, drawCount, 256);
+	jobData.batchSize = Maximum(jobData.batchSize, (drawCount + (MAX_COMMAND_BUFFER_PER_FRAME - 2)) / (MAX_COMMAND_BUFFER_PER_FRAME - 1));
+	u32 commandBufferCount = 1 + (drawCount + jobData.batchSize - 1) / jobData.batchSize;
+
+	render_thread renderThread;
+	renderThread.programs[ProgramSlot_Plain] = program;
+	StartRenderThread(&renderThread, window);
+
+	printf("workers : %u, draws : %u, command buffers : %u\n", jobSystem.workerCount, drawCount, commandBufferCount);
+	printf("iteration | commands | record(ms) | record(Mcmd/s) | replay(ms) | replay(Mcmd/s)\n");
+
+	r64 totalRecordTime = 0.0;
+	r64 totalReplayTime = 0.0;
+	u64 totalCommandCount = 0;
+	for (u32 iterationIndex = 0;
+		iterationIndex < iterationCount;
+		++iterationIndex)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		command_buffer *setupCommandBuffer = commandBuffers.data();
+		ResetCommandBuffer(setupCommandBuffer);
+		PushSetViewport(setupCommandBuffer, 0, 0, 256, 256);
+		PushSetRenderState(setupCommandBuffer, false, false);
+		PushClear(setupCommandBuffer, glm::vec4(0, 0, 0, 1));
+		PushUseProgram(setupCommandBuffer, ProgramSlot_Plain);
+
+		job *recordJob = CreateParallelForJob(&jobSystem, RecordBenchmarkCommandsJob, &jobData, "RecordBenchmarkCommands", drawCount, 256);
+		recordJob->batchSize = jobData.batchSize;
+		SubmitJob(&jobSystem, recordJob);
+		WaitForJob(&jobSystem, recordJob);
+		r64 recordTime = GetElapsedMilliseconds(start);
+
+		u64 commandCount = 0;
+		for (u32 bufferIndex = 0;
+			bufferIndex < commandBufferCount;
+			++bufferIndex)
+		{
+			commandCount += commandBuffers[bufferIndex].commandCount;
+		}
+
+		u64 frameNumber = SubmitRenderFrame(&renderThread, commandBuffers.data(), commandBufferCount, false);
+		WaitForRenderFrame(&renderThread, frameNumber);
+		r64 replayTime = renderThread.lastExecuteTime;
+
+		printf("%9u | %8llu | %10.2f | %14.2f | %10.2f | %14.2f\n",
+				iterationIndex, (unsigned long long)commandCount,
+				recordTime, commandCount / (recordTime * 1000.0),
+				replayTime, commandCount / (replayTime * 1000.0));
+
+		totalRecordTime += recordTime;
+		totalReplayTime += replayTime;
+		totalCommandCount += commandCount;
+	}
+
+	printf("average : record %.2f Mcmd/s, replay %.2f Mcmd/s\n",
+			totalCommandCount / (totalRecordTime * 1000.0), totalCommandCount / (totalReplayTime * 1000.0));
+
+	StopRenderThread(&renderThread);
+
+	for (u32 bufferIndex = 0;
+		bufferIndex < commandBuffers.size();
+		++bufferIndex)
+	{
+		FreeCommandBuffer(&commandBuffers[bufferIndex]);
+	}
+	ShutdownJobSystem(&jobSystem);
+
+	glDeleteBuffers(1, &jobData.perObjectUboID);
+	glDeleteBuffers(1, &jobData.indexBufferID);
+	glDeleteBuffers(1, &jobData.vertexBufferID);
+	glDeleteVertexArrays(1, &jobData.vertexArrayID);
+	glDeleteProgram(program);
+	DestroyBenchmarkWindow(window);
+
+	return 0;
+}
+
+// NOTE(joon) : Measures the CPU time of ImGui_ImplOpenGL3_RenderDrawData with the demo window,
+// once with the backend querying & restoring every GL state, and once with the state that we give to it.
+static int
+RunImGuiBackendBenchmark(int argc, char **argv)
+{
+	u32 frameCount = 1000;
+	if (argc > 0)
+	{
+		frameCount = Maximum((u32)atoi(argv[0]), 1u);
+	}
+
+	int width = 1280;
+	int height = 720;
+	GLFWwindow *window = CreateBenchmarkWindow(width, height);
+	if (!window)
+	{
+		return -1;
+	}
+
+	ImGui::CreateContext();
+	ImGuiIO &io = ImGui::GetIO();
+	io.IniFilename = 0;
+	io.DisplaySize = ImVec2((r32)width, (r32)height);
+	io.DeltaTime = 1.0f/60.0f;
+	ImGui_ImplOpenGL3_Init();
+	ImGui::StyleColorsDark();
+
+	// NOTE(joon) : Something that looks like the state the render thread leaves behind
+	glViewport(0, 0, width, height);
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+
+	ImGui_ImplOpenGL3_State knownState;
+	ImGui_ImplOpenGL3_QueryState(&knownState);
+
+	const char *modeNames[] = {"query", "known"};
+	r64 averageTimes[ArrayCount(modeNames)] = {};
+
+	printf("frames : %u\n", frameCount);
+	printf("mode  | total(ms) | per frame(us)\n");
+	for (u32 modeIndex = 0;
+		modeIndex < ArrayCount(modeNames);
+		++modeIndex)
+	{
+		ImGui_ImplOpenGL3_SetKnownState(modeIndex == 1 ? &knownState : 0);
+
+		r64 totalTime = 0.0;
+		for (u32 frameIndex = 0;
+			frameIndex < frameCount;
+			++frameIndex)
+		{
+			ImGui_ImplOpenGL3_NewFrame();
+			ImGui::NewFrame();
+			ImGui::ShowDemoWindow();
+			ImGui::Render();
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+			totalTime += GetElapsedMilliseconds(start);
+
+			// NOTE(joon) : Don't let the driver queue up too many frames, as that is not what we are measuring
+			glFinish();
+		}
+
+		averageTimes[modeIndex] = 1000.0*totalTime/frameCount;
+		printf("%5s | %9.2f | %13.2f\n", modeNames[modeIndex], totalTime, averageTimes[modeIndex]);
+	}
+	printf("saved %.2fus per frame (%.1f%%)\n",
+			averageTimes[0] - averageTimes[1], 100.0*(averageTimes[0] - averageTimes[1])/averageTimes[0]);
+
+	ImGui_ImplOpenGL3_SetKnownState(0);
+	ImGui_ImplOpenGL3_Shutdown();
+	ImGui::DestroyContext();
+	DestroyBenchmarkWindow(window);
+
+	return 0;
+}
+
+// NOTE(joon) : Software occlusion culling with a tessellated wall as the occluder, and boxes in front of & behind it.
+// Runs every available path, and checks that they agree with each other & with what we know about the scene.
+static int
+RunOcclusionBenchmark(int argc, char **argv)
+{
+	u32 occludeeCount = 4096;
+	u32 iterationCount = 200;
+	if (argc > 0)
+	{
+		occludeeCount = Maximum((u32)atoi(argv[0]), 2u);
+	}
+	if (argc > 1)
+	{
+		iterationCount = Maximum((u32)atoi(argv[1]), 1u);
+	}
+
+	job_system jobSystem;
+	InitializeJobSystem(&jobSystem, Maximum(std::thread::hardware_concurrency(), 1u));
+
+	// NOTE(joon) : 8x8 wall at z = 0, made out of 32x32 quads
+	mesh wall;
+	u32 wallResolution = 32;
+	for (u32 y = 0;
+		y <= wallResolution;
+		++y)
+	{
+		for (u32 x = 0;
+			x <= wallResolution;
+			++x)
+		{
+			vertex v = {};
+			v.p = glm::vec3(8.0f*x/wallResolution - 4.0f, 8.0f*y/wallResolution - 4.0f, 0.0f);
+			wall.vertexBuffer.push_back(v);
+		}
+	}
+	for (u32 y = 0;
+		y < wallResolution;
+		++y)
+	{
+		for (u32 x = 0;
+			x < wallResolution;
+			++x)
+		{
+			u32 i = y*(wallResolution + 1) + x;
+			u32 quadIndices[6] = {i, i + 1, i + wallResolution + 2, i, i + wallResolution + 2, i + wallResolution + 1};
+			wall.indexBuffer.insert(wall.indexBuffer.end(), quadIndices, quadIndices + 6);
+		}
+	}
+	glm::mat4 wallWorld = glm::mat4(1.0f);
+
+	// NOTE(joon) : Even ones are in front of the wall, odd ones are behind it.
+	// All of them are inside the wall's shadow, so every odd one should be occluded.
+	std::vector<glm::mat4> worlds(occludeeCount);
+	std::vector<occludee> occludees(occludeeCount);
+	u32 gridSize = (u32)ceilf(sqrtf((r32)occludeeCount));
+	for (u32 occludeeIndex = 0;
+		occludeeIndex < occludeeCount;
+		++occludeeIndex)
+	{
+		u32 cell = occludeeIndex / 2;
+		r32 x = 4.0f*((cell % gridSize) + 0.5f)/gridSize - 2.0f;
+		r32 y = 4.0f*((cell / gridSize) % gridSize + 0.5f)/gridSize - 2.0f;
+		r32 z = (occludeeIndex % 2) ? -3.0f : 3.0f;
+		worlds[occludeeIndex] = glm::translate(glm::vec3(x, y, z));
+
+		occludees[occludeeIndex].boundsMin = glm::vec3(-0.1f, -0.1f, -0.1f);
+		occludees[occludeeIndex].boundsMax = glm::vec3(0.1f, 0.1f, 0.1f);
+		occludees[occludeeIndex].world = &worlds[occludeeIndex];
+	}
+
+	glm::mat4 view = glm::lookAt(glm::vec3(0, 0, 10), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 2.0f, 0.1f, 100.0f);
+	glm::mat4 viewProjection = projection * view;
+
+	occlusion_buffer buffers[2];
+	InitializeOcclusionBuffer(buffers + 0, OCCLUSION_BUFFER_WIDTH, OCCLUSION_BUFFER_HEIGHT);
+	InitializeOcclusionBuffer(buffers + 1, OCCLUSION_BUFFER_WIDTH, OCCLUSION_BUFFER_HEIGHT);
+	b32 isAVX2Supported = buffers[1].useAVX2;
+	buffers[0].useAVX2 = false;
+	const char *pathNames[] = {"scalar", "avx2"};
+	u32 pathCount = isAVX2Supported ? 2 : 1;
+	std::vector<b32> decisions[2];
+
+	int result = 0;
+	printf("occludees : %u, iterations : %u, workers : %u\n", occludeeCount, iterationCount, jobSystem.workerCount);
+	printf("path   | triangles | setup(ms) | raster(ms) | test(ms) | occluded\n");
+	for (u32 pathIndex = 0;
+		pathIndex < pathCount;
+		++pathIndex)
+	{
+		occlusion_buffer *buffer = buffers + pathIndex;
+		r64 setupTime = 0.0;
+		r64 rasterizeTime = 0.0;
+		r64 testTime = 0.0;
+		for (u32 iterationIndex = 0;
+			iterationIndex < iterationCount;
+			++iterationIndex)
+		{
+			BeginOcclusionFrame(buffer, &viewProjection);
+			AddOccluder(buffer, &wall, &wallWorld);
+			RasterizeOccluders(buffer, &jobSystem);
+			TestOccludees(buffer, &jobSystem, occludees.data(), occludeeCount);
+
+			setupTime += buffer->setupTime;
+			rasterizeTime += buffer->rasterizeTime;
+			testTime += buffer->testTime;
+		}
+
+		decisions[pathIndex].resize(occludeeCount);
+		for (u32 occludeeIndex = 0;
+			occludeeIndex < occludeeCount;
+			++occludeeIndex)
+		{
+			b32 isOccluded = occludees[occludeeIndex].isOccluded;
+			decisions[pathIndex][occludeeIndex] = isOccluded;
+			if (isOccluded != (occludeeIndex % 2 == 1))
+			{
+				printf("%s : occludee %u should%s be occluded\n", pathNames[pathIndex], occludeeIndex, isOccluded ? " not" : "");
+				result = -1;
+			}
+		}
+
+		printf("%6s | %9u | %9.3f | %10.3f | %8.3f | %u/%u\n", pathNames[pathIndex], buffer->occluderTriangleCount,
+				setupTime/iterationCount, rasterizeTime/iterationCount, testTime/iterationCount,
+				buffer->occludedCount, buffer->testedCount);
+	}
+
+	if (pathCount == 2)
+	{
+		b32 isDepthSame = memcmp(buffers[0].depth, buffers[1].depth, sizeof(r32)*buffers[0].width*buffers[0].height) == 0 &&
+						memcmp(buffers[0].tileMaxDepth, buffers[1].tileMaxDepth, sizeof(r32)*buffers[0].tileCountX*buffers[0].tileCountY) == 0;
+		b32 isDecisionSame = decisions[0] == decisions[1];
+		printf("scalar & avx2 depth buffers %s, decisions %s\n", isDepthSame ? "match" : "DIFFER", isDecisionSame ? "match" : "DIFFER");
+		if (!isDepthSame || !isDecisionSame)
+		{
+			result = -1;
+		}
+	}
+	else
+	{
+		printf("avx2 is not supported, only the scalar path was tested\n");
+	}
+
+	FreeOcclusionBuffer(buffers + 0);
+	FreeOcclusionBuffer(buffers + 1);
+	ShutdownJobSystem(&jobSystem);
+
+	return result;
+}
+
+struct gpu_culling_benchmark_scene
+{
+	gpu_culling culling;
+	u32 instanceCount;
+
+	GLuint plainProgram;
+	GLuint instancedProgram;
+	GLuint perFrameUboID;
+	GLuint perObjectUboID;
+
+	// NOTE(joon) : the wall that occludes the instances behind it
+	GLuint wallVertexArrayID;
+	GLuint wallVertexBufferID;
+	GLuint wallIndexBufferID;
+
+	GLuint framebufferID;
+	GLuint colorRenderbufferID;
+	GLuint depthRenderbufferID;
+	i32 width;
+	i32 height;
+	glm::mat4 viewProjection;
+};
+
+// NOTE(joon) : Draws the wall & the instances that survived the culling into the framebuffer of the scene,
+// and returns the number of the instances that were drawn.
+static u32
+DrawGPUCullingBenchmarkFrame(gpu_culling_benchmark_scene *scene, b32 useHiZ, b32 shouldBuildHiZ, std::vector<u8> *pixels)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, scene->framebufferID);
+	glViewport(0, 0, scene->width, scene->height);
+	glEnable(GL_DEPTH_TEST);
+	glClearColor(0, 0, 0, 1);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	glUseProgram(scene->plainProgram);
+	glBindBufferBase(GL_UNIFORM_BUFFER, 0, scene->perFrameUboID);
+	glBindBufferBase(GL_UNIFORM_BUFFER, 1, scene->perObjectUboID);
+	glBindVertexArray(scene->wallVertexArrayID);
+	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+	glBindVertexArray(0);
+
+	CullGPUInstances(&scene->culling, scene->instanceCount, useHiZ);
+	glUseProgram(scene->instancedProgram);
+	DrawGPUInstances(&scene->culling, scene->instanceCount);
+
+	if (shouldBuildHiZ)
+	{
+		BuildHiZ(&scene->culling, scene->width, scene->height, &scene->viewProjection);
+	}
+
+	if (pixels)
+	{
+		pixels->resize(4*scene->width*scene->height);
+		glReadPixels(0, 0, scene->width, scene->height, GL_RGBA, GL_UNSIGNED_BYTE, pixels->data());
+	}
+
+	u32 result = 0;
+	glBindBuffer(GL_COPY_READ_BUFFER, scene->culling.drawCountBufferID);
+	glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(u32), &result);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	return result;
+}
+
+// NOTE(joon) : GPU culling with a wall in the middle. A quarter of the instances are in front of the wall,
+// half of them are behind it and the rest are outside of the frustum.
+// Checks the visible count of each culling mode, and that the hi-z culling doesn't change a single pixel.
+static int
+RunGPUCullingBenchmark(int argc, char **argv)
+{
+	u32 instanceCount = 4096;
+	u32 iterationCount = 50;
+	if (argc > 0)
+	{
+		instanceCount = (u32)Clamp(4.0f, (r32)atoi(argv[0]), (r32)MAX_GPU_INSTANCE_COUNT);
+		instanceCount &= ~3u;
+	}
+	if (argc > 1)
+	{
+		iterationCount = Maximum((u32)atoi(argv[1]), 1u);
+	}
+
+	gpu_culling_benchmark_scene scene = {};
+	scene.width = 512;
+	scene.height = 256;
+	scene.instanceCount = instanceCount;
+	GLFWwindow *window = CreateBenchmarkWindow(scene.width, scene.height);
+	if (!window)
+	{
+		return -1;
+	}
+	if (!(GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object && GLEW_ARB_multi_draw_indirect))
+	{
+		printf("GPU culling is not supported\n");
+		DestroyBenchmarkWindow(window);
+		return -1;
+	}
+
+	model sphereModel;
+	GenerateSphereModel(&sphereModel, 0.5f, 24, 12);
+	sphereModel.boundingRadius = GetBoundingRadius(&sphereModel.mesh);
+	glGenBuffers(1, &sphereModel.vertexBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, sphereModel.vertexBufferID);
+	glBufferData(GL_ARRAY_BUFFER, sphereModel.mesh.vertexBuffer.size()*sizeof(vertex), sphereModel.mesh.vertexBuffer.data(), GL_STATIC_DRAW);
+	glGenBuffers(1, &sphereModel.indexBufferID);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereModel.indexBufferID);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sphereModel.mesh.indexBuffer.size()*sizeof(u32), sphereModel.mesh.indexBuffer.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	b32 isInitialized = InitializeGPUCulling(&scene.culling, &sphereModel, instanceCount);
+	scene.plainProgram = LoadShaders("source/shaders/plain_shader.vert", "source/shaders/plain_shader.frag");
+	scene.instancedProgram = LoadShaders("source/shaders/instanced_shader.vert", "source/shaders/instanced_shader.frag");
+
+	// NOTE(joon) : 8x8 wall at z = 0, seen from z = 10
+	vertex wallVertices[4] = {};
+	wallVertices[0].p = glm::vec3(-4, -4, 0);
+	wallVertices[1].p = glm::vec3(4, -4, 0);
+	wallVertices[2].p = glm::vec3(4, 4, 0);
+	wallVertices[3].p = glm::vec3(-4, 4, 0);
+	u32 wallIndices[6] = {0, 1, 2, 0, 2, 3};
+	glGenVertexArrays(1, &scene.wallVertexArrayID);
+	glBindVertexArray(scene.wallVertexArrayID);
+	glGenBuffers(1, &scene.wallVertexBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, scene.wallVertexBufferID);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(wallVertices), wallVertices, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vertex), (void *)offsetof(vertex, p));
+	glEnableVertexAttribArray(0);
+	glGenBuffers(1, &scene.wallIndexBufferID);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, scene.wallIndexBufferID);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(wallIndices), wallIndices, GL_STATIC_DRAW);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	per_frame_ubo perFrameUbo = {};
+	perFrameUbo.view = glm::lookAt(glm::vec3(0, 0, 10), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
+	perFrameUbo.projection = glm::perspective(glm::radians(45.0f), scene.width / (r32)scene.height, 0.1f, 100.0f);
+	perFrameUbo.cameraDir = glm::vec3(0, 0, 1);
+	MultiplyMatrix4x4(&scene.viewProjection, &perFrameUbo.projection, &perFrameUbo.view);
+	glGenBuffers(1, &scene.perFrameUboID);
+	glBindBuffer(GL_UNIFORM_BUFFER, scene.perFrameUboID);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(per_frame_ubo), &perFrameUbo, GL_STATIC_DRAW);
+
+	plain_per_object_ubo wallUbo = {};
+	wallUbo.model = glm::mat4(1.0f);
+	wallUbo.mvp = scene.viewProjection;
+	wallUbo.normal = glm::mat4(1.0f);
+	wallUbo.color = glm::vec3(0.5f, 0.5f, 0.5f);
+	glGenBuffers(1, &scene.perObjectUboID);
+	glBindBuffer(GL_UNIFORM_BUFFER, scene.perObjectUboID);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(wallUbo), &wallUbo, GL_STATIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	glGenRenderbuffers(1, &scene.colorRenderbufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, scene.colorRenderbufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, scene.width, scene.height);
+	glGenRenderbuffers(1, &scene.depthRenderbufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, scene.depthRenderbufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, scene.width, scene.height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	glGenFramebuffers(1, &scene.framebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, scene.framebufferID);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, scene.colorRenderbufferID);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, scene.depthRenderbufferID);
+	b32 isFramebufferComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// NOTE(joon) : Every instance is a 0.2 sphere inside the grid cell
+	std::vector<gpu_instance> instances(instanceCount);
+	u32 quarterCount = instanceCount / 4;
+	u32 gridSize = (u32)ceilf(sqrtf((r32)quarterCount));
+	for (u32 instanceIndex = 0;
+		instanceIndex < instanceCount;
+		++instanceIndex)
+	{
+		u32 cell = instanceIndex % quarterCount;
+		r32 x = 4.0f*((cell % gridSize) + 0.5f)/gridSize - 2.0f;
+		r32 y = 4.0f*((cell / gridSize) + 0.5f)/gridSize - 2.0f;
+		u32 group = instanceIndex / quarterCount;
+
+		glm::vec3 p;
+		if (group == 0)
+		{
+			p = glm::vec3(x, y, 3.0f); // in front of the wall
+		}
+		else if (group == 3)
+		{
+			p = glm::vec3(x + 100.0f, y, 0.0f); // outside of the frustum
+		}
+		else
+		{
+			p = glm::vec3(x, y, -3.0f - group); // behind the wall
+		}
+		FillGPUInstance(&instances[instanceIndex], &sphereModel, p, 0.2f, glm::vec3(x, y, 1.0f));
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, scene.culling.instanceBufferID);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, instanceCount*sizeof(gpu_instance), instances.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	int result = 0;
+	if (isInitialized && scene.plainProgram && scene.instancedProgram && isFramebufferComplete)
+	{
+		printf("instances : %u, iterations : %u, %s\n", instanceCount, iterationCount,
+				scene.culling.hasIndirectParameters ? "glMultiDrawElementsIndirectCount" : "glMultiDrawElementsIndirect");
+
+		// NOTE(joon) : frustum only, and build the hi-z for the next frame
+		u32 frustumVisibleCount = DrawGPUCullingBenchmarkFrame(&scene, false, true, 0);
+
+		std::vector<u8> frustumPixels;
+		std::vector<u8> hiZPixels;
+		DrawGPUCullingBenchmarkFrame(&scene, false, false, &frustumPixels);
+		u32 hiZVisibleCount = DrawGPUCullingBenchmarkFrame(&scene, true, false, &hiZPixels);
+
+		printf("visible : frustum %u (expected %u), hi-z %u (expected %u)\n",
+				frustumVisibleCount, 3*quarterCount, hiZVisibleCount, quarterCount);
+		b32 isPixelSame = (frustumPixels == hiZPixels);
+		printf("hi-z culled image %s the frustum culled one\n", isPixelSame ? "matches" : "DIFFERS from");
+		if (frustumVisibleCount != 3*quarterCount || hiZVisibleCount != quarterCount || !isPixelSame)
+		{
+			result = -1;
+		}
+
+		if (scene.culling.hasIndirectParameters)
+		{
+			// NOTE(joon) : The fallback should draw exactly the same
+			std::vector<u8> fallbackPixels;
+			scene.culling.hasIndirectParameters = false;
+			u32 fallbackVisibleCount = DrawGPUCullingBenchmarkFrame(&scene, true, false, &fallbackPixels);
+			scene.culling.hasIndirectParameters = true;
+
+			b32 isFallbackSame = (fallbackPixels == hiZPixels) && (fallbackVisibleCount == hiZVisibleCount);
+			printf("glMultiDrawElementsIndirect fallback %s\n", isFallbackSame ? "matches" : "DIFFERS");
+			if (!isFallbackSame)
+			{
+				result = -1;
+			}
+		}
+
+		glBindFramebuffer(GL_FRAMEBUFFER, scene.framebufferID);
+		r64 cullTime = 0.0;
+		r64 hiZTime = 0.0;
+		for (u32 iterationIndex = 0;
+			iterationIndex < iterationCount;
+			++iterationIndex)
+		{
+			glFinish();
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			CullGPUInstances(&scene.culling, instanceCount, true);
+			glFinish();
+			cullTime += GetElapsedMilliseconds(start);
+
+			start = std::chrono::steady_clock::now();
+			BuildHiZ(&scene.culling, scene.width, scene.height, &scene.viewProjection);
+			glFinish();
+			hiZTime += GetElapsedMilliseconds(start);
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		printf("cull : %.3fms, hi-z build : %.3fms (%d levels)\n",
+				cullTime/iterationCount, hiZTime/iterationCount, scene.culling.hiZLevelCount);
+	}
+	else
+	{
+		printf("Failed to create the GPU culling resources\n");
+		result = -1;
+	}
+
+	glDeleteFramebuffers(1, &scene.framebufferID);
+	glDeleteRenderbuffers(1, &scene.colorRenderbufferID);
+	glDeleteRenderbuffers(1, &scene.depthRenderbufferID);
+	glDeleteBuffers(1, &scene.perFrameUboID);
+	glDeleteBuffers(1, &scene.perObjectUboID);
+	glDeleteBuffers(1, &scene.wallVertexBufferID);
+	glDeleteBuffers(1, &scene.wallIndexBufferID);
+	glDeleteVertexArrays(1, &scene.wallVertexArrayID);
+	glDeleteBuffers(1, &sphereModel.vertexBufferID);
+	glDeleteBuffers(1, &sphereModel.indexBufferID);
+	glDeleteProgram(scene.plainProgram);
+	glDeleteProgram(scene.instancedProgram);
+	FreeGPUCulling(&scene.culling);
+	DestroyBenchmarkWindow(window);
+
+	return result;
+}
+
+// NOTE(joon) : Shared by the benchmarks that shade a stack of screen filling quads,
+// which is the worst case overdraw when they are drawn from back to front
+struct shading_benchmark_scene
+{
+	GLuint forwardProgram;
+
+	GLuint perFrameUboID;
+	GLuint perObjectUboID;
+	per_frame_ubo perFrameUbo;
+	per_object_ubo perObjectUbo;
+	GLuint shadowUboID; // zero, the lighting programs read it but there are no shadows here
+
+	// NOTE(joon) : the quad that is drawn once for each layer of the overdraw, as a grid of cells
+	GLuint quadVertexArrayID;
+	GLuint quadVertexBufferID;
+	GLuint quadIndexBufferID;
+	u32 quadIndexCount;
+	// NOTE(joon) : positions only, shares the index buffer
+	GLuint quadPositionVertexArrayID;
+	GLuint quadPositionBufferID;
+	GLuint textureID;
+
+	GLuint framebufferID;
+	GLuint colorRenderbufferID;
+	GLuint depthRenderbufferID;
+	i32 width;
+	i32 height;
+	glm::mat4 viewProjection;
+};
+
+// NOTE(joon) : 20x12 quad at z = 0 that covers the whole screen seen from z = 10, made out of cellCount x cellCount cells.
+// Replaces the quad that was created before.
+static void
+CreateShadingBenchmarkQuad(shading_benchmark_scene *scene, u32 cellCount)
+{
+	glDeleteBuffers(1, &scene->quadVertexBufferID);
+	glDeleteBuffers(1, &scene->quadIndexBufferID);
+	glDeleteBuffers(1, &scene->quadPositionBufferID);
+	glDeleteVertexArrays(1, &scene->quadVertexArrayID);
+	glDeleteVertexArrays(1, &scene->quadPositionVertexArrayID);
+
+	u32 vertexCountPerRow = cellCount + 1;
+	std::vector<vertex> vertices(vertexCountPerRow*vertexCountPerRow);
+	std::vector<glm::vec3> positions(vertices.size());
+	for (u32 vertexIndex = 0;
+		vertexIndex < vertices.size();
+		++vertexIndex)
+	{
+		r32 u = (vertexIndex % vertexCountPerRow) / (r32)cellCount;
+		r32 v = (vertexIndex / vertexCountPerRow) / (r32)cellCount;
+		vertex *quadVertex = vertices.data() + vertexIndex;
+		quadVertex->p = glm::vec3(-10.0f + 20.0f*u, -6.0f + 12.0f*v, 0.0f);
+		quadVertex->normal = glm::vec3(0, 0, 1);
+		quadVertex->texCoord = glm::vec2(quadVertex->p.x / 4.0f, quadVertex->p.y / 4.0f);
+		positions[vertexIndex] = quadVertex->p;
+	}
+	std::vector<u32> indices;
+	indices.reserve(6*cellCount*cellCount);
+	for (u32 y = 0;
+		y < cellCount;
+		++y)
+	{
+		for (u32 x = 0;
+			x < cellCount;
+			++x)
+		{
+			u32 i0 = y*vertexCountPerRow + x;
+			u32 i1 = i0 + 1;
+			u32 i2 = i1 + vertexCountPerRow;
+			u32 i3 = i0 + vertexCountPerRow;
+			u32 cellIndices[6] = {i0, i1, i2, i0, i2, i3};
+			indices.insert(indices.end(), cellIndices, cellIndices + ArrayCount(cellIndices));
+		}
+	}
+	scene->quadIndexCount = (u32)indices.size();
+
+	glGenBuffers(1, &scene->quadIndexBufferID);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, scene->quadIndexBufferID);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size()*sizeof(u32), indices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	glGenVertexArrays(1, &scene->quadVertexArrayID);
+	glBindVertexArray(scene->quadVertexArrayID);
+	glGenBuffers(1, &scene->quadVertexBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, scene->quadVertexBufferID);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size()*sizeof(vertex), vertices.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vertex), (void *)offsetof(vertex, p));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(vertex), (void *)offsetof(vertex, normal));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), (void *)offsetof(vertex, texCoord));
+	glEnableVertexAttribArray(2);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, scene->quadIndexBufferID);
+
+	glGenVertexArrays(1, &scene->quadPositionVertexArrayID);
+	glBindVertexArray(scene->quadPositionVertexArrayID);
+	glGenBuffers(1, &scene->quadPositionBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, scene->quadPositionBufferID);
+	glBufferData(GL_ARRAY_BUFFER, positions.size()*sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)0);
+	glEnableVertexAttribArray(0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, scene->quadIndexBufferID);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+// NOTE(joon) : Creates everything but the programs, with a single cell quad.
+// Returns false when the framebuffer is not complete.
+static b32
+InitializeShadingBenchmarkScene(shading_benchmark_scene *scene)
+{
+	CreateShadingBenchmarkQuad(scene, 1);
+
+	// NOTE(joon) : 64x64 checker, so that the albedo is not the same everywhere
+	std::vector<u32> texels(64*64);
+	for (u32 texelIndex = 0;
+		texelIndex < texels.size();
+		++texelIndex)
+	{
+		u32 x = texelIndex % 64;
+		u32 y = texelIndex / 64;
+		texels[texelIndex] = (((x / 8) + (y / 8)) & 1) ? 0xffe0c0a0 : 0xff406080;
+	}
+	glGenTextures(1, &scene->textureID);
+	glBindTexture(GL_TEXTURE_2D, scene->textureID);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 64, 64, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// NOTE(joon) : The lights are enabled by SetShadingBenchmarkLightCount
+	per_frame_ubo *perFrameUbo = &scene->perFrameUbo;
+	perFrameUbo->view = glm::lookAt(glm::vec3(0, 0, 10), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
+	perFrameUbo->projection = glm::perspective(glm::radians(45.0f), scene->width / (r32)scene->height, 0.1f, 100.0f);
+	perFrameUbo->cameraP = glm::vec3(0, 0, 10);
+	perFrameUbo->cameraDir = glm::vec3(0, 0, -1);
+	perFrameUbo->IFog = glm::vec3(0.2f, 0.5f, 0.7f);
+	perFrameUbo->globalAmbient = glm::vec3(0.1f, 0.1f, 0.1f);
+	perFrameUbo->zNear = 0.1f;
+	perFrameUbo->zFar = 100.0f;
+	for (u32 lightIndex = 0;
+		lightIndex < ArrayCount(perFrameUbo->lights);
+		++lightIndex)
+	{
+		light *light = perFrameUbo->lights + lightIndex;
+		light->type = LightType_Point;
+		light->IAmbient = glm::vec3(0.02f, 0.02f, 0.02f);
+		light->IDiffuse = glm::vec3(0.3f, 0.25f, 0.2f);
+		light->ISpecular = glm::vec3(0.2f, 0.2f, 0.2f);
+		light->c1 = 1.0f;
+		light->c2 = 0.0f;
+		light->c3 = 8.0f;
+	}
+	MultiplyMatrix4x4(&scene->viewProjection, &perFrameUbo->projection, &perFrameUbo->view);
+	glGenBuffers(1, &scene->perFrameUboID);
+	glBindBuffer(GL_UNIFORM_BUFFER, scene->perFrameUboID);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(per_frame_ubo), perFrameUbo, GL_DYNAMIC_DRAW);
+
+	scene->perObjectUbo.kAmbient = 0.5f;
+	scene->perObjectUbo.kDiffuse = 0.8f;
+	scene->perObjectUbo.kSpecular = 0.5f;
+	scene->perObjectUbo.ns = 16.0f;
+	glGenBuffers(1, &scene->perObjectUboID);
+	glBindBuffer(GL_UNIFORM_BUFFER, scene->perObjectUboID);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(per_object_ubo), &scene->perObjectUbo, GL_DYNAMIC_DRAW);
+	shadow_ubo shadowUbo = {};
+	glGenBuffers(1, &scene->shadowUboID);
+	glBindBuffer(GL_UNIFORM_BUFFER, scene->shadowUboID);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(shadow_ubo), &shadowUbo, GL_STATIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	glGenRenderbuffers(1, &scene->colorRenderbufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, scene->colorRenderbufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, scene->width, scene->height);
+	glGenRenderbuffers(1, &scene->depthRenderbufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, scene->depthRenderbufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, scene->width, scene->height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	glGenFramebuffers(1, &scene->framebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, scene->framebufferID);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, scene->colorRenderbufferID);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, scene->depthRenderbufferID);
+	b32 isFramebufferComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	return isFramebufferComplete;
+}
+
+static void
+FreeShadingBenchmarkScene(shading_benchmark_scene *scene)
+{
+	glDeleteFramebuffers(1, &scene->framebufferID);
+	glDeleteRenderbuffers(1, &scene->colorRenderbufferID);
+	glDeleteRenderbuffers(1, &scene->depthRenderbufferID);
+	glDeleteBuffers(1, &scene->perFrameUboID);
+	glDeleteBuffers(1, &scene->perObjectUboID);
+	glDeleteBuffers(1, &scene->shadowUboID);
+	glDeleteBuffers(1, &scene->quadVertexBufferID);
+	glDeleteBuffers(1, &scene->quadIndexBufferID);
+	glDeleteBuffers(1, &scene->quadPositionBufferID);
+	glDeleteVertexArrays(1, &scene->quadVertexArrayID);
+	glDeleteVertexArrays(1, &scene->quadPositionVertexArrayID);
+	glDeleteTextures(1, &scene->textureID);
+	glDeleteProgram(scene->forwardProgram);
+}
+
+// NOTE(joon) : Point lights on a 4x4 grid in front of the quads
+static void
+SetShadingBenchmarkLightCount(shading_benchmark_scene *scene, u32 lightCount)
+{
+	per_frame_ubo *perFrameUbo = &scene->perFrameUbo;
+	// NOTE(joon) : Less than 4 lights go to the middle of the grid
+	u32 centerGridIndices[] = {5, 6, 9, 10};
+	for (u32 lightIndex = 0;
+		lightIndex < ArrayCount(perFrameUbo->lights);
+		++lightIndex)
+	{
+		perFrameUbo->lights[lightIndex].isEnabled = false;
+		if (lightIndex < lightCount)
+		{
+			u32 gridIndex = (lightCount <= ArrayCount(centerGridIndices)) ? centerGridIndices[lightIndex] : lightIndex;
+			perFrameUbo->lights[lightIndex].p = glm::vec3(4.0f*(gridIndex % 4) - 6.0f, 2.0f*(gridIndex / 4) - 3.0f, 1.0f);
+			perFrameUbo->lights[lightIndex].isEnabled = true;
+		}
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, scene->perFrameUboID);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(per_frame_ubo), perFrameUbo);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// NOTE(joon) : Layers are drawn from back to front, so that every layer is shaded by the forward shading
+static void
+DrawShadingBenchmarkLayers(shading_benchmark_scene *scene, u32 layerCount, b32 isPositionOnly = false)
+{
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, scene->textureID);
+	glBindVertexArray(isPositionOnly ? scene->quadPositionVertexArrayID : scene->quadVertexArrayID);
+	for (u32 layerIndex = 0;
+		layerIndex < layerCount;
+		++layerIndex)
+	{
+		scene->perObjectUbo.model = glm::translate(glm::vec3(0.0f, 0.0f, -0.05f*(layerCount - 1 - layerIndex)));
+		scene->perObjectUbo.mvp = scene->viewProjection*scene->perObjectUbo.model;
+		scene->perObjectUbo.normal = glm::mat4(1.0f);
+		glBindBuffer(GL_UNIFORM_BUFFER, scene->perObjectUboID);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(per_object_ubo), &scene->perObjectUbo);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+		glDrawElements(GL_TRIANGLES, scene->quadIndexCount, GL_UNSIGNED_INT, 0);
+	}
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// NOTE(joon) : Binds & clears the framebuffer of the scene, and waits for the GPU so that the timing can start
+static void
+BeginShadingBenchmarkFrame(shading_benchmark_scene *scene)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, scene->framebufferID);
+	glViewport(0, 0, scene->width, scene->height);
+	glEnable(GL_DEPTH_TEST);
+	glDepthFunc(GL_LESS);
+	glClearColor(scene->perFrameUbo.IFog.r, scene->perFrameUbo.IFog.g, scene->perFrameUbo.IFog.b, 1);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glBindBufferBase(GL_UNIFORM_BUFFER, 0, scene->perFrameUboID);
+	glBindBufferBase(GL_UNIFORM_BUFFER, 1, scene->perObjectUboID);
+	glBindBufferBase(GL_UNIFORM_BUFFER, SHADOW_UBO_BINDING, scene->shadowUboID);
+	glFinish();
+}
+
+static void
+EndShadingBenchmarkFrame(shading_benchmark_scene *scene, std::vector<u8> *pixels)
+{
+	if (pixels)
+	{
+		pixels->resize(4*scene->width*scene->height);
+		glReadPixels(0, 0, scene->width, scene->height, GL_RGBA, GL_UNSIGNED_BYTE, pixels->data());
+	}
+	glUseProgram(0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+static u32
+GetMaxPixelDifference(std::vector<u8> *a, std::vector<u8> *b)
+{
+	u32 result = 0;
+	for (u32 byteIndex = 0;
+		byteIndex < a->size();
+		++byteIndex)
+	{
+		u32 difference = (u32)abs((i32)(*a)[byteIndex] - (i32)(*b)[byteIndex]);
+		result = Maximum(result, difference);
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Draws one frame with the forward or the deferred shading into the framebuffer of the scene,
+// and returns how long the GPU took for the geometry(the whole frame for the forward) & the lighting
+static void
+DrawDeferredShadingBenchmarkFrame(shading_benchmark_scene *scene, deferred_shading *deferred, u32 layerCount, b32 isDeferred,
+								r64 *geometryTime, r64 *lightingTime, std::vector<u8> *pixels)
+{
+	BeginShadingBenchmarkFrame(scene);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (isDeferred)
+	{
+		BeginGBuffer(deferred, scene->width, scene->height);
+		DrawShadingBenchmarkLayers(scene, layerCount);
+		glFinish();
+		*geometryTime = GetElapsedMilliseconds(start);
+
+		glm::mat4 inverseProjection = glm::inverse(scene->perFrameUbo.projection);
+		glm::mat4 inverseViewProjection = glm::inverse(scene->viewProjection);
+		start = std::chrono::steady_clock::now();
+		ShadeDeferred(deferred, scene->framebufferID, &inverseProjection, &inverseViewProjection);
+		glFinish();
+		*lightingTime = GetElapsedMilliseconds(start);
+	}
+	else
+	{
+		glUseProgram(scene->forwardProgram);
+		DrawShadingBenchmarkLayers(scene, layerCount);
+		glFinish();
+		*geometryTime = GetElapsedMilliseconds(start);
+		*lightingTime = 0.0;
+	}
+
+	EndShadingBenchmarkFrame(scene, pixels);
+}
+
+// NOTE(joon) : Forward vs deferred phong shading of a stack of screen filling quads, as the number of the lights
+// and the overdraw grow. The forward shading lights every layer with every light,
+// while the deferred one only lights the closest layer with the lights of each tile.
+// Checks that both of them end up with the same image.
+static int
+RunDeferredShadingBenchmark(int argc, char **argv)
+{
+	u32 iterationCount = 10;
+	if (argc > 0)
+	{
+		iterationCount = Maximum((u32)atoi(argv[0]), 1u);
+	}
+
+	shading_benchmark_scene scene = {};
+	scene.width = 640;
+	scene.height = 360;
+	GLFWwindow *window = CreateBenchmarkWindow(scene.width, scene.height);
+	if (!window)
+	{
+		return -1;
+	}
+	if (!(GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object && GLEW_ARB_texture_storage))
+	{
+		printf("Deferred shading is not supported\n");
+		DestroyBenchmarkWindow(window);
+		return -1;
+	}
+
+	deferred_shading deferred;
+	b32 isInitialized = InitializeDeferredShading(&deferred);
+	scene.forwardProgram = LoadShaders("source/shaders/phong_shading_shader.vert", "source/shaders/phong_shading_shader.frag");
+	b32 isFramebufferComplete = InitializeShadingBenchmarkScene(&scene);
+
+	int result = 0;
+	if (isInitialized && scene.forwardProgram && isFramebufferComplete)
+	{
+		u32 lightCounts[] = {1, 4, 16};
+		u32 layerCounts[] = {1, 4, 16};
+		// NOTE(joon) : The G-buffer quantizes the albedo & the normal, and the tiles drop
+		// the lights that are too far to change a pixel by more than 1/256
+		u32 maxAllowedDifference = 8;
+
+		printf("%dx%d, %u iterations, G-buffer : %u bytes per pixel\n", scene.width, scene.height, iterationCount, 4 + 4 + 4);
+		printf("lights | overdraw | forward(ms) | g-buffer(ms) | lighting(ms) | deferred(ms) | speedup | max diff\n");
+		for (u32 lightCountIndex = 0;
+			lightCountIndex < ArrayCount(lightCounts);
+			++lightCountIndex)
+		{
+			u32 lightCount = lightCounts[lightCountIndex];
+			SetShadingBenchmarkLightCount(&scene, lightCount);
+
+			for (u32 layerCountIndex = 0;
+				layerCountIndex < ArrayCount(layerCounts);
+				++layerCountIndex)
+			{
+				u32 layerCount = layerCounts[layerCountIndex];
+
+				// NOTE(joon) : one frame to warm up each path, which is also the one that is compared
+				std::vector<u8> forwardPixels;
+				std::vector<u8> deferredPixels;
+				r64 geometryTime;
+				r64 lightingTime;
+				DrawDeferredShadingBenchmarkFrame(&scene, &deferred, layerCount, false, &geometryTime, &lightingTime, &forwardPixels);
+				DrawDeferredShadingBenchmarkFrame(&scene, &deferred, layerCount, true, &geometryTime, &lightingTime, &deferredPixels);
+				u32 maxDifference = GetMaxPixelDifference(&forwardPixels, &deferredPixels);
+
+				r64 forwardTime = 0.0;
+				r64 gBufferTime = 0.0;
+				r64 deferredLightingTime = 0.0;
+				for (u32 iterationIndex = 0;
+					iterationIndex < iterationCount;
+					++iterationIndex)
+				{
+					DrawDeferredShadingBenchmarkFrame(&scene, &deferred, layerCount, false, &geometryTime, &lightingTime, 0);
+					forwardTime += geometryTime;
+					DrawDeferredShadingBenchmarkFrame(&scene, &deferred, layerCount, true, &geometryTime, &lightingTime, 0);
+					gBufferTime += geometryTime;
+					deferredLightingTime += lightingTime;
+				}
+				forwardTime /= iterationCount;
+				gBufferTime /= iterationCount;
+				deferredLightingTime /= iterationCount;
+				r64 deferredTime = gBufferTime + deferredLightingTime;
+
+				printf("%6u | %8u | %11.3f | %12.3f | %12.3f | %12.3f | %6.2fx | %u\n",
+						lightCount, layerCount, forwardTime, gBufferTime, deferredLightingTime, deferredTime,
+						forwardTime / deferredTime, maxDifference);
+
+				if (maxDifference > maxAllowedDifference)
+				{
+					printf("deferred image DIFFERS from the forward one\n");
+					result = -1;
+				}
+			}
+		}
+	}
+	else
+	{
+		printf("Failed to create the deferred shading resources\n");
+		result = -1;
+	}
+
+	FreeShadingBenchmarkScene(&scene);
+	FreeDeferredShading(&deferred);
+	DestroyBenchmarkWindow(window);
+
+	return result;
+}
+
+// NOTE(joon) : Draws one frame with or without the depth pre-pass into the framebuffer of the scene,
+// and returns how long the GPU took for the pre-pass & the lit pass
+static void
+DrawDepthPrePassBenchmarkFrame(shading_benchmark_scene *scene, GLuint depthOnlyProgram, u32 layerCount, b32 shouldDepthPrePass,
+								r64 *prePassTime, r64 *litTime, std::vector<u8> *pixels)
+{
+	BeginShadingBenchmarkFrame(scene);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	*prePassTime = 0.0;
+	if (shouldDepthPrePass)
+	{
+		glUseProgram(depthOnlyProgram);
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		DrawShadingBenchmarkLayers(scene, layerCount, true);
+		glFinish();
+		*prePassTime = GetElapsedMilliseconds(start);
+
+		glDepthFunc(GL_EQUAL);
+		glDepthMask(GL_FALSE);
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		start = std::chrono::steady_clock::now();
+	}
+
+	glUseProgram(scene->forwardProgram);
+	DrawShadingBenchmarkLayers(scene, layerCount);
+	glFinish();
+	*litTime = GetElapsedMilliseconds(start);
+
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+	EndShadingBenchmarkFrame(scene, pixels);
+}
+
+// NOTE(joon) : Phong shading of a stack of screen filling quads drawn from back to front, with & without the depth pre-pass.
+// The pre-pass pays for itself when the shading that it saves on the hidden layers costs more than
+// drawing the geometry twice, so the quads are also tessellated to make the geometry more expensive.
+// The images should be exactly the same, as the lit pass only keeps the fragments at the depth of the pre-pass.
+static int
+RunDepthPrePassBenchmark(int argc, char **argv)
+{
+	u32 iterationCount = 10;
+	if (argc > 0)
+	{
+		iterationCount = Maximum((u32)atoi(argv[0]), 1u);
+	}
+
+	shading_benchmark_scene scene = {};
+	scene.width = 640;
+	scene.height = 360;
+	GLFWwindow *window = CreateBenchmarkWindow(scene.width, scene.height);
+	if (!window)
+	{
+		return -1;
+	}
+
+	scene.forwardProgram = LoadShaders("source/shaders/phong_shading_shader.vert", "source/shaders/phong_shading_shader.frag");
+	GLuint depthOnlyProgram = LoadShaders("source/shaders/depth_only_shader.vert", "source/shaders/depth_only_shader.frag");
+	b32 isFramebufferComplete = InitializeShadingBenchmarkScene(&scene);
+
+	int result = 0;
+	if (scene.forwardProgram && depthOnlyProgram && isFramebufferComplete)
+	{
+		u32 lightCounts[] = {1, 16};
+		u32 cellCounts[] = {1, 128};
+		u32 layerCounts[] = {1, 4, 16};
+
+		printf("%dx%d, %u iterations\n", scene.width, scene.height, iterationCount);
+		printf("lights | triangles | overdraw | forward(ms) | pre-pass(ms) | lit(ms) | with pre-pass(ms) | speedup | pays off | identical\n");
+		for (u32 lightCountIndex = 0;
+			lightCountIndex < ArrayCount(lightCounts);
+			++lightCountIndex)
+		{
+			u32 lightCount = lightCounts[lightCountIndex];
+			SetShadingBenchmarkLightCount(&scene, lightCount);
+
+			for (u32 cellCountIndex = 0;
+				cellCountIndex < ArrayCount(cellCounts);
+				++cellCountIndex)
+			{
+				CreateShadingBenchmarkQuad(&scene, cellCounts[cellCountIndex]);
+				u32 triangleCount = scene.quadIndexCount / 3;
+
+				for (u32 layerCountIndex = 0;
+					layerCountIndex < ArrayCount(layerCounts);
+					++layerCountIndex)
+				{
+					u32 layerCount = layerCounts[layerCountIndex];
+
+					// NOTE(joon) : one frame to warm up each path, which is also the one that is compared
+					std::vector<u8> forwardPixels;
+					std::vector<u8> prePassPixels;
+					r64 prePassTime;
+					r64 litTime;
+					DrawDepthPrePassBenchmarkFrame(&scene, depthOnlyProgram, layerCount, false, &prePassTime, &litTime, &forwardPixels);
+					DrawDepthPrePassBenchmarkFrame(&scene, depthOnlyProgram, layerCount, true, &prePassTime, &litTime, &prePassPixels);
+					b32 isIdentical = (forwardPixels == prePassPixels);
+
+					r64 forwardTime = 0.0;
+					r64 totalPrePassTime = 0.0;
+					r64 totalLitTime = 0.0;
+					for (u32 iterationIndex = 0;
+						iterationIndex < iterationCount;
+						++iterationIndex)
+					{
+						DrawDepthPrePassBenchmarkFrame(&scene, depthOnlyProgram, layerCount, false, &prePassTime, &litTime, 0);
+						forwardTime += litTime;
+						DrawDepthPrePassBenchmarkFrame(&scene, depthOnlyProgram, layerCount, true, &prePassTime, &litTime, 0);
+						totalPrePassTime += prePassTime;
+						totalLitTime += litTime;
+					}
+					forwardTime /= iterationCount;
+					totalPrePassTime /= iterationCount;
+					totalLitTime /= iterationCount;
+					r64 withPrePassTime = totalPrePassTime + totalLitTime;
+
+					printf("%6u | %9u | %8u | %11.3f | %12.3f | %7.3f | %17.3f | %6.2fx | %8s | %s\n",
+							lightCount, triangleCount*layerCount, layerCount, forwardTime, totalPrePassTime, totalLitTime,
+							withPrePassTime, forwardTime / withPrePassTime, (withPrePassTime < forwardTime) ? "yes" : "no",
+							isIdentical ? "yes" : "NO");
+
+					if (!isIdentical)
+					{
+						printf("pre-pass image DIFFERS by %u from the forward one\n", GetMaxPixelDifference(&forwardPixels, &prePassPixels));
+						result = -1;
+					}
+				}
+			}
+		}
+	}
+	else
+	{
+		printf("Failed to create the depth pre-pass resources\n");
+		result = -1;
+	}
+
+	glDeleteProgram(depthOnlyProgram);
+	FreeShadingBenchmarkScene(&scene);
+	DestroyBenchmarkWindow(window);
+
+	return result;
+}
+
+enum capture_benchmark_mode
+{
+	CaptureBenchmarkMode_None,
+	CaptureBenchmarkMode_ReadPixels, // glReadPixels into the memory & writes the frame right away, what a naive capture would do
+	CaptureBenchmarkMode_Async, // frame_capture
+};
+
+// NOTE(joon) : Draws one frame of the shading scene with one of the lights moved by frameIndex, so that every frame is different,
+// captures it and waits for the GPU. Returns how long the frame took.
+static r64
+DrawCaptureBenchmarkFrame(shading_benchmark_scene *scene, u32 frameIndex, capture_benchmark_mode mode,
+						frame_writer *writer, frame_capture *capture, std::vector<u32> *pixels)
+{
+	BeginShadingBenchmarkFrame(scene);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	scene->perFrameUbo.lights[0].p.x = -6.0f + 12.0f*((frameIndex % 32) / 31.0f);
+	glBindBuffer(GL_UNIFORM_BUFFER, scene->perFrameUboID);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(per_frame_ubo), &scene->perFrameUbo);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glUseProgram(scene->forwardProgram);
+	DrawShadingBenchmarkLayers(scene, 4);
+
+	switch (mode)
+	{
+		case CaptureBenchmarkMode_ReadPixels:
+		{
+			pixels->resize(scene->width*scene->height);
+			glReadPixels(0, 0, scene->width, scene->height, GL_RGBA, GL_UNSIGNED_BYTE, pixels->data());
+			WriteCapturedFrame(writer, pixels->data(), scene->width, scene->height, scene->width);
+		}break;
+
+		case CaptureBenchmarkMode_Async:
+		{
+			CaptureFrame(capture, scene->width, scene->height);
+		}break;
+
+		default:
+		{
+		}break;
+	}
+	glFinish();
+	r64 result = GetElapsedMilliseconds(start);
+
+	EndShadingBenchmarkFrame(scene, 0);
+
+	return result;
+}
+
+// NOTE(joon) : Returns true when both recordings have the same frameCount frames
+static b32
+AreCaptureBenchmarkOutputsIdentical(frame_capture_format format, const char *prefixA, const char *prefixB, u32 frameCount, b32 shouldRemove)
+{
+	b32 result = true;
+	u32 fileCount = (format == FrameCaptureFormat_Y4M) ? 1 : frameCount;
+	for (u32 fileIndex = 0;
+		fileIndex < fileCount;
+		++fileIndex)
+	{
+		char fileNames[2][512];
+		const char *prefixes[2] = {prefixA, prefixB};
+		std::vector<u8> contents[2];
+		for (u32 index = 0;
+			index < 2;
+			++index)
+		{
+			if (format == FrameCaptureFormat_Y4M)
+			{
+				snprintf(fileNames[index], sizeof(fileNames[index]), "%s.y4m", prefixes[index]);
+			}
+			else
+			{
+				snprintf(fileNames[index], sizeof(fileNames[index]), "%s_%06u.png", prefixes[index], fileIndex);
+			}
+			if (!ReadWholeFile(fileNames[index], &contents[index]))
+			{
+				result = false;
+			}
+			if (shouldRemove)
+			{
+				remove(fileNames[index]);
+			}
+		}
+
+		if (contents[0] != contents[1] || contents[0].empty())
+		{
+			result = false;
+		}
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Frame time without any capture, with the glReadPixels that stalls & writes the frame right away,
+// and with the frame capture. Both captures should write the same frames.
+static int
+RunFrameCaptureBenchmark(int argc, char **argv)
+{
+	u32 frameCount = 60;
+	if (argc > 0)
+	{
+		frameCount = Maximum((u32)atoi(argv[0]), 1u);
+	}
+	frame_capture_format formats[] = {FrameCaptureFormat_PNG, FrameCaptureFormat_Y4M};
+	u32 formatCount = ArrayCount(formats);
+	if (argc > 1)
+	{
+		formats[0] = (strcmp(argv[1], "y4m") == 0) ? FrameCaptureFormat_Y4M : FrameCaptureFormat_PNG;
+		formatCount = 1;
+	}
+
+	shading_benchmark_scene scene = {};
+	scene.width = 1280;
+	scene.height = 720;
+	GLFWwindow *window = CreateBenchmarkWindow(scene.width, scene.height);
+	if (!window)
+	{
+		return -1;
+	}
+	if (!GLEW_ARB_buffer_storage)
+	{
+		printf("Frame capture is not supported\n");
+		DestroyBenchmarkWindow(window);
+		return -1;
+	}
+
+	scene.forwardProgram = LoadShaders("source/shaders/phong_shading_shader.vert", "source/shaders/phong_shading_shader.frag");
+	b32 isFramebufferComplete = InitializeShadingBenchmarkScene(&scene);
+	frame_capture capture;
+	InitializeFrameCapture(&capture);
+
+	int result = 0;
+	if (scene.forwardProgram && isFramebufferComplete)
+	{
+		SetShadingBenchmarkLightCount(&scene, 16);
+		const char *formatNames[] = {"png", "y4m"};
+		const char *modeNames[] = {"none", "readpixels", "async"};
+		const char *readPixelsPrefix = "capture_benchmark_readpixels";
+		const char *asyncPrefix = "capture_benchmark_async";
+
+		printf("%dx%d, %u frames\n", scene.width, scene.height, frameCount);
+		printf("format | capture    | frame(ms) | max frame(ms) | overhead | drain(ms) | stalls | frames | identical\n");
+		for (u32 formatIndex = 0;
+			formatIndex < formatCount;
+			++formatIndex)
+		{
+			frame_capture_format format = formats[formatIndex];
+			r64 noCaptureFrameTime = 0.0;
+			u64 writtenFrameCounts[3] = {};
+
+			for (u32 mode = CaptureBenchmarkMode_None;
+				mode <= CaptureBenchmarkMode_Async;
+				++mode)
+			{
+				frame_writer writer = {};
+				std::vector<u32> pixels;
+				if (mode == CaptureBenchmarkMode_ReadPixels)
+				{
+					OpenFrameWriter(&writer, format, readPixelsPrefix);
+				}
+				else if (mode == CaptureBenchmarkMode_Async)
+				{
+					StartFrameCapture(&capture, format, asyncPrefix);
+				}
+
+				// NOTE(joon) : The first frame also creates the pixel buffers, so it's not a part of the average
+				r64 frameTime = 0.0;
+				r64 maxFrameTime = 0.0;
+				for (u32 frameIndex = 0;
+					frameIndex < frameCount;
+					++frameIndex)
+				{
+					r64 time = DrawCaptureBenchmarkFrame(&scene, frameIndex, (capture_benchmark_mode)mode, &writer, &capture, &pixels);
+					if (frameIndex > 0 || frameCount == 1)
+					{
+						frameTime += time;
+						maxFrameTime = Maximum(maxFrameTime, time);
+					}
+				}
+				frameTime /= Maximum(frameCount - 1, 1u);
+
+				std::chrono::steady_clock::time_point drainStart = std::chrono::steady_clock::now();
+				u64 stallCount = 0;
+				if (mode == CaptureBenchmarkMode_ReadPixels)
+				{
+					CloseFrameWriter(&writer);
+					writtenFrameCounts[mode] = writer.writtenFrameCount;
+				}
+				else if (mode == CaptureBenchmarkMode_Async)
+				{
+					StopFrameCapture(&capture);
+					writtenFrameCounts[mode] = capture.writer.writtenFrameCount;
+					stallCount = capture.stallCount;
+				}
+				r64 drainTime = GetElapsedMilliseconds(drainStart);
+
+				if (mode == CaptureBenchmarkMode_None)
+				{
+					noCaptureFrameTime = frameTime;
+					printf("%6s | %-10s | %9.3f | %13.3f | %8s | %9s | %6s | %6s | %s\n",
+							formatNames[format], modeNames[mode], frameTime, maxFrameTime, "-", "-", "-", "-", "-");
+				}
+				else
+				{
+					b32 isIdentical = true;
+					if (mode == CaptureBenchmarkMode_Async)
+					{
+						isIdentical = AreCaptureBenchmarkOutputsIdentical(format, readPixelsPrefix, asyncPrefix, frameCount, true);
+					}
+					printf("%6s | %-10s | %9.3f | %13.3f | %7.1f%% | %9.3f | %6llu | %6llu | %s\n",
+							formatNames[format], modeNames[mode], frameTime, maxFrameTime,
+							100.0*(frameTime / noCaptureFrameTime - 1.0), drainTime, (unsigned long long)stallCount,
+							(unsigned long long)writtenFrameCounts[mode], (mode == CaptureBenchmarkMode_Async) ? (isIdentical ? "yes" : "NO") : "-");
+
+					if (writtenFrameCounts[mode] != frameCount)
+					{
+						printf("%s capture has LOST %llu frames\n", modeNames[mode], (unsigned long long)(frameCount - writtenFrameCounts[mode]));
+						result = -1;
+					}
+					if (!isIdentical)
+					{
+						printf("async capture DIFFERS from the glReadPixels one\n");
+						result = -1;
+					}
+				}
+			}
+		}
+	}
+	else
+	{
+		printf("Failed to create the frame capture resources\n");
+		result = -1;
+	}
+
+	FreeFrameCapture(&capture);
+	FreeShadingBenchmarkScene(&scene);
+	DestroyBenchmarkWindow(window);
+
+	return result;
+}
+
+// NOTE(joon) : Renders the default scene with the software renderer using 1 to maxWorkerCount workers,
+// once for each lighting shader. The image should not depend on the worker count.
+static int
+RunSoftwareRendererBenchmark(int argc, char **argv)
+{
+	u32 maxWorkerCount = Maximum(std::thread::hardware_concurrency(), 1u);
+	u32 frameCount = 5;
+	i32 width = 1280;
+	i32 height = 720;
+	if (argc > 0)
+	{
+		maxWorkerCount = Maximum((u32)atoi(argv[0]), 1u);
+	}
+	if (argc > 1)
+	{
+		frameCount = Maximum((u32)atoi(argv[1]), 1u);
+	}
+
+	// NOTE(joon) : Only one job system can be alive at a time, so the packet is built first.
+	// The shaders only change the selectedProgramIndex of the packet.
+	headless_scene headless = {};
+	{
+		job_system jobSystem;
+		InitializeJobSystem(&jobSystem, maxWorkerCount);
+		InitializeHeadlessScene(&headless, &jobSystem, width, height);
+		BuildHeadlessFrame(&headless);
+		ShutdownJobSystem(&jobSystem);
+		headless.scene.jobSystem = 0;
+		headless.modelRegistry.jobSystem = 0;
+	}
+	frame_packet *packet = &headless.packet;
+
+	software_renderer renderer = {};
+	InitializeSoftwareRenderer(&renderer, width, height);
+	LoadSoftwareTexture(&renderer.diffuseTexture, "textures/metal_roof_diff_512x512.png");
+
+	const char *shaderNames[] = {"phong", "gouraud", "blinn"};
+	std::vector<u32> referenceImage(renderer.stride*height);
+
+	int result = 0;
+	printf("%dx%d, %u frames\n", width, height, frameCount);
+	printf("shader  | workers | vertex(ms) | setup(ms) | raster(ms) | total(ms) | Mtri/s | Mpixel/s | speedup\n");
+	for (u32 shaderIndex = 0;
+		shaderIndex < ArrayCount(shaderNames);
+		++shaderIndex)
+	{
+		packet->selectedProgramIndex = shaderIndex;
+
+		r64 singleWorkerTotal = 0.0;
+		for (u32 workerCount = 1;
+			workerCount <= maxWorkerCount;
+			++workerCount)
+		{
+			job_system jobSystem;
+			InitializeJobSystem(&jobSystem, workerCount);
+
+			r64 vertexTime = 0.0;
+			r64 setupTime = 0.0;
+			r64 rasterizeTime = 0.0;
+			for (u32 frameIndex = 0;
+				frameIndex < frameCount;
+				++frameIndex)
+			{
+				RenderFramePacketInSoftware(&renderer, &jobSystem, packet);
+				vertexTime += renderer.vertexTime;
+				setupTime += renderer.setupTime;
+				rasterizeTime += renderer.rasterizeTime;
+			}
+			ShutdownJobSystem(&jobSystem);
+
+			vertexTime /= frameCount;
+			setupTime /= frameCount;
+			rasterizeTime /= frameCount;
+			r64 total = vertexTime + setupTime + rasterizeTime;
+			if (workerCount == 1)
+			{
+				singleWorkerTotal = total;
+				memcpy(referenceImage.data(), renderer.color, sizeof(u32)*referenceImage.size());
+			}
+			else if (memcmp(referenceImage.data(), renderer.color, sizeof(u32)*referenceImage.size()) != 0)
+			{
+				printf("%s with %u workers DIFFERS from the single worker image\n", shaderNames[shaderIndex], workerCount);
+				result = -1;
+			}
+
+			printf("%-7s | %7u | %10.2f | %9.2f | %10.2f | %9.2f | %6.2f | %8.2f | %6.2fx\n",
+					shaderNames[shaderIndex], workerCount, vertexTime, setupTime, rasterizeTime, total,
+					renderer.submittedTriangleCount / (total*1000.0), renderer.shadedPixelCount / (total*1000.0),
+					singleWorkerTotal/total);
+		}
+	}
+	printf("%u triangles submitted, %u rasterized, %llu pixels shaded per frame\n",
+			renderer.submittedTriangleCount, renderer.rasterizedTriangleCount, (unsigned long long)renderer.shadedPixelCount);
+
+	FreeSoftwareRenderer(&renderer);
+	FreeHeadlessScene(&headless);
+
+	return result;
+}
+
+// NOTE(joon) : Culls the meshlets of every model from the views orbiting around it, the same way the build stage does.
+// Every triangle of the rejected meshlets is checked to be really invisible, so this fails when the culling is not conservative.
+static int
+RunMeshletBenchmark(int argc, char **argv)
+{
+	u32 viewCount = 64;
+	if (argc > 0)
+	{
+		viewCount = Maximum((u32)atoi(argv[0]), 1u);
+	}
+
+	job_system jobSystem;
+	InitializeJobSystem(&jobSystem, Maximum(std::thread::hardware_concurrency(), 1u));
+
+	std::vector<model> models(ArrayCount(modelFileNames));
+	LoadModels(&jobSystem, models.data(), modelFileNames, (u32)models.size());
+
+	// NOTE(joon) : Same as the default scene, the model is scaled by 2 and the camera orbits from (13, 6, 0).
+	// The near views are close enough that a part of the model is outside of the frustum.
+	glm::mat4 world = glm::scale(glm::vec3(2.0f, 2.0f, 2.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f/9.0f, 0.1f, 100.0f);
+	glm::vec3 viewStarts[2] = {glm::vec3(13.0f, 6.0f, 0.0f), glm::vec3(3.0f, 1.5f, 0.0f)};
+
+	int result = 0;
+	u64 allTriangleCount = 0;
+	u64 allRejectedTriangleCounts[2] = {};
+	printf("views : %u per distance, rejected triangles are the percentage of the triangles\n", viewCount);
+	printf("model               | triangles | meshlets | verts/meshlet | tris/meshlet | build(ms) | far : frustum | cone  | near : frustum | cone  | wrongly culled\n");
+	for (u32 modelIndex = 0;
+		modelIndex < models.size();
+		++modelIndex)
+	{
+		mesh *mesh = &models[modelIndex].mesh;
+		if (mesh->meshlets.empty())
+		{
+			continue;
+		}
+
+		// NOTE(joon) : already built by the loading, but built once more to see how long it takes
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		BuildMeshlets(mesh);
+		r64 buildTime = GetElapsedMilliseconds(start);
+
+		u32 meshletCount = (u32)mesh->meshlets.size();
+		u32 triangleCount = (u32)mesh->indexBuffer.size() / 3;
+		u64 vertexSum = 0;
+		for (u32 meshletIndex = 0;
+			meshletIndex < meshletCount;
+			++meshletIndex)
+		{
+			vertexSum += mesh->meshlets[meshletIndex].vertexCount;
+		}
+
+		std::vector<u8> results(meshletCount);
+		u64 rejectedTriangleCounts[2][2] = {}; // [far, near][frustum, cone]
+		u32 wronglyCulledCount = 0;
+		for (u32 distanceIndex = 0;
+			distanceIndex < ArrayCount(viewStarts);
+			++distanceIndex)
+		{
+			for (u32 viewIndex = 0;
+				viewIndex < viewCount;
+				++viewIndex)
+			{
+				r32 angle = Two_Pi32*viewIndex / viewCount;
+				glm::vec3 cameraP = glm::vec3(glm::rotate(angle, glm::vec3(0, 1, 0)) * glm::vec4(viewStarts[distanceIndex], 1.0f));
+				glm::mat4 mvp = projection * glm::lookAt(cameraP, glm::vec3(0, 0, 0), glm::vec3(0, 1, 0)) * world;
+				CullMeshlets(&jobSystem, mesh, &world, &mvp, cameraP, results.data());
+
+				glm::vec3 modelCameraP = glm::vec3(glm::inverse(world) * glm::vec4(cameraP, 1.0f));
+				glm::vec4 frustumPlanes[6];
+				ExtractFrustumPlanes(&mvp, frustumPlanes);
+				for (u32 meshletIndex = 0;
+					meshletIndex < meshletCount;
+					++meshletIndex)
+				{
+					meshlet *meshlet = &mesh->meshlets[meshletIndex];
+					if (results[meshletIndex] == MeshletCullResult_Visible)
+					{
+						continue;
+					}
+					rejectedTriangleCounts[distanceIndex][results[meshletIndex] == MeshletCullResult_Cone] += meshlet->triangleCount;
+
+					for (u32 triangleIndex = 0;
+						triangleIndex < meshlet->triangleCount;
+						++triangleIndex)
+					{
+						u32 *indices = mesh->indexBuffer.data() + meshlet->firstIndex + 3*triangleIndex;
+						glm::vec3 p0 = mesh->vertexBuffer[indices[0]].p;
+						glm::vec3 p1 = mesh->vertexBuffer[indices[1]].p;
+						glm::vec3 p2 = mesh->vertexBuffer[indices[2]].p;
+
+						b32 isInvisible = false;
+						if (results[meshletIndex] == MeshletCullResult_Frustum)
+						{
+							// NOTE(joon) : every corner should be outside of the same plane
+							for (u32 planeIndex = 0;
+								planeIndex < 6 && !isInvisible;
+								++planeIndex)
+							{
+								glm::vec3 normal = glm::vec3(frustumPlanes[planeIndex]);
+								r32 w = frustumPlanes[planeIndex].w;
+								isInvisible = (glm::dot(normal, p0) + w < 0.0f) &&
+											(glm::dot(normal, p1) + w < 0.0f) &&
+											(glm::dot(normal, p2) + w < 0.0f);
+							}
+						}
+						else
+						{
+							// NOTE(joon) : a little bit of tolerance for the triangles that are exactly edge on
+							glm::vec3 normal = GetTriangleNormal(mesh, indices);
+							isInvisible = (glm::dot(normal, glm::normalize(p0 - modelCameraP)) >= -1e-4f);
+						}
+
+						if (!isInvisible)
+						{
+							++wronglyCulledCount;
+						}
+					}
+				}
+			}
+		}
+
+		r64 toPercentage = 100.0 / ((r64)triangleCount*viewCount);
+		printf("%-19s | %9u | %8u | %13.1f | %12.1f | %9.2f |       %6.1f%% | %4.1f%% |        %6.1f%% | %4.1f%% | %u\n",
+				modelFileNames[modelIndex], triangleCount, meshletCount, (r64)vertexSum / meshletCount, (r64)triangleCount / meshletCount,
+				buildTime, rejectedTriangleCounts[0][0]*toPercentage, rejectedTriangleCounts[0][1]*toPercentage,
+				rejectedTriangleCounts[1][0]*toPercentage, rejectedTriangleCounts[1][1]*toPercentage, wronglyCulledCount);
+
+		allTriangleCount += (u64)triangleCount*viewCount;
+		allRejectedTriangleCounts[0] += rejectedTriangleCounts[0][0] + rejectedTriangleCounts[0][1];
+		allRejectedTriangleCounts[1] += rejectedTriangleCounts[1][0] + rejectedTriangleCounts[1][1];
+		if (wronglyCulledCount)
+		{
+			printf("%s has %u visible triangles inside the culled meshlets\n", modelFileNames[modelIndex], wronglyCulledCount);
+			result = -1;
+		}
+	}
+	printf("rejected triangles of every model : far %.1f%%, near %.1f%%\n",
+			100.0*allRejectedTriangleCounts[0] / allTriangleCount, 100.0*allRejectedTriangleCounts[1] / allTriangleCount);
+
+	ShutdownJobSystem(&jobSystem);
+
+	return result;
+}
+
+// NOTE(joon) : Torus with the normals & texcoords, for the loader benchmarks.
+// Each quad is 4 vertex indices, and gets split into (0, 1, 2) & (0, 2, 3) by every writer.
+struct benchmark_torus
+{
+	std::vector<vertex> vertices;
+	std::vector<u32> quads;
+};
+
+static void
+BuildBenchmarkTorus(benchmark_torus *torus, u32 triangleCount)
+{
+	u32 ringCount = Minimum(triangleCount / 64, 500u);
+	u32 segmentCount = Maximum(triangleCount / (2*ringCount), 3u);
+
+	torus->vertices.resize(segmentCount*ringCount);
+	torus->quads.resize(4*segmentCount*ringCount);
+	for (u32 segmentIndex = 0;
+		segmentIndex < segmentCount;
+		++segmentIndex)
+	{
+		r32 theta = Two_Pi32*segmentIndex/segmentCount;
+		for (u32 ringIndex = 0;
+			ringIndex < ringCount;
+			++ringIndex)
+		{
+			r32 phi = Two_Pi32*ringIndex/ringCount;
+			r32 radius = 1.0f + 0.35f*cosf(phi);
+
+			vertex *vertex = torus->vertices.data() + segmentIndex*ringCount + ringIndex;
+			vertex->p = glm::vec3(radius*cosf(theta), 0.35f*sinf(phi), radius*sinf(theta));
+			vertex->normal = glm::vec3(cosf(phi)*cosf(theta), sinf(phi), cosf(phi)*sinf(theta));
+			vertex->texCoord = glm::vec2((r32)segmentIndex/segmentCount, (r32)ringIndex/ringCount);
+
+			u32 nextSegment = (segmentIndex + 1) % segmentCount;
+			u32 nextRing = (ringIndex + 1) % ringCount;
+			u32 *quad = torus->quads.data() + 4*(segmentIndex*ringCount + ringIndex);
+			quad[0] = segmentIndex*ringCount + ringIndex;
+			quad[1] = segmentIndex*ringCount + nextRing;
+			quad[2] = nextSegment*ringCount + nextRing;
+			quad[3] = nextSegment*ringCount + ringIndex;
+		}
+	}
+}
+
+static void
+PushPLYBenchmarkValue(std::vector<u8> *bytes, void *value, u32 size, b32 isBigEndian)
+{
+	u8 *valueBytes = (u8 *)value;
+	for (u32 byteIndex = 0;
+		byteIndex < size;
+		++byteIndex)
+	{
+		bytes->push_back(valueBytes[isBigEndian ? (size - 1 - byteIndex) : byteIndex]);
+	}
+}
+
+static b32
+WritePLYBenchmarkFile(const char *fileName, std::string *header, std::vector<u8> *bytes)
+{
+	FILE *file = fopen(fileName, "wb");
+	if (!file)
+	{
+		printf("Failed to write %s\n", fileName);
+		return false;
+	}
+	fwrite(header->data(), 1, header->size(), file);
+	fwrite(bytes->data(), 1, bytes->size(), file);
+	fclose(file);
+
+	return true;
+}
+
+// NOTE(joon) : A triangle and a quad, which have fewer vertices than the chunks that NormalizeMeshVertices reduces the bounds with.
+// They should still be centered & scaled into [-1, 1], and get valid normals.
+static b32
+CheckSmallPLYMeshes(job_system *jobSystem)
+{
+	const char *fileName = "ply_benchmark_small.ply";
+	glm::vec3 positions[] = {glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(2.0f, 0.0f, 0.0f), glm::vec3(2.0f, 2.0f, 0.0f), glm::vec3(0.0f, 2.0f, 0.0f)};
+	u32 vertexCounts[] = {3, 4};
+
+	b32 result = true;
+	for (u32 caseIndex = 0;
+		caseIndex < ArrayCount(vertexCounts);
+		++caseIndex)
+	{
+		u32 vertexCount = vertexCounts[caseIndex];
+
+		char header[512];
+		snprintf(header, sizeof(header), 
+				"ply\nformat binary_little_endian 1.0\n"
+				"element vertex %u\nproperty float x\nproperty float y\nproperty float z\n"
+				"element face 1\nproperty list uchar int vertex_indices\nend_header\n", vertexCount);
+		std::string headerString = header;
+
+		std::vector<u8> bytes;
+		glm::vec3 min(FLT_MAX, FLT_MAX, FLT_MAX);
+		glm::vec3 max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		glm::vec3 average(0.0f, 0.0f, 0.0f);
+		for (u32 vertexIndex = 0;
+			vertexIndex < vertexCount;
+			++vertexIndex)
+		{
+			PushPLYBenchmarkValue(&bytes, positions + vertexIndex, sizeof(glm::vec3), false);
+			UpdateBoundingBox(&min, &max, positions[vertexIndex]);
+			average += positions[vertexIndex];
+		}
+		average /= (r32)vertexCount;
+		r32 maxDiff = Maximum(Maximum(max.x - min.x, max.y - min.y), max.z - min.z)/2.0f;
+
+		bytes.push_back((u8)vertexCount);
+		for (u32 vertexIndex = 0;
+			vertexIndex < vertexCount;
+			++vertexIndex)
+		{
+			PushPLYBenchmarkValue(&bytes, &vertexIndex, sizeof(u32), false);
+		}
+		if (!WritePLYBenchmarkFile(fileName, &headerString, &bytes))
+		{
+			return false;
+		}
+
+		mesh mesh;
+		ReadPLYFile(jobSystem, &mesh, fileName);
+		remove(fileName);
+
+		b32 isValid = (mesh.vertexBuffer.size() == vertexCount && mesh.indexBuffer.size() == 3*(vertexCount - 2));
+		for (u32 vertexIndex = 0;
+			isValid && vertexIndex < vertexCount;
+			++vertexIndex)
+		{
+			vertex *vertex = mesh.vertexBuffer.data() + vertexIndex;
+			glm::vec3 expected = (positions[vertexIndex] - average) / maxDiff;
+			glm::vec3 difference = glm::abs(vertex->p - expected);
+			r32 normalLength = glm::length(vertex->normal);
+			isValid = (Maximum(Maximum(difference.x, difference.y), difference.z) < 1e-5f) &&
+						(normalLength > 0.999f && normalLength < 1.001f);
+		}
+
+		if (!isValid)
+		{
+			printf("The small ply with %u vertices was not loaded correctly!\n", vertexCount);
+			result = false;
+		}
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Writes a tessellated torus as the obj and as two binary ply files, and loads each of them.
+// The little endian one is the common layout(float x y z & triangles), the big endian one has double positions,
+// properties & elements that we don't use and quad faces. Every file should give the same mesh as the obj.
+static int
+RunPLYBenchmark(int argc, char **argv)
+{
+	u32 triangleCount = 2000000;
+	if (argc > 0)
+	{
+		triangleCount = Maximum((u32)atoi(argv[0]), 64u);
+	}
+
+	benchmark_torus torus;
+	BuildBenchmarkTorus(&torus, triangleCount);
+	u32 vertexCount = (u32)torus.vertices.size();
+	u32 quadCount = (u32)torus.quads.size()/4;
+
+	const char *fileNames[] = {"ply_benchmark.obj", "ply_benchmark_little_endian.ply", "ply_benchmark_big_endian.ply"};
+
+	{
+		FILE *file = fopen(fileNames[0], "wb");
+		if (!file)
+		{
+			printf("Failed to write %s\n", fileNames[0]);
+			return -1;
+		}
+		for (u32 vertexIndex = 0;
+			vertexIndex < vertexCount;
+			++vertexIndex)
+		{
+			glm::vec3 p = torus.vertices[vertexIndex].p;
+			fprintf(file, "v %.9g %.9g %.9g\n", p.x, p.y, p.z);
+		}
+		for (u32 quadIndex = 0;
+			quadIndex < quadCount;
+			++quadIndex)
+		{
+			u32 *quad = torus.quads.data() + 4*quadIndex;
+			fprintf(file, "f %u %u %u\nf %u %u %u\n", quad[0] + 1, quad[1] + 1, quad[2] + 1, quad[0] + 1, quad[2] + 1, quad[3] + 1);
+		}
+		fclose(file);
+	}
+
+	{
+		char header[512];
+		snprintf(header, sizeof(header), 
+				"ply\nformat binary_little_endian 1.0\n"
+				"element vertex %u\nproperty float x\nproperty float y\nproperty float z\n"
+				"element face %u\nproperty list uchar int vertex_indices\nend_header\n", vertexCount, 2*quadCount);
+		std::string headerString = header;
+
+		std::vector<u8> bytes;
+		bytes.reserve((size_t)vertexCount*12 + (size_t)quadCount*26);
+		for (u32 vertexIndex = 0;
+			vertexIndex < vertexCount;
+			++vertexIndex)
+		{
+			PushPLYBenchmarkValue(&bytes, &torus.vertices[vertexIndex].p, sizeof(glm::vec3), false);
+		}
+		for (u32 quadIndex = 0;
+			quadIndex < quadCount;
+			++quadIndex)
+		{
+			u32 *quad = torus.quads.data() + 4*quadIndex;
+			u32 triangles[6] = {quad[0], quad[1], quad[2], quad[0], quad[2], quad[3]};
+			bytes.push_back(3);
+			PushPLYBenchmarkValue(&bytes, triangles, 3*sizeof(u32), false);
+			bytes.push_back(3);
+			PushPLYBenchmarkValue(&bytes, triangles + 3, 3*sizeof(u32), false);
+		}
+		if (!WritePLYBenchmarkFile(fileNames[1], &headerString, &bytes))
+		{
+			return -1;
+		}
+	}
+
+	{
+		char header[1024];
+		snprintf(header, sizeof(header), 
+				"ply\nformat binary_big_endian 1.0\ncomment written by the ply benchmark\n"
+				"element vertex %u\nproperty double x\nproperty double y\nproperty double z\nproperty float confidence\nproperty uchar intensity\n"
+				"element face %u\nproperty uchar flags\nproperty list uchar uint vertex_indices\nproperty list uchar float texcoord\n"
+				"element edge 2\nproperty int vertex1\nproperty int vertex2\nend_header\n", vertexCount, quadCount);
+		std::string headerString = header;
+
+		std::vector<u8> bytes;
+		bytes.reserve((size_t)vertexCount*29 + (size_t)quadCount*19 + 16);
+		for (u32 vertexIndex = 0;
+			vertexIndex < vertexCount;
+			++vertexIndex)
+		{
+			for (u32 componentIndex = 0;
+				componentIndex < 3;
+				++componentIndex)
+			{
+				r64 component = torus.vertices[vertexIndex].p[componentIndex];
+				PushPLYBenchmarkValue(&bytes, &component, sizeof(component), true);
+			}
+			r32 confidence = 0.5f;
+			PushPLYBenchmarkValue(&bytes, &confidence, sizeof(confidence), true);
+			bytes.push_back(255);
+		}
+		for (u32 quadIndex = 0;
+			quadIndex < quadCount;
+			++quadIndex)
+		{
+			bytes.push_back(1);
+			bytes.push_back(4);
+			for (u32 cornerIndex = 0;
+				cornerIndex < 4;
+				++cornerIndex)
+			{
+				PushPLYBenchmarkValue(&bytes, torus.quads.data() + 4*quadIndex + cornerIndex, sizeof(u32), true);
+			}
+			bytes.push_back(0);
+		}
+		for (i32 edgeValue = 0;
+			edgeValue < 4;
+			++edgeValue)
+		{
+			PushPLYBenchmarkValue(&bytes, &edgeValue, sizeof(edgeValue), true);
+		}
+		if (!WritePLYBenchmarkFile(fileNames[2], &headerString, &bytes))
+		{
+			return -1;
+		}
+	}
+
+	job_system jobSystem;
+	InitializeJobSystem(&jobSystem, Maximum(std::thread::hardware_concurrency(), 1u));
+
+	int result = 0;
+	mesh meshes[ArrayCount(fileNames)];
+	r64 loadTimes[ArrayCount(fileNames)];
+	printf("%u vertices, %u triangles\n", vertexCount, 2*quadCount);
+	printf("file                            | size(MB) | load(ms) | speedup\n");
+	for (u32 fileIndex = 0;
+		fileIndex < ArrayCount(fileNames);
+		++fileIndex)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (fileIndex == 0)
+		{
+			ReadOBJFileLineByLine(&jobSystem, meshes + fileIndex, fileNames[fileIndex]);
+		}
+		else
+		{
+			ReadPLYFile(&jobSystem, meshes + fileIndex, fileNames[fileIndex]);
+		}
+		loadTimes[fileIndex] = GetElapsedMilliseconds(start);
+
+		std::ifstream file(fileNames[fileIndex], std::ios::ate | std::ios::binary);
+		r64 fileSize = (r64)file.tellg() / (1024.0*1024.0);
+		file.close();
+		remove(fileNames[fileIndex]);
+
+		printf("%-31s | %8.1f | %8.2f | %6.2fx\n", fileNames[fileIndex], fileSize, loadTimes[fileIndex], loadTimes[0] / loadTimes[fileIndex]);
+
+		mesh *expected = meshes + 0;
+		mesh *loaded = meshes + fileIndex;
+		if (loaded->vertexBuffer.size() != expected->vertexBuffer.size() || loaded->indexBuffer != expected->indexBuffer)
+		{
+			printf("%s doesn't have the same vertices or triangles as the obj!\n", fileNames[fileIndex]);
+			result = -1;
+			continue;
+		}
+
+		r32 maxDifference = 0.0f;
+		for (u32 vertexIndex = 0;
+			vertexIndex < loaded->vertexBuffer.size();
+			++vertexIndex)
+		{
+			glm::vec3 difference = glm::abs(loaded->vertexBuffer[vertexIndex].p - expected->vertexBuffer[vertexIndex].p);
+			maxDifference = Maximum(maxDifference, Maximum(Maximum(difference.x, difference.y), difference.z));
+		}
+		if (maxDifference > 1e-5f)
+		{
+			printf("%s positions are off by %f from the obj!\n", fileNames[fileIndex], maxDifference);
+			result = -1;
+		}
+	}
+
+	if (!CheckSmallPLYMeshes(&jobSystem))
+	{
+		result = -1;
+	}
+
+	ShutdownJobSystem(&jobSystem);
+
+	return result;
+}
+
+// NOTE(joon) : glb chunks should be 4 byte aligned, the json is padded with the spaces and the binary with the zeros
+static void
+PushGLBChunk(std::vector<u8> *bytes, u32 type, const void *data, size_t size, u8 padding)
+{
+	u32 paddedSize = (u32)((size + 3) & ~(size_t)3);
+	PushPLYBenchmarkValue(bytes, &paddedSize, sizeof(paddedSize), false);
+	PushPLYBenchmarkValue(bytes, &type, sizeof(type), false);
+	bytes->insert(bytes->end(), (u8 *)data, (u8 *)data + size);
+	bytes->insert(bytes->end(), paddedSize - size, padding);
+}
+
+// NOTE(joon) : A single triangle without the indices & the normals, which has fewer vertices than the chunks
+// that NormalizeMeshVertices reduces the bounds with. It should still be centered & scaled, and get valid normals.
+static b32
+CheckSmallGLTFMesh(job_system *jobSystem)
+{
+	const char *fileName = "gltf_benchmark_small.glb";
+	glm::vec3 positions[3] = {glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(2.0f, 0.0f, 0.0f), glm::vec3(2.0f, 2.0f, 0.0f)};
+	glm::vec3 expectedPositions[3] = {glm::vec3(-4.0f/3.0f, -2.0f/3.0f, 0.0f), glm::vec3(2.0f/3.0f, -2.0f/3.0f, 0.0f), glm::vec3(2.0f/3.0f, 4.0f/3.0f, 0.0f)};
+
+	char json[512];
+	snprintf(json, sizeof(json),
+			"{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+			"\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0}}]}],"
+			"\"buffers\":[{\"byteLength\":%zu}],\"bufferViews\":[{\"buffer\":0,\"byteLength\":%zu}],"
+			"\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":3,\"type\":\"VEC3\"}]}",
+			sizeof(positions), sizeof(positions));
+
+	std::vector<u8> bytes;
+	u32 header[3] = {0x46546c67, 2, 0};
+	PushPLYBenchmarkValue(&bytes, header, sizeof(header), false);
+	PushGLBChunk(&bytes, 0x4e4f534a, json, strlen(json), ' ');
+	PushGLBChunk(&bytes, 0x004e4942, positions, sizeof(positions), 0);
+	u32 totalSize = (u32)bytes.size();
+	memcpy(bytes.data() + 8, &totalSize, sizeof(totalSize));
+
+	std::string noHeader;
+	if (!WritePLYBenchmarkFile(fileName, &noHeader, &bytes))
+	{
+		return false;
+	}
+
+	mesh mesh;
+	ReadGLTFFile(jobSystem, &mesh, fileName);
+	remove(fileName);
+
+	b32 result = (mesh.vertexBuffer.size() == 3 && mesh.indexBuffer.size() == 3);
+	for (u32 vertexIndex = 0;
+		result && vertexIndex < 3;
+		++vertexIndex)
+	{
+		vertex *vertex = mesh.vertexBuffer.data() + vertexIndex;
+		r32 normalLength = glm::length(vertex->normal);
+		result = (glm::length(vertex->p - expectedPositions[vertexIndex]) < 1e-5f) &&
+				(normalLength > 0.999f && normalLength < 1.001f);
+	}
+
+	if (!result)
+	{
+		printf("The small gltf was not loaded correctly!\n");
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Writes a torus as the obj(v/vt/vn) and as the gltf, and loads each of them.
+// The glb has the attributes interleaved like our vertex, and the .gltf & .bin one has a buffer view
+// for each attribute, u16 texcoords and a node transform. All of them should give the same triangles as the obj.
+static int
+RunGLTFBenchmark(int argc, char **argv)
+{
+	u32 triangleCount = 2000000;
+	if (argc > 0)
+	{
+		triangleCount = Maximum((u32)atoi(argv[0]), 64u);
+	}
+
+	benchmark_torus torus;
+	BuildBenchmarkTorus(&torus, triangleCount);
+	u32 vertexCount = (u32)torus.vertices.size();
+	u32 quadCount = (u32)torus.quads.size()/4;
+
+	std::vector<u32> indices;
+	indices.reserve(6*quadCount);
+	for (u32 quadIndex = 0;
+		quadIndex < quadCount;
+		++quadIndex)
+	{
+		u32 *quad = torus.quads.data() + 4*quadIndex;
+		u32 triangles[6] = {quad[0], quad[1], quad[2], quad[0], quad[2], quad[3]};
+		indices.insert(indices.end(), triangles, triangles + 6);
+	}
+	u32 indexCount = (u32)indices.size();
+
+	const char *fileNames[] = {"gltf_benchmark.obj", "gltf_benchmark.glb", "gltf_benchmark.gltf"};
+	const char *binaryFileName = "gltf_benchmark.bin";
+
+	{
+		FILE *file = fopen(fileNames[0], "wb");
+		if (!file)
+		{
+			printf("Failed to write %s\n", fileNames[0]);
+			return -1;
+		}
+		for (u32 vertexIndex = 0;
+			vertexIndex < vertexCount;
+			++vertexIndex)
+		{
+			vertex *vertex = torus.vertices.data() + vertexIndex;
+			fprintf(file, "v %.9g %.9g %.9g\nvt %.9g %.9g\nvn %.9g %.9g %.9g\n", vertex->p.x, vertex->p.y, vertex->p.z,
+					vertex->texCoord.x, 1.0f - vertex->texCoord.y, vertex->normal.x, vertex->normal.y, vertex->normal.z);
+		}
+		for (u32 index = 0;
+			index < indexCount;
+			index += 3)
+		{
+			u32 a = indices[index] + 1;
+			u32 b = indices[index + 1] + 1;
+			u32 c = indices[index + 2] + 1;
+			fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c);
+		}
+		fclose(file);
+	}
+
+	{
+		std::vector<u8> binary((size_t)vertexCount*sizeof(vertex) + (size_t)indexCount*sizeof(u32));
+		memcpy(binary.data(), torus.vertices.data(), (size_t)vertexCount*sizeof(vertex));
+		memcpy(binary.data() + (size_t)vertexCount*sizeof(vertex), indices.data(), (size_t)indexCount*sizeof(u32));
+
+		char json[2048];
+		snprintf(json, sizeof(json),
+				"{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+				"\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3}]}],"
+				"\"buffers\":[{\"byteLength\":%zu}],"
+				"\"bufferViews\":[{\"buffer\":0,\"byteLength\":%zu,\"byteStride\":%zu,\"target\":34962},"
+				"{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu,\"target\":34963}],"
+				"\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\",\"min\":[-1.35,-0.35,-1.35],\"max\":[1.35,0.35,1.35]},"
+				"{\"bufferView\":0,\"byteOffset\":%zu,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\"},"
+				"{\"bufferView\":0,\"byteOffset\":%zu,\"componentType\":5126,\"count\":%u,\"type\":\"VEC2\"},"
+				"{\"bufferView\":1,\"componentType\":5125,\"count\":%u,\"type\":\"SCALAR\"}]}",
+				binary.size(), (size_t)vertexCount*sizeof(vertex), sizeof(vertex),
+				(size_t)vertexCount*sizeof(vertex), (size_t)indexCount*sizeof(u32),
+				vertexCount, offsetof(vertex, normal), vertexCount, offsetof(vertex, texCoord), vertexCount, indexCount);
+
+		std::vector<u8> bytes;
+		u32 header[3] = {0x46546c67, 2, 0};
+		PushPLYBenchmarkValue(&bytes, header, sizeof(header), false);
+		PushGLBChunk(&bytes, 0x4e4f534a, json, strlen(json), ' ');
+		PushGLBChunk(&bytes, 0x004e4942, binary.data(), binary.size(), 0);
+		u32 totalSize = (u32)bytes.size();
+		memcpy(bytes.data() + 8, &totalSize, sizeof(totalSize));
+
+		std::string noHeader;
+		if (!WritePLYBenchmarkFile(fileNames[1], &noHeader, &bytes))
+		{
+			return -1;
+		}
+	}
+
+	{
+		// NOTE(joon) : positions, normals, texcoords, indices one after another
+		size_t normalOffset = (size_t)vertexCount*sizeof(glm::vec3);
+		size_t texCoordOffset = 2*normalOffset;
+		size_t indexOffset = texCoordOffset + (((size_t)vertexCount*2*sizeof(u16) + 3) & ~(size_t)3);
+		std::vector<u8> binary(indexOffset + (size_t)indexCount*sizeof(u32));
+		for (u32 vertexIndex = 0;
+			vertexIndex < vertexCount;
+			++vertexIndex)
+		{
+			vertex *vertex = torus.vertices.data() + vertexIndex;
+			memcpy(binary.data() + vertexIndex*sizeof(glm::vec3), &vertex->p, sizeof(glm::vec3));
+			memcpy(binary.data() + normalOffset + vertexIndex*sizeof(glm::vec3), &vertex->normal, sizeof(glm::vec3));
+			u16 texCoord[2] = {(u16)(vertex->texCoord.x*65535.0f + 0.5f), (u16)(vertex->texCoord.y*65535.0f + 0.5f)};
+			memcpy(binary.data() + texCoordOffset + vertexIndex*sizeof(texCoord), texCoord, sizeof(texCoord));
+		}
+		memcpy(binary.data() + indexOffset, indices.data(), (size_t)indexCount*sizeof(u32));
+
+		char json[2048];
+		snprintf(json, sizeof(json),
+				"{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],"
+				"\"nodes\":[{\"children\":[1],\"translation\":[3,0,-1]},{\"mesh\":0,\"scale\":[2,2,2]}],"
+				"\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3,\"mode\":4}]}],"
+				"\"buffers\":[{\"uri\":\"%s\",\"byteLength\":%zu}],"
+				"\"bufferViews\":[{\"buffer\":0,\"byteLength\":%zu},{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu},"
+				"{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu},{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu}],"
+				"\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\"},"
+				"{\"bufferView\":1,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\"},"
+				"{\"bufferView\":2,\"componentType\":5123,\"normalized\":true,\"count\":%u,\"type\":\"VEC2\"},"
+				"{\"bufferView\":3,\"componentType\":5125,\"count\":%u,\"type\":\"SCALAR\"}]}",
+				binaryFileName, binary.size(),
+				normalOffset, normalOffset, normalOffset, texCoordOffset, (size_t)vertexCount*2*sizeof(u16),
+				indexOffset, (size_t)indexCount*sizeof(u32),
+				vertexCount, vertexCount, vertexCount, indexCount);
+
+		std::string jsonString = json;
+		std::vector<u8> noBytes;
+		std::string noHeader;
+		if (!WritePLYBenchmarkFile(fileNames[2], &jsonString, &noBytes) ||
+			!WritePLYBenchmarkFile(binaryFileName, &noHeader, &binary))
+		{
+			return -1;
+		}
+	}
+
+	job_system jobSystem;
+	InitializeJobSystem(&jobSystem, Maximum(std::thread::hardware_concurrency(), 1u));
+
+	int result = 0;
+	mesh meshes[ArrayCount(fileNames)];
+	r64 loadTimes[ArrayCount(fileNames)];
+	printf("%u vertices, %u triangles\n", vertexCount, indexCount/3);
+	printf("file                | size(MB) | load(ms) | speedup | primitives\n");
+	for (u32 fileIndex = 0;
+		fileIndex < ArrayCount(fileNames);
+		++fileIndex)
+	{
+		gltf_load_stats stats = {};
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (fileIndex == 0)
+		{
+			ReadOBJFileLineByLine(&jobSystem, meshes + fileIndex, fileNames[fileIndex]);
+		}
+		else
+		{
+			ReadGLTFFile(&jobSystem, meshes + fileIndex, fileNames[fileIndex], &stats);
+		}
+		loadTimes[fileIndex] = GetElapsedMilliseconds(start);
+
+		std::ifstream file(fileNames[fileIndex], std::ios::ate | std::ios::binary);
+		r64 fileSize = (r64)file.tellg();
+		file.close();
+		remove(fileNames[fileIndex]);
+		if (fileIndex == 2)
+		{
+			std::ifstream binaryFile(binaryFileName, std::ios::ate | std::ios::binary);
+			fileSize += (r64)binaryFile.tellg();
+			binaryFile.close();
+			remove(binaryFileName);
+		}
+
+		printf("%-19s | %8.1f | %8.2f | %6.2fx | ", fileNames[fileIndex], fileSize / (1024.0*1024.0), loadTimes[fileIndex], loadTimes[0] / loadTimes[fileIndex]);
+		if (fileIndex == 0)
+		{
+			printf("-\n");
+		}
+		else
+		{
+			printf("%u loaded, %u skipped\n", stats.loadedPrimitiveCount, stats.skippedPrimitiveCount);
+		}
+
+		// NOTE(joon) : obj welds the vertices in the order that the faces use them, so the corners are compared instead
+		mesh *expected = meshes + 0;
+		mesh *loaded = meshes + fileIndex;
+		if (loaded->vertexBuffer.size() != expected->vertexBuffer.size() || loaded->indexBuffer.size() != expected->indexBuffer.size() ||
+			!loaded->hasTexCoords)
+		{
+			printf("%s doesn't have the same vertices or triangles as the obj!\n", fileNames[fileIndex]);
+			result = -1;
+			continue;
+		}
+
+		r32 maxPositionDifference = 0.0f;
+		r32 maxNormalDifference = 0.0f;
+		r32 maxTexCoordDifference = 0.0f;
+		for (u32 index = 0;
+			index < loaded->indexBuffer.size();
+			++index)
+		{
+			vertex *loadedVertex = loaded->vertexBuffer.data() + loaded->indexBuffer[index];
+			vertex *expectedVertex = expected->vertexBuffer.data() + expected->indexBuffer[index];
+
+			glm::vec3 positionDifference = glm::abs(loadedVertex->p - expectedVertex->p);
+			glm::vec3 normalDifference = glm::abs(loadedVertex->normal - expectedVertex->normal);
+			glm::vec2 texCoordDifference = glm::abs(loadedVertex->texCoord - expectedVertex->texCoord);
+			maxPositionDifference = Maximum(maxPositionDifference, Maximum(Maximum(positionDifference.x, positionDifference.y), positionDifference.z));
+			maxNormalDifference = Maximum(maxNormalDifference, Maximum(Maximum(normalDifference.x, normalDifference.y), normalDifference.z));
+			maxTexCoordDifference = Maximum(maxTexCoordDifference, Maximum(texCoordDifference.x, texCoordDifference.y));
+		}
+		// NOTE(joon) : The node transform rounds the positions once more before they are normalized
+		if (maxPositionDifference > 1e-4f || maxNormalDifference > 1e-4f || maxTexCoordDifference > 1e-4f)
+		{
+			printf("%s is off from the obj by %f(position), %f(normal), %f(texcoord)!\n", fileNames[fileIndex],
+					maxPositionDifference, maxNormalDifference, maxTexCoordDifference);
+			result = -1;
+		}
+	}
+
+	if (!CheckSmallGLTFMesh(&jobSystem))
+	{
+		result = -1;
+	}
+
+	ShutdownJobSystem(&jobSystem);
+
+	return result;
+}
+
+// NOTE(joon) : Drops the file from the OS file cache, so that the next read has to go to the disk.
+// Windows doesn't have a way to do this for a single file, but opening it without the buffering
+// flushes what the cache has of it, which is the best that we can do there.
+static void
+EvictFileFromCache(const char *fileName)
+{
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, 0, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, 0);
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(file);
+	}
+#else
+	int fileDescriptor = open(fileName, O_RDONLY);
+	if (fileDescriptor >= 0)
+	{
+		posix_fadvise(fileDescriptor, 0, 0, POSIX_FADV_DONTNEED);
+		close(fileDescriptor);
+	}
+#endif
+}
+
+// NOTE(joon) : Packs the textures & the shaders, and compares reading them from the pack against the loose files,
+// with the cold(evicted from the OS cache) and the warm cache. read is every asset through ReadAssetFile,
+// startup is what the app loads before the first frame(see LoadStartupAssets) with the thread pool reads.
+static int
+RunAssetPackBenchmark(int argc, char **argv)
+{
+	u32 iterationCount = (argc > 0) ? Maximum((u32)atoi(argv[0]), 1u) : 3;
+	const char *packFileName = "benchmark_assets.pack";
+	const char *directories[] = {"textures", "source/shaders"};
+
+	job_system jobSystem;
+	InitializeJobSystem(&jobSystem, 0);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	b32 isBuilt = BuildAssetPack(&jobSystem, packFileName, directories, ArrayCount(directories));
+	r64 buildTime = GetElapsedMilliseconds(start);
+
+	asset_pack pack;
+	if (!isBuilt || !OpenAssetPack(&pack, packFileName))
+	{
+		ShutdownJobSystem(&jobSystem);
+		remove(packFileName);
+		return -1;
+	}
+
+	start = std::chrono::steady_clock::now();
+	b32 isValid = VerifyAssetPack(&pack);
+	r64 verifyTime = GetElapsedMilliseconds(start);
+	printf("build : %.2fms, verify(decode every entry) : %.2fms\n", buildTime, verifyTime);
+
+	std::vector<const char *> assetFileNames;
+	u32 compressedCount = 0;
+	for (u32 entryIndex = 0;
+		entryIndex < pack.header->entryCount;
+		++entryIndex)
+	{
+		const char *path = pack.paths + pack.entries[entryIndex].pathOffset;
+		assetFileNames.push_back(path);
+		compressedCount += (pack.entries[entryIndex].codec == AssetPackCodec_LZ);
+	}
+	printf("%u entries, %u of them compressed\n", (u32)assetFileNames.size(), compressedCount);
+
+	// NOTE(joon) : Decoder alone, the pack is warm by now
+	u64 decodedSize = 0;
+	start = std::chrono::steady_clock::now();
+	for (u32 iterationIndex = 0;
+		iterationIndex < iterationCount;
+		++iterationIndex)
+	{
+		for (u32 entryIndex = 0;
+			entryIndex < pack.header->entryCount;
+			++entryIndex)
+		{
+			asset_pack_entry *entry = pack.entries + entryIndex;
+			if (entry->codec == AssetPackCodec_LZ)
+			{
+				std::vector<u8> decoded((size_t)entry->size);
+				isValid &= DecompressLZ(pack.file.data + entry->offset, (size_t)entry->storedSize, decoded.data(), decoded.size());
+				decodedSize += entry->size;
+			}
+		}
+	}
+	r64 decodeTime = GetElapsedMilliseconds(start);
+	printf("decode : %.1f MB/s\n", (decodedSize / (1024.0*1024.0)) / (decodeTime / 1000.0));
+
+	printf("source | cache | read(ms) | startup(ms)\n");
+	for (u32 caseIndex = 0;
+		caseIndex < 4;
+		++caseIndex)
+	{
+		b32 isFromPack = (caseIndex >= 2);
+		b32 isCold = (caseIndex % 2) == 0;
+
+		MountAssetPack(isFromPack ? &pack : 0);
+
+		r64 readTime = 0.0;
+		r64 startupTime = 0.0;
+		for (u32 iterationIndex = 0;
+			iterationIndex < iterationCount;
+			++iterationIndex)
+		{
+			if (isCold)
+			{
+				EvictFileFromCache(packFileName);
+				for (u32 assetIndex = 0;
+					assetIndex < assetFileNames.size();
+					++assetIndex)
+				{
+					EvictFileFromCache(assetFileNames[assetIndex]);
+				}
+			}
+
+			start = std::chrono::steady_clock::now();
+			for (u32 assetIndex = 0;
+				assetIndex < assetFileNames.size();
+				++assetIndex)
+			{
+				// NOTE(joon) : Hashing touches every byte, otherwise the mapped files are never read from the disk
+				asset_file file;
+				if (!ReadAssetFile(assetFileNames[assetIndex], &file) || file.isFromPack != isFromPack ||
+					HashAssetContent(file.data, file.size) != FindAssetPackEntry(&pack, assetFileNames[assetIndex])->contentHash)
+				{
+					printf("%s was not read correctly!\n", assetFileNames[assetIndex]);
+					isValid = false;
+				}
+				CloseAssetFile(&file);
+			}
+			readTime += GetElapsedMilliseconds(start);
+
+			if (isCold)
+			{
+				EvictFileFromCache(packFileName);
+				for (u32 assetIndex = 0;
+					assetIndex < assetFileNames.size();
+					++assetIndex)
+				{
+					EvictFileFromCache(assetFileNames[assetIndex]);
+				}
+			}
+
+			start = std::chrono::steady_clock::now();
+			model_registry modelRegistry;
+			InitializeModelRegistry(&modelRegistry, &jobSystem, 0, false);
+			startup_assets startupAssets;
+			LoadStartupAssets(&jobSystem, 0, &startupAssets, &modelRegistry);
+			startupTime += GetElapsedMilliseconds(start);
+			FreeStartupTextures(&startupAssets);
+			FreeModelRegistry(&modelRegistry);
+		}
+
+		printf("%-6s | %-5s | %8.2f | %11.2f\n", isFromPack ? "pack" : "loose", isCold ? "cold" : "warm",
+				readTime / iterationCount, startupTime / iterationCount);
+	}
+
+	MountAssetPack(0);
+	CloseAssetPack(&pack);
+	remove(packFileName);
+	ShutdownJobSystem(&jobSystem);
+
+	return isValid ? 0 : -1;
+}
+
+// NOTE(joon) : Reads every file under textures/ one at a time with the blocking reads(which is what the loaders used to do),
+// with the thread pool and with io_uring, from the cold and the warm cache.
+// startup is LoadStartupAssets, where the models are parsed & the textures are decoded as the reads complete.
+static int
+RunAsyncIOBenchmark(int argc, char **argv)
+{
+	u32 iterationCount = (argc > 0) ? Maximum((u32)atoi(argv[0]), 1u) : 3;
+
+	std::vector<std::string> fileNames;
+	ListFilesInDirectory("textures", &fileNames);
+	if (fileNames.empty())
+	{
+		printf("textures/ is empty!\n");
+		return -1;
+	}
+
+	job_system jobSystem;
+	InitializeJobSystem(&jobSystem, 0);
+
+	async_io uringIO;
+	InitializeAsyncIO(&uringIO);
+	b32 hasIOUring = (uringIO.backend == AsyncIOBackend_IOUring);
+	if (!hasIOUring)
+	{
+		printf("io_uring is not available, only the thread pool is measured\n");
+	}
+
+	// NOTE(joon) : Blocking reads are the reference for the others
+	u64 totalSize = 0;
+	std::vector<u32> contentHashes(fileNames.size());
+	for (u32 fileIndex = 0;
+		fileIndex < fileNames.size();
+		++fileIndex)
+	{
+		std::vector<u8> contents;
+		ReadWholeFile(fileNames[fileIndex].c_str(), &contents);
+		contentHashes[fileIndex] = HashAssetContent(contents.data(), contents.size());
+		totalSize += contents.size();
+	}
+	printf("%u files, %.2f MB, %u workers\n", (u32)fileNames.size(), totalSize / (1024.0*1024.0), jobSystem.workerCount);
+
+	int result = 0;
+	printf("reads       | cache | read(ms) | read(MB/s) | startup(ms)\n");
+	for (u32 caseIndex = 0;
+		caseIndex < 6;
+		++caseIndex)
+	{
+		u32 methodIndex = caseIndex / 2;
+		b32 isCold = (caseIndex % 2) == 0;
+		const char *methodNames[] = {"blocking", "thread pool", "io_uring"};
+		if (methodIndex == 2 && !hasIOUring)
+		{
+			break;
+		}
+		async_io *io = (methodIndex == 2) ? &uringIO : 0;
+
+		r64 readTime = 0.0;
+		r64 startupTime = 0.0;
+		for (u32 iterationIndex = 0;
+			iterationIndex < iterationCount;
+			++iterationIndex)
+		{
+			if (isCold)
+			{
+				for (u32 fileIndex = 0;
+					fileIndex < fileNames.size();
+					++fileIndex)
+				{
+					EvictFileFromCache(fileNames[fileIndex].c_str());
+				}
+			}
+
+			std::vector<async_read> reads(fileNames.size());
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			if (methodIndex == 0)
+			{
+				for (u32 fileIndex = 0;
+					fileIndex < fileNames.size();
+					++fileIndex)
+				{
+					async_read *read = reads.data() + fileIndex;
+					read->isValid = ReadWholeFile(fileNames[fileIndex].c_str(), &read->file.storage);
+					read->file.data = read->file.storage.data();
+					read->file.size = read->file.storage.size();
+				}
+			}
+			else
+			{
+				for (u32 fileIndex = 0;
+					fileIndex < fileNames.size();
+					++fileIndex)
+				{
+					reads[fileIndex].path = fileNames[fileIndex].c_str();
+				}
+				ReadAssetFilesAsync(&jobSystem, io, reads.data(), (u32)reads.size());
+			}
+			readTime += GetElapsedMilliseconds(start);
+
+			for (u32 fileIndex = 0;
+				fileIndex < fileNames.size();
+				++fileIndex)
+			{
+				async_read *read = reads.data() + fileIndex;
+				if (!read->isValid || HashAssetContent(read->file.data, read->file.size) != contentHashes[fileIndex])
+				{
+					printf("%s was not read correctly with %s!\n", fileNames[fileIndex].c_str(), methodNames[methodIndex]);
+					result = -1;
+				}
+				CloseAssetFile(&read->file);
+			}
+
+			// NOTE(joon) : The startup always goes through the batch, so the blocking reads don't have it
+			if (methodIndex != 0)
+			{
+				if (isCold)
+				{
+					for (u32 fileIndex = 0;
+						fileIndex < fileNames.size();
+						++fileIndex)
+					{
+						EvictFileFromCache(fileNames[fileIndex].c_str());
+					}
+				}
+
+				start = std::chrono::steady_clock::now();
+				model_registry modelRegistry;
+				InitializeModelRegistry(&modelRegistry, &jobSystem, io, false);
+				startup_assets startupAssets;
+				LoadStartupAssets(&jobSystem, io, &startupAssets, &modelRegistry);
+				startupTime += GetElapsedMilliseconds(start);
+				FreeStartupTextures(&startupAssets);
+				FreeModelRegistry(&modelRegistry);
+			}
+		}
+
+		readTime /= iterationCount;
+		startupTime /= iterationCount;
+		printf("%-11s | %-5s | %8.2f | %10.1f | ", methodNames[methodIndex], isCold ? "cold" : "warm",
+				readTime, (totalSize / (1024.0*1024.0)) / (readTime / 1000.0));
+		if (methodIndex == 0)
+		{
+			printf("%11s\n", "-");
+		}
+		else
+		{
+			printf("%11.2f\n", startupTime);
+		}
+	}
+
+	ShutdownAsyncIO(&uringIO);
+	ShutdownJobSystem(&jobSystem);
+
+	return result;
+}
+
+static benchmark_entry benchmarks[] =
+{
+	{"jobs", "jobs [max worker count]", RunJobSystemBenchmark},
+	{"commands", "commands [draw count] [iteration count]", RunCommandBufferBenchmark},
+	{"imgui", "imgui [frame count]", RunImGuiBackendBenchmark},
+	{"occlusion", "occlusion [occludee count] [iteration count]", RunOcclusionBenchmark},
+	{"gpuculling", "gpuculling [instance count] [iteration count]", RunGPUCullingBenchmark},
+	{"deferred", "deferred [iteration count]", RunDeferredShadingBenchmark},
+	{"depthprepass", "depthprepass [iteration count]", RunDepthPrePassBenchmark},
+	{"capture", "capture [frame count] [png|y4m]", RunFrameCaptureBenchmark},
+	{"software", "software [max worker count] [frame count]", RunSoftwareRendererBenchmark},
+	{"meshlets", "meshlets [view count]", RunMeshletBenchmark},
+	{"ply", "ply [triangle count]", RunPLYBenchmark},
+	{"gltf", "gltf [triangle count]", RunGLTFBenchmark},
+	{"pack", "pack [iteration count]", RunAssetPackBenchmark},
+	{"asyncio", "asyncio [iteration count]", RunAsyncIOBenchmark},
+};
+
+static int
+RunBenchmarks(int argc, char **argv)
+{
+	int result = 0;
+
+	if (argc == 0)
+	{
+		for (u32 benchmarkIndex = 0;
+			benchmarkIndex < ArrayCount(benchmarks);
+			++benchmarkIndex)
+		{
+			printf("\n== %s ==\n", benchmarks[benchmarkIndex].name);
+			result |= benchmarks[benchmarkIndex].function(0, 0);
+		}
+	}
+	else
+	{
+		b32 found = false;
+		for (u32 benchmarkIndex = 0;
+			benchmarkIndex < ArrayCount(benchmarks);
+			++benchmarkIndex)
+		{
+			if (strcmp(argv[0], benchmarks[benchmarkIndex].name) == 0)
+			{
+				result = benchmarks[benchmarkIndex].function(argc - 1, argv + 1);
+				found = true;
+				break;
+			}
+		}
+
+		if (!found)
+		{
+			printf("Unknown benchmark %s, available benchmarks are :\n", argv[0]);
+			for (u32 benchmarkIndex = 0;
+				benchmarkIndex < ArrayCount(benchmarks);
+				++benchmarkIndex)
+			{
+				printf("  %s\n", benchmarks[benchmarkIndex].usage);
+			}
+			result = -1;
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,398 @@
+#include "command_buffer.h"
+
+static u32
+AlignRenderCommandSize(u32 size)
+{
+	u32 result = (size + (RENDER_COMMAND_ALIGNMENT - 1)) & ~(RENDER_COMMAND_ALIGNMENT - 1);
+	return result;
+}
+
+static void
+InitializeCommandBuffer(command_buffer *buffer, u32 capacity)
+{
+	buffer->capacity = AlignRenderCommandSize(capacity);
+	buffer->base = (u8 *)malloc(buffer->capacity);
+	buffer->used = 0;
+	buffer->commandCount = 0;
+}
+
+static void
+FreeCommandBuffer(command_buffer *buffer)
+{
+	free(buffer->base);
+	*buffer = {};
+}
+
+// NOTE(joon) : Doesn't free the memory, so the buffer can be reused for the next frame without allocating
+static void
+ResetCommandBuffer(command_buffer *buffer)
+{
+	buffer->used = 0;
+	buffer->commandCount = 0;
+}
+
+// NOTE(joon) : The commands are only referenced by their offsets until they get executed,
+// so it's fine to move the whole arena when it's full.
+static void *
+PushRenderCommand(command_buffer *buffer, render_command_type type, u32 commandSize, u32 payloadSize)
+{
+	u32 payloadOffset = AlignRenderCommandSize(commandSize);
+	u32 size = payloadOffset + AlignRenderCommandSize(payloadSize);
+
+	if (buffer->used + size > buffer->capacity)
+	{
+		u32 newCapacity = Maximum(2*buffer->capacity, buffer->used + size);
+		buffer->base = (u8 *)realloc(buffer->base, newCapacity);
+		buffer->capacity = newCapacity;
+	}
+
+	render_command_header *header = (render_command_header *)(buffer->base + buffer->used);
+	memset(header, 0, payloadOffset);
+	header->type = type;
+	header->size = size;
+
+	buffer->used += size;
+	buffer->commandCount++;
+
+	return header;
+}
+
+static void *
+GetRenderCommandPayload(void *command, u32 commandSize)
+{
+	return (u8 *)command + AlignRenderCommandSize(commandSize);
+}
+
+static void
+PushClear(command_buffer *buffer, glm::vec4 color)
+{
+	render_command_clear *command = (render_command_clear *)
+		PushRenderCommand(buffer, RenderCommandType_Clear, sizeof(render_command_clear), 0);
+	command->color = color;
+}
+
+static void
+PushSetRenderState(command_buffer *buffer, b32 isDepthTestEnabled, b32 isCullFaceEnabled)
+{
+	render_command_set_render_state *command = (render_command_set_render_state *)
+		PushRenderCommand(buffer, RenderCommandType_SetRenderState, sizeof(render_command_set_render_state), 0);
+	command->isDepthTestEnabled = isDepthTestEnabled;
+	command->isCullFaceEnabled = isCullFaceEnabled;
+}
+
+static void
+PushSetViewport(command_buffer *buffer, i32 x, i32 y, i32 width, i32 height)
+{
+	render_command_set_viewport *command = (render_command_set_viewport *)
+		PushRenderCommand(buffer, RenderCommandType_SetViewport, sizeof(render_command_set_viewport), 0);
+	command->x = x;
+	command->y = y;
+	command->width = width;
+	command->height = height;
+}
+
+static void
+PushUseProgram(command_buffer *buffer, u32 programSlot)
+{
+	render_command_use_program *command = (render_command_use_program *)
+		PushRenderCommand(buffer, RenderCommandType_UseProgram, sizeof(render_command_use_program), 0);
+	command->programSlot = programSlot;
+}
+
+static void
+PushReloadProgram(command_buffer *buffer, u32 programSlot, const char *vertexShaderPath, const char *fragmentShaderPath)
+{
+	render_command_reload_program *command = (render_command_reload_program *)
+		PushRenderCommand(buffer, RenderCommandType_ReloadProgram, sizeof(render_command_reload_program), 0);
+	command->programSlot = programSlot;
+	command->vertexShaderPath = vertexShaderPath;
+	command->fragmentShaderPath = fragmentShaderPath;
+}
+
+// NOTE(joon) : data is copied into the command buffer, so it can be modified right after this call
+static void
+PushUpdateUniformBuffer(command_buffer *buffer, GLuint bufferID, u32 bindingIndex, void *data, u32 dataSize)
+{
+	render_command_update_uniform_buffer *command = (render_command_update_uniform_buffer *)
+		PushRenderCommand(buffer, RenderCommandType_UpdateUniformBuffer, sizeof(render_command_update_uniform_buffer), dataSize);
+	command->bufferID = bufferID;
+	command->bindingIndex = bindingIndex;
+	command->dataSize = dataSize;
+	memcpy(GetRenderCommandPayload(command, sizeof(*command)), data, dataSize);
+}
+
+// NOTE(joon) : data is copied into the command buffer, so it can be modified right after this call
+static void
+PushUpdateVertexBuffer(command_buffer *buffer, GLuint bufferID, void *data, u32 dataSize)
+{
+	render_command_update_vertex_buffer *command = (render_command_update_vertex_buffer *)
+		PushRenderCommand(buffer, RenderCommandType_UpdateVertexBuffer, sizeof(render_command_update_vertex_buffer), dataSize);
+	command->bufferID = bufferID;
+	command->dataSize = dataSize;
+	memcpy(GetRenderCommandPayload(command, sizeof(*command)), data, dataSize);
+}
+
+static void
+PushBindTextures(command_buffer *buffer, GLuint diffuseTextureID, GLuint specularTextureID)
+{
+	render_command_bind_textures *command = (render_command_bind_textures *)
+		PushRenderCommand(buffer, RenderCommandType_BindTextures, sizeof(render_command_bind_textures), 0);
+	command->diffuseTextureID = diffuseTextureID;
+	command->specularTextureID = specularTextureID;
+}
+
+static void
+PushDrawElements(command_buffer *buffer, GLuint vertexArrayID, GLuint vertexBufferID, GLuint indexBufferID, u32 indexCount,
+				b32 isPositionOnly = false)
+{
+	render_command_draw_elements *command = (render_command_draw_elements *)
+		PushRenderCommand(buffer, RenderCommandType_DrawElements, sizeof(render_command_draw_elements), 0);
+	command->vertexArrayID = vertexArrayID;
+	command->vertexBufferID = vertexBufferID;
+	command->indexBufferID = indexBufferID;
+	command->indexCount = indexCount;
+	command->isPositionOnly = isPositionOnly;
+}
+
+static void
+PushDrawLines(command_buffer *buffer, GLuint vertexArrayID, GLuint vertexBufferID, u32 vertexCount)
+{
+	render_command_draw_lines *command = (render_command_draw_lines *)
+		PushRenderCommand(buffer, RenderCommandType_DrawLines, sizeof(render_command_draw_lines), 0);
+	command->vertexArrayID = vertexArrayID;
+	command->vertexBufferID = vertexBufferID;
+	command->vertexCount = vertexCount;
+}
+
+static void
+PushDrawNormalLines(command_buffer *buffer, GLuint vertexArrayID, GLuint vertexBufferID, GLuint indexBufferID,
+					u32 lineCount, b32 isFaceNormal)
+{
+	render_command_draw_normal_lines *command = (render_command_draw_normal_lines *)
+		PushRenderCommand(buffer, RenderCommandType_DrawNormalLines, sizeof(render_command_draw_normal_lines), 0);
+	command->vertexArrayID = vertexArrayID;
+	command->vertexBufferID = vertexBufferID;
+	command->indexBufferID = indexBufferID;
+	command->lineCount = lineCount;
+	command->isFaceNormal = isFaceNormal;
+}
+
+static void
+PushRenderImGui(command_buffer *buffer, ImDrawData *drawData, b32 useStreamingUpload, b32 useKnownState)
+{
+	render_command_render_imgui *command = (render_command_render_imgui *)
+		PushRenderCommand(buffer, RenderCommandType_RenderImGui, sizeof(render_command_render_imgui), 0);
+	command->drawData = drawData;
+	command->useStreamingUpload = useStreamingUpload;
+	command->useKnownState = useKnownState;
+}
+
+static void
+PushCullInstances(command_buffer *buffer, gpu_culling *culling, u32 instanceCount, b32 useHiZ)
+{
+	render_command_cull_instances *command = (render_command_cull_instances *)
+		PushRenderCommand(buffer, RenderCommandType_CullInstances, sizeof(render_command_cull_instances), 0);
+	command->culling = culling;
+	command->instanceCount = instanceCount;
+	command->useHiZ = useHiZ;
+}
+
+static void
+PushDrawInstancesIndirect(command_buffer *buffer, gpu_culling *culling, u32 instanceCount)
+{
+	render_command_draw_instances_indirect *command = (render_command_draw_instances_indirect *)
+		PushRenderCommand(buffer, RenderCommandType_DrawInstancesIndirect, sizeof(render_command_draw_instances_indirect), 0);
+	command->culling = culling;
+	command->instanceCount = instanceCount;
+}
+
+static void
+PushBuildHiZ(command_buffer *buffer, gpu_culling *culling, i32 width, i32 height, glm::mat4 *viewProjection)
+{
+	render_command_build_hi_z *command = (render_command_build_hi_z *)
+		PushRenderCommand(buffer, RenderCommandType_BuildHiZ, sizeof(render_command_build_hi_z), 0);
+	command->culling = culling;
+	command->width = width;
+	command->height = height;
+	command->viewProjection = *viewProjection;
+}
+
+static void
+PushDrawElementsIndirect(command_buffer *buffer, GLuint vertexArrayID, GLuint vertexBufferID, GLuint indexBufferID,
+						GLuint indirectBufferID, u32 firstCommand, u32 commandCount, b32 isPositionOnly = false)
+{
+	render_command_draw_elements_indirect *command = (render_command_draw_elements_indirect *)
+		PushRenderCommand(buffer, RenderCommandType_DrawElementsIndirect, sizeof(render_command_draw_elements_indirect), 0);
+	command->vertexArrayID = vertexArrayID;
+	command->vertexBufferID = vertexBufferID;
+	command->indexBufferID = indexBufferID;
+	command->indirectBufferID = indirectBufferID;
+	command->firstCommand = firstCommand;
+	command->commandCount = commandCount;
+	command->isPositionOnly = isPositionOnly;
+}
+
+static void
+PushUploadModel(command_buffer *buffer, model_registry_entry *entry)
+{
+	render_command_upload_model *command = (render_command_upload_model *)
+		PushRenderCommand(buffer, RenderCommandType_UploadModel, sizeof(render_command_upload_model), 0);
+	command->entry = entry;
+}
+
+static void
+PushDeleteModelBuffers(command_buffer *buffer, GLuint *vertexArrayIDs, GLuint *bufferIDs)
+{
+	render_command_delete_model_buffers *command = (render_command_delete_model_buffers *)
+		PushRenderCommand(buffer, RenderCommandType_DeleteModelBuffers, sizeof(render_command_delete_model_buffers), 0);
+	memcpy(command->vertexArrayIDs, vertexArrayIDs, sizeof(command->vertexArrayIDs));
+	memcpy(command->bufferIDs, bufferIDs, sizeof(command->bufferIDs));
+}
+
+static void
+PushMapTexCoords(command_buffer *buffer, GLuint vertexBufferID, u32 vertexCount, int textureMappingMethod, b32 shouldUseP)
+{
+	render_command_map_tex_coords *command = (render_command_map_tex_coords *)
+		PushRenderCommand(buffer, RenderCommandType_MapTexCoords, sizeof(render_command_map_tex_coords), 0);
+	command->vertexBufferID = vertexBufferID;
+	command->vertexCount = vertexCount;
+	command->textureMappingMethod = textureMappingMethod;
+	command->shouldUseP = shouldUseP;
+}
+
+static void
+PushBindBakedLighting(command_buffer *buffer, GLuint textureID)
+{
+	render_command_bind_baked_lighting *command = (render_command_bind_baked_lighting *)
+		PushRenderCommand(buffer, RenderCommandType_BindBakedLighting, sizeof(render_command_bind_baked_lighting), 0);
+	command->textureID = textureID;
+}
+
+static void
+PushBeginGBuffer(command_buffer *buffer, deferred_shading *deferred, i32 width, i32 height)
+{
+	render_command_begin_g_buffer *command = (render_command_begin_g_buffer *)
+		PushRenderCommand(buffer, RenderCommandType_BeginGBuffer, sizeof(render_command_begin_g_buffer), 0);
+	command->deferred = deferred;
+	command->width = width;
+	command->height = height;
+}
+
+static void
+PushShadeDeferred(command_buffer *buffer, deferred_shading *deferred, GLuint targetFramebufferID,
+				glm::mat4 *inverseProjection, glm::mat4 *inverseViewProjection)
+{
+	render_command_shade_deferred *command = (render_command_shade_deferred *)
+		PushRenderCommand(buffer, RenderCommandType_ShadeDeferred, sizeof(render_command_shade_deferred), 0);
+	command->deferred = deferred;
+	command->targetFramebufferID = targetFramebufferID;
+	command->inverseProjection = *inverseProjection;
+	command->inverseViewProjection = *inverseViewProjection;
+}
+
+static void
+PushSetDepthState(command_buffer *buffer, GLenum depthFunc, b32 isDepthWriteEnabled, b32 isColorWriteEnabled)
+{
+	render_command_set_depth_state *command = (render_command_set_depth_state *)
+		PushRenderCommand(buffer, RenderCommandType_SetDepthState, sizeof(render_command_set_depth_state), 0);
+	command->depthFunc = depthFunc;
+	command->isDepthWriteEnabled = isDepthWriteEnabled;
+	command->isColorWriteEnabled = isColorWriteEnabled;
+}
+
+static void
+PushBeginShadowPasses(command_buffer *buffer, shadow_maps *shadowMaps)
+{
+	render_command_begin_shadow_passes *command = (render_command_begin_shadow_passes *)
+		PushRenderCommand(buffer, RenderCommandType_BeginShadowPasses, sizeof(render_command_begin_shadow_passes), 0);
+	command->shadowMaps = shadowMaps;
+}
+
+static void
+PushBeginShadowView(command_buffer *buffer, shadow_maps *shadowMaps, glm::ivec4 rect, b32 isStatic, b32 shouldClear)
+{
+	render_command_begin_shadow_view *command = (render_command_begin_shadow_view *)
+		PushRenderCommand(buffer, RenderCommandType_BeginShadowView, sizeof(render_command_begin_shadow_view), 0);
+	command->shadowMaps = shadowMaps;
+	command->rect = rect;
+	command->isStatic = isStatic;
+	command->shouldClear = shouldClear;
+}
+
+static void
+PushCopyShadowView(command_buffer *buffer, shadow_maps *shadowMaps, glm::ivec4 rect)
+{
+	render_command_copy_shadow_view *command = (render_command_copy_shadow_view *)
+		PushRenderCommand(buffer, RenderCommandType_CopyShadowView, sizeof(render_command_copy_shadow_view), 0);
+	command->shadowMaps = shadowMaps;
+	command->rect = rect;
+}
+
+static void
+PushEndShadowPasses(command_buffer *buffer, shadow_maps *shadowMaps)
+{
+	render_command_end_shadow_passes *command = (render_command_end_shadow_passes *)
+		PushRenderCommand(buffer, RenderCommandType_EndShadowPasses, sizeof(render_command_end_shadow_passes), 0);
+	command->shadowMaps = shadowMaps;
+}
+
+static void
+PushBindShadowAtlas(command_buffer *buffer, GLuint textureID)
+{
+	render_command_bind_shadow_atlas *command = (render_command_bind_shadow_atlas *)
+		PushRenderCommand(buffer, RenderCommandType_BindShadowAtlas, sizeof(render_command_bind_shadow_atlas), 0);
+	command->textureID = textureID;
+}
+
+static void
+PushBeginFrameTimer(command_buffer *buffer, dynamic_resolution *dynamicResolution, r32 renderScale)
+{
+	render_command_begin_frame_timer *command = (render_command_begin_frame_timer *)
+		PushRenderCommand(buffer, RenderCommandType_BeginFrameTimer, sizeof(render_command_begin_frame_timer), 0);
+	command->dynamicResolution = dynamicResolution;
+	command->renderScale = renderScale;
+}
+
+static void
+PushEndFrameTimer(command_buffer *buffer, dynamic_resolution *dynamicResolution)
+{
+	render_command_end_frame_timer *command = (render_command_end_frame_timer *)
+		PushRenderCommand(buffer, RenderCommandType_EndFrameTimer, sizeof(render_command_end_frame_timer), 0);
+	command->dynamicResolution = dynamicResolution;
+}
+
+static void
+PushBeginSceneTarget(command_buffer *buffer, dynamic_resolution *dynamicResolution, i32 width, i32 height)
+{
+	render_command_begin_scene_target *command = (render_command_begin_scene_target *)
+		PushRenderCommand(buffer, RenderCommandType_BeginSceneTarget, sizeof(render_command_begin_scene_target), 0);
+	command->dynamicResolution = dynamicResolution;
+	command->width = width;
+	command->height = height;
+}
+
+static void
+PushResolveSceneTarget(command_buffer *buffer, dynamic_resolution *dynamicResolution, i32 sourceWidth, i32 sourceHeight,
+						i32 targetWidth, i32 targetHeight, i32 filter)
+{
+	render_command_resolve_scene_target *command = (render_command_resolve_scene_target *)
+		PushRenderCommand(buffer, RenderCommandType_ResolveSceneTarget, sizeof(render_command_resolve_scene_target), 0);
+	command->dynamicResolution = dynamicResolution;
+	command->sourceWidth = sourceWidth;
+	command->sourceHeight = sourceHeight;
+	command->targetWidth = targetWidth;
+	command->targetHeight = targetHeight;
+	command->filter = filter;
+}
+
+static void
+PushCaptureFrame(command_buffer *buffer, frame_capture *capture, b32 shouldRecord, i32 format, i32 width, i32 height)
+{
+	render_command_capture_frame *command = (render_command_capture_frame *)
+		PushRenderCommand(buffer, RenderCommandType_CaptureFrame, sizeof(render_command_capture_frame), 0);
+	command->capture = capture;
+	command->shouldRecord = shouldRecord;
+	command->format = format;
+	command->width = width;
+	command->height = height;
+}
@@ -0,0 +1,361 @@
+#ifndef COMMAND_BUFFER_H
+#define COMMAND_BUFFER_H
+
+// NOTE(joon) : Render commands are recorded into a linear arena and replayed later by the render thread,
+// which is the only thread that owns the GL context.
+// Every thread should record into its own command buffer. The buffers are replayed
+// in the order they were submitted, so that's how the recordings are merged.
+
+// NOTE(joon) : Every command(and its payload) is aligned to this
+#define RENDER_COMMAND_ALIGNMENT 16
+
+enum render_command_type
+{
+	RenderCommandType_Clear,
+	RenderCommandType_SetRenderState,
+	RenderCommandType_SetViewport,
+	RenderCommandType_UseProgram,
+	RenderCommandType_ReloadProgram,
+	RenderCommandType_UpdateUniformBuffer,
+	RenderCommandType_UpdateVertexBuffer,
+	RenderCommandType_BindTextures,
+	RenderCommandType_DrawElements,
+	RenderCommandType_DrawLines,
+	RenderCommandType_DrawNormalLines,
+	RenderCommandType_RenderImGui,
+	RenderCommandType_CullInstances,
+	RenderCommandType_DrawInstancesIndirect,
+	RenderCommandType_BuildHiZ,
+	RenderCommandType_DrawElementsIndirect,
+	RenderCommandType_UploadModel,
+	RenderCommandType_DeleteModelBuffers,
+	RenderCommandType_MapTexCoords,
+	RenderCommandType_BindBakedLighting,
+	RenderCommandType_BeginGBuffer,
+	RenderCommandType_ShadeDeferred,
+	RenderCommandType_SetDepthState,
+	RenderCommandType_BeginShadowPasses,
+	RenderCommandType_BeginShadowView,
+	RenderCommandType_CopyShadowView,
+	RenderCommandType_EndShadowPasses,
+	RenderCommandType_BindShadowAtlas,
+	RenderCommandType_BeginFrameTimer,
+	RenderCommandType_EndFrameTimer,
+	RenderCommandType_BeginSceneTarget,
+	RenderCommandType_ResolveSceneTarget,
+	RenderCommandType_CaptureFrame,
+};
+
+struct render_command_header
+{
+	render_command_type type;
+	u32 size; // including the header and the payload
+};
+
+struct render_command_clear
+{
+	render_command_header header;
+	glm::vec4 color;
+};
+
+struct render_command_set_render_state
+{
+	render_command_header header;
+	b32 isDepthTestEnabled;
+	b32 isCullFaceEnabled;
+};
+
+struct render_command_set_viewport
+{
+	render_command_header header;
+	i32 x;
+	i32 y;
+	i32 width;
+	i32 height;
+};
+
+// NOTE(joon) : Programs are referred by their slot instead of the GL ID,
+// as the ID can be changed by the reload that happens on the render thread
+struct render_command_use_program
+{
+	render_command_header header;
+	u32 programSlot;
+};
+
+struct render_command_reload_program
+{
+	render_command_header header;
+	u32 programSlot;
+	// NOTE(joon) : should be alive until the command gets executed
+	const char *vertexShaderPath;
+	const char *fragmentShaderPath;
+};
+
+// NOTE(joon) : payload is the data that will be uploaded
+struct render_command_update_uniform_buffer
+{
+	render_command_header header;
+	GLuint bufferID;
+	u32 bindingIndex;
+	u32 dataSize;
+};
+
+// NOTE(joon) : payload is the data that will be uploaded
+struct render_command_update_vertex_buffer
+{
+	render_command_header header;
+	GLuint bufferID;
+	u32 dataSize;
+};
+
+// NOTE(joon) : 0 means unbind
+struct render_command_bind_textures
+{
+	render_command_header header;
+	GLuint diffuseTextureID;
+	GLuint specularTextureID;
+};
+
+// NOTE(joon) : Buffer texture of the baked lighting, see lighting_cache.h
+struct render_command_bind_baked_lighting
+{
+	render_command_header header;
+	GLuint textureID;
+};
+
+struct render_command_draw_elements
+{
+	render_command_header header;
+	GLuint vertexArrayID;
+	GLuint vertexBufferID;
+	GLuint indexBufferID;
+	u32 indexCount;
+	b32 isPositionOnly; // the vertex array only has the attribute 0, see model::positionVertexArrayID
+};
+
+struct render_command_draw_lines
+{
+	render_command_header header;
+	GLuint vertexArrayID;
+	GLuint vertexBufferID;
+	u32 vertexCount;
+};
+
+// NOTE(joon) : The lines are pulled from the vertex & index buffer of the model by the normal line shader,
+// one line per face(isFaceNormal) or one per vertex
+struct render_command_draw_normal_lines
+{
+	render_command_header header;
+	GLuint vertexArrayID;
+	GLuint vertexBufferID;
+	GLuint indexBufferID;
+	u32 lineCount;
+	b32 isFaceNormal;
+};
+
+struct render_command_render_imgui
+{
+	render_command_header header;
+	// NOTE(joon) : should be alive until the command gets executed
+	ImDrawData *drawData;
+	b32 useStreamingUpload;
+	b32 useKnownState; // let the backend use the state tracked by the render thread instead of querying it
+};
+
+// NOTE(joon) : The instances are culled with the hi-z of the last BuildHiZ,
+// and uses the per frame ubo that is bound at that point.
+struct render_command_cull_instances
+{
+	render_command_header header;
+	struct gpu_culling *culling;
+	u32 instanceCount;
+	b32 useHiZ;
+};
+
+struct render_command_draw_instances_indirect
+{
+	render_command_header header;
+	struct gpu_culling *culling;
+	u32 instanceCount;
+};
+
+// NOTE(joon) : Should come after every draw that writes the depth, and
+// viewProjection should be the one that those draws used
+struct render_command_build_hi_z
+{
+	render_command_header header;
+	struct gpu_culling *culling;
+	i32 width;
+	i32 height;
+	glm::mat4 viewProjection;
+};
+
+// NOTE(joon) : Draws commandCount draw_elements_indirect_commands starting from firstCommand,
+// which should be already uploaded to the indirect buffer
+struct render_command_draw_elements_indirect
+{
+	render_command_header header;
+	GLuint vertexArrayID;
+	GLuint vertexBufferID;
+	GLuint indexBufferID;
+	GLuint indirectBufferID;
+	u32 firstCommand;
+	u32 commandCount;
+	b32 isPositionOnly;
+};
+
+// NOTE(joon) : Creates the GL objects of the model from its CPU mesh, which should not change until the command gets executed.
+// The entry becomes resident after this.
+struct render_command_upload_model
+{
+	render_command_header header;
+	struct model_registry_entry *entry;
+};
+
+// NOTE(joon) : GL objects of an evicted model, see evicted_model_buffers
+struct render_command_delete_model_buffers
+{
+	render_command_header header;
+	GLuint vertexArrayIDs[2];
+	GLuint bufferIDs[3];
+};
+
+// NOTE(joon) : Regenerates the texcoords inside the vertex buffer with the compute shader
+struct render_command_map_tex_coords
+{
+	render_command_header header;
+	GLuint vertexBufferID;
+	u32 vertexCount;
+	i32 textureMappingMethod;
+	b32 shouldUseP;
+};
+
+// NOTE(joon) : The draws after this go into the G-buffer with the geometry program, until the ShadeDeferred.
+// See deferred_shading.h
+struct render_command_begin_g_buffer
+{
+	render_command_header header;
+	struct deferred_shading *deferred;
+	i32 width;
+	i32 height;
+};
+
+// NOTE(joon) : Lights the G-buffer into the target framebuffer(the default one or the scene target), with the per frame ubo
+// and the per object ubo that are bound at that point
+struct render_command_shade_deferred
+{
+	render_command_header header;
+	struct deferred_shading *deferred;
+	GLuint targetFramebufferID;
+	glm::mat4 inverseProjection;
+	glm::mat4 inverseViewProjection;
+};
+
+// NOTE(joon) : For the depth pre-pass, which only writes the depth and then draws again with GL_EQUAL.
+// The default is GL_LESS with every write enabled.
+struct render_command_set_depth_state
+{
+	render_command_header header;
+	GLenum depthFunc;
+	b32 isDepthWriteEnabled;
+	b32 isColorWriteEnabled;
+};
+
+// NOTE(joon) : The shadow views are rendered between these two, with the depth only program.
+// See shadow_maps.h
+struct render_command_begin_shadow_passes
+{
+	render_command_header header;
+	struct shadow_maps *shadowMaps;
+};
+
+// NOTE(joon) : The draws after this go into one tile of the static or the final atlas
+struct render_command_begin_shadow_view
+{
+	render_command_header header;
+	struct shadow_maps *shadowMaps;
+	glm::ivec4 rect;
+	b32 isStatic;
+	b32 shouldClear;
+};
+
+// NOTE(joon) : Static depth of the tile into the final atlas, before the dynamic casters are drawn on top
+struct render_command_copy_shadow_view
+{
+	render_command_header header;
+	struct shadow_maps *shadowMaps;
+	glm::ivec4 rect;
+};
+
+struct render_command_end_shadow_passes
+{
+	render_command_header header;
+	struct shadow_maps *shadowMaps;
+};
+
+// NOTE(joon) : Final atlas for the lighting programs, bound to SHADOW_ATLAS_TEXTURE_UNIT
+struct render_command_bind_shadow_atlas
+{
+	render_command_header header;
+	GLuint textureID;
+};
+
+// NOTE(joon) : The GPU time of everything between these two is read back a few frames later.
+// See dynamic_resolution.h
+struct render_command_begin_frame_timer
+{
+	render_command_header header;
+	struct dynamic_resolution *dynamicResolution;
+	r32 renderScale;
+};
+
+struct render_command_end_frame_timer
+{
+	render_command_header header;
+	struct dynamic_resolution *dynamicResolution;
+};
+
+// NOTE(joon) : The draws after this go into the scene target, until the ResolveSceneTarget.
+// The size is the one of the framebuffer, the viewport decides how much of it gets used.
+struct render_command_begin_scene_target
+{
+	render_command_header header;
+	struct dynamic_resolution *dynamicResolution;
+	i32 width;
+	i32 height;
+};
+
+// NOTE(joon) : Upscales the scene target into the default framebuffer, before the imgui is drawn
+struct render_command_resolve_scene_target
+{
+	render_command_header header;
+	struct dynamic_resolution *dynamicResolution;
+	i32 sourceWidth;
+	i32 sourceHeight;
+	i32 targetWidth;
+	i32 targetHeight;
+	i32 filter; // see upscale_filter
+};
+
+// NOTE(joon) : Reads back the default framebuffer once everything is drawn, see frame_capture.h.
+// Also starts & stops the recording, so this should be pushed for every frame.
+struct render_command_capture_frame
+{
+	render_command_header header;
+	struct frame_capture *capture;
+	b32 shouldRecord;
+	i32 format; // see frame_capture_format
+	i32 width;
+	i32 height;
+};
+
+struct command_buffer
+{
+	u8 *base;
+	u32 used;
+	u32 capacity;
+
+	u32 commandCount;
+};
+
+#endif
@@ -0,0 +1,146 @@
+#include "deferred_shading.h"
+
+// NOTE(joon) : Should be called while we have the context, before the render thread is started.
+// The G-buffer is created by the first BeginGBuffer, when we know the size of the framebuffer.
+// Returns false when the shaders cannot be loaded.
+static b32
+InitializeDeferredShading(deferred_shading *deferred)
+{
+	*deferred = {};
+	// NOTE(joon) : The geometry pass reuses the vertex shader of the phong shading, including the texcoord generation
+	deferred->geometryProgram = LoadShaders("source/shaders/phong_shading_shader.vert", "source/shaders/deferred_geometry_shader.frag");
+	deferred->lightCullingProgram = LoadComputeShader("source/shaders/deferred_light_culling_shader.comp");
+	deferred->lightingProgram = LoadShaders("source/shaders/deferred_lighting_shader.vert", "source/shaders/deferred_lighting_shader.frag");
+
+	glGenFramebuffers(1, &deferred->framebufferID);
+	glGenBuffers(1, &deferred->tileLightMaskBufferID);
+	glGenVertexArrays(1, &deferred->emptyVertexArrayID);
+
+	return deferred->geometryProgram && deferred->lightCullingProgram && deferred->lightingProgram;
+}
+
+static void
+FreeDeferredShading(deferred_shading *deferred)
+{
+	glDeleteProgram(deferred->geometryProgram);
+	glDeleteProgram(deferred->lightCullingProgram);
+	glDeleteProgram(deferred->lightingProgram);
+	glDeleteFramebuffers(1, &deferred->framebufferID);
+	glDeleteTextures(1, &deferred->albedoTextureID);
+	glDeleteTextures(1, &deferred->normalTextureID);
+	glDeleteTextures(1, &deferred->depthTextureID);
+	glDeleteBuffers(1, &deferred->tileLightMaskBufferID);
+	glDeleteVertexArrays(1, &deferred->emptyVertexArrayID);
+}
+
+static GLuint
+CreateGBufferTexture(GLenum internalFormat, i32 width, i32 height)
+{
+	GLuint textureID;
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height);
+	// NOTE(joon) : Everything is read with texelFetch, but the texture is not complete without these
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	return textureID;
+}
+
+// NOTE(joon) : Leaves the framebuffer of the G-buffer bound, and nothing bound to the texture unit 0
+static void
+ResizeGBuffer(deferred_shading *deferred, i32 width, i32 height)
+{
+	glDeleteTextures(1, &deferred->albedoTextureID);
+	glDeleteTextures(1, &deferred->normalTextureID);
+	glDeleteTextures(1, &deferred->depthTextureID);
+
+	glActiveTexture(GL_TEXTURE0);
+	deferred->albedoTextureID = CreateGBufferTexture(GL_RGBA8, width, height);
+	deferred->normalTextureID = CreateGBufferTexture(GL_RG16, width, height);
+	deferred->depthTextureID = CreateGBufferTexture(GL_DEPTH_COMPONENT24, width, height);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, deferred->framebufferID);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, deferred->albedoTextureID, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, deferred->normalTextureID, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, deferred->depthTextureID, 0);
+	GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(ArrayCount(drawBuffers), drawBuffers);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		printf("G-buffer is not complete\n");
+	}
+
+	deferred->tileCountX = (width + DEFERRED_TILE_SIZE - 1) / DEFERRED_TILE_SIZE;
+	deferred->tileCountY = (height + DEFERRED_TILE_SIZE - 1) / DEFERRED_TILE_SIZE;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, deferred->tileLightMaskBufferID);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, deferred->tileCountX*deferred->tileCountY*sizeof(u32), 0, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	deferred->width = width;
+	deferred->height = height;
+}
+
+// NOTE(joon) : Everything that is drawn after this goes into the G-buffer, with the geometry program.
+// Expects the texture unit 0 to be active.
+// Leaves the program & the framebuffer changed, and nothing bound to the texture unit 0 when the G-buffer was resized.
+static void
+BeginGBuffer(deferred_shading *deferred, i32 width, i32 height)
+{
+	if (deferred->width != width || deferred->height != height)
+	{
+		ResizeGBuffer(deferred, width, height);
+	}
+	else
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, deferred->framebufferID);
+	}
+
+	// NOTE(joon) : Only the depth needs to be cleared, the lighting pass never reads the pixels that were not drawn
+	glClear(GL_DEPTH_BUFFER_BIT);
+	glUseProgram(deferred->geometryProgram);
+}
+
+// NOTE(joon) : Lights the G-buffer into the target framebuffer, which should be as big as the G-buffer.
+// The depth is also written, so that whatever was drawn there before(or after) is still depth tested against the models.
+// Expects the per frame ubo to be bound at 0, and the per object ubo with the material at 1.
+// Leaves the program & the vertex array changed, the texture unit 0 active and nothing bound to the texture units 0 to 2.
+static void
+ShadeDeferred(deferred_shading *deferred, GLuint targetFramebufferID, glm::mat4 *inverseProjection, glm::mat4 *inverseViewProjection)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, targetFramebufferID);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, deferred->albedoTextureID);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, deferred->normalTextureID);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, deferred->depthTextureID);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, deferred->tileLightMaskBufferID);
+
+	// NOTE(joon) : Lights of each tile
+	GLuint program = deferred->lightCullingProgram;
+	glUseProgram(program);
+	glUniformMatrix4fv(glGetUniformLocation(program, "inverseProjection"), 1, GL_FALSE, (r32 *)inverseProjection);
+	glUniform2i(glGetUniformLocation(program, "screenSize"), deferred->width, deferred->height);
+	glDispatchCompute(deferred->tileCountX, deferred->tileCountY, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// NOTE(joon) : One fullscreen triangle
+	program = deferred->lightingProgram;
+	glUseProgram(program);
+	glUniformMatrix4fv(glGetUniformLocation(program, "inverseViewProjection"), 1, GL_FALSE, (r32 *)inverseViewProjection);
+	glUniform2i(glGetUniformLocation(program, "screenSize"), deferred->width, deferred->height);
+	glUniform1i(glGetUniformLocation(program, "tileCountX"), deferred->tileCountX);
+	glBindVertexArray(deferred->emptyVertexArrayID);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
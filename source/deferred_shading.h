@@ -0,0 +1,39 @@
+#ifndef DEFERRED_SHADING_H
+#define DEFERRED_SHADING_H
+
+// NOTE(joon) : Deferred alternative to the lighting programs, selected as the last of the "Shader Types".
+// The geometry pass writes the models into a compact G-buffer, 12 bytes per pixel :
+//   albedo : RGBA8, the diffuse texture with the kSpecular in the alpha
+//   normal : RG16, octahedral encoded world space normal
+//   depth : 24 bits, the world position is reconstructed from it
+// A compute shader then finds the lights that can reach each screen tile between the depth bounds of the tile,
+// and the lighting pass shades every pixel once with the lights of its tile, so the overdraw only costs the geometry pass.
+//
+// The rest of the material(IEmissive, kAmbient, kDiffuse, ns) is shared by every model,
+// so the lighting pass reads it from the per object ubo. The lighting is the same as the phong shading.
+
+#define DEFERRED_TILE_SIZE 16 // should match the local_size of the light culling shader & the one inside the lighting shader
+
+// NOTE(joon) : Every GL object here is owned by the render thread after it's started
+struct deferred_shading
+{
+	GLuint geometryProgram;
+	GLuint lightCullingProgram;
+	GLuint lightingProgram;
+
+	// NOTE(joon) : Recreated whenever the size changes
+	GLuint framebufferID;
+	GLuint albedoTextureID;
+	GLuint normalTextureID;
+	GLuint depthTextureID;
+	i32 width;
+	i32 height;
+
+	GLuint tileLightMaskBufferID; // one bit for each light, for each tile
+	i32 tileCountX;
+	i32 tileCountY;
+
+	GLuint emptyVertexArrayID; // the fullscreen triangle comes from gl_VertexID, but the core profile still needs a vertex array
+};
+
+#endif
@@ -0,0 +1,267 @@
+#include "dynamic_resolution.h"
+
+// NOTE(joon) : Should be called while we have the context, before the render thread is started.
+// The scene target is created by the first BeginSceneTarget, when we know the size of the framebuffer.
+// Returns false when the shaders cannot be loaded.
+static b32
+InitializeDynamicResolution(dynamic_resolution *dynamicResolution)
+{
+	*dynamicResolution = {};
+	// NOTE(joon) : Same fullscreen triangle as the lighting pass of the deferred shading
+	dynamicResolution->upscaleProgram = LoadShaders("source/shaders/deferred_lighting_shader.vert", "source/shaders/upscale_shader.frag");
+
+	glGenVertexArrays(1, &dynamicResolution->emptyVertexArrayID);
+	glGenFramebuffers(1, &dynamicResolution->framebufferID);
+	glGenQueries(2*DYNAMIC_RESOLUTION_TIMER_QUERY_COUNT, &dynamicResolution->timerQueryIDs[0][0]);
+
+	return dynamicResolution->upscaleProgram != 0;
+}
+
+static void
+FreeDynamicResolution(dynamic_resolution *dynamicResolution)
+{
+	glDeleteProgram(dynamicResolution->upscaleProgram);
+	glDeleteVertexArrays(1, &dynamicResolution->emptyVertexArrayID);
+	glDeleteFramebuffers(1, &dynamicResolution->framebufferID);
+	glDeleteTextures(1, &dynamicResolution->colorTextureID);
+	glDeleteTextures(1, &dynamicResolution->depthTextureID);
+	glDeleteQueries(2*DYNAMIC_RESOLUTION_TIMER_QUERY_COUNT, &dynamicResolution->timerQueryIDs[0][0]);
+}
+
+// NOTE(joon) : Picks up the time of the oldest frame if the GPU is done with it, and starts timing this one.
+// Should be the first command of the frame.
+static void
+BeginFrameTimer(dynamic_resolution *dynamicResolution, r32 renderScale)
+{
+	u32 queryIndex = dynamicResolution->timerQueryIndex;
+	GLuint *queryIDs = dynamicResolution->timerQueryIDs[queryIndex];
+	if (dynamicResolution->isTimerQueryIssued[queryIndex])
+	{
+		// NOTE(joon) : Never waits, the queries are simply reused when they are not ready yet.
+		// The end is written after the begin, so the begin is also available when the end is.
+		GLint isAvailable = 0;
+		glGetQueryObjectiv(queryIDs[1], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+		if (isAvailable)
+		{
+			GLuint64 beginTime = 0;
+			GLuint64 endTime = 0;
+			glGetQueryObjectui64v(queryIDs[0], GL_QUERY_RESULT, &beginTime);
+			glGetQueryObjectui64v(queryIDs[1], GL_QUERY_RESULT, &endTime);
+
+			frame_gpu_time *lastFrameGPUTime = &dynamicResolution->lastFrameGPUTime;
+			lastFrameGPUTime->time = (endTime - beginTime) / 1000000.0;
+			lastFrameGPUTime->renderScale = dynamicResolution->timerQueryScales[queryIndex];
+			lastFrameGPUTime->sampleIndex++;
+		}
+	}
+
+	glQueryCounter(queryIDs[0], GL_TIMESTAMP);
+	dynamicResolution->timerQueryScales[queryIndex] = renderScale;
+	dynamicResolution->isTimerQueryIssued[queryIndex] = false;
+}
+
+// NOTE(joon) : Should be the last command of the frame
+static void
+EndFrameTimer(dynamic_resolution *dynamicResolution)
+{
+	u32 queryIndex = dynamicResolution->timerQueryIndex;
+	glQueryCounter(dynamicResolution->timerQueryIDs[queryIndex][1], GL_TIMESTAMP);
+	dynamicResolution->isTimerQueryIssued[queryIndex] = true;
+	dynamicResolution->timerQueryIndex = (queryIndex + 1) % DYNAMIC_RESOLUTION_TIMER_QUERY_COUNT;
+}
+
+// NOTE(joon) : Leaves nothing bound to the texture unit 0
+static void
+ResizeSceneTarget(dynamic_resolution *dynamicResolution, i32 width, i32 height)
+{
+	glDeleteTextures(1, &dynamicResolution->colorTextureID);
+	glDeleteTextures(1, &dynamicResolution->depthTextureID);
+
+	glActiveTexture(GL_TEXTURE0);
+	glGenTextures(1, &dynamicResolution->colorTextureID);
+	glBindTexture(GL_TEXTURE_2D, dynamicResolution->colorTextureID);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+	// NOTE(joon) : The upscale relies on the bilinear filtering, and clamps the taps to the part that was rendered
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	// NOTE(joon) : Also read back by the hi-z, which copies it the same way as the default framebuffer
+	glGenTextures(1, &dynamicResolution->depthTextureID);
+	glBindTexture(GL_TEXTURE_2D, dynamicResolution->depthTextureID);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, dynamicResolution->framebufferID);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dynamicResolution->colorTextureID, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, dynamicResolution->depthTextureID, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		printf("Scene target is not complete\n");
+	}
+
+	dynamicResolution->width = width;
+	dynamicResolution->height = height;
+}
+
+// NOTE(joon) : Everything that is drawn after this goes into the scene target, which should be as big as the framebuffer.
+// The viewport should be set to the scaled size by the caller.
+// Leaves nothing bound to the texture unit 0 when the scene target was resized.
+static void
+BeginSceneTarget(dynamic_resolution *dynamicResolution, i32 width, i32 height)
+{
+	if (dynamicResolution->width != width || dynamicResolution->height != height)
+	{
+		ResizeSceneTarget(dynamicResolution, width, height);
+	}
+	else
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, dynamicResolution->framebufferID);
+	}
+}
+
+// NOTE(joon) : Upscales the lower left sourceWidth x sourceHeight of the scene target into the whole default framebuffer.
+// Leaves the default framebuffer bound with the viewport covering it, the depth test disabled,
+// the program & the vertex array changed, the texture unit 0 active and nothing bound to it.
+static void
+ResolveSceneTarget(dynamic_resolution *dynamicResolution, i32 sourceWidth, i32 sourceHeight,
+					i32 targetWidth, i32 targetHeight, upscale_filter filter)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, targetWidth, targetHeight);
+	glDisable(GL_DEPTH_TEST);
+
+	GLuint program = dynamicResolution->upscaleProgram;
+	glUseProgram(program);
+	glUniform2i(glGetUniformLocation(program, "sourceSize"), sourceWidth, sourceHeight);
+	glUniform2i(glGetUniformLocation(program, "targetSize"), targetWidth, targetHeight);
+	glUniform1i(glGetUniformLocation(program, "filterType"), filter);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, dynamicResolution->colorTextureID);
+	glBindVertexArray(dynamicResolution->emptyVertexArrayID);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// NOTE(joon) : Snapped to DYNAMIC_RESOLUTION_SCALE_STEP, so that the same scale is always exactly the same float
+static r32
+SnapResolutionScale(r32 scale)
+{
+	r32 result = roundf(scale / DYNAMIC_RESOLUTION_SCALE_STEP) * DYNAMIC_RESOLUTION_SCALE_STEP;
+	result = Clamp(DYNAMIC_RESOLUTION_MIN_SCALE, result, 1.0f);
+
+	return result;
+}
+
+static void
+InitializeResolutionController(resolution_controller *controller)
+{
+	*controller = {};
+	controller->targetFrameTime = 1000.0f / 60.0f;
+	controller->minScale = 0.5f;
+	controller->scale = 1.0f;
+}
+
+static void
+LogResolutionScaleChange(resolution_controller *controller, u64 frameIndex, r32 newScale)
+{
+	if (!controller->logFile)
+	{
+		controller->logFile = fopen(DYNAMIC_RESOLUTION_LOG_FILE_NAME, "w");
+		if (controller->logFile)
+		{
+			fprintf(controller->logFile, "time,frame,gpu_time_ms,target_ms,old_scale,new_scale\n");
+		}
+		else
+		{
+			printf("Failed to open %s\n", DYNAMIC_RESOLUTION_LOG_FILE_NAME);
+		}
+	}
+
+	if (controller->logFile)
+	{
+		fprintf(controller->logFile, "%.4f,%llu,%.4f,%.4f,%.2f,%.2f\n", glfwGetTime(), (unsigned long long)frameIndex,
+				controller->filteredFrameTime, controller->targetFrameTime, controller->scale, newScale);
+		// NOTE(joon) : Flushed right away, so that the log is there even when the app doesn't exit normally
+		fflush(controller->logFile);
+	}
+}
+
+// NOTE(joon) : Feeds the latest readback of the frame timer into the controller, which might change the scale.
+// The same sample can be passed more than once, it's only used once.
+static void
+UpdateResolutionController(resolution_controller *controller, frame_gpu_time *sample, b32 isEnabled, u64 frameIndex)
+{
+	if (!isEnabled)
+	{
+		// NOTE(joon) : Starts from the full size again when it gets enabled
+		controller->scale = 1.0f;
+		controller->sampleCountAtScale = 0;
+		return;
+	}
+
+	r32 minScale = SnapResolutionScale(controller->minScale);
+	if (controller->scale < minScale)
+	{
+		controller->scale = minScale;
+		controller->sampleCountAtScale = 0;
+	}
+
+	if (sample->sampleIndex == controller->lastSampleIndex)
+	{
+		return;
+	}
+	controller->lastSampleIndex = sample->sampleIndex;
+
+	// NOTE(joon) : The frames that were rendered before the last change are still being read back
+	if (sample->renderScale != controller->scale)
+	{
+		return;
+	}
+
+	if (controller->sampleCountAtScale)
+	{
+		controller->filteredFrameTime += 0.25*(sample->time - controller->filteredFrameTime);
+	}
+	else
+	{
+		controller->filteredFrameTime = sample->time;
+	}
+	controller->sampleCountAtScale++;
+
+	r64 targetFrameTime = controller->targetFrameTime;
+	if (controller->sampleCountAtScale >= DYNAMIC_RESOLUTION_SETTLE_SAMPLE_COUNT &&
+		controller->filteredFrameTime > 0.0 &&
+		(controller->filteredFrameTime > targetFrameTime || controller->filteredFrameTime < DYNAMIC_RESOLUTION_HEADROOM*targetFrameTime))
+	{
+		// NOTE(joon) : Aims a bit under the target, so that it doesn't keep going back & forth around it.
+		// Goes down quickly when we're over the budget, but only comes back up slowly.
+		r32 pixelRatio = (r32)(0.9*targetFrameTime / controller->filteredFrameTime);
+		r32 newScale = controller->scale * sqrtf(pixelRatio);
+		newScale = Clamp(controller->scale - 0.25f, newScale, controller->scale + 0.1f);
+		newScale = Maximum(SnapResolutionScale(newScale), minScale);
+
+		if (newScale != controller->scale)
+		{
+			LogResolutionScaleChange(controller, frameIndex, newScale);
+			controller->scale = newScale;
+			controller->sampleCountAtScale = 0;
+			controller->scaleChangeCount++;
+		}
+	}
+}
+
+static void
+FreeResolutionController(resolution_controller *controller)
+{
+	if (controller->logFile)
+	{
+		fclose(controller->logFile);
+		controller->logFile = 0;
+	}
+}
@@ -0,0 +1,73 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+// NOTE(joon) : The 3D scene can be rendered into the scene target instead of the default framebuffer,
+// at a fraction of the framebuffer size, and then upscaled before the imgui is drawn on top at the full size.
+//
+// The GPU time of every frame is measured with two timestamp queries(which can wrap the shadow passes,
+// unlike GL_TIME_ELAPSED) and read back a few frames later. The build stage feeds each sample into the controller,
+// which assumes that the frame time grows with the pixel count and picks the scale that should meet the target.
+// Only the samples that were measured with the current scale are used, so that the latency of the readback
+// doesn't make the scale oscillate. Every scale change is appended to DYNAMIC_RESOLUTION_LOG_FILE_NAME.
+//
+// The scene target is as big as the framebuffer, and the scene is rendered into its lower left part,
+// so that the scale can change without recreating anything.
+
+#define DYNAMIC_RESOLUTION_TIMER_QUERY_COUNT 4 // the GPU time is read back this many frames later, so that we never stall
+#define DYNAMIC_RESOLUTION_MIN_SCALE 0.25f
+#define DYNAMIC_RESOLUTION_SCALE_STEP 0.05f // the scales are snapped to this, so that a small change doesn't resize every target
+#define DYNAMIC_RESOLUTION_SETTLE_SAMPLE_COUNT 4 // samples with the current scale before it can change again
+#define DYNAMIC_RESOLUTION_HEADROOM 0.8f // the scale only goes up when the frame is this much under the target
+#define DYNAMIC_RESOLUTION_LOG_FILE_NAME "dynamic_resolution_log.csv"
+
+enum upscale_filter
+{
+	UpscaleFilter_Bilinear,
+	UpscaleFilter_CatmullRom, // 9 bilinear taps, sharper than the bilinear without the cost of 16 taps
+};
+
+// NOTE(joon) : One readback of the frame timer
+struct frame_gpu_time
+{
+	r64 time; // in ms, everything between the first command of the frame and the imgui
+	r32 renderScale; // that the frame was rendered with, 1 when it wasn't scaled
+	u64 sampleIndex; // 0 when nothing was read back yet
+};
+
+// NOTE(joon) : Build stage only
+struct resolution_controller
+{
+	b32 isSupported; // the scene target was created, should be set before the first build
+	r32 targetFrameTime; // in ms
+	r32 minScale;
+
+	r32 scale; // of the width & the height
+	r64 filteredFrameTime; // of the samples with the current scale
+	u32 sampleCountAtScale;
+	u64 lastSampleIndex;
+
+	u32 scaleChangeCount;
+	FILE *logFile; // opened by the first scale change
+};
+
+// NOTE(joon) : Every GL object here is owned by the render thread after it's started
+struct dynamic_resolution
+{
+	GLuint upscaleProgram;
+	GLuint emptyVertexArrayID;
+
+	// NOTE(joon) : Recreated whenever the size of the framebuffer changes
+	GLuint framebufferID;
+	GLuint colorTextureID;
+	GLuint depthTextureID;
+	i32 width;
+	i32 height;
+
+	GLuint timerQueryIDs[DYNAMIC_RESOLUTION_TIMER_QUERY_COUNT][2]; // begin, end
+	r32 timerQueryScales[DYNAMIC_RESOLUTION_TIMER_QUERY_COUNT];
+	b32 isTimerQueryIssued[DYNAMIC_RESOLUTION_TIMER_QUERY_COUNT];
+	u32 timerQueryIndex;
+	frame_gpu_time lastFrameGPUTime;
+};
+
+#endif
@@ -0,0 +1,613 @@
+#include "frame_capture.h"
+
+struct crc32_table
+{
+	u32 entries[256];
+};
+
+static crc32_table
+BuildCRC32Table()
+{
+	crc32_table result;
+	for (u32 n = 0;
+		n < 256;
+		++n)
+	{
+		u32 c = n;
+		for (u32 k = 0;
+			k < 8;
+			++k)
+		{
+			c = (c & 1) ? (0xedb88320u ^ (c >> 1)) : (c >> 1);
+		}
+		result.entries[n] = c;
+	}
+
+	return result;
+}
+
+static u32
+UpdateCRC32(u32 crc, u8 *data, size_t size)
+{
+	// NOTE(joon) : Built by the first call in a thread safe way, as the encoder thread & the benchmark can both get here
+	static const crc32_table table = BuildCRC32Table();
+
+	crc = ~crc;
+	for (size_t index = 0;
+		index < size;
+		++index)
+	{
+		crc = table.entries[(crc ^ data[index]) & 0xff] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
+
+static void
+AppendBigEndian32(std::vector<u8> *buffer, u32 value)
+{
+	buffer->push_back((u8)(value >> 24));
+	buffer->push_back((u8)(value >> 16));
+	buffer->push_back((u8)(value >> 8));
+	buffer->push_back((u8)value);
+}
+
+static void
+AppendPNGChunk(std::vector<u8> *buffer, const char *type, u8 *data, u32 size)
+{
+	AppendBigEndian32(buffer, size);
+	size_t typeStart = buffer->size();
+	buffer->insert(buffer->end(), type, type + 4);
+	buffer->insert(buffer->end(), data, data + size);
+	AppendBigEndian32(buffer, UpdateCRC32(0, buffer->data() + typeStart, size + 4));
+}
+
+// NOTE(joon) : RGB PNG from the RGBA8 pixels, bottom row first like the GL framebuffer.
+// The image data is not compressed(stored deflate blocks), which keeps this tiny and fast
+// at the cost of the file size.
+static b32
+WritePNG(const char *fileName, u32 *pixels, i32 width, i32 height, i32 stride)
+{
+	// NOTE(joon) : Every row starts with the filter type, which is always 0(none)
+	u32 rowSize = 1 + 3*width;
+	std::vector<u8> image(rowSize*height);
+	for (i32 y = 0;
+		y < height;
+		++y)
+	{
+		u8 *row = image.data() + y*rowSize;
+		u32 *source = pixels + (height - 1 - y)*stride;
+		row[0] = 0;
+		for (i32 x = 0;
+			x < width;
+			++x)
+		{
+			row[1 + 3*x + 0] = (u8)(source[x] >> 0);
+			row[1 + 3*x + 1] = (u8)(source[x] >> 8);
+			row[1 + 3*x + 2] = (u8)(source[x] >> 16);
+		}
+	}
+
+	// NOTE(joon) : zlib header, stored blocks of at most 65535 bytes and the adler32 of the uncompressed data
+	std::vector<u8> zlib;
+	zlib.reserve(image.size() + 6 + 5*(image.size()/65535 + 1));
+	zlib.push_back(0x78);
+	zlib.push_back(0x01);
+	u32 adlerA = 1;
+	u32 adlerB = 0;
+	size_t offset = 0;
+	do
+	{
+		u32 blockSize = (u32)Minimum(image.size() - offset, (size_t)65535);
+		b32 isLast = (offset + blockSize == image.size());
+		zlib.push_back(isLast ? 1 : 0);
+		zlib.push_back((u8)blockSize);
+		zlib.push_back((u8)(blockSize >> 8));
+		zlib.push_back((u8)~blockSize);
+		zlib.push_back((u8)(~blockSize >> 8));
+		zlib.insert(zlib.end(), image.begin() + offset, image.begin() + offset + blockSize);
+
+		// NOTE(joon) : The sums cannot overflow in 5552 bytes, so the modulo is only needed once for that many bytes
+		for (u32 start = 0;
+			start < blockSize;
+			start += 5552)
+		{
+			u32 end = Minimum(start + 5552, blockSize);
+			for (u32 index = start;
+				index < end;
+				++index)
+			{
+				adlerA += image[offset + index];
+				adlerB += adlerA;
+			}
+			adlerA %= 65521;
+			adlerB %= 65521;
+		}
+		offset += blockSize;
+	}while (offset < image.size());
+	AppendBigEndian32(&zlib, (adlerB << 16) | adlerA);
+
+	std::vector<u8> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+	u8 header[13] = {};
+	header[0] = (u8)(width >> 24);
+	header[1] = (u8)(width >> 16);
+	header[2] = (u8)(width >> 8);
+	header[3] = (u8)width;
+	header[4] = (u8)(height >> 24);
+	header[5] = (u8)(height >> 16);
+	header[6] = (u8)(height >> 8);
+	header[7] = (u8)height;
+	header[8] = 8; // bit depth
+	header[9] = 2; // RGB
+	AppendPNGChunk(&png, "IHDR", header, sizeof(header));
+	AppendPNGChunk(&png, "IDAT", zlib.data(), (u32)zlib.size());
+	AppendPNGChunk(&png, "IEND", 0, 0);
+
+	b32 result = false;
+	FILE *file = fopen(fileName, "wb");
+	if (file)
+	{
+		result = (fwrite(png.data(), 1, png.size(), file) == png.size());
+		fclose(file);
+	}
+	if (!result)
+	{
+		printf("Failed to write %s\n", fileName);
+	}
+
+	return result;
+}
+
+// NOTE(joon) : The Y4M file is opened here, but its header is written with the first frame
+static b32
+OpenFrameWriter(frame_writer *writer, frame_capture_format format, const char *prefix)
+{
+	writer->format = format;
+	snprintf(writer->prefix, sizeof(writer->prefix), "%s", prefix);
+	writer->y4mFile = 0;
+	writer->y4mWidth = 0;
+	writer->y4mHeight = 0;
+	writer->writtenFrameCount = 0;
+	writer->skippedFrameCount = 0;
+	writer->hasFailed = false;
+
+	b32 result = true;
+	if (format == FrameCaptureFormat_Y4M)
+	{
+		char fileName[512];
+		snprintf(fileName, sizeof(fileName), "%s.y4m", prefix);
+		writer->y4mFile = fopen(fileName, "wb");
+		if (!writer->y4mFile)
+		{
+			printf("Failed to open %s\n", fileName);
+			result = false;
+		}
+	}
+
+	return result;
+}
+
+// NOTE(joon) : RGBA8 to 8 bit BT.601 YCbCr(video range), the Y4M rows go from the top to the bottom
+static void
+WriteY4MFrame(frame_writer *writer, u32 *pixels, i32 width, i32 height, i32 stride)
+{
+	if (!writer->y4mWidth)
+	{
+		fprintf(writer->y4mFile, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width, height, FRAME_CAPTURE_Y4M_FRAME_RATE);
+		writer->y4mWidth = width;
+		writer->y4mHeight = height;
+	}
+	if (width != writer->y4mWidth || height != writer->y4mHeight)
+	{
+		if (!writer->skippedFrameCount)
+		{
+			printf("The size of the frame has changed, frames that are not %dx%d are skipped\n", writer->y4mWidth, writer->y4mHeight);
+		}
+		writer->skippedFrameCount++;
+		return;
+	}
+
+	size_t planeSize = (size_t)width*height;
+	writer->y4mPlanes.resize(3*planeSize);
+	u8 *yPlane = writer->y4mPlanes.data();
+	u8 *cbPlane = yPlane + planeSize;
+	u8 *crPlane = cbPlane + planeSize;
+	for (i32 y = 0;
+		y < height;
+		++y)
+	{
+		u32 *source = pixels + (height - 1 - y)*stride;
+		size_t rowStart = (size_t)y*width;
+		for (i32 x = 0;
+			x < width;
+			++x)
+		{
+			i32 r = (i32)((source[x] >> 0) & 0xff);
+			i32 g = (i32)((source[x] >> 8) & 0xff);
+			i32 b = (i32)((source[x] >> 16) & 0xff);
+			yPlane[rowStart + x] = (u8)(((66*r + 129*g + 25*b + 128) >> 8) + 16);
+			cbPlane[rowStart + x] = (u8)(((-38*r - 74*g + 112*b + 128) >> 8) + 128);
+			crPlane[rowStart + x] = (u8)(((112*r - 94*g - 18*b + 128) >> 8) + 128);
+		}
+	}
+
+	fputs("FRAME\n", writer->y4mFile);
+	if (fwrite(yPlane, 1, writer->y4mPlanes.size(), writer->y4mFile) != writer->y4mPlanes.size())
+	{
+		printf("Failed to write the frame into %s.y4m\n", writer->prefix);
+		writer->hasFailed = true;
+	}
+}
+
+// NOTE(joon) : Pixels are RGBA8, bottom row first
+static void
+WriteCapturedFrame(frame_writer *writer, u32 *pixels, i32 width, i32 height, i32 stride)
+{
+	// NOTE(joon) : Only the first failure is reported, the rest of the frames would fail the same way
+	if (writer->hasFailed)
+	{
+		writer->skippedFrameCount++;
+		return;
+	}
+
+	if (writer->format == FrameCaptureFormat_Y4M)
+	{
+		WriteY4MFrame(writer, pixels, width, height, stride);
+	}
+	else
+	{
+		char fileName[512];
+		snprintf(fileName, sizeof(fileName), "%s_%06llu.png", writer->prefix, (unsigned long long)writer->writtenFrameCount);
+		writer->hasFailed = !WritePNG(fileName, pixels, width, height, stride);
+	}
+
+	if (!writer->hasFailed)
+	{
+		writer->writtenFrameCount++;
+	}
+}
+
+static void
+CloseFrameWriter(frame_writer *writer)
+{
+	if (writer->y4mFile)
+	{
+		fclose(writer->y4mFile);
+		writer->y4mFile = 0;
+	}
+}
+
+// NOTE(joon) : Should be called by the thread that owns the context. The pixel buffers are created by the first frame.
+static void
+InitializeFrameCapture(frame_capture *capture)
+{
+	for (u32 slotIndex = 0;
+		slotIndex < FRAME_CAPTURE_SLOT_COUNT;
+		++slotIndex)
+	{
+		capture->slots[slotIndex] = {};
+	}
+	capture->slotCapacity = 0;
+	capture->nextSlotIndex = 0;
+	capture->oldestReadingSlotIndex = 0;
+	capture->readingSlotCount = 0;
+	capture->isRecording = false;
+	capture->isStartBlocked = false;
+	capture->sessionCount = 0;
+	capture->writer = {};
+	capture->encodeSlotIndex = 0;
+	capture->isEncoderRunning = false;
+	capture->capturedFrameCount = 0;
+	capture->encodedFrameCount = 0;
+	capture->stallCount = 0;
+	capture->lastEncodeTime = 0.0;
+	capture->failedStartCount = 0;
+}
+
+// NOTE(joon) : Every slot should be free
+static void
+ResizeFrameCaptureSlots(frame_capture *capture, size_t size)
+{
+	for (u32 slotIndex = 0;
+		slotIndex < FRAME_CAPTURE_SLOT_COUNT;
+		++slotIndex)
+	{
+		frame_capture_slot *slot = capture->slots + slotIndex;
+		Assert(slot->state == FrameCaptureSlot_Free);
+		if (slot->pixelBufferID)
+		{
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pixelBufferID);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			glDeleteBuffers(1, &slot->pixelBufferID);
+		}
+
+		// NOTE(joon) : Coherent, so the pixels are visible to the encoder as soon as the fence is signaled
+		GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glGenBuffers(1, &slot->pixelBufferID);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pixelBufferID);
+		glBufferStorage(GL_PIXEL_PACK_BUFFER, size, 0, flags);
+		slot->pixels = (u32 *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, flags);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	capture->slotCapacity = size;
+}
+
+// NOTE(joon) : Hands the readbacks that the GPU has finished over to the encoder thread, oldest first.
+// When shouldWaitForOldest is true, the oldest one is handed over even if we have to wait for it.
+static void
+HandOverFinishedReadbacks(frame_capture *capture, b32 shouldWaitForOldest)
+{
+	while (capture->readingSlotCount)
+	{
+		frame_capture_slot *slot = capture->slots + capture->oldestReadingSlotIndex;
+		GLenum status = glClientWaitSync(slot->fence, 0, 0);
+		if (status == GL_TIMEOUT_EXPIRED)
+		{
+			if (!shouldWaitForOldest)
+			{
+				break;
+			}
+
+			do
+			{
+				status = glClientWaitSync(slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+			}while (status == GL_TIMEOUT_EXPIRED);
+		}
+		shouldWaitForOldest = false;
+
+		glDeleteSync(slot->fence);
+		slot->fence = 0;
+		{
+			std::lock_guard<std::mutex> lock(capture->lock);
+			slot->state = FrameCaptureSlot_Encoding;
+			capture->capturedFrameCount++;
+		}
+		capture->encodeCondition.notify_one();
+
+		capture->oldestReadingSlotIndex = (capture->oldestReadingSlotIndex + 1) % FRAME_CAPTURE_SLOT_COUNT;
+		capture->readingSlotCount--;
+	}
+}
+
+// NOTE(joon) : Waits until every frame that was captured is written
+static void
+WaitForFrameCaptureSlots(frame_capture *capture)
+{
+	while (capture->readingSlotCount)
+	{
+		HandOverFinishedReadbacks(capture, true);
+	}
+
+	std::unique_lock<std::mutex> lock(capture->lock);
+	capture->freeCondition.wait(lock, [capture]
+	{
+		for (u32 slotIndex = 0;
+			slotIndex < FRAME_CAPTURE_SLOT_COUNT;
+			++slotIndex)
+		{
+			if (capture->slots[slotIndex].state != FrameCaptureSlot_Free)
+			{
+				return false;
+			}
+		}
+		return true;
+	});
+}
+
+static void
+FrameCaptureEncoderProc(frame_capture *capture)
+{
+	for (;;)
+	{
+		// NOTE(joon) : The slots are handed over in order, so the next one is always the oldest frame
+		frame_capture_slot *slot = capture->slots + capture->encodeSlotIndex;
+		{
+			std::unique_lock<std::mutex> lock(capture->lock);
+			capture->encodeCondition.wait(lock, [capture, slot]
+			{
+				return slot->state == FrameCaptureSlot_Encoding || !capture->isEncoderRunning;
+			});
+
+			if (slot->state != FrameCaptureSlot_Encoding)
+			{
+				// NOTE(joon) : not running anymore, and every frame that was handed over is written
+				break;
+			}
+		}
+
+		std::chrono::steady_clock::time_point encodeStart = std::chrono::steady_clock::now();
+		WriteCapturedFrame(&capture->writer, slot->pixels, slot->width, slot->height, slot->width);
+		std::chrono::duration<r64, std::milli> encodeTime = std::chrono::steady_clock::now() - encodeStart;
+
+		{
+			std::lock_guard<std::mutex> lock(capture->lock);
+			slot->state = FrameCaptureSlot_Free;
+			capture->encodedFrameCount++;
+			capture->lastEncodeTime = encodeTime.count();
+		}
+		capture->freeCondition.notify_all();
+
+		capture->encodeSlotIndex = (capture->encodeSlotIndex + 1) % FRAME_CAPTURE_SLOT_COUNT;
+	}
+}
+
+// NOTE(joon) : Returns false when the output cannot be opened
+static b32
+StartFrameCapture(frame_capture *capture, frame_capture_format format, const char *prefix)
+{
+	Assert(!capture->isRecording);
+	if (!OpenFrameWriter(&capture->writer, format, prefix))
+	{
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(capture->lock);
+		capture->capturedFrameCount = 0;
+		capture->encodedFrameCount = 0;
+		capture->stallCount = 0;
+		capture->lastEncodeTime = 0.0;
+		capture->isEncoderRunning = true;
+	}
+	capture->encodeSlotIndex = capture->nextSlotIndex;
+	capture->encoderThread = std::thread(FrameCaptureEncoderProc, capture);
+	capture->isRecording = true;
+	capture->sessionCount++;
+
+	return true;
+}
+
+// NOTE(joon) : Reads back the GL_READ_FRAMEBUFFER, which should be at least width x height.
+// Only waits when every slot is still being read back or encoded.
+static void
+CaptureFrame(frame_capture *capture, i32 width, i32 height)
+{
+	Assert(capture->isRecording);
+	HandOverFinishedReadbacks(capture, false);
+
+	size_t size = 4*(size_t)width*height;
+	if (size > capture->slotCapacity)
+	{
+		// NOTE(joon) : The frames before this one are still using the old buffers
+		WaitForFrameCaptureSlots(capture);
+		ResizeFrameCaptureSlots(capture, size);
+	}
+
+	// NOTE(joon) : The ring is full of readbacks, so the next slot is the oldest one
+	b32 hasStalled = false;
+	if (capture->readingSlotCount == FRAME_CAPTURE_SLOT_COUNT)
+	{
+		HandOverFinishedReadbacks(capture, true);
+		hasStalled = true;
+	}
+
+	frame_capture_slot *slot = capture->slots + capture->nextSlotIndex;
+	{
+		std::unique_lock<std::mutex> lock(capture->lock);
+		if (slot->state != FrameCaptureSlot_Free)
+		{
+			hasStalled = true;
+			capture->freeCondition.wait(lock, [slot]
+			{
+				return slot->state == FrameCaptureSlot_Free;
+			});
+		}
+		if (hasStalled)
+		{
+			capture->stallCount++;
+		}
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pixelBufferID);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot->width = width;
+	slot->height = height;
+	{
+		std::lock_guard<std::mutex> lock(capture->lock);
+		slot->state = FrameCaptureSlot_Reading;
+	}
+
+	capture->nextSlotIndex = (capture->nextSlotIndex + 1) % FRAME_CAPTURE_SLOT_COUNT;
+	capture->readingSlotCount++;
+}
+
+// NOTE(joon) : Waits until every frame that was captured is written
+static void
+StopFrameCapture(frame_capture *capture)
+{
+	Assert(capture->isRecording);
+	while (capture->readingSlotCount)
+	{
+		HandOverFinishedReadbacks(capture, true);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(capture->lock);
+		capture->isEncoderRunning = false;
+	}
+	capture->encodeCondition.notify_all();
+	capture->encoderThread.join();
+
+	CloseFrameWriter(&capture->writer);
+	capture->isRecording = false;
+}
+
+static void
+PrintFrameCaptureSummary(frame_capture *capture)
+{
+	frame_writer *writer = &capture->writer;
+	printf("Captured %llu frames into %s%s, %llu stalls\n", (unsigned long long)writer->writtenFrameCount, writer->prefix,
+			(writer->format == FrameCaptureFormat_Y4M) ? ".y4m" : "_*.png", (unsigned long long)capture->stallCount);
+	if (writer->skippedFrameCount)
+	{
+		printf("%llu frames were skipped\n", (unsigned long long)writer->skippedFrameCount);
+	}
+}
+
+// NOTE(joon) : Starts or stops the recording when shouldRecord has changed, and captures the frame while it's recording.
+// Every recording gets its own FRAME_CAPTURE_FILE_PREFIX_<index> files.
+static void
+UpdateFrameCapture(frame_capture *capture, b32 shouldRecord, frame_capture_format format, i32 width, i32 height)
+{
+	if (!shouldRecord)
+	{
+		capture->isStartBlocked = false;
+	}
+
+	if (shouldRecord && !capture->isRecording && !capture->isStartBlocked)
+	{
+		char prefix[256];
+		snprintf(prefix, sizeof(prefix), "%s_%u", FRAME_CAPTURE_FILE_PREFIX, capture->sessionCount);
+		if (!StartFrameCapture(capture, format, prefix))
+		{
+			// NOTE(joon) : Reported once, the build stage clears the record request when it sees the failure
+			printf("Failed to start the frame capture into %s\n", prefix);
+			capture->isStartBlocked = true;
+
+			std::lock_guard<std::mutex> lock(capture->lock);
+			capture->failedStartCount++;
+		}
+	}
+	else if (!shouldRecord && capture->isRecording)
+	{
+		StopFrameCapture(capture);
+		PrintFrameCaptureSummary(capture);
+	}
+
+	// NOTE(joon) : Nothing to capture while the window is minimized
+	if (capture->isRecording && width > 0 && height > 0)
+	{
+		CaptureFrame(capture, width, height);
+	}
+}
+
+// NOTE(joon) : Also finishes the recording
+static void
+FreeFrameCapture(frame_capture *capture)
+{
+	if (capture->isRecording)
+	{
+		StopFrameCapture(capture);
+		PrintFrameCaptureSummary(capture);
+	}
+
+	for (u32 slotIndex = 0;
+		slotIndex < FRAME_CAPTURE_SLOT_COUNT;
+		++slotIndex)
+	{
+		frame_capture_slot *slot = capture->slots + slotIndex;
+		if (slot->pixelBufferID)
+		{
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pixelBufferID);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			glDeleteBuffers(1, &slot->pixelBufferID);
+			slot->pixelBufferID = 0;
+			slot->pixels = 0;
+		}
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	capture->slotCapacity = 0;
+}
@@ -0,0 +1,86 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+// NOTE(joon) : Records every frame without waiting for the GPU.
+// Each frame is read back into the next pixel buffer of a ring with glReadPixels, which only queues the copy,
+// and a fence tells us when the copy is done. The pixel buffers stay mapped, so the finished ones are handed
+// to the encoder thread as they are, which writes them as a PNG sequence or a single Y4M file
+// and gives the buffer back to the ring.
+// The thread that owns the context only waits when every buffer of the ring is still in use
+// (the GPU or the encoder is too far behind), which is counted as a stall.
+
+#define FRAME_CAPTURE_SLOT_COUNT 6 // frames that can be read back or encoded at the same time
+#define FRAME_CAPTURE_FILE_PREFIX "capture"
+#define FRAME_CAPTURE_Y4M_FRAME_RATE 60
+
+enum frame_capture_format
+{
+	FrameCaptureFormat_PNG, // <prefix>_000000.png, <prefix>_000001.png...
+	FrameCaptureFormat_Y4M, // <prefix>.y4m, 4:4:4 BT.601 so that it doesn't need to be subsampled
+};
+
+// NOTE(joon) : Writes the frames one by one, bottom row first like the GL framebuffer
+struct frame_writer
+{
+	frame_capture_format format;
+	char prefix[256];
+
+	FILE *y4mFile;
+	i32 y4mWidth; // of the first frame, every frame of a Y4M should have the same size
+	i32 y4mHeight;
+	std::vector<u8> y4mPlanes;
+
+	u64 writtenFrameCount;
+	u64 skippedFrameCount; // Y4M frames that didn't have the size of the first one
+	b32 hasFailed;
+};
+
+enum frame_capture_slot_state
+{
+	FrameCaptureSlot_Free,
+	FrameCaptureSlot_Reading, // the GPU is copying the frame into it
+	FrameCaptureSlot_Encoding, // waiting for or being written by the encoder thread
+};
+
+struct frame_capture_slot
+{
+	GLuint pixelBufferID;
+	u32 *pixels; // persistently mapped
+	GLsync fence;
+	i32 width;
+	i32 height;
+
+	frame_capture_slot_state state; // protected by the lock
+};
+
+struct frame_capture
+{
+	// NOTE(joon) : The slots are used in order, so the frames are always encoded in the order they were captured.
+	// Only the thread that owns the context touches the buffers & the indices, the encoder thread has its own index.
+	frame_capture_slot slots[FRAME_CAPTURE_SLOT_COUNT];
+	size_t slotCapacity; // in bytes, the buffers are recreated when a bigger frame comes in
+	u32 nextSlotIndex;
+	u32 oldestReadingSlotIndex;
+	u32 readingSlotCount;
+	b32 isRecording;
+	b32 isStartBlocked; // the last start has failed, and is not retried until the record request is cleared
+	u32 sessionCount;
+
+	frame_writer writer; // only touched by the encoder thread while it's running
+	std::thread encoderThread;
+	u32 encodeSlotIndex;
+
+	std::mutex lock;
+	std::condition_variable encodeCondition; // a slot was handed over, or the recording has stopped
+	std::condition_variable freeCondition; // a slot was encoded
+	b32 isEncoderRunning;
+
+	// NOTE(joon) : stats of the current(or the last) recording, protected by the lock
+	u64 capturedFrameCount;
+	u64 encodedFrameCount;
+	u64 stallCount;
+	r64 lastEncodeTime; // in ms
+	u32 failedStartCount; // of every recording, so that the build stage can tell that its request has failed
+};
+
+#endif
@@ -0,0 +1,1543 @@
+#include "frame_pipeline.h"
+
+// NOTE(joon) : Gribb & Hartmann, planes are pointing inside & not normalized
+static void
+ExtractFrustumPlanes(glm::mat4 *viewProjection, glm::vec4 *planes)
+{
+	glm::mat4 m = *viewProjection;
+	glm::vec4 row0 = glm::vec4(m[0][0], m[1][0], m[2][0], m[3][0]);
+	glm::vec4 row1 = glm::vec4(m[0][1], m[1][1], m[2][1], m[3][1]);
+	glm::vec4 row2 = glm::vec4(m[0][2], m[1][2], m[2][2], m[3][2]);
+	glm::vec4 row3 = glm::vec4(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+	planes[0] = row3 + row0; // left
+	planes[1] = row3 - row0; // right
+	planes[2] = row3 + row1; // bottom
+	planes[3] = row3 - row1; // top
+	planes[4] = row3 + row2; // near
+	planes[5] = row3 - row2; // far
+}
+
+static b32
+IsSphereInsideFrustum(glm::vec4 *planes, glm::vec3 center, r32 radius)
+{
+	b32 result = true;
+	for (u32 planeIndex = 0;
+		planeIndex < 6;
+		++planeIndex)
+	{
+		glm::vec4 plane = planes[planeIndex];
+		r32 distance = glm::dot(glm::vec3(plane), center) + plane.w;
+		if (distance < -radius*glm::length(glm::vec3(plane)))
+		{
+			result = false;
+			break;
+		}
+	}
+
+	return result;
+}
+
+static b32
+IsTransformInsideFrustum(glm::vec4 *planes, transform *transform, r32 boundingRadius)
+{
+	r32 maxScale = Maximum(Maximum(transform->scale.x, transform->scale.y), transform->scale.z);
+	glm::vec3 center = glm::vec3(transform->world[3]);
+
+	return IsSphereInsideFrustum(planes, center, boundingRadius*maxScale);
+}
+
+enum meshlet_cull_result
+{
+	MeshletCullResult_Visible,
+	MeshletCullResult_Frustum,
+	MeshletCullResult_Cone,
+};
+
+struct cull_meshlets_job_data
+{
+	meshlet *meshlets;
+	glm::vec4 *frustumPlanes; // model space
+	glm::vec3 cameraP; // model space
+	b32 shouldConeCull;
+	u8 *results;
+};
+
+static void
+CullMeshletsJob(void *data, u32 start, u32 onePastEnd)
+{
+	cull_meshlets_job_data *jobData = (cull_meshlets_job_data *)data;
+	for (u32 meshletIndex = start;
+		meshletIndex < onePastEnd;
+		++meshletIndex)
+	{
+		meshlet *meshlet = jobData->meshlets + meshletIndex;
+
+		u8 result = MeshletCullResult_Visible;
+		if (!IsSphereInsideFrustum(jobData->frustumPlanes, meshlet->center, meshlet->radius))
+		{
+			result = MeshletCullResult_Frustum;
+		}
+		else if (jobData->shouldConeCull && IsMeshletBackFacing(meshlet, jobData->cameraP))
+		{
+			result = MeshletCullResult_Cone;
+		}
+		jobData->results[meshletIndex] = result;
+	}
+}
+
+// NOTE(joon) : Writes a meshlet_cull_result for each meshlet of the mesh.
+// Everything is tested in the model space, where the planes extracted from the mvp are.
+static void
+CullMeshlets(job_system *jobSystem, mesh *mesh, glm::mat4 *world, glm::mat4 *mvp, glm::vec3 cameraP, u8 *results)
+{
+	glm::vec4 frustumPlanes[6];
+	ExtractFrustumPlanes(mvp, frustumPlanes);
+
+	cull_meshlets_job_data jobData = {};
+	jobData.meshlets = mesh->meshlets.data();
+	jobData.frustumPlanes = frustumPlanes;
+	jobData.cameraP = glm::vec3(glm::inverse(*world) * glm::vec4(cameraP, 1.0f));
+	// NOTE(joon) : Mirroring world matrix flips the winding, and the cones would be pointing the other way
+	jobData.shouldConeCull = (glm::determinant(glm::mat3(*world)) > 0.0f);
+	jobData.results = results;
+	ParallelFor(jobSystem, CullMeshletsJob, &jobData, "CullMeshlets", (u32)mesh->meshlets.size(), 64);
+}
+
+// NOTE(joon) : The item will only draw its visible meshlets, with one indirect command
+// for each run of them that are next to each other
+static void
+CullDrawItemMeshlets(scene_state *scene, frame_packet *packet, draw_item *item)
+{
+	mesh *mesh = &item->model->mesh;
+	u32 meshletCount = (u32)mesh->meshlets.size();
+	if (meshletCount == 0)
+	{
+		return;
+	}
+
+	scene->meshletCullResults.resize(Maximum(scene->meshletCullResults.size(), (size_t)meshletCount));
+	u8 *results = scene->meshletCullResults.data();
+	CullMeshlets(scene->jobSystem, mesh, &item->matrices.model, &item->matrices.mvp, scene->perFrameUbo.cameraP, results);
+
+	item->shouldDrawMeshlets = true;
+	item->firstMeshletCommand = (u32)packet->meshletCommands.size();
+	b32 wasLastVisible = false;
+	for (u32 meshletIndex = 0;
+		meshletIndex < meshletCount;
+		++meshletIndex)
+	{
+		meshlet *meshlet = mesh->meshlets.data() + meshletIndex;
+		packet->meshletTriangleCount += meshlet->triangleCount;
+
+		switch (results[meshletIndex])
+		{
+			case MeshletCullResult_Visible:
+			{
+				if (wasLastVisible)
+				{
+					packet->meshletCommands.back().count += 3*meshlet->triangleCount;
+				}
+				else
+				{
+					draw_elements_indirect_command command = {};
+					command.count = 3*meshlet->triangleCount;
+					command.instanceCount = 1;
+					command.firstIndex = meshlet->firstIndex;
+					packet->meshletCommands.push_back(command);
+				}
+			}break;
+
+			case MeshletCullResult_Frustum:
+			{
+				packet->frustumCulledMeshletTriangleCount += meshlet->triangleCount;
+			}break;
+
+			case MeshletCullResult_Cone:
+			{
+				packet->coneCulledMeshletTriangleCount += meshlet->triangleCount;
+			}break;
+		}
+		wasLastVisible = (results[meshletIndex] == MeshletCullResult_Visible);
+	}
+	item->meshletCommandCount = (u32)packet->meshletCommands.size() - item->firstMeshletCommand;
+}
+
+static void
+CopyImGuiDrawData(frame_packet *packet, ImDrawData *drawData)
+{
+	while (packet->imguiDrawLists.Size < drawData->CmdListsCount)
+	{
+		packet->imguiDrawLists.push_back(IM_NEW(ImDrawList)(0));
+	}
+
+	for (int listIndex = 0;
+		listIndex < drawData->CmdListsCount;
+		++listIndex)
+	{
+		ImDrawList *source = drawData->CmdLists[listIndex];
+		ImDrawList *dest = packet->imguiDrawLists[listIndex];
+
+		// NOTE(joon) : ImVector reuses the memory if it's big enough, so this doesn't allocate every frame
+		dest->CmdBuffer = source->CmdBuffer;
+		dest->IdxBuffer = source->IdxBuffer;
+		dest->VtxBuffer = source->VtxBuffer;
+		dest->Flags = source->Flags;
+	}
+
+	packet->imguiDrawData = *drawData;
+	packet->imguiDrawData.CmdLists = packet->imguiDrawLists.Data;
+}
+
+#define FNV_OFFSET_BASIS_64 0xcbf29ce484222325ull
+#define FNV_PRIME_64 0x100000001b3ull
+
+// NOTE(joon) : FNV-1a, only used to see if anything changed so it doesn't need to be a good hash
+static u64
+HashBytes(u64 hash, void *data, size_t size)
+{
+	u8 *at = (u8 *)data;
+	for (size_t byteIndex = 0;
+		byteIndex < size;
+		++byteIndex)
+	{
+		hash ^= at[byteIndex];
+		hash *= FNV_PRIME_64;
+	}
+
+	return hash;
+}
+
+// NOTE(joon) : Everything that can change the pixels, except the GPU resources(shader files, textures)
+// that are only changed by the requests in the packet
+static u64
+HashFramePacket(frame_packet *packet)
+{
+	u64 hash = FNV_OFFSET_BASIS_64;
+	hash = HashBytes(hash, &packet->perFrameUbo, sizeof(packet->perFrameUbo));
+	hash = HashBytes(hash, &packet->perObjectUbo, sizeof(packet->perObjectUbo));
+	hash = HashBytes(hash, &packet->selectedProgramIndex, sizeof(packet->selectedProgramIndex));
+	hash = HashBytes(hash, &packet->textureMappingMethod, sizeof(packet->textureMappingMethod));
+	hash = HashBytes(hash, &packet->shouldUseP, sizeof(packet->shouldUseP));
+	hash = HashBytes(hash, &packet->shouldDrawInstances, sizeof(packet->shouldDrawInstances));
+	hash = HashBytes(hash, &packet->shouldHiZCullInstances, sizeof(packet->shouldHiZCullInstances));
+	hash = HashBytes(hash, &packet->instanceCount, sizeof(packet->instanceCount));
+	hash = HashBytes(hash, &packet->shouldCastShadows, sizeof(packet->shouldCastShadows));
+	hash = HashBytes(hash, &packet->shadowUbo, sizeof(packet->shadowUbo));
+	hash = HashBytes(hash, &packet->shouldScaleResolution, sizeof(packet->shouldScaleResolution));
+	hash = HashBytes(hash, &packet->renderScale, sizeof(packet->renderScale));
+	hash = HashBytes(hash, &packet->upscaleFilter, sizeof(packet->upscaleFilter));
+
+	// NOTE(joon) : field by field, as the padding of the draw item is not guaranteed to be copied
+	for (u32 itemIndex = 0;
+		itemIndex < packet->drawItems.size();
+		++itemIndex)
+	{
+		draw_item *item = &packet->drawItems[itemIndex];
+		hash = HashBytes(hash, &item->type, sizeof(item->type));
+		hash = HashBytes(hash, &item->model, sizeof(item->model));
+		hash = HashBytes(hash, &item->matrices, sizeof(item->matrices));
+		hash = HashBytes(hash, &item->isTextured, sizeof(item->isTextured));
+		hash = HashBytes(hash, &item->color, sizeof(item->color));
+		hash = HashBytes(hash, &item->shouldDrawMeshlets, sizeof(item->shouldDrawMeshlets));
+		hash = HashBytes(hash, &item->bakedLightingSlot, sizeof(item->bakedLightingSlot));
+	}
+	hash = HashBytes(hash, packet->meshletCommands.data(), packet->meshletCommands.size()*sizeof(draw_elements_indirect_command));
+	hash = HashBytes(hash, packet->orbitLinePoints.data(), packet->orbitLinePoints.size()*sizeof(glm::vec3));
+
+	ImDrawData *drawData = &packet->imguiDrawData;
+	hash = HashBytes(hash, &drawData->DisplayPos, sizeof(drawData->DisplayPos));
+	hash = HashBytes(hash, &drawData->DisplaySize, sizeof(drawData->DisplaySize));
+	hash = HashBytes(hash, &drawData->FramebufferScale, sizeof(drawData->FramebufferScale));
+	for (int listIndex = 0;
+		listIndex < drawData->CmdListsCount;
+		++listIndex)
+	{
+		ImDrawList *drawList = drawData->CmdLists[listIndex];
+		hash = HashBytes(hash, drawList->VtxBuffer.Data, drawList->VtxBuffer.size_in_bytes());
+		hash = HashBytes(hash, drawList->IdxBuffer.Data, drawList->IdxBuffer.size_in_bytes());
+		for (int commandIndex = 0;
+			commandIndex < drawList->CmdBuffer.Size;
+			++commandIndex)
+		{
+			ImDrawCmd *command = &drawList->CmdBuffer[commandIndex];
+			hash = HashBytes(hash, &command->ClipRect, sizeof(command->ClipRect));
+			hash = HashBytes(hash, &command->TextureId, sizeof(command->TextureId));
+			hash = HashBytes(hash, &command->VtxOffset, sizeof(command->VtxOffset));
+			hash = HashBytes(hash, &command->IdxOffset, sizeof(command->IdxOffset));
+			hash = HashBytes(hash, &command->ElemCount, sizeof(command->ElemCount));
+		}
+	}
+
+	return hash;
+}
+
+static void
+BuildImGui(scene_state *scene, frame_packet *packet, build_frame_job_data *stats)
+{
+	per_frame_ubo *perFrameUbo = &scene->perFrameUbo;
+	per_object_ubo *perObjectUbo = &scene->perObjectUbo;
+	light *lights = scene->lights;
+
+	// NOTE(joon) : config imgui
+	ImGui::Begin("Options");
+	ImGui::Text("Preset");
+	const char* presets[3] = {"1", "2", "3"};
+	b32 isPresetSelected = ImGui::Combo("Preset", (int *)&scene->selectedPresetIndex, presets, ArrayCount(presets), 0);
+	ImGui::Separator();
+	ImGui::Text("Shaders");
+	// NOTE(joon) : The deferred shading comes last, so that the others keep their program slots
+	const char* shaderTypes[4] = {"Phong Shading", "Phong Lighting", "Blinn", "Deferred Phong Shading"};
+	i32 shaderTypeCount = stats->isDeferredShadingSupported ? ArrayCount(shaderTypes) : DEFERRED_SHADER_TYPE_INDEX;
+	ImGui::Combo("Shader Types", (int *)&scene->selectedProgramIndex, shaderTypes, shaderTypeCount, 0);
+	packet->shouldReloadShader = ImGui::Button("Reload", ImVec2(100, 0));
+	ImGui::Checkbox("Depth Pre-Pass", &scene->shouldDepthPrePass);
+	ImGui::Separator();
+	ImGui::Text("Texture Mapping");
+	const char* textureMappingTypes[] = {"Planar", "Cylindrical", "Spherical"};
+	ImGui::Combo("Texture Mapping Types", (int *)&perFrameUbo->textureMappingMethod, textureMappingTypes, ArrayCount(textureMappingTypes), 0);
+	const char* textureGenerateLocations[3] = {"CPU", "GPU", "GPU Compute(GPU only meshes)"};
+	ImGui::Combo("TexCoord Generate Location", (int *)&scene->selectedMappingLocationIndex, textureGenerateLocations, ArrayCount(textureGenerateLocations), 0);
+	const char* textureEntities[] = {"Position", "Normal"};
+	ImGui::Combo("Texture Entity", (int *)&perFrameUbo->shouldUseNormal, textureEntities, ArrayCount(textureEntities), 0);
+	ImGui::Separator();
+	ImGui::Text("Global Constants");
+	ImGui::SliderFloat3("Global Ambient", (float *)&perFrameUbo->globalAmbient, 0.0f, 1.0f, "%.5f", 0);
+	ImGui::SliderFloat3("IFog", (float *)&perFrameUbo->IFog, 0.0f, 1.0f, "%.5f", 0);
+	ImGui::SliderFloat("Fog Near", (float *)&perFrameUbo->zNear, 0.0f, 100.0f, "%.5f", 0);
+	ImGui::SliderFloat("Fog Far", (float *)&perFrameUbo->zFar, 0, 100.0f, "%.5f", 0);
+	ImGui::Separator();
+	ImGui::Text("Model");
+	const char* modelNames[] = {"4Sphere", "Bunny", "BunnyHighPoly", "Cube", "Cube2", "Cup", "Lucy", "Quad", "Rhino", "Sphere", "SphereModified", "StarWars", "Triangle"};
+	ImGui::Combo("Models", (int *)&scene->selectedModelIndex, modelNames, ArrayCount(modelNames), 0);
+	ImGui::SliderFloat3("IEmissive", (float *)&perObjectUbo->IEmissive, 0.0f, 1.0f, "%.5f", 0);
+	ImGui::SliderFloat("kAmbient", (float *)&perObjectUbo->kAmbient, 0.0f, 1.0f, "%.5f", 0);
+	ImGui::SliderFloat("kDiffuse", (float *)&perObjectUbo->kDiffuse, 0.0f, 1.0f, "%.5f", 0);
+	ImGui::SliderFloat("kSpecular", (float *)&perObjectUbo->kSpecular, 0.0f, 1.0f, "%.5f", 0);
+	//ImGui::SliderFloat("ns", (float *)&perObjectUbo->ns, 0.0f, 1.0f, "%.5f", 0);
+
+	ImGui::Checkbox("Vertex Normal", &scene->shouldDrawVertexNormal);
+	ImGui::Checkbox("Face Normal", &scene->shouldDrawFaceNormal);
+	ImGui::Checkbox("Rotate Model", &scene->shouldModelRotate);
+	ImGui::Separator();
+
+	model_registry *modelRegistry = scene->modelRegistry;
+	ImGui::Text("Model Residency");
+	int gpuBudgetInMB = (int)(modelRegistry->gpuBudget / (1024*1024));
+	if (ImGui::SliderInt("GPU Budget(MB)", &gpuBudgetInMB, 1, 512))
+	{
+		modelRegistry->gpuBudget = (u64)gpuBudgetInMB*1024*1024;
+	}
+	u64 totalCPUBytes = 0;
+	for (u32 modelIndex = 0;
+		modelIndex < modelRegistry->modelCount;
+		++modelIndex)
+	{
+		model_registry_entry *entry = modelRegistry->entries + modelIndex;
+		u32 residency = entry->residency.load(std::memory_order_acquire);
+		if (residency >= ModelResidency_Loaded && residency <= ModelResidency_Resident)
+		{
+			totalCPUBytes += entry->cpuBytes;
+			ImGui::Text("%-14s : %-9s CPU %.2fMB, GPU %.2fMB, %u uploads", modelNames[modelIndex], modelResidencyNames[residency],
+						entry->cpuBytes / (1024.0*1024.0), entry->gpuBytes / (1024.0*1024.0), entry->uploadCount);
+		}
+	}
+	ImGui::Text("CPU %.2fMB, GPU %.2fMB, %u evictions", totalCPUBytes / (1024.0*1024.0),
+				modelRegistry->gpuBytes / (1024.0*1024.0), modelRegistry->evictionCount);
+	ImGui::Separator();
+
+	ImGui::Text("Camera");
+	ImGui::SliderFloat("Orbit", (float *)&scene->camera.angle, 0.0f, Two_Pi32, "%.5f", 0);
+	ImGui::Separator();
+
+	ImGui::Text("Lights");
+	ImGui::SliderFloat("Radius", (float *)&scene->lightRadius, 2.0f, 8.0f, "%.5f", 0);
+	ImGui::Checkbox("Rotate", &scene->shouldLightRotate);
+	lighting_cache *lightingCache = &scene->lightingCache;
+	if (lightingCache->isSupported)
+	{
+		ImGui::Checkbox("Bake Ambient & Diffuse", &scene->shouldBakeLighting);
+		ImGui::Text("Bakes : %u full, %u incremental, last %.3fms(%u lights)", lightingCache->fullBakeCount,
+					lightingCache->incrementalBakeCount, lightingCache->lastBakeTime, lightingCache->lastBakedLightCount);
+	}
+	shadow_cache *shadowCache = &scene->shadowCache;
+	if (shadowCache->isSupported)
+	{
+		ImGui::Checkbox("Cast Shadows", &scene->shouldCastShadows);
+		// NOTE(joon) : Power of two, so that the tiles can be packed without any gap
+		const char* maxTileSizes[] = {"256", "512", "1024", "2048"};
+		int maxTileSizeIndex = 0;
+		while ((SHADOW_MIN_TILE_SIZE << (maxTileSizeIndex + 1)) < shadowCache->maxTileSize)
+		{
+			++maxTileSizeIndex;
+		}
+		if (ImGui::Combo("Max Shadow Tile", &maxTileSizeIndex, maxTileSizes, ArrayCount(maxTileSizes), 0))
+		{
+			shadowCache->maxTileSize = SHADOW_MIN_TILE_SIZE << (maxTileSizeIndex + 1);
+		}
+		ImGui::Text("Shadow views : %u static, %u composited of %u", shadowCache->staticViewCount,
+					shadowCache->compositedViewCount, shadowCache->totalViewCount);
+		ImGui::Text("Shadow atlas : %.1f%% used, GPU %.3fms", 100.0*shadowCache->usedAtlasTexelCount / ((r64)SHADOW_ATLAS_SIZE*SHADOW_ATLAS_SIZE),
+					stats->lastShadowGPUTime);
+	}
+	ImGui::Separator();
+	for (u32 lightIndex = 0;
+		lightIndex < ArrayCount(scene->lights);
+		++lightIndex)
+	{
+		ImGui::PushID(lightIndex);
+		light *light = lights + lightIndex;
+		ImGui::Text("Light %u", lightIndex);
+		ImGui::Checkbox("Enable", &light->isEnabled);
+
+		const char* lightTypes[3] = {"Point", "Directional", "SpotLight"};
+		ImGui::Combo("Light Types", (int *)&light->type, lightTypes, (int)ArrayCount(lightTypes), 0);
+
+		if (light->isEnabled)
+		{
+			ImGui::SliderFloat3("Ambient", (float *)&light->IAmbient, 0.0f, 1.0f, "%.5f", 0);
+			ImGui::SliderFloat3("Diffuse", (float *)&light->IDiffuse, 0.0f, 1.0f, "%.5f", 0);
+			ImGui::SliderFloat3("Specular", (float *)&light->ISpecular, 0.0f, 1.0f, "%.5f", 0);
+			ImGui::SliderFloat("C1", (float *)&light->c1, 0.0f, 1.0f, "%.5f", 0);
+			ImGui::SliderFloat("C2", (float *)&light->c2, 0.0f, 1.0f, "%.5f", 0);
+			ImGui::SliderFloat("C3", (float *)&light->c3, 0.0f, 1.0f, "%.5f", 0);
+
+			if (light->type == LightType_SpotLight)
+			{
+				ImGui::SliderFloat("Cos(Inner Cone Angle)", (float *)&light->innerConeAngleCos, 0.0f, 1.0f, "%.5f", 0);
+				ImGui::SliderFloat("Cos(Outer Cone Angle)", (float *)&light->outerConeAngleCos, 0.0f, 1.0f, "%.5f", 0);
+				ImGui::SliderFloat("FallOff", (float *)&light->fallOff, 0.0f, 10.0f, "%.5f", 0);
+
+				light->innerConeAngleCos = Clamp(light->outerConeAngleCos, light->innerConeAngleCos, 1.0f);
+				light->outerConeAngleCos = Clamp(0.0f, light->outerConeAngleCos, light->innerConeAngleCos);
+			}
+		}
+
+		ImGui::Spacing();
+		ImGui::Separator();
+		ImGui::PopID();
+	}
+
+	resolution_controller *resolutionController = &scene->resolutionController;
+	if (resolutionController->isSupported)
+	{
+		ImGui::Text("Dynamic Resolution");
+		ImGui::Checkbox("Scale Resolution", &scene->shouldScaleResolution);
+		ImGui::SliderFloat("Target Frame Time(ms)", &resolutionController->targetFrameTime, 2.0f, 50.0f, "%.2f", 0);
+		ImGui::SliderFloat("Min Scale", &resolutionController->minScale, DYNAMIC_RESOLUTION_MIN_SCALE, 1.0f, "%.2f", 0);
+		const char* upscaleFilters[] = {"Bilinear", "Catmull-Rom"};
+		ImGui::Combo("Upscale Filter", &scene->selectedUpscaleFilter, upscaleFilters, ArrayCount(upscaleFilters), 0);
+		ImGui::Text("Scale : %.2f, %u changes(see %s)", resolutionController->scale, resolutionController->scaleChangeCount,
+					DYNAMIC_RESOLUTION_LOG_FILE_NAME);
+		ImGui::Text("GPU frame : %.3fms", stats->lastFrameGPUTime);
+		ImGui::Separator();
+	}
+
+	if (stats->isFrameCaptureSupported)
+	{
+		ImGui::Text("Frame Capture");
+		// NOTE(joon) : The recording couldn't start, so the request is cleared instead of being retried
+		if (scene->seenFailedCaptureStartCount != stats->failedCaptureStartCount)
+		{
+			scene->shouldCaptureFrames = false;
+			scene->seenFailedCaptureStartCount = stats->failedCaptureStartCount;
+		}
+		ImGui::Checkbox("Record Frames", &scene->shouldCaptureFrames);
+		// NOTE(joon) : Only used when the recording starts
+		const char* captureFormats[] = {"PNG", "Y4M"};
+		ImGui::Combo("Capture Format", &scene->selectedCaptureFormat, captureFormats, ArrayCount(captureFormats), 0);
+		ImGui::Text("Captured : %llu, encoded : %llu, %llu stalls", (unsigned long long)stats->capturedFrameCount,
+					(unsigned long long)stats->encodedFrameCount, (unsigned long long)stats->captureStallCount);
+		ImGui::Text("Encode : %.3fms(into %s_*)", stats->lastCaptureEncodeTime, FRAME_CAPTURE_FILE_PREFIX);
+		ImGui::Separator();
+	}
+
+	job_system *jobSystem = scene->jobSystem;
+	ImGui::Text("Pipeline");
+	ImGui::Text("Frame build : %.3fms", stats->lastBuildTime);
+	ImGui::Text("Culled draws : %u", stats->lastCulledDrawCount);
+	ImGui::Checkbox("Occlusion Culling", &scene->shouldOcclusionCull);
+	ImGui::Text("Occluded draws : %u (%u occluder triangles)", stats->lastOccludedDrawCount, stats->lastOccluderTriangleCount);
+	ImGui::Text("Occlusion raster : %.3fms, test : %.3fms", stats->lastOcclusionRasterizeTime, stats->lastOcclusionTestTime);
+	if (stats->isMeshletCullingSupported)
+	{
+		ImGui::Checkbox("Meshlet Culling", &scene->shouldCullMeshlets);
+		r32 oneOverTriangleCount = stats->lastMeshletTriangleCount ? 100.0f / stats->lastMeshletTriangleCount : 0.0f;
+		ImGui::Text("Meshlet rejected : frustum %.1f%%, cone %.1f%% of %u triangles",
+					stats->lastFrustumCulledMeshletTriangleCount*oneOverTriangleCount,
+					stats->lastConeCulledMeshletTriangleCount*oneOverTriangleCount, stats->lastMeshletTriangleCount);
+		ImGui::Text("Meshlet cull : %.3fms, %u indirect draws", stats->lastMeshletCullTime, stats->lastMeshletCommandCount);
+	}
+	if (stats->isGPUCullingSupported)
+	{
+		ImGui::Checkbox("GPU Instances", &scene->shouldDrawInstances);
+		ImGui::SliderInt("Instance Grid", &scene->instanceGridSize, 8, 128);
+		ImGui::Checkbox("Hi-Z Culling", &scene->shouldHiZCullInstances);
+		ImGui::Text("GPU visible instances : %u / %u", stats->lastGPUVisibleInstanceCount,
+					scene->shouldDrawInstances ? (u32)(scene->instanceGridSize*scene->instanceGridSize) : 0);
+	}
+	if (stats->isStreamingUploadSupported)
+	{
+		ImGui::Checkbox("Streaming ImGui Upload", &scene->shouldStreamImGuiUpload);
+	}
+	ImGui::Checkbox("Known ImGui GL State", &scene->shouldUseKnownImGuiState);
+	ImGui::Checkbox("Render On Demand", &scene->shouldRenderOnDemand);
+	ImGui::Text("Skipped frames : %llu", (unsigned long long)stats->skippedFrameCount);
+	ImGui::Text("ImGui upload : %.2fKB", stats->lastImGuiUploadBytes / 1024.0);
+	ImGui::Separator();
+
+	ImGui::Text("Jobs");
+	bool shouldRecordJobTimings = jobSystem->shouldRecordTimings.load();
+	if (ImGui::Checkbox("Record Job Timings", &shouldRecordJobTimings))
+	{
+		jobSystem->shouldRecordTimings.store(shouldRecordJobTimings);
+	}
+	if (ImGui::Button("Export Job Timings", ImVec2(200, 0)))
+	{
+		// NOTE(joon) : Other workers might be still pushing their timings, so ask the main thread
+		// to do this after waiting for the build job
+		packet->shouldExportJobTimings = true;
+	}
+	ImGui::End();
+
+	if (isPresetSelected)
+	{
+		switch (scene->selectedPresetIndex)
+		{
+			case 0:
+			{
+				ConfigureLightPreset1(lights, ArrayCount(scene->lights));
+			}break;
+			case 1:
+			{
+				ConfigureLightPreset2(lights, ArrayCount(scene->lights));
+			}break;
+			case 2:
+			{
+				ConfigureLightPreset3(lights, ArrayCount(scene->lights));
+			}break;
+		}
+	}
+
+	// NOTE(joon) : Otherwise, the texcoords inside the vertex buffers are regenerated by the model registry when they don't match these
+	perFrameUbo->shouldGenerateTexCoordInGPU = (scene->selectedMappingLocationIndex == TextureMappingLocation_GPU);
+
+	packet->selectedProgramIndex = scene->selectedProgramIndex;
+	packet->textureMappingMethod = perFrameUbo->textureMappingMethod;
+	packet->shouldUseP = (perFrameUbo->shouldUseNormal != 1);
+}
+
+static void
+AddDrawItem(frame_packet *packet, draw_item_type type, model *model, transform *transform, glm::mat4 *viewProjection)
+{
+	draw_item item = {};
+	item.type = type;
+	item.model = model;
+	item.bakedLightingSlot = -1;
+	FillObjectMatrices(&item.matrices, transform, viewProjection);
+
+	packet->drawItems.push_back(item);
+}
+
+// NOTE(joon) : The lights can only be baked while they are not moving, and the mesh should be still on the CPU.
+// The slot is uploaded again by the packet whenever it was baked.
+static void
+UseBakedLighting(scene_state *scene, frame_packet *packet, draw_item *item, u32 slotIndex)
+{
+	lighting_cache *cache = &scene->lightingCache;
+	model *model = item->model;
+	// NOTE(joon) : The deferred lighting only reads the G-buffer, and the baked diffuse cannot be shadowed for each light
+	if (cache->isSupported && scene->shouldBakeLighting && !scene->shouldLightRotate &&
+		scene->selectedProgramIndex != DEFERRED_SHADER_TYPE_INDEX && !scene->shouldCastShadows &&
+		model->mesh.vertexBuffer.size() >= LIGHTING_CACHE_MIN_VERTEX_COUNT)
+	{
+		if (UpdateLightingCacheSlot(cache, slotIndex, scene->jobSystem, model, &item->matrices.model, &item->matrices.normal,
+									scene->lights, ArrayCount(scene->lights)))
+		{
+			packet->bakedLightingUploads[slotIndex] = cache->slots[slotIndex].bakedVertices;
+		}
+		item->bakedLightingSlot = (i32)slotIndex;
+	}
+}
+
+static b32
+HasBakedLightingUploads(frame_packet *packet)
+{
+	b32 result = false;
+	for (u32 slotIndex = 0;
+		slotIndex < LIGHTING_CACHE_SLOT_COUNT;
+		++slotIndex)
+	{
+		result |= !packet->bakedLightingUploads[slotIndex].empty();
+	}
+
+	return result;
+}
+
+struct shadow_caster_source
+{
+	struct model *model;
+	struct transform *transform;
+	b32 isStatic;
+};
+
+// NOTE(joon) : Returns the number of the casters that were added
+static u32
+AddShadowCasters(frame_packet *packet, shadow_caster_source *sources, u32 sourceCount,
+				glm::vec4 *frustumPlanes, glm::mat4 *viewProjection, b32 isStatic)
+{
+	u32 result = 0;
+	for (u32 sourceIndex = 0;
+		sourceIndex < sourceCount;
+		++sourceIndex)
+	{
+		shadow_caster_source *source = sources + sourceIndex;
+		if (source->isStatic == isStatic &&
+			IsTransformInsideFrustum(frustumPlanes, source->transform, source->model->boundingRadius))
+		{
+			shadow_caster caster = {};
+			caster.model = source->model;
+			FillObjectMatrices(&caster.matrices, source->transform, viewProjection);
+			packet->shadowCasters.push_back(caster);
+			++result;
+		}
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Updates the shadow cache, and adds a pass for each view that has anything to change.
+// The casters of each view are frustum culled against the view of the light.
+static void
+BuildShadowPasses(scene_state *scene, frame_packet *packet, shadow_caster_source *sources, u32 sourceCount, glm::vec3 cameraP)
+{
+	shadow_cache *cache = &scene->shadowCache;
+	cache->staticViewCount = 0;
+	cache->compositedViewCount = 0;
+	packet->shadowUbo = {};
+	packet->shouldCastShadows = cache->isSupported && scene->shouldCastShadows;
+	if (!packet->shouldCastShadows)
+	{
+		cache->totalViewCount = 0;
+		cache->usedAtlasTexelCount = 0;
+		return;
+	}
+
+	u64 staticCasterHash = FNV_OFFSET_BASIS_64;
+	for (u32 sourceIndex = 0;
+		sourceIndex < sourceCount;
+		++sourceIndex)
+	{
+		shadow_caster_source *source = sources + sourceIndex;
+		if (source->isStatic)
+		{
+			staticCasterHash = HashBytes(staticCasterHash, &source->model, sizeof(source->model));
+			staticCasterHash = HashBytes(staticCasterHash, &source->transform->world, sizeof(source->transform->world));
+		}
+	}
+
+	b32 shouldRenderStatic[ArrayCount(scene->lights)];
+	UpdateShadowCache(cache, scene->lights, ArrayCount(scene->lights), cameraP, scene->camera.fovInDegree,
+					staticCasterHash, &packet->shadowUbo, shouldRenderStatic);
+
+	for (u32 lightIndex = 0;
+		lightIndex < ArrayCount(scene->lights);
+		++lightIndex)
+	{
+		shadow_light_cache *lightCache = cache->lights + lightIndex;
+		for (u32 viewIndex = 0;
+			viewIndex < lightCache->viewCount;
+			++viewIndex)
+		{
+			glm::mat4 *viewProjection = lightCache->viewProjections + viewIndex;
+			glm::vec4 frustumPlanes[6];
+			ExtractFrustumPlanes(viewProjection, frustumPlanes);
+
+			shadow_pass pass = {};
+			pass.rect = glm::ivec4(lightCache->tileOrigins[viewIndex], lightCache->tileSize, lightCache->tileSize);
+			pass.shouldRenderStatic = shouldRenderStatic[lightIndex];
+			pass.firstCaster = (u32)packet->shadowCasters.size();
+			// NOTE(joon) : The static ones first, then the dynamic ones
+			if (pass.shouldRenderStatic)
+			{
+				pass.staticCasterCount = AddShadowCasters(packet, sources, sourceCount, frustumPlanes, viewProjection, true);
+			}
+			pass.dynamicCasterCount = AddShadowCasters(packet, sources, sourceCount, frustumPlanes, viewProjection, false);
+
+			// NOTE(joon) : The dynamic casters of the last time are still inside the final atlas,
+			// so the view should be composited again once more after they are gone
+			b32 hasDynamicCasters = (pass.dynamicCasterCount != 0);
+			if (pass.shouldRenderStatic || hasDynamicCasters || lightCache->hasDynamicCasters[viewIndex])
+			{
+				packet->shadowPasses.push_back(pass);
+				cache->staticViewCount += pass.shouldRenderStatic ? 1 : 0;
+				++cache->compositedViewCount;
+			}
+			lightCache->hasDynamicCasters[viewIndex] = hasDynamicCasters;
+		}
+	}
+}
+
+// NOTE(joon) : The default scene that we start with
+static void
+InitializeScene(scene_state *scene, model_registry *modelRegistry, model *sphereModel, job_system *jobSystem,
+				int windowWidth, int windowHeight)
+{
+	scene->windowWidth = windowWidth;
+	scene->windowHeight = windowHeight;
+	scene->modelRegistry = modelRegistry;
+	scene->sphereModel = sphereModel;
+	scene->jobSystem = jobSystem;
+
+	camera *camera = &scene->camera;
+	camera->initP = { 13, 6, 0 };
+	camera->angle = 0.0f;
+	camera->lookAtP = { 0, 0, 0 };
+	camera->up = { 0, 1, 0 };
+	camera->fovInDegree = 45.0f;
+	camera->near = 0.1f;
+	camera->far = 100.0f;
+
+	// Initialize the lights
+	scene->lightRadius = 4.0f;
+	light *lights = scene->lights;
+	for (u32 lightIndex = 0;
+		lightIndex < ArrayCount(scene->lights);
+		++lightIndex)
+	{
+		light *light = lights + lightIndex;
+		light->angle = (Two_Pi32 / ArrayCount(scene->lights)) * lightIndex;
+
+		light->IAmbient = glm::vec3(0.8f, 0.8f, 0.8f);
+		light->IDiffuse = glm::vec3(0.8f, 0.8f, 0.8f);
+		light->ISpecular = glm::vec3(1.0f, 1.0f, 1.0f);
+
+		light->c1 = 0.2f;
+		light->c2 = 0.04f;
+		light->c3 = 0.015f;
+
+		// spotlight only
+		light->innerConeAngleCos = 0.9f;
+		light->outerConeAngleCos = 0.7f;
+		light->fallOff = 0.13f;
+	}
+	ConfigureLightPreset1(lights, ArrayCount(scene->lights));
+
+	scene->shouldDrawVertexNormal = false;
+	scene->shouldDrawFaceNormal = false;
+	scene->shouldLightRotate = true;
+	scene->shouldUseKnownImGuiState = true;
+	scene->shouldRenderOnDemand = true;
+	scene->shouldOcclusionCull = true;
+	scene->shouldDrawInstances = false;
+	scene->shouldHiZCullInstances = true;
+	scene->shouldCullMeshlets = true;
+	scene->shouldBakeLighting = true;
+	scene->shouldDepthPrePass = false;
+	scene->shouldCastShadows = false;
+	scene->shouldModelRotate = false;
+	scene->modelAngle = 0.0f;
+	scene->shadowCache.maxTileSize = 1024;
+	scene->shouldScaleResolution = true;
+	scene->selectedUpscaleFilter = UpscaleFilter_CatmullRom;
+	InitializeResolutionController(&scene->resolutionController);
+	scene->shouldCaptureFrames = false;
+	scene->selectedCaptureFormat = FrameCaptureFormat_PNG;
+	scene->seenFailedCaptureStartCount = 0;
+	scene->instanceGridSize = 64;
+	scene->wasHiZBuilt = false;
+	InitializeOcclusionBuffer(&scene->occlusionBuffer, OCCLUSION_BUFFER_WIDTH, OCCLUSION_BUFFER_HEIGHT);
+	scene->selectedProgramIndex = 0;
+
+	// imgui texture options
+	scene->selectedMappingLocationIndex = TextureMappingLocation_CPU;
+	scene->selectedPresetIndex = 0;
+	scene->selectedModelIndex = 0;
+
+	per_frame_ubo *perFrameUbo = &scene->perFrameUbo;
+	perFrameUbo->IFog = glm::vec3(0.2f, 0.5f, 0.7f);
+	perFrameUbo->zNear = 0.1f;
+	perFrameUbo->zFar = 20.0f;
+	perFrameUbo->shouldGenerateTexCoordInGPU = false;
+	perFrameUbo->textureMappingMethod = TextureMappingMethod_Planar;
+
+	per_object_ubo *perObjectUbo = &scene->perObjectUbo;
+	perObjectUbo->kAmbient = 0.2f;
+	perObjectUbo->kDiffuse = 0.6f;
+	perObjectUbo->kSpecular = 0.9f;
+	perObjectUbo->ns = 10;
+
+	// NOTE(joon) : Every object that we draw has its own cached transform,
+	// and only the dirty ones get recomputed each frame.
+	scene->transforms.resize(SceneTransform_LightStart + ArrayCount(scene->lights));
+	SetTransform(&scene->transforms[SceneTransform_Floor], glm::vec3(7, 7, 7), glm::vec3(-Pi32/2.0f, 0, 0), glm::vec3(0, -2, 0));
+	SetTransform(&scene->transforms[SceneTransform_Model], glm::vec3(2, 2, 2), glm::vec3(0, 0, 0), glm::vec3(0, 0, 0));
+	SetTransform(&scene->transforms[SceneTransform_Debug], glm::vec3(1, 1, 1), glm::vec3(0, 0, 0), glm::vec3(0, 0, 0));
+}
+
+// NOTE(joon) : Grid of small spheres covering the floor
+static void
+GenerateFloorInstances(scene_state *scene, u32 gridSize)
+{
+	Assert(gridSize*gridSize <= MAX_GPU_INSTANCE_COUNT);
+	scene->instances.resize(gridSize*gridSize);
+
+	r32 extent = 6.0f;
+	r32 spacing = 2.0f*extent / gridSize;
+	r32 scale = Minimum(0.6f*spacing, 0.5f);
+	for (u32 z = 0;
+		z < gridSize;
+		++z)
+	{
+		for (u32 x = 0;
+			x < gridSize;
+			++x)
+		{
+			glm::vec3 p = glm::vec3(-extent + (x + 0.5f)*spacing, 0.0f, -extent + (z + 0.5f)*spacing);
+			p.y = -2.0f + scene->sphereModel->boundingRadius*scale;
+			glm::vec3 color = glm::vec3((r32)x / gridSize, 0.5f, (r32)z / gridSize);
+			FillGPUInstance(&scene->instances[z*gridSize + x], scene->sphereModel, p, scale, color);
+		}
+	}
+}
+
+// NOTE(joon) : Runs on a worker, should not touch any GL state!
+static void
+BuildFrame(scene_state *scene, frame_packet *packet, build_frame_job_data *stats)
+{
+	packet->drawItems.clear();
+	packet->orbitLinePoints.clear();
+	packet->culledDrawCount = 0;
+	packet->shouldExportJobTimings = false;
+	packet->meshletCommands.clear();
+	packet->meshletTriangleCount = 0;
+	packet->frustumCulledMeshletTriangleCount = 0;
+	packet->coneCulledMeshletTriangleCount = 0;
+	packet->meshletCullTime = 0.0;
+	packet->shadowPasses.clear();
+	packet->shadowCasters.clear();
+	for (u32 slotIndex = 0;
+		slotIndex < LIGHTING_CACHE_SLOT_COUNT;
+		++slotIndex)
+	{
+		packet->bakedLightingUploads[slotIndex].clear();
+	}
+	ClearModelResidencyChanges(&packet->residencyChanges);
+
+	BuildImGui(scene, packet, stats);
+	packet->shouldStreamImGuiUpload = scene->shouldStreamImGuiUpload;
+	packet->shouldUseKnownImGuiState = scene->shouldUseKnownImGuiState;
+	packet->shouldRenderOnDemand = scene->shouldRenderOnDemand;
+	packet->shouldDepthPrePass = scene->shouldDepthPrePass;
+
+	// NOTE(joon) : The GPU time comes from a frame that was rendered a few packets ago
+	resolution_controller *resolutionController = &scene->resolutionController;
+	packet->shouldScaleResolution = resolutionController->isSupported && scene->shouldScaleResolution;
+	UpdateResolutionController(resolutionController, &stats->frameGPUTime, packet->shouldScaleResolution, packet->frameIndex);
+	packet->renderScale = resolutionController->scale;
+	packet->upscaleFilter = scene->selectedUpscaleFilter;
+	packet->shouldCaptureFrames = stats->isFrameCaptureSupported && scene->shouldCaptureFrames;
+	packet->captureFormat = scene->selectedCaptureFormat;
+
+	// NOTE(joon) : GPU instances are static, so they only get uploaded when the count changes
+	packet->shouldDrawInstances = scene->shouldDrawInstances;
+	packet->shouldHiZCullInstances = scene->shouldDrawInstances && scene->shouldHiZCullInstances;
+	packet->shouldUseHiZ = packet->shouldHiZCullInstances && scene->wasHiZBuilt;
+	packet->instances.clear();
+	if (scene->shouldDrawInstances)
+	{
+		u32 gridSize = (u32)scene->instanceGridSize;
+		if (scene->instances.size() != gridSize*gridSize)
+		{
+			GenerateFloorInstances(scene, gridSize);
+			packet->instances = scene->instances;
+		}
+		packet->instanceCount = (u32)scene->instances.size();
+	}
+	else
+	{
+		packet->instanceCount = 0;
+	}
+	scene->wasHiZBuilt = packet->shouldHiZCullInstances;
+
+	// NOTE(joon) : simulation
+	for (u32 lightIndex = 0;
+		lightIndex < ArrayCount(scene->lights);
+		++lightIndex)
+	{
+		light* light = scene->lights + lightIndex;
+
+		if (scene->shouldLightRotate)
+		{
+			light->angle += 0.015f;
+		}
+		light->p = scene->lightRadius * glm::vec3(cos(light->angle), 0, sin(light->angle));
+
+		SetTransform(&scene->transforms[SceneTransform_LightStart + lightIndex],
+					glm::vec3(0.5f, 0.5f, 0.5f), glm::vec3(0, 0, 0), light->p);
+	}
+	if (scene->shouldModelRotate)
+	{
+		scene->modelAngle += 0.01f;
+		SetTransform(&scene->transforms[SceneTransform_Model], glm::vec3(2, 2, 2), glm::vec3(0, scene->modelAngle, 0), glm::vec3(0, 0, 0));
+	}
+
+	camera *camera = &scene->camera;
+	per_frame_ubo *perFrameUbo = &scene->perFrameUbo;
+	glm::vec3 cameraP = glm::vec3(glm::rotate(camera->angle, glm::vec3(0, 1, 0)) * glm::vec4(camera->initP, 1.0f));
+	perFrameUbo->view = glm::lookAt(cameraP, camera->lookAtP, camera->up);
+	perFrameUbo->projection = glm::perspective(glm::radians(camera->fovInDegree), scene->windowWidth / (float)scene->windowHeight, camera->near, camera->far);
+	perFrameUbo->cameraP = cameraP;
+	perFrameUbo->cameraDir = glm::normalize(cameraP - glm::vec3(0, 0, 0));
+	for (u32 lightIndex = 0;
+		lightIndex < ArrayCount(scene->lights);
+		++lightIndex)
+	{
+		perFrameUbo->lights[lightIndex] = scene->lights[lightIndex];
+	}
+
+	glm::mat4 viewProjection;
+	MultiplyMatrix4x4(&viewProjection, &perFrameUbo->projection, &perFrameUbo->view);
+
+	UpdateTransforms(scene->transforms.data(), (u32)scene->transforms.size());
+
+	// NOTE(joon) : culling & recording the draws
+	glm::vec4 frustumPlanes[6];
+	ExtractFrustumPlanes(&viewProjection, frustumPlanes);
+
+	// NOTE(joon) : The floor is loaded with the startup assets, so it's simply not drawn until it's resident.
+	// The selected model is drawn as the sphere instead.
+	model_residency_changes *residencyChanges = &packet->residencyChanges;
+	BeginModelRequests(scene->modelRegistry, packet->frameIndex, packet->textureMappingMethod, packet->shouldUseP,
+					scene->selectedMappingLocationIndex);
+	model *residentFloorModel = RequestModel(scene->modelRegistry, residencyChanges, ModelType_quad);
+	model *residentModel = RequestModel(scene->modelRegistry, residencyChanges, scene->selectedModelIndex);
+	model *floorModel = residentFloorModel ? residentFloorModel : scene->sphereModel;
+	model *selectedModel = residentModel ? residentModel : scene->sphereModel;
+	EvictModels(scene->modelRegistry, residencyChanges);
+	ReleaseCPUMeshes(scene->modelRegistry);
+	packet->isWaitingForModels = !residentFloorModel || !residentModel;
+
+	transform *floorTransform = &scene->transforms[SceneTransform_Floor];
+	transform *modelTransform = &scene->transforms[SceneTransform_Model];
+
+	b32 isFloorVisible = residentFloorModel && IsTransformInsideFrustum(frustumPlanes, floorTransform, floorModel->boundingRadius);
+	b32 isModelVisible = IsTransformInsideFrustum(frustumPlanes, modelTransform, selectedModel->boundingRadius);
+	b32 isLightVisible[ArrayCount(scene->lights)];
+	for (u32 lightIndex = 0;
+		lightIndex < ArrayCount(scene->lights);
+		++lightIndex)
+	{
+		isLightVisible[lightIndex] = false;
+		if (scene->lights[lightIndex].isEnabled)
+		{
+			isLightVisible[lightIndex] = IsTransformInsideFrustum(frustumPlanes, &scene->transforms[SceneTransform_LightStart + lightIndex],
+																scene->sphereModel->boundingRadius);
+			packet->culledDrawCount += isLightVisible[lightIndex] ? 0 : 1;
+		}
+	}
+	packet->culledDrawCount += (isFloorVisible ? 0 : 1) + (isModelVisible ? 0 : 1);
+
+	// NOTE(joon) : The casters are not culled by the camera, as they can be still casting shadows into the view.
+	// The light spheres & the GPU instances don't cast shadows.
+	shadow_caster_source shadowCasterSources[2];
+	u32 shadowCasterSourceCount = 0;
+	if (residentFloorModel)
+	{
+		shadowCasterSources[shadowCasterSourceCount++] = {floorModel, floorTransform, true};
+	}
+	shadowCasterSources[shadowCasterSourceCount++] = {selectedModel, modelTransform, !scene->shouldModelRotate};
+	BuildShadowPasses(scene, packet, shadowCasterSources, shadowCasterSourceCount, cameraP);
+
+	// NOTE(joon) : Whatever survived the frustum culling is tested against the floor & the model.
+	// Occluders also test against themselves, which is fine as the test is conservative.
+	packet->occludedDrawCount = 0;
+	packet->occluderTriangleCount = 0;
+	packet->occlusionRasterizeTime = 0.0;
+	packet->occlusionTestTime = 0.0;
+	if (scene->shouldOcclusionCull)
+	{
+		occlusion_buffer *occlusionBuffer = &scene->occlusionBuffer;
+		BeginOcclusionFrame(occlusionBuffer, &viewProjection);
+		if (isFloorVisible)
+		{
+			AddOccluder(occlusionBuffer, &floorModel->mesh, &floorTransform->world);
+		}
+		if (isModelVisible)
+		{
+			// NOTE(joon) : Too detailed models are skipped by the triangle budget
+			AddOccluder(occlusionBuffer, &selectedModel->mesh, &modelTransform->world);
+		}
+		RasterizeOccluders(occlusionBuffer, scene->jobSystem);
+
+		occludee occludees[2 + ArrayCount(scene->lights)] = {};
+		occludees[0] = {floorModel->boundsMin, floorModel->boundsMax, &floorTransform->world, false};
+		occludees[1] = {selectedModel->boundsMin, selectedModel->boundsMax, &modelTransform->world, false};
+		for (u32 lightIndex = 0;
+			lightIndex < ArrayCount(scene->lights);
+			++lightIndex)
+		{
+			occludees[2 + lightIndex] = {scene->sphereModel->boundsMin, scene->sphereModel->boundsMax,
+										&scene->transforms[SceneTransform_LightStart + lightIndex].world, false};
+		}
+		TestOccludees(occlusionBuffer, scene->jobSystem, occludees, ArrayCount(occludees));
+
+		b32 *isVisible[ArrayCount(occludees)] = {&isFloorVisible, &isModelVisible};
+		for (u32 lightIndex = 0;
+			lightIndex < ArrayCount(scene->lights);
+			++lightIndex)
+		{
+			isVisible[2 + lightIndex] = isLightVisible + lightIndex;
+		}
+		for (u32 occludeeIndex = 0;
+			occludeeIndex < ArrayCount(occludees);
+			++occludeeIndex)
+		{
+			if (*isVisible[occludeeIndex] && occludees[occludeeIndex].isOccluded)
+			{
+				*isVisible[occludeeIndex] = false;
+				++packet->occludedDrawCount;
+			}
+		}
+
+		packet->occluderTriangleCount = occlusionBuffer->occluderTriangleCount;
+		packet->occlusionRasterizeTime = occlusionBuffer->setupTime + occlusionBuffer->rasterizeTime;
+		packet->occlusionTestTime = occlusionBuffer->testTime;
+	}
+
+	if (isFloorVisible)
+	{
+		AddDrawItem(packet, DrawItemType_Model, floorModel, floorTransform, &viewProjection);
+		UseBakedLighting(scene, packet, &packet->drawItems.back(), 0);
+	}
+	if (isModelVisible)
+	{
+		AddDrawItem(packet, DrawItemType_Model, selectedModel, modelTransform, &viewProjection);
+		packet->drawItems.back().isTextured = (residentModel != 0);
+		UseBakedLighting(scene, packet, &packet->drawItems.back(), 1);
+	}
+
+	// NOTE(joon) : Parts of the big models can be still rejected even when the model itself is visible
+	if (scene->shouldCullMeshlets)
+	{
+		std::chrono::steady_clock::time_point meshletCullStart = std::chrono::steady_clock::now();
+		for (u32 itemIndex = 0;
+			itemIndex < packet->drawItems.size();
+			++itemIndex)
+		{
+			if (packet->drawItems[itemIndex].type == DrawItemType_Model)
+			{
+				CullDrawItemMeshlets(scene, packet, &packet->drawItems[itemIndex]);
+			}
+		}
+		std::chrono::duration<r64, std::milli> meshletCullTime = std::chrono::steady_clock::now() - meshletCullStart;
+		packet->meshletCullTime = meshletCullTime.count();
+	}
+
+	transform *debugTransform = &scene->transforms[SceneTransform_Debug];
+	if (scene->shouldDrawFaceNormal && residentModel)
+	{
+		AddDrawItem(packet, DrawItemType_FaceNormal, selectedModel, debugTransform, &viewProjection);
+	}
+	if (scene->shouldDrawVertexNormal && residentModel)
+	{
+		AddDrawItem(packet, DrawItemType_VertexNormal, selectedModel, debugTransform, &viewProjection);
+	}
+
+	// NOTE(joon) : draw orbital line!
+	u32 lineDensity = 1000;
+	float angleForEachLine = Two_Pi32 / (r32)lineDensity;
+	for (u32 lineIndex = 0;
+		lineIndex < lineDensity;
+		++lineIndex)
+	{
+		glm::vec3 start = {};
+		start.x = scene->lightRadius * cos(lineIndex * angleForEachLine);
+		start.y = 0;
+		start.z = scene->lightRadius * sin(lineIndex * angleForEachLine);
+
+		glm::vec3 end = {};
+		end.x = scene->lightRadius * cos((lineIndex+1) * angleForEachLine);
+		end.y = 0.0f;
+		end.z = scene->lightRadius * sin((lineIndex+1) * angleForEachLine);
+
+		packet->orbitLinePoints.push_back(start);
+		packet->orbitLinePoints.push_back(end);
+	}
+	AddDrawItem(packet, DrawItemType_OrbitLine, 0, debugTransform, &viewProjection);
+
+	for (u32 lightIndex = 0;
+		lightIndex < ArrayCount(scene->lights);
+		++lightIndex)
+	{
+		light *light = scene->lights + lightIndex;
+		transform *lightTransform = &scene->transforms[SceneTransform_LightStart + lightIndex];
+
+		if (isLightVisible[lightIndex])
+		{
+			AddDrawItem(packet, DrawItemType_LightSphere, scene->sphereModel, lightTransform, &viewProjection);
+			packet->drawItems.back().color = light->IDiffuse;
+		}
+	}
+
+	packet->perFrameUbo = scene->perFrameUbo;
+	packet->perObjectUbo = scene->perObjectUbo;
+
+	ImGui::Render();
+	CopyImGuiDrawData(packet, ImGui::GetDrawData());
+
+	packet->contentHash = HashFramePacket(packet);
+}
+
+static void
+BuildFrameJob(void *data, u32 start, u32 onePastEnd)
+{
+	build_frame_job_data *jobData = (build_frame_job_data *)data;
+
+	std::chrono::steady_clock::time_point buildStart = std::chrono::steady_clock::now();
+	BuildFrame(jobData->scene, jobData->packet, jobData);
+	std::chrono::duration<r64, std::milli> buildTime = std::chrono::steady_clock::now() - buildStart;
+
+	jobData->packet->buildTime = buildTime.count();
+}
+
+struct record_draw_items_job_data
+{
+	render_context *context;
+	frame_packet *packet;
+
+	// NOTE(joon) : each batch records into its own command buffer
+	command_buffer *commandBuffers;
+	u32 batchSize;
+
+	b32 isDeferred; // the models were already drawn into the G-buffer
+	b32 shouldSkipModels; // the models were already drawn, either by the deferred shading or after the depth pre-pass
+};
+
+// NOTE(joon) : Expects one of the lighting programs(or the geometry program of the deferred shading) to be in use
+static void
+RecordModelDrawItem(command_buffer *commandBuffer, render_context *context, frame_packet *packet, draw_item *item)
+{
+	per_object_ubo ubo = packet->perObjectUbo;
+	if (item->bakedLightingSlot >= 0)
+	{
+		ubo.hasBakedLighting = true;
+		PushBindBakedLighting(commandBuffer, context->bakedLightingTextureIDs[item->bakedLightingSlot]);
+	}
+	GLuint diffuseTextureID = item->isTextured ? context->diffuseTextureID : 0;
+	GLuint specularTextureID = item->isTextured ? context->specularTextureID : 0;
+	if (item->shouldDrawMeshlets && context->meshletIndirectBufferID)
+	{
+		RenderModelMeshlets(commandBuffer, item->model, &item->matrices, context->perObjectUboID, &ubo, sizeof(ubo),
+							diffuseTextureID, specularTextureID,
+							context->meshletIndirectBufferID, item->firstMeshletCommand, item->meshletCommandCount);
+	}
+	else
+	{
+		RenderModel(commandBuffer, item->model, &item->matrices, context->perObjectUboID, &ubo, sizeof(ubo),
+					diffuseTextureID, specularTextureID);
+	}
+}
+
+static void
+RecordDrawItemsJob(void *data, u32 start, u32 onePastEnd)
+{
+	record_draw_items_job_data *jobData = (record_draw_items_job_data *)data;
+	render_context *context = jobData->context;
+	frame_packet *packet = jobData->packet;
+
+	command_buffer *commandBuffer = jobData->commandBuffers + (start / jobData->batchSize);
+	ResetCommandBuffer(commandBuffer);
+
+	// NOTE(joon) : With the deferred shading, the orbit line is still drawn with the phong shading
+	u32 lightingProgramSlot = ProgramSlot_Lighting;
+	if (!jobData->isDeferred)
+	{
+		lightingProgramSlot += packet->selectedProgramIndex;
+	}
+	u32 currentProgramSlot = ProgramSlot_Count;
+	for (u32 itemIndex = start;
+		itemIndex < onePastEnd;
+		++itemIndex)
+	{
+		draw_item *item = packet->drawItems.data() + itemIndex;
+		if (jobData->shouldSkipModels && item->type == DrawItemType_Model)
+		{
+			continue;
+		}
+
+		// NOTE(joon) : Each buffer can be executed after any other buffer, so it cannot
+		// rely on the program that was used by the previous buffer
+		u32 programSlot = lightingProgramSlot;
+		if (item->type == DrawItemType_LightSphere)
+		{
+			programSlot = ProgramSlot_Plain;
+		}
+		else if (item->type == DrawItemType_FaceNormal || item->type == DrawItemType_VertexNormal)
+		{
+			if (!context->canDrawNormalLines)
+			{
+				continue;
+			}
+			programSlot = ProgramSlot_NormalLine;
+		}
+		if (programSlot != currentProgramSlot)
+		{
+			PushUseProgram(commandBuffer, programSlot);
+			currentProgramSlot = programSlot;
+		}
+
+		switch (item->type)
+		{
+			case DrawItemType_Model:
+			{
+				RecordModelDrawItem(commandBuffer, context, packet, item);
+			}break;
+
+			case DrawItemType_FaceNormal:
+			{
+				RenderFaceNormal(commandBuffer, item->model, &item->matrices, context->perObjectUboID);
+			}break;
+
+			case DrawItemType_VertexNormal:
+			{
+				RenderVertexNormal(commandBuffer, item->model, &item->matrices, context->perObjectUboID);
+			}break;
+
+			case DrawItemType_OrbitLine:
+			{
+				RenderLines(commandBuffer, packet->orbitLinePoints.data(), (u32)packet->orbitLinePoints.size(),
+							context->lineVertexArrayID, context->lineVertexBufferID,
+							&item->matrices, context->perObjectUboID);
+			}break;
+
+			case DrawItemType_LightSphere:
+			{
+				plain_per_object_ubo ubo = {};
+				ubo.color = item->color;
+				RenderModel(commandBuffer, item->model, &item->matrices, context->perObjectUboID, &ubo, sizeof(ubo), 0, 0);
+			}break;
+		}
+	}
+}
+
+// NOTE(joon) : Records the packet into the command buffers, which should have MAX_COMMAND_BUFFER_PER_FRAME buffers.
+// Returns the number of the command buffers that were used, and they should be executed in that order.
+// The first buffer is recorded by the calling thread, the draw items are recorded in parallel
+// and the imgui comes at the last.
+static u32
+RecordFramePacket(render_context *context, frame_packet *packet, command_buffer *commandBuffers)
+{
+	u32 commandBufferCount = 0;
+
+	command_buffer *frameCommandBuffer = commandBuffers + commandBufferCount++;
+	ResetCommandBuffer(frameCommandBuffer);
+
+	b32 isDeferred = (packet->selectedProgramIndex == DEFERRED_SHADER_TYPE_INDEX) && context->deferredShading;
+
+	// NOTE(joon) : The frame timer wraps everything, including the shadow passes & the imgui, as that's what the target is for
+	dynamic_resolution *dynamicResolution = context->dynamicResolution;
+	b32 shouldScaleResolution = packet->shouldScaleResolution && dynamicResolution;
+	if (dynamicResolution)
+	{
+		PushBeginFrameTimer(frameCommandBuffer, dynamicResolution, shouldScaleResolution ? packet->renderScale : 1.0f);
+	}
+
+	// NOTE(joon) : The programs of the deferred shading are not inside the program slots, so they cannot be reloaded
+	if (packet->shouldReloadShader && !isDeferred)
+	{
+		i32 programIndex = packet->selectedProgramIndex;
+		PushReloadProgram(frameCommandBuffer, ProgramSlot_Lighting + programIndex,
+						context->vertexShaderPaths[programIndex], context->fragmentShaderPaths[programIndex]);
+	}
+
+	RecordModelResidencyChanges(frameCommandBuffer, &packet->residencyChanges);
+
+	for (u32 slotIndex = 0;
+		slotIndex < LIGHTING_CACHE_SLOT_COUNT;
+		++slotIndex)
+	{
+		std::vector<baked_vertex_lighting> *upload = packet->bakedLightingUploads + slotIndex;
+		if (!upload->empty())
+		{
+			// NOTE(joon) : Also goes through the GL_ARRAY_BUFFER, the texture only refers to the buffer
+			PushUpdateVertexBuffer(frameCommandBuffer, context->bakedLightingBufferIDs[slotIndex], upload->data(),
+								(u32)(upload->size()*sizeof(baked_vertex_lighting)));
+		}
+	}
+
+	// NOTE(joon) : The shadow views change the framebuffer & the viewport, so they come before anything else
+	shadow_maps *shadowMaps = context->shadowMaps;
+	if (shadowMaps)
+	{
+		if (packet->shadowPasses.size())
+		{
+			PushSetRenderState(frameCommandBuffer, true, true);
+			PushBeginShadowPasses(frameCommandBuffer, shadowMaps);
+			PushUseProgram(frameCommandBuffer, ProgramSlot_DepthOnly);
+			for (u32 passIndex = 0;
+				passIndex < packet->shadowPasses.size();
+				++passIndex)
+			{
+				shadow_pass *pass = packet->shadowPasses.data() + passIndex;
+				shadow_caster *casters = packet->shadowCasters.data() + pass->firstCaster;
+				if (pass->shouldRenderStatic)
+				{
+					PushBeginShadowView(frameCommandBuffer, shadowMaps, pass->rect, true, true);
+					for (u32 casterIndex = 0;
+						casterIndex < pass->staticCasterCount;
+						++casterIndex)
+					{
+						shadow_caster *caster = casters + casterIndex;
+						RenderModelDepthOnly(frameCommandBuffer, caster->model, &caster->matrices, context->perObjectUboID);
+					}
+				}
+
+				PushCopyShadowView(frameCommandBuffer, shadowMaps, pass->rect);
+				if (pass->dynamicCasterCount)
+				{
+					PushBeginShadowView(frameCommandBuffer, shadowMaps, pass->rect, false, false);
+					for (u32 casterIndex = pass->staticCasterCount;
+						casterIndex < pass->staticCasterCount + pass->dynamicCasterCount;
+						++casterIndex)
+					{
+						shadow_caster *caster = casters + casterIndex;
+						RenderModelDepthOnly(frameCommandBuffer, caster->model, &caster->matrices, context->perObjectUboID);
+					}
+				}
+			}
+			PushEndShadowPasses(frameCommandBuffer, shadowMaps);
+		}
+		PushBindShadowAtlas(frameCommandBuffer, shadowMaps->atlasTextureID);
+	}
+	PushUpdateUniformBuffer(frameCommandBuffer, context->shadowUboID, SHADOW_UBO_BINDING, &packet->shadowUbo, sizeof(shadow_ubo));
+
+	int displayWidth;
+	int displayHeight;
+	glfwGetFramebufferSize(context->window, &displayWidth, &displayHeight);
+
+	// NOTE(joon) : Everything until the imgui is drawn into the lower left part of the scene target,
+	// so every pass that cares about the size of the screen should use the render size instead of the display size
+	i32 renderWidth = displayWidth;
+	i32 renderHeight = displayHeight;
+	GLuint sceneFramebufferID = 0;
+	// NOTE(joon) : The framebuffer is empty while the window is minimized
+	shouldScaleResolution = shouldScaleResolution && displayWidth > 0 && displayHeight > 0;
+	if (shouldScaleResolution)
+	{
+		renderWidth = Maximum((i32)(displayWidth*packet->renderScale + 0.5f), 1);
+		renderHeight = Maximum((i32)(displayHeight*packet->renderScale + 0.5f), 1);
+		sceneFramebufferID = dynamicResolution->framebufferID;
+		PushBeginSceneTarget(frameCommandBuffer, dynamicResolution, displayWidth, displayHeight);
+	}
+
+	per_frame_ubo *perFrameUbo = &packet->perFrameUbo;
+	PushClear(frameCommandBuffer, glm::vec4(perFrameUbo->IFog, 1.0f));
+	PushSetRenderState(frameCommandBuffer, true, true);
+	PushSetViewport(frameCommandBuffer, 0, 0, renderWidth, renderHeight);
+
+	// update per frame uniform buffer
+	PushUpdateUniformBuffer(frameCommandBuffer, context->perFrameUboID, 0, perFrameUbo, sizeof(per_frame_ubo));
+
+	if (packet->meshletCommands.size() && context->meshletIndirectBufferID)
+	{
+		// NOTE(joon) : Any buffer can be uploaded through the GL_ARRAY_BUFFER
+		PushUpdateVertexBuffer(frameCommandBuffer, context->meshletIndirectBufferID, packet->meshletCommands.data(),
+							(u32)(packet->meshletCommands.size()*sizeof(draw_elements_indirect_command)));
+	}
+
+	if (packet->shouldDrawInstances && context->gpuCulling)
+	{
+		if (packet->instances.size())
+		{
+			PushUpdateVertexBuffer(frameCommandBuffer, context->gpuCulling->instanceBufferID,
+								packet->instances.data(), (u32)(packet->instances.size()*sizeof(gpu_instance)));
+		}
+		PushCullInstances(frameCommandBuffer, context->gpuCulling, packet->instanceCount, packet->shouldUseHiZ);
+		PushUseProgram(frameCommandBuffer, ProgramSlot_Instanced);
+		PushDrawInstancesIndirect(frameCommandBuffer, context->gpuCulling, packet->instanceCount);
+	}
+
+	// NOTE(joon) : The models are drawn into the G-buffer and lit before anything else is drawn forward,
+	// which is still depth tested against them because the lighting pass also writes the depth
+	b32 shouldDepthPrePass = packet->shouldDepthPrePass && !isDeferred;
+	if (isDeferred)
+	{
+		PushBeginGBuffer(frameCommandBuffer, context->deferredShading, renderWidth, renderHeight);
+		for (u32 itemIndex = 0;
+			itemIndex < packet->drawItems.size();
+			++itemIndex)
+		{
+			draw_item *item = packet->drawItems.data() + itemIndex;
+			if (item->type == DrawItemType_Model)
+			{
+				RecordModelDrawItem(frameCommandBuffer, context, packet, item);
+			}
+		}
+
+		// NOTE(joon) : The lighting pass reads the material from the per object ubo
+		PushUpdateUniformBuffer(frameCommandBuffer, context->perObjectUboID, 1, &packet->perObjectUbo, sizeof(per_object_ubo));
+
+		glm::mat4 viewProjection;
+		MultiplyMatrix4x4(&viewProjection, &perFrameUbo->projection, &perFrameUbo->view);
+		glm::mat4 inverseProjection = glm::inverse(perFrameUbo->projection);
+		glm::mat4 inverseViewProjection = glm::inverse(viewProjection);
+		PushShadeDeferred(frameCommandBuffer, context->deferredShading, sceneFramebufferID, &inverseProjection, &inverseViewProjection);
+	}
+	else if (shouldDepthPrePass)
+	{
+		// NOTE(joon) : Only the positions are fetched to lay down the nearest depth of the models first,
+		// so that the lighting program only runs once for each pixel that ends up being visible.
+		// The models are recorded here(instead of the parallel jobs) because the two passes should not be interleaved.
+		PushUseProgram(frameCommandBuffer, ProgramSlot_DepthOnly);
+		PushSetDepthState(frameCommandBuffer, GL_LESS, true, false);
+		for (u32 itemIndex = 0;
+			itemIndex < packet->drawItems.size();
+			++itemIndex)
+		{
+			draw_item *item = packet->drawItems.data() + itemIndex;
+			if (item->type == DrawItemType_Model)
+			{
+				if (item->shouldDrawMeshlets && context->meshletIndirectBufferID)
+				{
+					RenderModelMeshletsDepthOnly(frameCommandBuffer, item->model, &item->matrices, context->perObjectUboID,
+												context->meshletIndirectBufferID, item->firstMeshletCommand, item->meshletCommandCount);
+				}
+				else
+				{
+					RenderModelDepthOnly(frameCommandBuffer, item->model, &item->matrices, context->perObjectUboID);
+				}
+			}
+		}
+
+		// NOTE(joon) : The depth is already there, so only the fragments that are exactly at that depth are shaded.
+		// This relies on the lighting vertex shaders computing the same gl_Position(see invariant inside the shaders)
+		PushSetDepthState(frameCommandBuffer, GL_EQUAL, false, true);
+		PushUseProgram(frameCommandBuffer, ProgramSlot_Lighting + packet->selectedProgramIndex);
+		for (u32 itemIndex = 0;
+			itemIndex < packet->drawItems.size();
+			++itemIndex)
+		{
+			draw_item *item = packet->drawItems.data() + itemIndex;
+			if (item->type == DrawItemType_Model)
+			{
+				RecordModelDrawItem(frameCommandBuffer, context, packet, item);
+			}
+		}
+		PushSetDepthState(frameCommandBuffer, GL_LESS, true, true);
+	}
+
+	u32 drawItemCount = (u32)packet->drawItems.size();
+	if (drawItemCount)
+	{
+		// NOTE(joon) : one buffer for the frame setup, one for the imgui
+		u32 maxBatchCount = MAX_COMMAND_BUFFER_PER_FRAME - 2;
+
+		record_draw_items_job_data jobData = {};
+		jobData.context = context;
+		jobData.packet = packet;
+		jobData.commandBuffers = commandBuffers + commandBufferCount;
+		jobData.isDeferred = isDeferred;
+		jobData.shouldSkipModels = isDeferred || shouldDepthPrePass;
+		jobData.batchSize = GetParallelForBatchSize(context->jobSystem, drawItemCount, 16);
+		jobData.batchSize = Maximum(jobData.batchSize, (drawItemCount + maxBatchCount - 1) / maxBatchCount);
+
+		job *recordJob = CreateParallelForJob(context->jobSystem, RecordDrawItemsJob, &jobData, "RecordDrawItems", drawItemCount, 16);
+		recordJob->batchSize = jobData.batchSize;
+		SubmitJob(context->jobSystem, recordJob);
+		WaitForJob(context->jobSystem, recordJob);
+
+		commandBufferCount += (drawItemCount + jobData.batchSize - 1) / jobData.batchSize;
+	}
+
+	command_buffer *imguiCommandBuffer = commandBuffers + commandBufferCount++;
+	ResetCommandBuffer(imguiCommandBuffer);
+	if (packet->shouldHiZCullInstances && context->gpuCulling)
+	{
+		// NOTE(joon) : every draw that writes the depth is done at this point
+		glm::mat4 viewProjection;
+		MultiplyMatrix4x4(&viewProjection, &perFrameUbo->projection, &perFrameUbo->view);
+		PushBuildHiZ(imguiCommandBuffer, context->gpuCulling, renderWidth, renderHeight, &viewProjection);
+	}
+	if (shouldScaleResolution)
+	{
+		PushResolveSceneTarget(imguiCommandBuffer, dynamicResolution, renderWidth, renderHeight,
+							displayWidth, displayHeight, packet->upscaleFilter);
+	}
+	PushRenderImGui(imguiCommandBuffer, &packet->imguiDrawData, packet->shouldStreamImGuiUpload, packet->shouldUseKnownImGuiState);
+	if (dynamicResolution)
+	{
+		PushEndFrameTimer(imguiCommandBuffer, dynamicResolution);
+	}
+	// NOTE(joon) : Outside of the frame timer, the dynamic resolution shouldn't lower the scale because of the readback
+	if (context->frameCapture)
+	{
+		PushCaptureFrame(imguiCommandBuffer, context->frameCapture, packet->shouldCaptureFrames, packet->captureFormat,
+						displayWidth, displayHeight);
+	}
+
+	return commandBufferCount;
+}
+
+// NOTE(joon) : The default scene & the packets built from it, without a window or any GL call.
+// The imgui still runs without any backend, as the build stage expects it.
+struct headless_scene
+{
+	model_registry modelRegistry;
+	model sphereModel;
+
+	scene_state scene;
+	frame_packet packet;
+	build_frame_job_data buildFrameJobData;
+};
+
+static void
+InitializeHeadlessScene(headless_scene *headless, job_system *jobSystem, int width, int height)
+{
+	InitializeModelRegistry(&headless->modelRegistry, jobSystem, 0, false);
+	LoadAllRegistryModels(&headless->modelRegistry);
+
+	GenerateSphereModel(&headless->sphereModel, 0.5f, 72, 24);
+	headless->sphereModel.boundingRadius = GetBoundingRadius(&headless->sphereModel.mesh);
+	GetBoundingBox(&headless->sphereModel.mesh, &headless->sphereModel.boundsMin, &headless->sphereModel.boundsMax);
+
+	InitializeScene(&headless->scene, &headless->modelRegistry, &headless->sphereModel, jobSystem, width, height);
+
+	IMGUI_CHECKVERSION();
+	ImGui::CreateContext();
+	ImGuiIO &io = ImGui::GetIO();
+	io.DisplaySize = ImVec2((r32)width, (r32)height);
+	unsigned char *fontPixels;
+	int fontWidth;
+	int fontHeight;
+	io.Fonts->GetTexDataAsRGBA32(&fontPixels, &fontWidth, &fontHeight);
+
+	headless->buildFrameJobData.scene = &headless->scene;
+	headless->buildFrameJobData.packet = &headless->packet;
+}
+
+static frame_packet *
+BuildHeadlessFrame(headless_scene *headless)
+{
+	ImGui::NewFrame();
+	++headless->packet.frameIndex;
+	BuildFrameJob(&headless->buildFrameJobData, 0, 0);
+
+	return &headless->packet;
+}
+
+static void
+FreeHeadlessScene(headless_scene *headless)
+{
+	for (int listIndex = 0;
+		listIndex < headless->packet.imguiDrawLists.Size;
+		++listIndex)
+	{
+		IM_DELETE(headless->packet.imguiDrawLists[listIndex]);
+	}
+	headless->packet.imguiDrawLists.clear();
+	ImGui::DestroyContext();
+
+	FreeOcclusionBuffer(&headless->scene.occlusionBuffer);
+	FreeModelRegistry(&headless->modelRegistry);
+}
@@ -0,0 +1,278 @@
+#ifndef FRAME_PIPELINE_H
+#define FRAME_PIPELINE_H
+
+// NOTE(joon) : The main loop is split into two stages.
+// While the frame N is recorded & executed by the render thread, a worker is building the frame N+1
+// (simulation, culling, imgui) into a frame packet. The packets are the only thing that
+// the two stages share.
+
+#define FRAME_PACKET_COUNT 3
+#define MAX_COMMAND_BUFFER_PER_FRAME 64
+
+// NOTE(joon) : When rendering on demand, the packets that look exactly like the last submitted one are not submitted.
+// After this many of them in a row, the main thread sleeps until there's an event (or the timeout, for the imgui timers like the tooltips).
+// imgui sometimes needs a couple of frames to settle, which is why this is not 1.
+#define ON_DEMAND_STATIC_FRAME_COUNT 3
+#define ON_DEMAND_WAIT_TIMEOUT 0.5 // in seconds
+
+// NOTE(joon) : The stats shown in the imgui are only refreshed this often and only after a submitted frame,
+// otherwise the stats themselves would keep changing the imgui and the frame would never be static
+#define PIPELINE_STATS_REFRESH_INTERVAL 0.5 // in seconds
+
+enum scene_transform_index
+{
+	SceneTransform_Floor,
+	SceneTransform_Model,
+	SceneTransform_Debug, // normals & orbital line
+	SceneTransform_LightStart,
+};
+
+// NOTE(joon) : Everything that the simulation & the imgui can modify.
+// Only touched by the build stage.
+struct scene_state
+{
+	struct camera camera;
+
+	r32 lightRadius;
+	light lights[16];
+	r32 modelAngle;
+
+	std::vector<transform> transforms;
+
+	per_frame_ubo perFrameUbo;
+	per_object_ubo perObjectUbo;
+
+	bool shouldDrawVertexNormal;
+	bool shouldDrawFaceNormal;
+	bool shouldLightRotate;
+	bool shouldStreamImGuiUpload;
+	bool shouldUseKnownImGuiState;
+	bool shouldRenderOnDemand;
+	bool shouldOcclusionCull;
+	bool shouldDrawInstances;
+	bool shouldHiZCullInstances;
+	bool shouldCullMeshlets;
+	bool shouldBakeLighting;
+	bool shouldDepthPrePass;
+	bool shouldCastShadows;
+	bool shouldModelRotate; // makes the model a dynamic shadow caster
+	bool shouldScaleResolution;
+	bool shouldCaptureFrames;
+	i32 selectedProgramIndex;
+	int selectedUpscaleFilter; // see upscale_filter
+	int selectedCaptureFormat; // see frame_capture_format
+	u32 seenFailedCaptureStartCount;
+
+	int selectedMappingLocationIndex;
+	int selectedPresetIndex;
+	int selectedModelIndex;
+
+	int windowWidth;
+	int windowHeight;
+
+	// NOTE(joon) : The models are requested from here every frame, so the build stage is the only one that touches it
+	model_registry *modelRegistry;
+	model *sphereModel; // also the placeholder of the models that are not resident yet
+
+	// NOTE(joon) : Only used by the build job, so it doesn't need to be per packet
+	occlusion_buffer occlusionBuffer;
+	std::vector<u8> meshletCullResults; // see meshlet_cull_result
+	lighting_cache lightingCache;
+	shadow_cache shadowCache;
+	resolution_controller resolutionController;
+
+	// NOTE(joon) : instanceGridSize^2 instances on the floor, culled & drawn by the GPU
+	int instanceGridSize;
+	std::vector<gpu_instance> instances;
+	b32 wasHiZBuilt; // by the last packet, so the next one can use it
+
+	job_system *jobSystem;
+};
+
+// NOTE(joon) : The shader type after the three lighting programs, see deferred_shading.h
+#define DEFERRED_SHADER_TYPE_INDEX 3
+
+// NOTE(joon) : Programs inside the render thread
+enum program_slot
+{
+	ProgramSlot_Plain,
+	ProgramSlot_Lighting, // + selectedProgramIndex, except the deferred shading which has its own programs
+	ProgramSlot_Instanced = ProgramSlot_Lighting + 3,
+	ProgramSlot_NormalLine,
+	ProgramSlot_DepthOnly,
+	ProgramSlot_Count,
+};
+
+enum draw_item_type
+{
+	DrawItemType_Model,
+	DrawItemType_FaceNormal,
+	DrawItemType_VertexNormal,
+	DrawItemType_OrbitLine,
+	DrawItemType_LightSphere, // uses the plain program instead of the lighting program
+};
+
+struct draw_item
+{
+	draw_item_type type;
+
+	struct model *model;
+	object_matrices matrices;
+
+	b32 isTextured;
+	glm::vec3 color; // only for the light sphere
+	i32 bakedLightingSlot; // -1 when the lights are not baked, see lighting_cache.h
+
+	// NOTE(joon) : When the meshlets were culled, only these commands inside frame_packet::meshletCommands are drawn
+	b32 shouldDrawMeshlets;
+	u32 firstMeshletCommand;
+	u32 meshletCommandCount;
+};
+
+struct frame_packet
+{
+	u64 frameIndex;
+
+	per_frame_ubo perFrameUbo;
+	per_object_ubo perObjectUbo;
+
+	std::vector<draw_item> drawItems;
+	std::vector<glm::vec3> orbitLinePoints; // pairs of start & end
+	u32 culledDrawCount;
+	u32 occludedDrawCount;
+
+	// NOTE(joon) : occlusion culling stats, not a part of the content hash
+	u32 occluderTriangleCount;
+	r64 occlusionRasterizeTime; // in ms, including the triangle setup
+	r64 occlusionTestTime; // in ms
+
+	// NOTE(joon) : One command for each run of the visible meshlets that are next to each other inside the index buffer
+	std::vector<draw_elements_indirect_command> meshletCommands;
+	u32 meshletTriangleCount; // of the draws that were meshlet culled
+	u32 frustumCulledMeshletTriangleCount;
+	u32 coneCulledMeshletTriangleCount;
+	r64 meshletCullTime; // in ms
+
+	// NOTE(joon) : Copy of the lighting cache slots that were baked by this packet, empty if the slot didn't change
+	std::vector<baked_vertex_lighting> bakedLightingUploads[LIGHTING_CACHE_SLOT_COUNT];
+
+	// NOTE(joon) : Only the shadow views that have anything to change are rendered, see shadow_maps.h
+	b32 shouldCastShadows;
+	shadow_ubo shadowUbo;
+	std::vector<shadow_pass> shadowPasses;
+	std::vector<shadow_caster> shadowCasters;
+
+	// NOTE(joon) : Requests that should be handled while recording
+	b32 shouldReloadShader;
+	i32 selectedProgramIndex;
+	b32 shouldDepthPrePass; // only for the forward lighting programs, doesn't change the pixels
+	b32 shouldScaleResolution; // the scene goes into the scene target, and gets upscaled before the imgui
+	r32 renderScale; // of the width & the height, 1 when the resolution is not scaled
+	i32 upscaleFilter;
+	b32 shouldCaptureFrames; // every frame is submitted while this is on, even the ones that didn't change
+	i32 captureFormat;
+	int textureMappingMethod;
+	b32 shouldUseP;
+	model_residency_changes residencyChanges; // should be recorded before the draws
+	b32 isWaitingForModels; // a requested model was drawn as the placeholder
+	b32 shouldExportJobTimings; // should be done after the build job is finished
+	b32 shouldStreamImGuiUpload;
+	b32 shouldUseKnownImGuiState;
+	b32 shouldRenderOnDemand;
+
+	b32 shouldDrawInstances;
+	b32 shouldHiZCullInstances; // also builds the hi-z for the next frame
+	b32 shouldUseHiZ; // false when the last packet didn't build the hi-z
+	u32 instanceCount;
+	std::vector<gpu_instance> instances; // only filled when they should be uploaded
+
+	r64 buildTime; // in ms
+	u64 contentHash; // used to skip the frame if nothing has changed
+
+	// NOTE(joon) : The packet & its command buffers should not be touched until this render frame is executed
+	b32 isSubmitted;
+	u64 renderFrameNumber;
+
+	// NOTE(joon) : imgui context will be used to build the next frame while this one is submitted,
+	// so the draw lists are copied here
+	ImDrawData imguiDrawData;
+	ImVector<ImDrawList *> imguiDrawLists;
+};
+
+// NOTE(joon) : Everything that the main thread needs to record the frame packet.
+// These are only the IDs, the GL objects are owned by the render thread.
+struct render_context
+{
+	job_system *jobSystem;
+
+	model *sphereModel;
+
+	const char **vertexShaderPaths;
+	const char **fragmentShaderPaths;
+
+	GLuint perFrameUboID;
+	GLuint perObjectUboID;
+
+	GLuint lineVertexArrayID;
+	GLuint lineVertexBufferID;
+
+	GLuint diffuseTextureID;
+	GLuint specularTextureID;
+	i32 textureWidth;
+	i32 textureHeight;
+
+	gpu_culling *gpuCulling; // 0 when it's not supported
+	deferred_shading *deferredShading; // 0 when it's not supported
+	GLuint meshletIndirectBufferID; // 0 when the indirect draw is not supported
+	b32 canDrawNormalLines; // the normal line shader reads the model buffers as shader storage buffers
+	// NOTE(joon) : Buffer textures that hold the baked lighting of each lighting cache slot, 0 when it's not supported
+	GLuint bakedLightingBufferIDs[LIGHTING_CACHE_SLOT_COUNT];
+	GLuint bakedLightingTextureIDs[LIGHTING_CACHE_SLOT_COUNT];
+	shadow_maps *shadowMaps; // 0 when it's not supported
+	GLuint shadowUboID; // always bound, so that the lighting programs see no shadows without the shadow maps
+	dynamic_resolution *dynamicResolution; // 0 when it's not supported
+	frame_capture *frameCapture; // 0 when it's not supported
+
+	GLFWwindow *window;
+};
+
+struct build_frame_job_data
+{
+	scene_state *scene;
+	frame_packet *packet;
+
+	// NOTE(joon) : stats from the previous builds, shown in the imgui and
+	// refreshed by the main thread every PIPELINE_STATS_REFRESH_INTERVAL
+	r64 lastBuildTime;
+	u32 lastCulledDrawCount;
+	u32 lastOccludedDrawCount;
+	u32 lastOccluderTriangleCount;
+	r64 lastOcclusionRasterizeTime;
+	r64 lastOcclusionTestTime;
+	u32 lastMeshletTriangleCount;
+	u32 lastFrustumCulledMeshletTriangleCount;
+	u32 lastConeCulledMeshletTriangleCount;
+	u32 lastMeshletCommandCount;
+	r64 lastMeshletCullTime;
+	u64 skippedFrameCount;
+	u64 lastImGuiUploadBytes; // copied from the render thread by the main thread
+	u32 lastGPUVisibleInstanceCount; // copied from the render thread by the main thread
+	r64 lastShadowGPUTime; // copied from the render thread by the main thread
+	r64 lastFrameGPUTime; // copied from the render thread by the main thread
+	// NOTE(joon) : Copied from the render thread by the main thread after every build(not only when the stats are refreshed),
+	// as the dynamic resolution should see every sample
+	frame_gpu_time frameGPUTime;
+	// NOTE(joon) : Copied from the frame capture by the main thread, with the rest of the stats
+	u64 capturedFrameCount;
+	u64 encodedFrameCount;
+	u64 captureStallCount;
+	r64 lastCaptureEncodeTime;
+	u32 failedCaptureStartCount;
+	b32 isStreamingUploadSupported;
+	b32 isGPUCullingSupported;
+	b32 isMeshletCullingSupported;
+	b32 isDeferredShadingSupported;
+	b32 isFrameCaptureSupported;
+};
+
+#endif
@@ -0,0 +1,942 @@
+// NOTE(joon) : glTF 2.0 loader, for both the .gltf(json + .bin or data uri buffers) and the .glb(json & binary chunk in one file).
+// Every triangle primitive of the default scene is merged into a single mesh, with the node transforms applied.
+// Every accessor type & layout goes through the same conversion, which is split across the job system.
+// The model is normalized like the other loaders after that, so that it fits inside [-1, 1].
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#define GLTF_COMPONENT_BYTE 5120
+#define GLTF_COMPONENT_UNSIGNED_BYTE 5121
+#define GLTF_COMPONENT_SHORT 5122
+#define GLTF_COMPONENT_UNSIGNED_SHORT 5123
+#define GLTF_COMPONENT_UNSIGNED_INT 5125
+#define GLTF_COMPONENT_FLOAT 5126
+
+#define GLTF_MODE_TRIANGLES 4
+
+#define GLB_MAGIC 0x46546c67 // glTF
+#define GLB_CHUNK_JSON 0x4e4f534a
+#define GLB_CHUNK_BIN 0x004e4942
+
+enum json_type
+{
+	JSONType_Null,
+	JSONType_Bool,
+	JSONType_Number,
+	JSONType_String,
+	JSONType_Array,
+	JSONType_Object,
+};
+
+// NOTE(joon) : Just enough json for the gltf, members of an object are the children with the key
+struct json_value
+{
+	json_type type;
+	r64 number; // 1 or 0 for the bools
+	std::string string;
+
+	std::string key;
+	std::vector<json_value> children;
+};
+
+static void
+SkipJSONWhitespace(char **at, char *end)
+{
+	while (*at < end && (**at == ' ' || **at == '\t' || **at == '\n' || **at == '\r'))
+	{
+		++*at;
+	}
+}
+
+static b32
+ParseJSONString(char **at, char *end, std::string *result)
+{
+	if (*at >= end || **at != '"')
+	{
+		return false;
+	}
+	++*at;
+
+	while (*at < end && **at != '"')
+	{
+		char c = **at;
+		++*at;
+		if (c == '\\' && *at < end)
+		{
+			c = **at;
+			++*at;
+			switch (c)
+			{
+				case 'b': c = '\b'; break;
+				case 'f': c = '\f'; break;
+				case 'n': c = '\n'; break;
+				case 'r': c = '\r'; break;
+				case 't': c = '\t'; break;
+				case 'u':
+				{
+					// NOTE(joon) : None of the names that we look for has these, so they are not decoded
+					*at = Minimum(*at + 4, end);
+					c = '?';
+				}break;
+				default: break; // '"', '\\' and '/' are just themselves
+			}
+		}
+		result->push_back(c);
+	}
+
+	if (*at >= end)
+	{
+		return false;
+	}
+	++*at;
+
+	return true;
+}
+
+static b32
+ParseJSONValue(char **at, char *end, json_value *value, u32 depth)
+{
+	// NOTE(joon) : Only to not overflow the stack with the broken files, gltf doesn't go anywhere near this
+	if (depth > 64)
+	{
+		return false;
+	}
+
+	SkipJSONWhitespace(at, end);
+	if (*at >= end)
+	{
+		return false;
+	}
+
+	b32 result = true;
+	char c = **at;
+	if (c == '{' || c == '[')
+	{
+		b32 isObject = (c == '{');
+		char closing = isObject ? '}' : ']';
+		value->type = isObject ? JSONType_Object : JSONType_Array;
+		++*at;
+
+		SkipJSONWhitespace(at, end);
+		if (*at < end && **at == closing)
+		{
+			++*at;
+			return true;
+		}
+
+		for (;;)
+		{
+			json_value child = {};
+			if (isObject)
+			{
+				SkipJSONWhitespace(at, end);
+				if (!ParseJSONString(at, end, &child.key))
+				{
+					return false;
+				}
+				SkipJSONWhitespace(at, end);
+				if (*at >= end || **at != ':')
+				{
+					return false;
+				}
+				++*at;
+			}
+
+			if (!ParseJSONValue(at, end, &child, depth + 1))
+			{
+				return false;
+			}
+			value->children.push_back(std::move(child));
+
+			SkipJSONWhitespace(at, end);
+			if (*at < end && **at == ',')
+			{
+				++*at;
+			}
+			else if (*at < end && **at == closing)
+			{
+				++*at;
+				break;
+			}
+			else
+			{
+				return false;
+			}
+		}
+	}
+	else if (c == '"')
+	{
+		value->type = JSONType_String;
+		result = ParseJSONString(at, end, &value->string);
+	}
+	else if (end - *at >= 4 && strncmp(*at, "true", 4) == 0)
+	{
+		value->type = JSONType_Bool;
+		value->number = 1.0;
+		*at += 4;
+	}
+	else if (end - *at >= 5 && strncmp(*at, "false", 5) == 0)
+	{
+		value->type = JSONType_Bool;
+		*at += 5;
+	}
+	else if (end - *at >= 4 && strncmp(*at, "null", 4) == 0)
+	{
+		value->type = JSONType_Null;
+		*at += 4;
+	}
+	else
+	{
+		// NOTE(joon) : The json is null terminated when it's read, so strtod can't go past the end
+		char *numberEnd = *at;
+		value->type = JSONType_Number;
+		value->number = strtod(*at, &numberEnd);
+		result = (numberEnd != *at);
+		*at = numberEnd;
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Returns 0 if the value is not an object or doesn't have the member
+static json_value *
+GetJSONMember(json_value *value, const char *key)
+{
+	json_value *result = 0;
+	if (value && value->type == JSONType_Object)
+	{
+		for (u32 childIndex = 0;
+			childIndex < value->children.size();
+			++childIndex)
+		{
+			if (value->children[childIndex].key == key)
+			{
+				result = value->children.data() + childIndex;
+				break;
+			}
+		}
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Returns 0 if the value is not an array or the index is out of range
+static json_value *
+GetJSONElement(json_value *value, i64 index)
+{
+	json_value *result = 0;
+	if (value && value->type == JSONType_Array && index >= 0 && (u64)index < value->children.size())
+	{
+		result = value->children.data() + index;
+	}
+
+	return result;
+}
+
+static r64
+GetJSONNumber(json_value *value, const char *key, r64 defaultValue)
+{
+	json_value *member = GetJSONMember(value, key);
+	r64 result = (member && member->type == JSONType_Number) ? member->number : defaultValue;
+
+	return result;
+}
+
+struct gltf_buffer
+{
+	u8 *data;
+	size_t size;
+};
+
+struct gltf_file
+{
+	json_value root;
+
+	std::vector<gltf_buffer> buffers;
+	std::vector<asset_file> bufferFiles; // .bin files, the glb binary chunk stays inside the glb
+	std::vector<std::vector<u8>> externalBuffers; // data uris
+};
+
+static void
+CloseGLTFFile(gltf_file *file)
+{
+	for (u32 bufferIndex = 0;
+		bufferIndex < file->bufferFiles.size();
+		++bufferIndex)
+	{
+		CloseAssetFile(file->bufferFiles.data() + bufferIndex);
+	}
+}
+
+// NOTE(joon) : Points to the first element of the accessor, every element is validated to be inside the buffer
+struct gltf_accessor
+{
+	u8 *data;
+	u32 count;
+	u32 stride; // in bytes
+
+	u32 componentType;
+	u32 componentCount;
+	b32 isNormalized;
+};
+
+static u32
+GetGLTFComponentSize(u32 componentType)
+{
+	u32 result = 0;
+	switch (componentType)
+	{
+		case GLTF_COMPONENT_BYTE:
+		case GLTF_COMPONENT_UNSIGNED_BYTE:
+		{
+			result = 1;
+		}break;
+		case GLTF_COMPONENT_SHORT:
+		case GLTF_COMPONENT_UNSIGNED_SHORT:
+		{
+			result = 2;
+		}break;
+		case GLTF_COMPONENT_UNSIGNED_INT:
+		case GLTF_COMPONENT_FLOAT:
+		{
+			result = 4;
+		}break;
+	}
+
+	return result;
+}
+
+static u32
+GetGLTFComponentCount(json_value *type)
+{
+	u32 result = 0;
+	if (type && type->type == JSONType_String)
+	{
+		if (type->string == "SCALAR")
+		{
+			result = 1;
+		}
+		else if (type->string == "VEC2")
+		{
+			result = 2;
+		}
+		else if (type->string == "VEC3")
+		{
+			result = 3;
+		}
+		else if (type->string == "VEC4")
+		{
+			result = 4;
+		}
+	}
+
+	return result;
+}
+
+static b32
+DecodeBase64(const char *at, const char *end, std::vector<u8> *result)
+{
+	u32 bits = 0;
+	u32 bitCount = 0;
+	while (at < end && *at != '=')
+	{
+		char c = *at++;
+		u32 value;
+		if (c >= 'A' && c <= 'Z')
+		{
+			value = c - 'A';
+		}
+		else if (c >= 'a' && c <= 'z')
+		{
+			value = c - 'a' + 26;
+		}
+		else if (c >= '0' && c <= '9')
+		{
+			value = c - '0' + 52;
+		}
+		else if (c == '+')
+		{
+			value = 62;
+		}
+		else if (c == '/')
+		{
+			value = 63;
+		}
+		else
+		{
+			return false;
+		}
+
+		bits = (bits << 6) | value;
+		bitCount += 6;
+		if (bitCount >= 8)
+		{
+			bitCount -= 8;
+			result->push_back((u8)(bits >> bitCount));
+		}
+	}
+
+	return true;
+}
+
+static b32
+LoadGLTFBuffers(gltf_file *file, const char *fileName, u8 *binaryChunk, size_t binaryChunkSize)
+{
+	json_value *buffers = GetJSONMember(&file->root, "buffers");
+	u32 bufferCount = buffers ? (u32)buffers->children.size() : 0;
+	file->buffers.resize(bufferCount);
+	file->externalBuffers.resize(bufferCount);
+	file->bufferFiles.resize(bufferCount);
+
+	std::string directory = fileName;
+	size_t directoryEnd = directory.find_last_of("/\\");
+	directory = (directoryEnd == std::string::npos) ? "" : directory.substr(0, directoryEnd + 1);
+
+	for (u32 bufferIndex = 0;
+		bufferIndex < bufferCount;
+		++bufferIndex)
+	{
+		json_value *buffer = GetJSONElement(buffers, bufferIndex);
+		size_t byteLength = (size_t)GetJSONNumber(buffer, "byteLength", 0);
+		json_value *uri = GetJSONMember(buffer, "uri");
+
+		gltf_buffer *result = file->buffers.data() + bufferIndex;
+		std::vector<u8> *storage = file->externalBuffers.data() + bufferIndex;
+		u8 *data = 0;
+		size_t size = 0;
+		if (!uri)
+		{
+			// NOTE(joon) : Only the first buffer of the glb can be without the uri
+			if (bufferIndex != 0 || !binaryChunk || binaryChunkSize < byteLength)
+			{
+				printf("%s has a buffer without the data!\n", fileName);
+				return false;
+			}
+			result->data = binaryChunk;
+			result->size = byteLength;
+			continue;
+		}
+
+		if (uri->string.compare(0, 5, "data:") == 0)
+		{
+			size_t dataStart = uri->string.find(";base64,");
+			if (dataStart == std::string::npos ||
+				!DecodeBase64(uri->string.data() + dataStart + 8, uri->string.data() + uri->string.size(), storage))
+			{
+				printf("%s has a data uri that is not base64!\n", fileName);
+				return false;
+			}
+			data = storage->data();
+			size = storage->size();
+		}
+		else
+		{
+			std::string path = directory + uri->string;
+			asset_file *bufferFile = file->bufferFiles.data() + bufferIndex;
+			if (!ReadAssetFile(path.c_str(), bufferFile))
+			{
+				printf("Failed to open %s\n", path.c_str());
+				return false;
+			}
+			data = bufferFile->data;
+			size = bufferFile->size;
+		}
+
+		if (size < byteLength)
+		{
+			printf("%s has a buffer that is smaller than its byteLength!\n", fileName);
+			return false;
+		}
+		result->data = data;
+		result->size = byteLength;
+	}
+
+	return true;
+}
+
+// NOTE(joon) : Accessors without the buffer view(all zero, or sparse) are not supported
+static b32
+GetGLTFAccessor(gltf_file *file, json_value *accessorIndex, gltf_accessor *accessor)
+{
+	if (!accessorIndex || accessorIndex->type != JSONType_Number)
+	{
+		return false;
+	}
+	json_value *accessorValue = GetJSONElement(GetJSONMember(&file->root, "accessors"), (i64)accessorIndex->number);
+	json_value *bufferView = GetJSONElement(GetJSONMember(&file->root, "bufferViews"), (i64)GetJSONNumber(accessorValue, "bufferView", -1));
+	if (!accessorValue || !bufferView || GetJSONMember(accessorValue, "sparse"))
+	{
+		return false;
+	}
+
+	i64 bufferIndex = (i64)GetJSONNumber(bufferView, "buffer", -1);
+	if (bufferIndex < 0 || (u64)bufferIndex >= file->buffers.size())
+	{
+		return false;
+	}
+	gltf_buffer *buffer = file->buffers.data() + bufferIndex;
+
+	accessor->componentType = (u32)GetJSONNumber(accessorValue, "componentType", 0);
+	accessor->componentCount = GetGLTFComponentCount(GetJSONMember(accessorValue, "type"));
+	accessor->count = (u32)GetJSONNumber(accessorValue, "count", 0);
+	json_value *normalized = GetJSONMember(accessorValue, "normalized");
+	accessor->isNormalized = normalized && normalized->number != 0.0;
+
+	u32 elementSize = GetGLTFComponentSize(accessor->componentType)*accessor->componentCount;
+	accessor->stride = (u32)GetJSONNumber(bufferView, "byteStride", elementSize);
+	if (elementSize == 0 || accessor->stride < elementSize)
+	{
+		return false;
+	}
+
+	u64 viewOffset = (u64)GetJSONNumber(bufferView, "byteOffset", 0);
+	u64 viewLength = (u64)GetJSONNumber(bufferView, "byteLength", 0);
+	u64 accessorOffset = (u64)GetJSONNumber(accessorValue, "byteOffset", 0);
+	u64 accessorEnd = accessorOffset + (accessor->count ? (u64)(accessor->count - 1)*accessor->stride + elementSize : 0);
+	if (viewOffset + viewLength > buffer->size || accessorEnd > viewLength)
+	{
+		return false;
+	}
+
+	accessor->data = buffer->data + viewOffset + accessorOffset;
+
+	return true;
+}
+
+// NOTE(joon) : Normalized integers are converted to [0, 1] or [-1, 1] like GL does
+static r32
+ReadGLTFComponent(u8 *at, u32 componentType, b32 isNormalized)
+{
+	r32 result = 0.0f;
+	switch (componentType)
+	{
+		case GLTF_COMPONENT_FLOAT:
+		{
+			memcpy(&result, at, sizeof(result));
+		}break;
+		case GLTF_COMPONENT_UNSIGNED_BYTE:
+		{
+			result = isNormalized ? *at / 255.0f : (r32)*at;
+		}break;
+		case GLTF_COMPONENT_BYTE:
+		{
+			result = isNormalized ? Maximum(*(i8 *)at / 127.0f, -1.0f) : (r32)*(i8 *)at;
+		}break;
+		case GLTF_COMPONENT_UNSIGNED_SHORT:
+		{
+			u16 value;
+			memcpy(&value, at, sizeof(value));
+			result = isNormalized ? value / 65535.0f : (r32)value;
+		}break;
+		case GLTF_COMPONENT_SHORT:
+		{
+			i16 value;
+			memcpy(&value, at, sizeof(value));
+			result = isNormalized ? Maximum(value / 32767.0f, -1.0f) : (r32)value;
+		}break;
+		case GLTF_COMPONENT_UNSIGNED_INT:
+		{
+			u32 value;
+			memcpy(&value, at, sizeof(value));
+			result = (r32)value;
+		}break;
+	}
+
+	return result;
+}
+
+struct convert_gltf_vertices_job_data
+{
+	gltf_accessor *positions;
+	gltf_accessor *normals; // 0 if the primitive doesn't have them
+	gltf_accessor *texCoords;
+
+	glm::mat4 transform;
+	glm::mat3 normalTransform;
+
+	vertex *vertices;
+};
+
+static void
+ConvertGLTFVerticesJob(void *data, u32 start, u32 onePastEnd)
+{
+	convert_gltf_vertices_job_data *jobData = (convert_gltf_vertices_job_data *)data;
+	for (u32 vertexIndex = start;
+		vertexIndex < onePastEnd;
+		++vertexIndex)
+	{
+		vertex *vertex = jobData->vertices + vertexIndex;
+
+		gltf_accessor *positions = jobData->positions;
+		u8 *at = positions->data + (u64)vertexIndex*positions->stride;
+		u32 componentSize = GetGLTFComponentSize(positions->componentType);
+		glm::vec3 p;
+		p.x = ReadGLTFComponent(at, positions->componentType, positions->isNormalized);
+		p.y = ReadGLTFComponent(at + componentSize, positions->componentType, positions->isNormalized);
+		p.z = ReadGLTFComponent(at + 2*componentSize, positions->componentType, positions->isNormalized);
+		vertex->p = glm::vec3(jobData->transform*glm::vec4(p, 1.0f));
+
+		vertex->normal = glm::vec3(0.0f, 0.0f, 0.0f);
+		gltf_accessor *normals = jobData->normals;
+		if (normals)
+		{
+			at = normals->data + (u64)vertexIndex*normals->stride;
+			componentSize = GetGLTFComponentSize(normals->componentType);
+			glm::vec3 normal;
+			normal.x = ReadGLTFComponent(at, normals->componentType, normals->isNormalized);
+			normal.y = ReadGLTFComponent(at + componentSize, normals->componentType, normals->isNormalized);
+			normal.z = ReadGLTFComponent(at + 2*componentSize, normals->componentType, normals->isNormalized);
+			normal = jobData->normalTransform*normal;
+
+			r32 length = glm::length(normal);
+			vertex->normal = (length > 0.0f) ? normal / length : normal;
+		}
+
+		// NOTE(joon) : gltf texcoord starts from the top of the image, which is already the same as ours
+		vertex->texCoord = glm::vec2(0.0f, 0.0f);
+		gltf_accessor *texCoords = jobData->texCoords;
+		if (texCoords)
+		{
+			at = texCoords->data + (u64)vertexIndex*texCoords->stride;
+			componentSize = GetGLTFComponentSize(texCoords->componentType);
+			vertex->texCoord.x = ReadGLTFComponent(at, texCoords->componentType, texCoords->isNormalized);
+			vertex->texCoord.y = ReadGLTFComponent(at + componentSize, texCoords->componentType, texCoords->isNormalized);
+		}
+	}
+}
+
+struct gltf_load_stats
+{
+	b32 hasAllNormals;
+	b32 hasAllTexCoords;
+
+	u32 loadedPrimitiveCount;
+	u32 skippedPrimitiveCount; // not triangles, or broken
+};
+
+static void
+AppendGLTFPrimitive(job_system *jobSystem, gltf_file *file, json_value *primitive, glm::mat4 transform, mesh *mesh, gltf_load_stats *stats)
+{
+	json_value *attributes = GetJSONMember(primitive, "attributes");
+
+	gltf_accessor positions = {};
+	gltf_accessor normals = {};
+	gltf_accessor texCoords = {};
+	gltf_accessor indices = {};
+	b32 hasNormals = GetGLTFAccessor(file, GetJSONMember(attributes, "NORMAL"), &normals) && normals.componentCount == 3;
+	b32 hasTexCoords = GetGLTFAccessor(file, GetJSONMember(attributes, "TEXCOORD_0"), &texCoords) && texCoords.componentCount == 2;
+	json_value *indicesValue = GetJSONMember(primitive, "indices");
+	b32 hasIndices = (indicesValue != 0);
+
+	if ((u32)GetJSONNumber(primitive, "mode", GLTF_MODE_TRIANGLES) != GLTF_MODE_TRIANGLES ||
+		!GetGLTFAccessor(file, GetJSONMember(attributes, "POSITION"), &positions) || positions.componentCount != 3 ||
+		(hasNormals && normals.count < positions.count) ||
+		(hasTexCoords && texCoords.count < positions.count) ||
+		(hasIndices && (!GetGLTFAccessor(file, indicesValue, &indices) || indices.componentCount != 1)))
+	{
+		stats->skippedPrimitiveCount++;
+		return;
+	}
+
+	u32 firstVertex = (u32)mesh->vertexBuffer.size();
+	mesh->vertexBuffer.resize(firstVertex + positions.count);
+	convert_gltf_vertices_job_data convertData = {};
+	convertData.positions = &positions;
+	convertData.normals = hasNormals ? &normals : 0;
+	convertData.texCoords = hasTexCoords ? &texCoords : 0;
+	convertData.transform = transform;
+	convertData.normalTransform = glm::transpose(glm::inverse(glm::mat3(transform)));
+	convertData.vertices = mesh->vertexBuffer.data() + firstVertex;
+	ParallelFor(jobSystem, ConvertGLTFVerticesJob, &convertData, "ConvertGLTFVertices", positions.count, 4096);
+	stats->loadedPrimitiveCount++;
+	stats->hasAllNormals &= hasNormals;
+	stats->hasAllTexCoords &= hasTexCoords;
+
+	// NOTE(joon) : Mirroring transform flips the winding
+	b32 shouldFlipWinding = glm::determinant(glm::mat3(transform)) < 0.0f;
+
+	size_t firstIndex = mesh->indexBuffer.size();
+	u32 indexCount = hasIndices ? indices.count : positions.count;
+	indexCount -= indexCount % 3;
+	mesh->indexBuffer.resize(firstIndex + indexCount);
+	u32 *dest = mesh->indexBuffer.data() + firstIndex;
+	if (!hasIndices)
+	{
+		for (u32 index = 0;
+			index < indexCount;
+			++index)
+		{
+			dest[index] = firstVertex + index;
+		}
+	}
+	else if (firstVertex == 0 && indices.componentType == GLTF_COMPONENT_UNSIGNED_INT && indices.stride == sizeof(u32))
+	{
+		memcpy(dest, indices.data, (size_t)indexCount*sizeof(u32));
+	}
+	else
+	{
+		for (u32 index = 0;
+			index < indexCount;
+			++index)
+		{
+			u8 *at = indices.data + (u64)index*indices.stride;
+			u32 value = 0;
+			switch (indices.componentType)
+			{
+				case GLTF_COMPONENT_UNSIGNED_BYTE:
+				{
+					value = *at;
+				}break;
+				case GLTF_COMPONENT_UNSIGNED_SHORT:
+				{
+					u16 value16;
+					memcpy(&value16, at, sizeof(value16));
+					value = value16;
+				}break;
+				case GLTF_COMPONENT_UNSIGNED_INT:
+				{
+					memcpy(&value, at, sizeof(value));
+				}break;
+			}
+			dest[index] = firstVertex + value;
+		}
+	}
+
+	// NOTE(joon) : Indices are not trusted, the triangles that point outside of the primitive are dropped
+	u32 onePastLastVertex = firstVertex + positions.count;
+	u32 validIndexCount = 0;
+	for (u32 triangleIndex = 0;
+		triangleIndex < indexCount/3;
+		++triangleIndex)
+	{
+		u32 *triangle = dest + 3*triangleIndex;
+		if (triangle[0] >= firstVertex && triangle[0] < onePastLastVertex &&
+			triangle[1] >= firstVertex && triangle[1] < onePastLastVertex &&
+			triangle[2] >= firstVertex && triangle[2] < onePastLastVertex)
+		{
+			u32 *validTriangle = dest + validIndexCount;
+			u32 second = triangle[1];
+			u32 third = triangle[2];
+			validTriangle[0] = triangle[0];
+			validTriangle[1] = shouldFlipWinding ? third : second;
+			validTriangle[2] = shouldFlipWinding ? second : third;
+			validIndexCount += 3;
+		}
+	}
+	mesh->indexBuffer.resize(firstIndex + validIndexCount);
+}
+
+static glm::mat4
+GetGLTFNodeTransform(json_value *node)
+{
+	glm::mat4 result = glm::mat4(1.0f);
+
+	json_value *matrix = GetJSONMember(node, "matrix");
+	if (matrix && matrix->children.size() == 16)
+	{
+		// NOTE(joon) : column major, same as glm
+		r32 values[16];
+		for (u32 valueIndex = 0;
+			valueIndex < 16;
+			++valueIndex)
+		{
+			values[valueIndex] = (r32)matrix->children[valueIndex].number;
+		}
+		result = glm::make_mat4(values);
+	}
+	else
+	{
+		json_value *translation = GetJSONMember(node, "translation");
+		json_value *rotation = GetJSONMember(node, "rotation");
+		json_value *scale = GetJSONMember(node, "scale");
+		if (translation && translation->children.size() == 3)
+		{
+			result = glm::translate(glm::vec3(translation->children[0].number, translation->children[1].number, translation->children[2].number));
+		}
+		if (rotation && rotation->children.size() == 4)
+		{
+			// NOTE(joon) : gltf stores x, y, z, w
+			glm::quat quaternion = glm::quat((r32)rotation->children[3].number, (r32)rotation->children[0].number,
+											(r32)rotation->children[1].number, (r32)rotation->children[2].number);
+			result = result*glm::mat4_cast(quaternion);
+		}
+		if (scale && scale->children.size() == 3)
+		{
+			result = result*glm::scale(glm::vec3(scale->children[0].number, scale->children[1].number, scale->children[2].number));
+		}
+	}
+
+	return result;
+}
+
+static void
+AppendGLTFNode(job_system *jobSystem, gltf_file *file, i64 nodeIndex, glm::mat4 parentTransform, mesh *mesh, gltf_load_stats *stats, u32 depth)
+{
+	json_value *node = GetJSONElement(GetJSONMember(&file->root, "nodes"), nodeIndex);
+	if (!node || depth > 64)
+	{
+		return;
+	}
+
+	glm::mat4 transform = parentTransform*GetGLTFNodeTransform(node);
+
+	json_value *meshValue = GetJSONElement(GetJSONMember(&file->root, "meshes"), (i64)GetJSONNumber(node, "mesh", -1));
+	json_value *primitives = GetJSONMember(meshValue, "primitives");
+	if (primitives)
+	{
+		for (u32 primitiveIndex = 0;
+			primitiveIndex < primitives->children.size();
+			++primitiveIndex)
+		{
+			AppendGLTFPrimitive(jobSystem, file, primitives->children.data() + primitiveIndex, transform, mesh, stats);
+		}
+	}
+
+	json_value *children = GetJSONMember(node, "children");
+	if (children)
+	{
+		for (u32 childIndex = 0;
+			childIndex < children->children.size();
+			++childIndex)
+		{
+			AppendGLTFNode(jobSystem, file, (i64)children->children[childIndex].number, transform, mesh, stats, depth + 1);
+		}
+	}
+}
+
+// NOTE(joon) : The mesh ends up the same as ReadOBJFileLineByLine would make it, centered & resized to fit inside [-1, 1].
+// The external buffers are read relative to fileName.
+static void
+ParseGLTFFile(job_system *jobSystem, mesh *mesh, u8 *fileContents, size_t fileSize, const char *fileName, gltf_load_stats *outStats = 0)
+{
+	gltf_file file = {};
+
+	char *json = (char *)fileContents;
+	char *jsonEnd = json + fileSize;
+	u8 *binaryChunk = 0;
+	size_t binaryChunkSize = 0;
+
+	u32 magic = 0;
+	if (fileSize >= 12)
+	{
+		memcpy(&magic, fileContents, sizeof(magic));
+	}
+	if (magic == GLB_MAGIC)
+	{
+		// NOTE(joon) : 12 byte header, and then the chunks(length, type, data), json first
+		size_t at = 12;
+		json = 0;
+		while (at + 8 <= fileSize)
+		{
+			u32 chunkLength;
+			u32 chunkType;
+			memcpy(&chunkLength, fileContents + at, sizeof(chunkLength));
+			memcpy(&chunkType, fileContents + at + 4, sizeof(chunkType));
+			u8 *chunkData = fileContents + at + 8;
+			if (at + 8 + (size_t)chunkLength > fileSize)
+			{
+				break;
+			}
+
+			if (chunkType == GLB_CHUNK_JSON && !json)
+			{
+				json = (char *)chunkData;
+				jsonEnd = json + chunkLength;
+			}
+			else if (chunkType == GLB_CHUNK_BIN && !binaryChunk)
+			{
+				binaryChunk = chunkData;
+				binaryChunkSize = chunkLength;
+			}
+			at += 8 + (size_t)chunkLength;
+		}
+
+		if (!json)
+		{
+			printf("%s doesn't have the json chunk!\n", fileName);
+			return;
+		}
+	}
+
+	// NOTE(joon) : strtod needs the null at the end, which neither the mapped file nor the json chunk has,
+	// so the json is copied out.
+	std::string jsonString(json, jsonEnd);
+	char *jsonAt = &jsonString[0];
+	if (!ParseJSONValue(&jsonAt, jsonAt + jsonString.size(), &file.root, 0) || file.root.type != JSONType_Object)
+	{
+		printf("%s has an invalid json!\n", fileName);
+		return;
+	}
+
+	if (!LoadGLTFBuffers(&file, fileName, binaryChunk, binaryChunkSize))
+	{
+		CloseGLTFFile(&file);
+		return;
+	}
+
+	gltf_load_stats stats = {};
+	stats.hasAllNormals = true;
+	stats.hasAllTexCoords = true;
+
+	// NOTE(joon) : The default scene, or every mesh without any transform if there's no scene
+	json_value *scenes = GetJSONMember(&file.root, "scenes");
+	json_value *scene = GetJSONElement(scenes, (i64)GetJSONNumber(&file.root, "scene", 0));
+	if (scene)
+	{
+		json_value *nodes = GetJSONMember(scene, "nodes");
+		for (u32 nodeIndex = 0;
+			nodes && nodeIndex < nodes->children.size();
+			++nodeIndex)
+		{
+			AppendGLTFNode(jobSystem, &file, (i64)nodes->children[nodeIndex].number, glm::mat4(1.0f), mesh, &stats, 0);
+		}
+	}
+	else
+	{
+		json_value *meshes = GetJSONMember(&file.root, "meshes");
+		for (u32 meshIndex = 0;
+			meshes && meshIndex < meshes->children.size();
+			++meshIndex)
+		{
+			json_value *primitives = GetJSONMember(meshes->children.data() + meshIndex, "primitives");
+			for (u32 primitiveIndex = 0;
+				primitives && primitiveIndex < primitives->children.size();
+				++primitiveIndex)
+			{
+				AppendGLTFPrimitive(jobSystem, &file, primitives->children.data() + primitiveIndex, glm::mat4(1.0f), mesh, &stats);
+			}
+		}
+	}
+	CloseGLTFFile(&file);
+
+	if (outStats)
+	{
+		*outStats = stats;
+	}
+	if (stats.skippedPrimitiveCount)
+	{
+		printf("%u primitives that are not triangles or have invalid accessors were skipped from %s\n", stats.skippedPrimitiveCount, fileName);
+	}
+	if (mesh->vertexBuffer.empty())
+	{
+		return;
+	}
+
+	NormalizeMeshVertices(jobSystem, mesh);
+
+	mesh->hasTexCoords = stats.hasAllTexCoords;
+	GenerateVertexAndFaceNormals(jobSystem, mesh, !stats.hasAllNormals);
+}
+
+void
+ReadGLTFFile(job_system *jobSystem, mesh *mesh, const char *fileName, gltf_load_stats *outStats = 0)
+{
+	asset_file file;
+	if (!ReadAssetFile(fileName, &file))
+	{
+		printf("Invalid glTF file!\n");
+		return;
+	}
+	ParseGLTFFile(jobSystem, mesh, file.data, file.size, fileName, outStats);
+	CloseAssetFile(&file);
+}
@@ -0,0 +1,271 @@
+#include "gpu_culling.h"
+
+// NOTE(joon) : Should be called while we have the context, before the render thread is started.
+// Returns false when the shaders cannot be loaded.
+static b32
+InitializeGPUCulling(gpu_culling *culling, model *model, u32 maxInstanceCount)
+{
+	*culling = {};
+	culling->cullProgram = LoadComputeShader("source/shaders/gpu_culling_shader.comp");
+	culling->hiZProgram = LoadComputeShader("source/shaders/hi_z_shader.comp");
+	culling->indexCount = (u32)model->mesh.indexBuffer.size();
+	culling->maxInstanceCount = maxInstanceCount;
+	culling->hasIndirectParameters = GLEW_ARB_indirect_parameters;
+
+	glGenBuffers(1, &culling->instanceBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, culling->instanceBufferID);
+	glBufferData(GL_ARRAY_BUFFER, maxInstanceCount*sizeof(gpu_instance), 0, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glGenBuffers(1, &culling->commandBufferID);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, culling->commandBufferID);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, maxInstanceCount*sizeof(draw_elements_indirect_command), 0, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	u32 zero = 0;
+	glGenBuffers(1, &culling->drawCountBufferID);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, culling->drawCountBufferID);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(u32), &zero, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glGenBuffers(GPU_CULLING_READBACK_COUNT, culling->readbackBufferIDs);
+	for (u32 readbackIndex = 0;
+		readbackIndex < GPU_CULLING_READBACK_COUNT;
+		++readbackIndex)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, culling->readbackBufferIDs[readbackIndex]);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(u32), &zero, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	glGenVertexArrays(1, &culling->vertexArrayID);
+	glBindVertexArray(culling->vertexArrayID);
+
+	glBindBuffer(GL_ARRAY_BUFFER, model->vertexBufferID);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vertex), (void *)offsetof(vertex, p));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(vertex), (void *)offsetof(vertex, normal));
+	glEnableVertexAttribArray(1);
+
+	// NOTE(joon) : world matrix takes 4 locations, one for each column
+	glBindBuffer(GL_ARRAY_BUFFER, culling->instanceBufferID);
+	for (u32 columnIndex = 0;
+		columnIndex < 4;
+		++columnIndex)
+	{
+		glVertexAttribPointer(3 + columnIndex, 4, GL_FLOAT, GL_FALSE, sizeof(gpu_instance),
+							(void *)(offsetof(gpu_instance, world) + columnIndex*sizeof(glm::vec4)));
+		glVertexAttribDivisor(3 + columnIndex, 1);
+		glEnableVertexAttribArray(3 + columnIndex);
+	}
+	glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(gpu_instance), (void *)offsetof(gpu_instance, color));
+	glVertexAttribDivisor(7, 1);
+	glEnableVertexAttribArray(7);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model->indexBufferID);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	return culling->cullProgram && culling->hiZProgram;
+}
+
+static void
+FreeGPUCulling(gpu_culling *culling)
+{
+	glDeleteProgram(culling->cullProgram);
+	glDeleteProgram(culling->hiZProgram);
+	glDeleteVertexArrays(1, &culling->vertexArrayID);
+	glDeleteBuffers(1, &culling->instanceBufferID);
+	glDeleteBuffers(1, &culling->commandBufferID);
+	glDeleteBuffers(1, &culling->drawCountBufferID);
+	glDeleteBuffers(GPU_CULLING_READBACK_COUNT, culling->readbackBufferIDs);
+	for (u32 readbackIndex = 0;
+		readbackIndex < GPU_CULLING_READBACK_COUNT;
+		++readbackIndex)
+	{
+		if (culling->readbackFences[readbackIndex])
+		{
+			glDeleteSync(culling->readbackFences[readbackIndex]);
+		}
+	}
+	glDeleteTextures(1, &culling->depthTextureID);
+	glDeleteTextures(1, &culling->hiZTextureID);
+}
+
+// NOTE(joon) : Builds the hi-z pyramid from the depth attachment of the current read framebuffer.
+// viewProjection should be the one that was used to draw that depth.
+// Leaves the program, texture unit 3 & image unit 0 changed.
+static void
+BuildHiZ(gpu_culling *culling, i32 width, i32 height, glm::mat4 *viewProjection)
+{
+	glActiveTexture(GL_TEXTURE3);
+
+	if (culling->depthWidth != width || culling->depthHeight != height)
+	{
+		glDeleteTextures(1, &culling->depthTextureID);
+		glDeleteTextures(1, &culling->hiZTextureID);
+
+		glGenTextures(1, &culling->depthTextureID);
+		glBindTexture(GL_TEXTURE_2D, culling->depthTextureID);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, width, height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		// NOTE(joon) : Sizes are rounded up when halving, so that every pixel is covered by the next level
+		i32 hiZWidth = (width + 1) / 2;
+		i32 hiZHeight = (height + 1) / 2;
+		culling->hiZLevelCount = 1;
+		for (i32 size = Maximum(hiZWidth, hiZHeight);
+			size > 1;
+			size = (size + 1) / 2)
+		{
+			++culling->hiZLevelCount;
+		}
+
+		glGenTextures(1, &culling->hiZTextureID);
+		glBindTexture(GL_TEXTURE_2D, culling->hiZTextureID);
+		glTexStorage2D(GL_TEXTURE_2D, culling->hiZLevelCount, GL_R32F, hiZWidth, hiZHeight);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		culling->depthWidth = width;
+		culling->depthHeight = height;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, culling->depthTextureID);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+
+	glUseProgram(culling->hiZProgram);
+	GLint sourceLevelLocation = glGetUniformLocation(culling->hiZProgram, "sourceLevel");
+
+	i32 levelWidth = width;
+	i32 levelHeight = height;
+	for (i32 level = 0;
+		level < culling->hiZLevelCount;
+		++level)
+	{
+		// NOTE(joon) : level 0 reads from the depth, others read from the previous level
+		if (level == 0)
+		{
+			glBindTexture(GL_TEXTURE_2D, culling->depthTextureID);
+			glUniform1i(sourceLevelLocation, 0);
+		}
+		else
+		{
+			glBindTexture(GL_TEXTURE_2D, culling->hiZTextureID);
+			glUniform1i(sourceLevelLocation, level - 1);
+		}
+		glBindImageTexture(0, culling->hiZTextureID, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+		levelWidth = (levelWidth + 1) / 2;
+		levelHeight = (levelHeight + 1) / 2;
+		glDispatchCompute((levelWidth + HI_Z_GROUP_SIZE - 1) / HI_Z_GROUP_SIZE, (levelHeight + HI_Z_GROUP_SIZE - 1) / HI_Z_GROUP_SIZE, 1);
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	}
+
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+
+	culling->hiZViewProjection = *viewProjection;
+}
+
+// NOTE(joon) : Expects the per frame ubo to be bound at 0.
+// Leaves the program & texture unit 3 changed.
+static void
+CullGPUInstances(gpu_culling *culling, u32 instanceCount, b32 useHiZ)
+{
+	Assert(instanceCount <= culling->maxInstanceCount);
+
+	// NOTE(joon) : The count that was copied GPU_CULLING_READBACK_COUNT frames ago should be ready by now,
+	// but never wait for it if it's not
+	GLsync fence = culling->readbackFences[culling->readbackIndex];
+	if (fence)
+	{
+		if (glClientWaitSync(fence, 0, 0) != GL_TIMEOUT_EXPIRED)
+		{
+			glBindBuffer(GL_COPY_READ_BUFFER, culling->readbackBufferIDs[culling->readbackIndex]);
+			glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(u32), &culling->lastVisibleCount);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		}
+		glDeleteSync(fence);
+		culling->readbackFences[culling->readbackIndex] = 0;
+	}
+
+	useHiZ = useHiZ && culling->hiZLevelCount > 0;
+
+	u32 zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, culling->drawCountBufferID);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(u32), &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glUseProgram(culling->cullProgram);
+	GLuint program = culling->cullProgram;
+	glUniform1ui(glGetUniformLocation(program, "instanceCount"), instanceCount);
+	glUniform1ui(glGetUniformLocation(program, "indexCount"), culling->indexCount);
+	glUniform1i(glGetUniformLocation(program, "shouldCompact"), culling->hasIndirectParameters);
+	glUniform1i(glGetUniformLocation(program, "useHiZ"), useHiZ);
+	glUniformMatrix4fv(glGetUniformLocation(program, "hiZViewProjection"), 1, GL_FALSE, (r32 *)&culling->hiZViewProjection);
+	glUniform2i(glGetUniformLocation(program, "depthSize"), culling->depthWidth, culling->depthHeight);
+	glUniform1i(glGetUniformLocation(program, "hiZLevelCount"), culling->hiZLevelCount);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, culling->instanceBufferID);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, culling->commandBufferID);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, culling->drawCountBufferID);
+	glActiveTexture(GL_TEXTURE3);
+	glBindTexture(GL_TEXTURE_2D, useHiZ ? culling->hiZTextureID : 0);
+	glActiveTexture(GL_TEXTURE0);
+
+	if (instanceCount)
+	{
+		glDispatchCompute((instanceCount + GPU_CULLING_GROUP_SIZE - 1) / GPU_CULLING_GROUP_SIZE, 1, 1);
+	}
+	// NOTE(joon) : the commands & the count are read by the draw, and the count is also copied
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	glBindBuffer(GL_COPY_READ_BUFFER, culling->drawCountBufferID);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, culling->readbackBufferIDs[culling->readbackIndex]);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(u32));
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	culling->readbackFences[culling->readbackIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	culling->readbackIndex = (culling->readbackIndex + 1) % GPU_CULLING_READBACK_COUNT;
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, 0);
+}
+
+// NOTE(joon) : Draws whatever the last CullGPUInstances left, with the program that is currently bound
+static void
+DrawGPUInstances(gpu_culling *culling, u32 instanceCount)
+{
+	glBindVertexArray(culling->vertexArrayID);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, culling->commandBufferID);
+
+	if (culling->hasIndirectParameters)
+	{
+		glBindBuffer(GL_PARAMETER_BUFFER_ARB, culling->drawCountBufferID);
+		glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, 0, 0, instanceCount, sizeof(draw_elements_indirect_command));
+		glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+	}
+	else
+	{
+		// NOTE(joon) : culled ones have 0 instance count
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0, instanceCount, sizeof(draw_elements_indirect_command));
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+// NOTE(joon) : Instances that are only translated & uniformly scaled, so the bounding sphere is easy to get
+static void
+FillGPUInstance(gpu_instance *instance, model *model, glm::vec3 p, r32 scale, glm::vec3 color)
+{
+	instance->world = glm::translate(p) * glm::scale(glm::vec3(scale, scale, scale));
+	instance->boundingSphere = glm::vec4(p, model->boundingRadius*scale);
+	instance->color = glm::vec4(color, 1.0f);
+}
@@ -0,0 +1,69 @@
+#ifndef GPU_CULLING_H
+#define GPU_CULLING_H
+
+// NOTE(joon) : GPU driven culling for a large number of instances of the same model.
+// A compute shader tests the bounding sphere of each instance against the frustum and
+// the Hi-Z pyramid of the previous frame, and appends an indirect draw command for
+// every instance that survived. The commands are then drawn with one glMultiDrawElementsIndirect.
+//
+// The Hi-Z pyramid is built from the depth buffer at the end of the frame, and keeps
+// the view projection matrix of that frame so that the next frame can reproject into it.
+// An instance that just came out from behind an occluder can be missing for a frame.
+
+#define GPU_CULLING_GROUP_SIZE 64 // should match the local_size_x of the culling shader
+#define HI_Z_GROUP_SIZE 8 // should match the local_size of the hi-z shader
+#define GPU_CULLING_READBACK_COUNT 3 // the visible count is read back this many frames later, so that we never stall
+#define MAX_GPU_INSTANCE_COUNT 16384
+
+// NOTE(joon) : std430, should match the gpu_instance in the shaders.
+// Also used as the per instance vertex attributes.
+struct gpu_instance
+{
+	alignas(16) glm::mat4 world;
+	alignas(16) glm::vec4 boundingSphere; // xyz : world space center, w : radius
+	alignas(16) glm::vec4 color;
+};
+
+// NOTE(joon) : The layout glMultiDrawElementsIndirect expects
+struct draw_elements_indirect_command
+{
+	u32 count;
+	u32 instanceCount;
+	u32 firstIndex;
+	i32 baseVertex;
+	u32 baseInstance;
+};
+
+// NOTE(joon) : Every GL object here is owned by the render thread after it's started
+struct gpu_culling
+{
+	GLuint cullProgram;
+	GLuint hiZProgram;
+
+	// NOTE(joon) : shares the vertex & index buffers of the model,
+	// and adds the instance buffer as the per instance attributes
+	GLuint vertexArrayID;
+	GLuint instanceBufferID;
+	GLuint commandBufferID;
+	GLuint drawCountBufferID;
+	u32 indexCount;
+	u32 maxInstanceCount;
+
+	// NOTE(joon) : Without ARB_indirect_parameters, the shader writes one command per instance
+	// (instance count 0 for the culled ones) and we draw all of them.
+	b32 hasIndirectParameters;
+
+	GLuint depthTextureID; // copy of the depth buffer
+	GLuint hiZTextureID; // half the resolution of the depth at the level 0, each texel is the farthest depth
+	i32 depthWidth;
+	i32 depthHeight;
+	i32 hiZLevelCount;
+	glm::mat4 hiZViewProjection; // of the frame that the pyramid was built from
+
+	GLuint readbackBufferIDs[GPU_CULLING_READBACK_COUNT];
+	GLsync readbackFences[GPU_CULLING_READBACK_COUNT];
+	u32 readbackIndex;
+	u32 lastVisibleCount;
+};
+
+#endif
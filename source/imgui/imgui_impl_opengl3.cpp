@@ -89,6 +89,7 @@
 #include "imgui.h"
 #include "imgui_impl_opengl3.h"
 #include <stdio.h>
+#include <string.h>     // memcpy, memcmp
 #if defined(_MSC_VER) && _MSC_VER <= 1500 // MSVC 2008 or earlier
 #include <stddef.h>     // intptr_t
 #else
@@ -161,6 +162,12 @@
 #define IMGUI_IMPL_OPENGL_MAY_HAVE_EXTENSIONS
 #endif
 
+// Desktop GL 4.4+ (or GL_ARB_buffer_storage) has glBufferStorage() for persistently mapped buffers, fences and base vertex come from 3.2
+#if !defined(IMGUI_IMPL_OPENGL_ES2) && !defined(IMGUI_IMPL_OPENGL_ES3) && defined(GL_VERSION_4_4)
+#define IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+#define IMGUI_IMPL_OPENGL_STREAM_FRAME_COUNT    3           // Number of frames the GPU may still be reading from the stream buffer
+#endif
+
 // OpenGL Data
 struct ImGui_ImplOpenGL3_Data
 {
@@ -175,6 +182,21 @@ struct ImGui_ImplOpenGL3_Data
     GLuint          AttribLocationVtxColor;
     unsigned int    VboHandle, ElementsHandle;
     bool            HasClipOrigin;
+    bool            HasBufferStorage;
+    bool            UseStreamingUpload;      // Requested with ImGui_ImplOpenGL3_SetStreamingUpload()
+    size_t          LastUploadBytes;         // Vertex + index bytes uploaded by the last ImGui_ImplOpenGL3_RenderDrawData() call
+    bool            HasKnownState;           // Set with ImGui_ImplOpenGL3_SetKnownState()
+    ImGui_ImplOpenGL3_State KnownState;
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+    GLuint          StreamBufferHandle;      // Holds both vertices and indices, split into one segment per frame in flight
+    GLsizeiptr      StreamSegmentSize;
+    unsigned char*  StreamMappedData;
+    GLsync          StreamFences[IMGUI_IMPL_OPENGL_STREAM_FRAME_COUNT];
+    int             StreamFrameIndex;
+    bool            IsStreaming;             // Current frame was uploaded into the stream buffer
+    GLsizeiptr      StreamVtxOffset;         // Where the current frame's vertices/indices start inside the stream buffer
+    GLsizeiptr      StreamIdxOffset;
+#endif
 
     ImGui_ImplOpenGL3_Data() { memset(this, 0, sizeof(*this)); }
 };
@@ -261,8 +283,12 @@ bool    ImGui_ImplOpenGL3_Init(const char* glsl_version)
         const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
         if (extension != NULL && strcmp(extension, "GL_ARB_clip_control") == 0)
             bd->HasClipOrigin = true;
+        if (extension != NULL && strcmp(extension, "GL_ARB_buffer_storage") == 0)
+            bd->HasBufferStorage = true;
     }
 #endif
+    if (bd->GlVersion >= 440)
+        bd->HasBufferStorage = true;
 
     return true;
 }
@@ -279,6 +305,166 @@ void    ImGui_ImplOpenGL3_Shutdown()
     IM_DELETE(bd);
 }
 
+void    ImGui_ImplOpenGL3_SetStreamingUpload(bool enabled)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != NULL && "Did you call ImGui_ImplOpenGL3_Init()?");
+    bd->UseStreamingUpload = enabled;
+}
+
+bool    ImGui_ImplOpenGL3_IsStreamingUploadSupported()
+{
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    return bd != NULL && bd->HasBufferStorage && bd->GlVersion >= 320;
+#else
+    return false;
+#endif
+}
+
+size_t  ImGui_ImplOpenGL3_GetLastUploadBytes()
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    return bd ? bd->LastUploadBytes : 0;
+}
+
+// NOTE(joon) : Local change, not a part of the upstream backend. With the opt-in known state(ImGui_ImplOpenGL3_SetKnownState),
+// the GL state backup queries are skipped and only what was changed gets restored.
+// IMGUI_IMPL_OPENGL_VALIDATE_KNOWN_STATE checks the known state against the driver. Keep it when updating the backend.
+void    ImGui_ImplOpenGL3_QueryState(ImGui_ImplOpenGL3_State* out_state)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != NULL && "Did you call ImGui_ImplOpenGL3_Init()?");
+    memset(out_state, 0, sizeof(*out_state));
+
+    // The texture/sampler bindings are the ones of texture unit 0, which is what we are using
+    glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&out_state->ActiveTexture);
+    glActiveTexture(GL_TEXTURE0);
+    glGetIntegerv(GL_CURRENT_PROGRAM, (GLint*)&out_state->Program);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, (GLint*)&out_state->Texture);
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BIND_SAMPLER
+    if (bd->GlVersion >= 330)
+        glGetIntegerv(GL_SAMPLER_BINDING, (GLint*)&out_state->Sampler);
+#endif
+    glActiveTexture(out_state->ActiveTexture);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, (GLint*)&out_state->ArrayBuffer);
+#ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, (GLint*)&out_state->VertexArray);
+#endif
+#ifdef IMGUI_IMPL_HAS_POLYGON_MODE
+    GLint polygon_mode[2]; glGetIntegerv(GL_POLYGON_MODE, polygon_mode);
+    out_state->PolygonMode = polygon_mode[0];
+#endif
+    glGetIntegerv(GL_VIEWPORT, out_state->Viewport);
+    glGetIntegerv(GL_SCISSOR_BOX, out_state->ScissorBox);
+    glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&out_state->BlendSrcRgb);
+    glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&out_state->BlendDstRgb);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&out_state->BlendSrcAlpha);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&out_state->BlendDstAlpha);
+    glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&out_state->BlendEquationRgb);
+    glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&out_state->BlendEquationAlpha);
+    out_state->Blend = glIsEnabled(GL_BLEND) == GL_TRUE;
+    out_state->CullFace = glIsEnabled(GL_CULL_FACE) == GL_TRUE;
+    out_state->DepthTest = glIsEnabled(GL_DEPTH_TEST) == GL_TRUE;
+    out_state->StencilTest = glIsEnabled(GL_STENCIL_TEST) == GL_TRUE;
+    out_state->ScissorTest = glIsEnabled(GL_SCISSOR_TEST) == GL_TRUE;
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_PRIMITIVE_RESTART
+    if (bd->GlVersion >= 310)
+        out_state->PrimitiveRestart = glIsEnabled(GL_PRIMITIVE_RESTART) == GL_TRUE;
+#endif
+#if defined(GL_CLIP_ORIGIN)
+    if (bd->HasClipOrigin)
+    {
+        GLenum clip_origin = 0; glGetIntegerv(GL_CLIP_ORIGIN, (GLint*)&clip_origin);
+        out_state->ClipOriginUpperLeft = (clip_origin == GL_UPPER_LEFT);
+    }
+#endif
+}
+
+void    ImGui_ImplOpenGL3_SetKnownState(const ImGui_ImplOpenGL3_State* state)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != NULL && "Did you call ImGui_ImplOpenGL3_Init()?");
+    bd->HasKnownState = (state != NULL);
+    if (state)
+        bd->KnownState = *state;
+}
+
+#ifdef IMGUI_IMPL_OPENGL_VALIDATE_KNOWN_STATE
+static void ImGui_ImplOpenGL3_ValidateKnownState(const ImGui_ImplOpenGL3_State* known)
+{
+    ImGui_ImplOpenGL3_State real;
+    ImGui_ImplOpenGL3_QueryState(&real);
+    bool matches = true;
+#define IMGUI_IMPL_OPENGL_CHECK_STATE(_FIELD)   if (memcmp(&known->_FIELD, &real._FIELD, sizeof(real._FIELD)) != 0) { fprintf(stderr, "ImGui_ImplOpenGL3: known state '%s' doesn't match the driver\n", #_FIELD); matches = false; }
+    IMGUI_IMPL_OPENGL_CHECK_STATE(ActiveTexture);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(Program);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(Texture);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(Sampler);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(ArrayBuffer);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(VertexArray);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(PolygonMode);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(Viewport);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(ScissorBox);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(BlendSrcRgb);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(BlendDstRgb);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(BlendSrcAlpha);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(BlendDstAlpha);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(BlendEquationRgb);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(BlendEquationAlpha);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(Blend);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(CullFace);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(DepthTest);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(StencilTest);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(ScissorTest);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(PrimitiveRestart);
+    IMGUI_IMPL_OPENGL_CHECK_STATE(ClipOriginUpperLeft);
+#undef IMGUI_IMPL_OPENGL_CHECK_STATE
+    IM_ASSERT(matches && "ImGui_ImplOpenGL3_SetKnownState() was given a state that doesn't match the driver!");
+    (void)matches;
+}
+#endif
+
+// Restore 'last_state'. When 'current_state' is given, only the fields that differ from it are restored.
+static void ImGui_ImplOpenGL3_RestoreState(const ImGui_ImplOpenGL3_State* last_state, const ImGui_ImplOpenGL3_State* current_state)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    const ImGui_ImplOpenGL3_State* last = last_state;
+    const ImGui_ImplOpenGL3_State* cur = current_state;
+#define IMGUI_IMPL_OPENGL_CHANGED(_FIELD)       (cur == NULL || memcmp(&last->_FIELD, &cur->_FIELD, sizeof(last->_FIELD)) != 0)
+    if (IMGUI_IMPL_OPENGL_CHANGED(Program)) glUseProgram(last->Program);
+    if (IMGUI_IMPL_OPENGL_CHANGED(Texture)) glBindTexture(GL_TEXTURE_2D, last->Texture);
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BIND_SAMPLER
+    if (bd->GlVersion >= 330 && IMGUI_IMPL_OPENGL_CHANGED(Sampler))
+        glBindSampler(0, last->Sampler);
+#endif
+    if (IMGUI_IMPL_OPENGL_CHANGED(ActiveTexture)) glActiveTexture(last->ActiveTexture);
+#ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
+    if (IMGUI_IMPL_OPENGL_CHANGED(VertexArray)) glBindVertexArray(last->VertexArray);
+#endif
+    if (IMGUI_IMPL_OPENGL_CHANGED(ArrayBuffer)) glBindBuffer(GL_ARRAY_BUFFER, last->ArrayBuffer);
+    if (IMGUI_IMPL_OPENGL_CHANGED(BlendEquationRgb) || IMGUI_IMPL_OPENGL_CHANGED(BlendEquationAlpha))
+        glBlendEquationSeparate(last->BlendEquationRgb, last->BlendEquationAlpha);
+    if (IMGUI_IMPL_OPENGL_CHANGED(BlendSrcRgb) || IMGUI_IMPL_OPENGL_CHANGED(BlendDstRgb) || IMGUI_IMPL_OPENGL_CHANGED(BlendSrcAlpha) || IMGUI_IMPL_OPENGL_CHANGED(BlendDstAlpha))
+        glBlendFuncSeparate(last->BlendSrcRgb, last->BlendDstRgb, last->BlendSrcAlpha, last->BlendDstAlpha);
+    if (IMGUI_IMPL_OPENGL_CHANGED(Blend)) { if (last->Blend) glEnable(GL_BLEND); else glDisable(GL_BLEND); }
+    if (IMGUI_IMPL_OPENGL_CHANGED(CullFace)) { if (last->CullFace) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE); }
+    if (IMGUI_IMPL_OPENGL_CHANGED(DepthTest)) { if (last->DepthTest) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST); }
+    if (IMGUI_IMPL_OPENGL_CHANGED(StencilTest)) { if (last->StencilTest) glEnable(GL_STENCIL_TEST); else glDisable(GL_STENCIL_TEST); }
+    if (IMGUI_IMPL_OPENGL_CHANGED(ScissorTest)) { if (last->ScissorTest) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST); }
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_PRIMITIVE_RESTART
+    if (bd->GlVersion >= 310 && IMGUI_IMPL_OPENGL_CHANGED(PrimitiveRestart)) { if (last->PrimitiveRestart) glEnable(GL_PRIMITIVE_RESTART); else glDisable(GL_PRIMITIVE_RESTART); }
+#endif
+
+#ifdef IMGUI_IMPL_HAS_POLYGON_MODE
+    if (IMGUI_IMPL_OPENGL_CHANGED(PolygonMode)) glPolygonMode(GL_FRONT_AND_BACK, (GLenum)last->PolygonMode);
+#endif
+    if (IMGUI_IMPL_OPENGL_CHANGED(Viewport)) glViewport(last->Viewport[0], last->Viewport[1], (GLsizei)last->Viewport[2], (GLsizei)last->Viewport[3]);
+    if (IMGUI_IMPL_OPENGL_CHANGED(ScissorBox)) glScissor(last->ScissorBox[0], last->ScissorBox[1], (GLsizei)last->ScissorBox[2], (GLsizei)last->ScissorBox[3]);
+#undef IMGUI_IMPL_OPENGL_CHANGED
+    (void)bd; // Not all compilation paths use this
+}
+
 void    ImGui_ImplOpenGL3_NewFrame()
 {
     ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
@@ -311,7 +497,11 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_wid
     // Support for GL 4.5 rarely used glClipControl(GL_UPPER_LEFT)
 #if defined(GL_CLIP_ORIGIN)
     bool clip_origin_lower_left = true;
-    if (bd->HasClipOrigin)
+    if (bd->HasKnownState)
+    {
+        clip_origin_lower_left = !bd->KnownState.ClipOriginUpperLeft;
+    }
+    else if (bd->HasClipOrigin)
     {
         GLenum current_clip_origin = 0; glGetIntegerv(GL_CLIP_ORIGIN, (GLint*)&current_clip_origin);
         if (current_clip_origin == GL_UPPER_LEFT)
@@ -351,15 +541,125 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_wid
 #endif
 
     // Bind vertex/index buffers and setup attributes for ImDrawVert
-    glBindBuffer(GL_ARRAY_BUFFER, bd->VboHandle);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bd->ElementsHandle);
+    GLuint vtx_buffer = bd->VboHandle;
+    GLuint idx_buffer = bd->ElementsHandle;
+    intptr_t vtx_offset = 0;
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+    if (bd->IsStreaming)
+    {
+        // Vertices and indices share the stream buffer, draw calls add the per-list offsets with base vertex
+        vtx_buffer = idx_buffer = bd->StreamBufferHandle;
+        vtx_offset = (intptr_t)bd->StreamVtxOffset;
+    }
+#endif
+    glBindBuffer(GL_ARRAY_BUFFER, vtx_buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, idx_buffer);
     glEnableVertexAttribArray(bd->AttribLocationVtxPos);
     glEnableVertexAttribArray(bd->AttribLocationVtxUV);
     glEnableVertexAttribArray(bd->AttribLocationVtxColor);
-    glVertexAttribPointer(bd->AttribLocationVtxPos,   2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, pos));
-    glVertexAttribPointer(bd->AttribLocationVtxUV,    2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, uv));
-    glVertexAttribPointer(bd->AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE,  sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, col));
+    glVertexAttribPointer(bd->AttribLocationVtxPos,   2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)(vtx_offset + IM_OFFSETOF(ImDrawVert, pos)));
+    glVertexAttribPointer(bd->AttribLocationVtxUV,    2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)(vtx_offset + IM_OFFSETOF(ImDrawVert, uv)));
+    glVertexAttribPointer(bd->AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE,  sizeof(ImDrawVert), (GLvoid*)(vtx_offset + IM_OFFSETOF(ImDrawVert, col)));
+}
+
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+static void ImGui_ImplOpenGL3_DestroyStreamBuffer()
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    for (int i = 0; i < IMGUI_IMPL_OPENGL_STREAM_FRAME_COUNT; i++)
+        if (bd->StreamFences[i])
+        {
+            glClientWaitSync(bd->StreamFences[i], GL_SYNC_FLUSH_COMMANDS_BIT, (GLuint64)1000000000);
+            glDeleteSync(bd->StreamFences[i]);
+            bd->StreamFences[i] = 0;
+        }
+    if (bd->StreamBufferHandle)
+    {
+        GLint last_array_buffer; glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, bd->StreamBufferHandle);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
+        glDeleteBuffers(1, &bd->StreamBufferHandle);
+    }
+    bd->StreamBufferHandle = 0;
+    bd->StreamMappedData = NULL;
+    bd->StreamSegmentSize = 0;
+    bd->StreamFrameIndex = 0;
+}
+
+static bool ImGui_ImplOpenGL3_CreateStreamBuffer(GLsizeiptr segment_size)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const GLsizeiptr total_size = segment_size * IMGUI_IMPL_OPENGL_STREAM_FRAME_COUNT;
+
+    GLint last_array_buffer; glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
+    glGenBuffers(1, &bd->StreamBufferHandle);
+    glBindBuffer(GL_ARRAY_BUFFER, bd->StreamBufferHandle);
+    glBufferStorage(GL_ARRAY_BUFFER, total_size, NULL, flags);
+    bd->StreamMappedData = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, total_size, flags);
+    glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
+
+    if (bd->StreamMappedData == NULL)
+    {
+        ImGui_ImplOpenGL3_DestroyStreamBuffer();
+        return false;
+    }
+    bd->StreamSegmentSize = segment_size;
+    return true;
+}
+
+// NOTE(joon) : Local change, not a part of the upstream backend. The opt-in streaming upload(ImGui_ImplOpenGL3_SetStreamingUpload)
+// copies every command list into one persistently mapped, fenced ring buffer instead of calling glBufferData() per list.
+// Desktop GL 4.4+ or GL_ARB_buffer_storage only. Keep it when updating the backend.
+// Copy every command list into the stream buffer segment of this frame, vertices first then indices.
+// Returns false if the stream buffer cannot be used, in which case the caller falls back to glBufferData().
+static bool ImGui_ImplOpenGL3_UploadStreamingData(ImDrawData* draw_data)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    const GLsizeiptr vtx_size = (GLsizeiptr)draw_data->TotalVtxCount * (GLsizeiptr)sizeof(ImDrawVert);
+    const GLsizeiptr idx_offset = (vtx_size + 3) & ~(GLsizeiptr)3;
+    const GLsizeiptr required_size = idx_offset + (GLsizeiptr)draw_data->TotalIdxCount * (GLsizeiptr)sizeof(ImDrawIdx);
+
+    if (required_size > bd->StreamSegmentSize)
+    {
+        // Grow with some headroom so we don't recreate the buffer every time a window opens. Keep segments 256-byte aligned.
+        ImGui_ImplOpenGL3_DestroyStreamBuffer();
+        GLsizeiptr segment_size = required_size * 2 < 256 * 1024 ? 256 * 1024 : required_size * 2;
+        segment_size = (segment_size + 255) & ~(GLsizeiptr)255;
+        if (!ImGui_ImplOpenGL3_CreateStreamBuffer(segment_size))
+            return false;
+    }
+
+    // Wait until the GPU is done with the frame that last used this segment
+    const int frame = bd->StreamFrameIndex;
+    if (bd->StreamFences[frame])
+    {
+        GLenum wait_result = glClientWaitSync(bd->StreamFences[frame], GL_SYNC_FLUSH_COMMANDS_BIT, (GLuint64)1000000000);
+        while (wait_result == GL_TIMEOUT_EXPIRED)
+            wait_result = glClientWaitSync(bd->StreamFences[frame], GL_SYNC_FLUSH_COMMANDS_BIT, (GLuint64)1000000000);
+        glDeleteSync(bd->StreamFences[frame]);
+        bd->StreamFences[frame] = 0;
+    }
+
+    const GLsizeiptr segment_offset = (GLsizeiptr)frame * bd->StreamSegmentSize;
+    ImDrawVert* vtx_dst = (ImDrawVert*)(bd->StreamMappedData + segment_offset);
+    ImDrawIdx* idx_dst = (ImDrawIdx*)(bd->StreamMappedData + segment_offset + idx_offset);
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        memcpy(vtx_dst, cmd_list->VtxBuffer.Data, (size_t)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
+        memcpy(idx_dst, cmd_list->IdxBuffer.Data, (size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+        vtx_dst += cmd_list->VtxBuffer.Size;
+        idx_dst += cmd_list->IdxBuffer.Size;
+    }
+
+    bd->StreamVtxOffset = segment_offset;
+    bd->StreamIdxOffset = segment_offset + idx_offset;
+    bd->LastUploadBytes = (size_t)vtx_size + (size_t)draw_data->TotalIdxCount * sizeof(ImDrawIdx);
+    return true;
 }
+#endif
 
 // OpenGL3 Render function.
 // Note that this implementation is little overcomplicated because we are saving/setting up/restoring every OpenGL state explicitly.
@@ -373,37 +673,29 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
         return;
 
     ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    bd->LastUploadBytes = 0;
 
-    // Backup GL state
-    GLenum last_active_texture; glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&last_active_texture);
-    glActiveTexture(GL_TEXTURE0);
-    GLuint last_program; glGetIntegerv(GL_CURRENT_PROGRAM, (GLint*)&last_program);
-    GLuint last_texture; glGetIntegerv(GL_TEXTURE_BINDING_2D, (GLint*)&last_texture);
-#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BIND_SAMPLER
-    GLuint last_sampler; if (bd->GlVersion >= 330) { glGetIntegerv(GL_SAMPLER_BINDING, (GLint*)&last_sampler); } else { last_sampler = 0; }
-#endif
-    GLuint last_array_buffer; glGetIntegerv(GL_ARRAY_BUFFER_BINDING, (GLint*)&last_array_buffer);
-#ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
-    GLuint last_vertex_array_object; glGetIntegerv(GL_VERTEX_ARRAY_BINDING, (GLint*)&last_vertex_array_object);
+    // Backup GL state, unless the application told us what it is
+    ImGui_ImplOpenGL3_State last_state;
+    if (bd->HasKnownState)
+    {
+        last_state = bd->KnownState;
+#ifdef IMGUI_IMPL_OPENGL_VALIDATE_KNOWN_STATE
+        ImGui_ImplOpenGL3_ValidateKnownState(&last_state);
 #endif
-#ifdef IMGUI_IMPL_HAS_POLYGON_MODE
-    GLint last_polygon_mode[2]; glGetIntegerv(GL_POLYGON_MODE, last_polygon_mode);
-#endif
-    GLint last_viewport[4]; glGetIntegerv(GL_VIEWPORT, last_viewport);
-    GLint last_scissor_box[4]; glGetIntegerv(GL_SCISSOR_BOX, last_scissor_box);
-    GLenum last_blend_src_rgb; glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&last_blend_src_rgb);
-    GLenum last_blend_dst_rgb; glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&last_blend_dst_rgb);
-    GLenum last_blend_src_alpha; glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&last_blend_src_alpha);
-    GLenum last_blend_dst_alpha; glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&last_blend_dst_alpha);
-    GLenum last_blend_equation_rgb; glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&last_blend_equation_rgb);
-    GLenum last_blend_equation_alpha; glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&last_blend_equation_alpha);
-    GLboolean last_enable_blend = glIsEnabled(GL_BLEND);
-    GLboolean last_enable_cull_face = glIsEnabled(GL_CULL_FACE);
-    GLboolean last_enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
-    GLboolean last_enable_stencil_test = glIsEnabled(GL_STENCIL_TEST);
-    GLboolean last_enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
-#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_PRIMITIVE_RESTART
-    GLboolean last_enable_primitive_restart = (bd->GlVersion >= 310) ? glIsEnabled(GL_PRIMITIVE_RESTART) : GL_FALSE;
+    }
+    else
+    {
+        ImGui_ImplOpenGL3_QueryState(&last_state);
+    }
+    if (last_state.ActiveTexture != GL_TEXTURE0)
+        glActiveTexture(GL_TEXTURE0);
+
+    // Upload everything at once when streaming is enabled (needs base vertex as all the lists share one buffer)
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+    bd->IsStreaming = false;
+    if (bd->UseStreamingUpload && bd->HasBufferStorage && bd->GlVersion >= 320)
+        bd->IsStreaming = ImGui_ImplOpenGL3_UploadStreamingData(draw_data);
 #endif
 
     // Setup desired GL state
@@ -415,18 +707,53 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
 #endif
     ImGui_ImplOpenGL3_SetupRenderState(draw_data, fb_width, fb_height, vertex_array_object);
 
+    // What ImGui_ImplOpenGL3_SetupRenderState() and the draw loop leave behind, so we only restore what we changed
+    ImGui_ImplOpenGL3_State current_state = last_state;
+    current_state.ActiveTexture = GL_TEXTURE0;
+    current_state.Program = bd->ShaderHandle;
+    current_state.Sampler = 0;
+    current_state.ArrayBuffer = bd->VboHandle;
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+    if (bd->IsStreaming)
+        current_state.ArrayBuffer = bd->StreamBufferHandle;
+#endif
+    current_state.VertexArray = 0; // The temporary VAO is deleted before restoring, which reverts the binding to zero
+#ifdef IMGUI_IMPL_HAS_POLYGON_MODE
+    current_state.PolygonMode = GL_FILL;
+#endif
+    current_state.Viewport[0] = current_state.Viewport[1] = 0;
+    current_state.Viewport[2] = fb_width;
+    current_state.Viewport[3] = fb_height;
+    current_state.BlendSrcRgb = GL_SRC_ALPHA;
+    current_state.BlendDstRgb = GL_ONE_MINUS_SRC_ALPHA;
+    current_state.BlendSrcAlpha = GL_ONE;
+    current_state.BlendDstAlpha = GL_ONE_MINUS_SRC_ALPHA;
+    current_state.BlendEquationRgb = current_state.BlendEquationAlpha = GL_FUNC_ADD;
+    current_state.Blend = true;
+    current_state.CullFace = current_state.DepthTest = current_state.StencilTest = false;
+    current_state.ScissorTest = true;
+    current_state.PrimitiveRestart = false;
+
     // Will project scissor/clipping rectangles into framebuffer space
     ImVec2 clip_off = draw_data->DisplayPos;         // (0,0) unless using multi-viewports
     ImVec2 clip_scale = draw_data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
 
     // Render command lists
+    int global_vtx_offset = 0;
+    int global_idx_offset = 0;
     for (int n = 0; n < draw_data->CmdListsCount; n++)
     {
         const ImDrawList* cmd_list = draw_data->CmdLists[n];
 
-        // Upload vertex/index buffers
-        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.Size * (int)sizeof(ImDrawVert), (const GLvoid*)cmd_list->VtxBuffer.Data, GL_STREAM_DRAW);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.Size * (int)sizeof(ImDrawIdx), (const GLvoid*)cmd_list->IdxBuffer.Data, GL_STREAM_DRAW);
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+        if (!bd->IsStreaming)
+#endif
+        {
+            // Upload vertex/index buffers
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.Size * (int)sizeof(ImDrawVert), (const GLvoid*)cmd_list->VtxBuffer.Data, GL_STREAM_DRAW);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.Size * (int)sizeof(ImDrawIdx), (const GLvoid*)cmd_list->IdxBuffer.Data, GL_STREAM_DRAW);
+            bd->LastUploadBytes += (size_t)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert) + (size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx);
+        }
 
         for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
         {
@@ -449,10 +776,20 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
                     continue;
 
                 // Apply scissor/clipping rectangle (Y is inverted in OpenGL)
-                glScissor((int)clip_min.x, (int)(fb_height - clip_max.y), (int)(clip_max.x - clip_min.x), (int)(clip_max.y - clip_min.y));
+                current_state.ScissorBox[0] = (int)clip_min.x;
+                current_state.ScissorBox[1] = (int)(fb_height - clip_max.y);
+                current_state.ScissorBox[2] = (int)(clip_max.x - clip_min.x);
+                current_state.ScissorBox[3] = (int)(clip_max.y - clip_min.y);
+                glScissor(current_state.ScissorBox[0], current_state.ScissorBox[1], current_state.ScissorBox[2], current_state.ScissorBox[3]);
 
                 // Bind texture, Draw
-                glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->GetTexID());
+                current_state.Texture = (GLuint)(intptr_t)pcmd->GetTexID();
+                glBindTexture(GL_TEXTURE_2D, current_state.Texture);
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+                if (bd->IsStreaming)
+                    glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(bd->StreamIdxOffset + (pcmd->IdxOffset + global_idx_offset) * sizeof(ImDrawIdx)), (GLint)(pcmd->VtxOffset + global_vtx_offset));
+                else
+#endif
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET
                 if (bd->GlVersion >= 320)
                     glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx)), (GLint)pcmd->VtxOffset);
@@ -461,41 +798,27 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
                 glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx)));
             }
         }
+        global_vtx_offset += cmd_list->VtxBuffer.Size;
+        global_idx_offset += cmd_list->IdxBuffer.Size;
     }
 
-    // Destroy the temporary VAO
-#ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
-    glDeleteVertexArrays(1, &vertex_array_object);
+    // Fence the segment so we don't overwrite it while the GPU is still reading from it
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+    if (bd->IsStreaming)
+    {
+        bd->StreamFences[bd->StreamFrameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        bd->StreamFrameIndex = (bd->StreamFrameIndex + 1) % IMGUI_IMPL_OPENGL_STREAM_FRAME_COUNT;
+        bd->IsStreaming = false;
+    }
 #endif
 
-    // Restore modified GL state
-    glUseProgram(last_program);
-    glBindTexture(GL_TEXTURE_2D, last_texture);
-#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BIND_SAMPLER
-    if (bd->GlVersion >= 330)
-        glBindSampler(0, last_sampler);
-#endif
-    glActiveTexture(last_active_texture);
+    // Destroy the temporary VAO
 #ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
-    glBindVertexArray(last_vertex_array_object);
-#endif
-    glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
-    glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
-    glBlendFuncSeparate(last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha);
-    if (last_enable_blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
-    if (last_enable_cull_face) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
-    if (last_enable_depth_test) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
-    if (last_enable_stencil_test) glEnable(GL_STENCIL_TEST); else glDisable(GL_STENCIL_TEST);
-    if (last_enable_scissor_test) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
-#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_PRIMITIVE_RESTART
-    if (bd->GlVersion >= 310) { if (last_enable_primitive_restart) glEnable(GL_PRIMITIVE_RESTART); else glDisable(GL_PRIMITIVE_RESTART); }
+    glDeleteVertexArrays(1, &vertex_array_object);
 #endif
 
-#ifdef IMGUI_IMPL_HAS_POLYGON_MODE
-    glPolygonMode(GL_FRONT_AND_BACK, (GLenum)last_polygon_mode[0]);
-#endif
-    glViewport(last_viewport[0], last_viewport[1], (GLsizei)last_viewport[2], (GLsizei)last_viewport[3]);
-    glScissor(last_scissor_box[0], last_scissor_box[1], (GLsizei)last_scissor_box[2], (GLsizei)last_scissor_box[3]);
+    // Restore modified GL state. Without a known state, restore everything as user callbacks may have changed anything.
+    ImGui_ImplOpenGL3_RestoreState(&last_state, bd->HasKnownState ? &current_state : NULL);
     (void)bd; // Not all compilation paths use this
 }
 
@@ -774,5 +1097,8 @@ void    ImGui_ImplOpenGL3_DestroyDeviceObjects()
     if (bd->VboHandle)      { glDeleteBuffers(1, &bd->VboHandle); bd->VboHandle = 0; }
     if (bd->ElementsHandle) { glDeleteBuffers(1, &bd->ElementsHandle); bd->ElementsHandle = 0; }
     if (bd->ShaderHandle)   { glDeleteProgram(bd->ShaderHandle); bd->ShaderHandle = 0; }
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+    ImGui_ImplOpenGL3_DestroyStreamBuffer();
+#endif
     ImGui_ImplOpenGL3_DestroyFontsTexture();
 }
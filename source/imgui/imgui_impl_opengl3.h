@@ -32,6 +32,36 @@ IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyFontsTexture();
 IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_CreateDeviceObjects();
 IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyDeviceObjects();
 
+// (Optional) Streaming upload: copy every command list into one persistently mapped, fenced ring buffer
+// and draw with base vertex instead of calling glBufferData() per command list. Desktop GL 4.4+ or GL_ARB_buffer_storage,
+// silently falls back to the default upload otherwise.
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetStreamingUpload(bool enabled);
+IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_IsStreamingUploadSupported();
+IMGUI_IMPL_API size_t   ImGui_ImplOpenGL3_GetLastUploadBytes();    // Vertex + index bytes uploaded by the last ImGui_ImplOpenGL3_RenderDrawData() call
+
+// (Optional) Known state: the GL state touched by ImGui_ImplOpenGL3_RenderDrawData(), as the application last left it.
+// When set with ImGui_ImplOpenGL3_SetKnownState(), the backend trusts it instead of querying every field with glGetIntegerv()/glIsEnabled(),
+// and only restores the fields it actually changed. User callbacks should leave the state as ImGui_ImplOpenGL3_SetupRenderState() did.
+// #define IMGUI_IMPL_OPENGL_VALIDATE_KNOWN_STATE to still query the driver and assert that the known state matches.
+struct ImGui_ImplOpenGL3_State
+{
+    unsigned int    ActiveTexture;          // GLenum, e.g. GL_TEXTURE0
+    unsigned int    Program;
+    unsigned int    Texture;                // GL_TEXTURE_2D binding of texture unit 0
+    unsigned int    Sampler;                // Sampler binding of texture unit 0
+    unsigned int    ArrayBuffer;
+    unsigned int    VertexArray;
+    int             PolygonMode;
+    int             Viewport[4];
+    int             ScissorBox[4];
+    unsigned int    BlendSrcRgb, BlendDstRgb, BlendSrcAlpha, BlendDstAlpha;
+    unsigned int    BlendEquationRgb, BlendEquationAlpha;
+    bool            Blend, CullFace, DepthTest, StencilTest, ScissorTest, PrimitiveRestart;
+    bool            ClipOriginUpperLeft;
+};
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_QueryState(ImGui_ImplOpenGL3_State* out_state);     // Fill from the driver, e.g. once after creating the context
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetKnownState(const ImGui_ImplOpenGL3_State* state); // NULL to go back to querying the driver
+
 // Specific OpenGL ES versions
 //#define IMGUI_IMPL_OPENGL_ES2     // Auto-detected on Emscripten
 //#define IMGUI_IMPL_OPENGL_ES3     // Auto-detected on iOS/Android
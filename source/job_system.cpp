@@ -0,0 +1,512 @@
+#include "job_system.h"
+
+// NOTE(joon) : -1 for the threads that are not part of the job system
+static thread_local i32 currentWorkerIndex = -1;
+
+static u64
+GetJobSystemTime(job_system *system)
+{
+	std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - system->initializedTime;
+	return (u64)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+static void
+PushJob(job_deque *deque, job *job)
+{
+	i64 bottom = deque->bottom.load(std::memory_order_relaxed);
+	i64 top = deque->top.load(std::memory_order_acquire);
+	Assert(bottom - top < JOB_DEQUE_CAPACITY);
+
+	deque->entries[bottom & (JOB_DEQUE_CAPACITY - 1)].store(job, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	deque->bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+static job *
+PopJob(job_deque *deque)
+{
+	i64 bottom = deque->bottom.load(std::memory_order_relaxed) - 1;
+	deque->bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	i64 top = deque->top.load(std::memory_order_relaxed);
+
+	job *result = 0;
+	if (top <= bottom)
+	{
+		result = deque->entries[bottom & (JOB_DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+		if (top == bottom)
+		{
+			// NOTE(joon) : This is the last job, so we are racing against the stealers
+			if (!deque->top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				result = 0;
+			}
+			deque->bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+	}
+	else
+	{
+		// NOTE(joon) : deque was empty
+		deque->bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+
+	return result;
+}
+
+static job *
+StealJob(job_deque *deque)
+{
+	i64 top = deque->top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	i64 bottom = deque->bottom.load(std::memory_order_acquire);
+
+	job *result = 0;
+	if (top < bottom)
+	{
+		result = deque->entries[top & (JOB_DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+		if (!deque->top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			// NOTE(joon) : Someone else took it
+			result = 0;
+		}
+	}
+
+	return result;
+}
+
+static void
+ResetJob(job *job, job_callback *callback, void *data, const char *name, struct job *parent)
+{
+	// NOTE(joon) : If this fires, the pool wrapped around while the job was still in flight
+	Assert(job->unfinishedJobCount.load() == 0);
+
+	job->callback = callback;
+	job->data = data;
+	job->name = name;
+	job->start = 0;
+	job->onePastEnd = 0;
+	job->batchSize = 0;
+	job->parent = parent;
+	job->unfinishedJobCount.store(1);
+	job->pendingDependencyCount.store(1);
+	job->continuationCount = 0;
+
+	if (parent)
+	{
+		parent->unfinishedJobCount.fetch_add(1);
+	}
+}
+
+// NOTE(joon) : The job is not going to be executed until it gets submitted.
+static job *
+CreateJob(job_system *system, job_callback *callback, void *data, const char *name, job *parent = 0)
+{
+	job *result = 0;
+	if (currentWorkerIndex >= 0)
+	{
+		job_worker *worker = system->workers + currentWorkerIndex;
+		result = worker->jobPool + (worker->allocatedJobCount++ & (JOB_POOL_CAPACITY - 1));
+	}
+	else
+	{
+		std::lock_guard<std::mutex> guard(system->externalLock);
+		result = system->externalJobPool + (system->externalAllocatedJobCount++ & (JOB_POOL_CAPACITY - 1));
+	}
+
+	ResetJob(result, callback, data, name, parent);
+
+	return result;
+}
+
+// NOTE(joon) : after will not start until before is finished.
+// Should be called before submitting any of the two jobs.
+static void
+AddJobDependency(job *before, job *after)
+{
+	Assert(before->continuationCount < MAX_JOB_CONTINUATION_COUNT);
+	before->continuations[before->continuationCount++] = after;
+	after->pendingDependencyCount.fetch_add(1);
+}
+
+static void
+QueueJob(job_system *system, job *job)
+{
+	if (currentWorkerIndex >= 0)
+	{
+		PushJob(&system->workers[currentWorkerIndex].deque, job);
+	}
+	else
+	{
+		std::lock_guard<std::mutex> guard(system->externalLock);
+		system->externalQueue.push_back(job);
+	}
+
+	system->queuedJobCount.fetch_add(1);
+	{
+		// NOTE(joon) : Taking the lock prevents the worker from missing the notification
+		// between checking the queued job count and going to sleep
+		std::lock_guard<std::mutex> guard(system->sleepLock);
+	}
+	system->sleepCondition.notify_one();
+}
+
+static void
+SubmitJob(job_system *system, job *job)
+{
+	if (job->pendingDependencyCount.fetch_sub(1) == 1)
+	{
+		QueueJob(system, job);
+	}
+}
+
+static void
+FinishJob(job_system *system, job *job)
+{
+	// NOTE(joon) : Read these before the count goes down, as someone who was waiting for this job(or the parent)
+	// can reuse the memory of this job right after
+	struct job *parent = job->parent;
+	u32 continuationCount = job->continuationCount;
+	struct job *continuations[MAX_JOB_CONTINUATION_COUNT];
+	for (u32 continuationIndex = 0;
+		continuationIndex < continuationCount;
+		++continuationIndex)
+	{
+		continuations[continuationIndex] = job->continuations[continuationIndex];
+	}
+
+	if (job->unfinishedJobCount.fetch_sub(1) == 1)
+	{
+		for (u32 continuationIndex = 0;
+			continuationIndex < continuationCount;
+			++continuationIndex)
+		{
+			SubmitJob(system, continuations[continuationIndex]);
+		}
+
+		if (parent)
+		{
+			FinishJob(system, parent);
+		}
+	}
+}
+
+static job *
+GetNextJob(job_system *system)
+{
+	job *result = 0;
+
+	if (currentWorkerIndex >= 0)
+	{
+		job_worker *worker = system->workers + currentWorkerIndex;
+		result = PopJob(&worker->deque);
+
+		if (!result)
+		{
+			std::lock_guard<std::mutex> guard(system->externalLock);
+			if (!system->externalQueue.empty())
+			{
+				result = system->externalQueue.back();
+				system->externalQueue.pop_back();
+			}
+		}
+
+		if (!result && system->workerCount > 1)
+		{
+			// NOTE(joon) : xorshift to pick a random victim
+			worker->randomSeed ^= worker->randomSeed << 13;
+			worker->randomSeed ^= worker->randomSeed >> 17;
+			worker->randomSeed ^= worker->randomSeed << 5;
+
+			u32 firstVictimIndex = worker->randomSeed % system->workerCount;
+			for (u32 victimOffset = 0;
+				victimOffset < system->workerCount && !result;
+				++victimOffset)
+			{
+				u32 victimIndex = (firstVictimIndex + victimOffset) % system->workerCount;
+				if (victimIndex != (u32)currentWorkerIndex)
+				{
+					result = StealJob(&system->workers[victimIndex].deque);
+				}
+			}
+		}
+	}
+
+	if (result)
+	{
+		system->queuedJobCount.fetch_sub(1);
+	}
+
+	return result;
+}
+
+static void
+ExecuteJob(job_system *system, job *job)
+{
+	if (job->batchSize && (job->onePastEnd - job->start) > job->batchSize)
+	{
+		// NOTE(joon) : parallel for root, split the range into child jobs and let others steal them
+		for (u32 batchStart = job->start;
+			batchStart < job->onePastEnd;
+			batchStart += job->batchSize)
+		{
+			struct job *child = CreateJob(system, job->callback, job->data, job->name, job);
+			child->start = batchStart;
+			child->onePastEnd = Minimum(batchStart + job->batchSize, job->onePastEnd);
+			SubmitJob(system, child);
+		}
+	}
+	else if (job->callback)
+	{
+		b32 shouldRecordTiming = system->shouldRecordTimings.load(std::memory_order_relaxed) || system->timingHook;
+
+		job_timing timing = {};
+		if (shouldRecordTiming)
+		{
+			timing.name = job->name;
+			timing.workerIndex = (u32)currentWorkerIndex;
+			timing.beginTime = GetJobSystemTime(system);
+		}
+
+		job->callback(job->data, job->start, job->onePastEnd);
+
+		if (shouldRecordTiming)
+		{
+			timing.endTime = GetJobSystemTime(system);
+			if (system->shouldRecordTimings.load(std::memory_order_relaxed) && currentWorkerIndex >= 0)
+			{
+				system->workers[currentWorkerIndex].timings.push_back(timing);
+			}
+			if (system->timingHook)
+			{
+				system->timingHook(system->timingHookUserData, &timing);
+			}
+		}
+	}
+
+	FinishJob(system, job);
+}
+
+static b32
+IsJobFinished(job *job)
+{
+	return job->unfinishedJobCount.load() == 0;
+}
+
+// NOTE(joon) : Instead of blocking, the waiting thread helps executing other jobs.
+static void
+WaitForJob(job_system *system, job *job)
+{
+	while (!IsJobFinished(job))
+	{
+		struct job *nextJob = GetNextJob(system);
+		if (nextJob)
+		{
+			ExecuteJob(system, nextJob);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+static void
+WorkerThreadProc(job_system *system, u32 workerIndex)
+{
+	currentWorkerIndex = (i32)workerIndex;
+
+	while (system->isRunning.load())
+	{
+		job *job = GetNextJob(system);
+		if (job)
+		{
+			ExecuteJob(system, job);
+		}
+		else
+		{
+			std::unique_lock<std::mutex> lock(system->sleepLock);
+			system->sleepCondition.wait_for(lock, std::chrono::milliseconds(2),
+					[system]{return system->queuedJobCount.load() > 0 || !system->isRunning.load();});
+		}
+	}
+
+	currentWorkerIndex = -1;
+}
+
+// NOTE(joon) : workerCount includes the calling thread, which becomes the worker 0.
+// 0 means one worker per hardware thread.
+static void
+InitializeJobSystem(job_system *system, u32 workerCount)
+{
+	if (workerCount == 0)
+	{
+		workerCount = Maximum(std::thread::hardware_concurrency(), 1u);
+	}
+
+	system->workerCount = workerCount;
+	system->workers = new job_worker[workerCount];
+	system->isRunning.store(true);
+	system->queuedJobCount.store(0);
+	system->shouldRecordTimings.store(false);
+	system->timingHook = 0;
+	system->timingHookUserData = 0;
+	system->initializedTime = std::chrono::steady_clock::now();
+
+	system->externalJobPool = new job[JOB_POOL_CAPACITY];
+	system->externalAllocatedJobCount = 0;
+	for (u32 jobIndex = 0;
+		jobIndex < JOB_POOL_CAPACITY;
+		++jobIndex)
+	{
+		system->externalJobPool[jobIndex].unfinishedJobCount.store(0);
+	}
+
+	for (u32 workerIndex = 0;
+		workerIndex < workerCount;
+		++workerIndex)
+	{
+		job_worker *worker = system->workers + workerIndex;
+		worker->deque.top.store(0);
+		worker->deque.bottom.store(0);
+		worker->jobPool = new job[JOB_POOL_CAPACITY];
+		for (u32 jobIndex = 0;
+			jobIndex < JOB_POOL_CAPACITY;
+			++jobIndex)
+		{
+			worker->jobPool[jobIndex].unfinishedJobCount.store(0);
+		}
+		worker->allocatedJobCount = 0;
+		worker->randomSeed = 0x9E3779B9u * (workerIndex + 1);
+	}
+
+	currentWorkerIndex = 0;
+	for (u32 workerIndex = 1;
+		workerIndex < workerCount;
+		++workerIndex)
+	{
+		system->workers[workerIndex].thread = std::thread(WorkerThreadProc, system, workerIndex);
+	}
+}
+
+static void
+ShutdownJobSystem(job_system *system)
+{
+	system->isRunning.store(false);
+	{
+		std::lock_guard<std::mutex> guard(system->sleepLock);
+	}
+	system->sleepCondition.notify_all();
+
+	for (u32 workerIndex = 1;
+		workerIndex < system->workerCount;
+		++workerIndex)
+	{
+		system->workers[workerIndex].thread.join();
+	}
+
+	for (u32 workerIndex = 0;
+		workerIndex < system->workerCount;
+		++workerIndex)
+	{
+		delete[] system->workers[workerIndex].jobPool;
+	}
+	delete[] system->workers;
+	delete[] system->externalJobPool;
+
+	system->workers = 0;
+	system->workerCount = 0;
+	currentWorkerIndex = -1;
+}
+
+// NOTE(joon) : Picks a batch size so that every worker gets a few batches to steal,
+// but never goes below minBatchSize
+static u32
+GetParallelForBatchSize(job_system *system, u32 count, u32 minBatchSize)
+{
+	u32 batchSize = count / (4*system->workerCount);
+	batchSize = Maximum(batchSize, minBatchSize);
+	// NOTE(joon) : All the children should fit inside the deque
+	batchSize = Maximum(batchSize, count/(JOB_DEQUE_CAPACITY/2) + 1);
+
+	return batchSize;
+}
+
+// NOTE(joon) : Returns the root job, which can be used for the dependencies.
+// callback will be called with the sub ranges of [0, count).
+static job *
+CreateParallelForJob(job_system *system, job_callback *callback, void *data, const char *name,
+					u32 count, u32 minBatchSize, job *parent = 0)
+{
+	job *result = CreateJob(system, callback, data, name, parent);
+	result->start = 0;
+	result->onePastEnd = count;
+	result->batchSize = GetParallelForBatchSize(system, count, minBatchSize);
+
+	return result;
+}
+
+static void
+ParallelFor(job_system *system, job_callback *callback, void *data, const char *name,
+			u32 count, u32 minBatchSize)
+{
+	if (count)
+	{
+		job *root = CreateParallelForJob(system, callback, data, name, count, minBatchSize);
+		SubmitJob(system, root);
+		WaitForJob(system, root);
+	}
+}
+
+// NOTE(joon) : Writes the recorded timings in chrome tracing format,
+// which can be opened with chrome://tracing or https://ui.perfetto.dev
+static b32
+ExportJobTimings(job_system *system, const char *fileName)
+{
+	b32 result = false;
+
+	FILE *file = fopen(fileName, "w");
+	if (file)
+	{
+		fprintf(file, "{\"traceEvents\":[\n");
+		b32 isFirst = true;
+		for (u32 workerIndex = 0;
+			workerIndex < system->workerCount;
+			++workerIndex)
+		{
+			job_worker *worker = system->workers + workerIndex;
+			for (u32 timingIndex = 0;
+				timingIndex < worker->timings.size();
+				++timingIndex)
+			{
+				job_timing *timing = worker->timings.data() + timingIndex;
+				fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%llu,\"dur\":%llu}",
+						isFirst ? "" : ",\n",
+						timing->name ? timing->name : "unnamed", timing->workerIndex,
+						(unsigned long long)timing->beginTime, (unsigned long long)(timing->endTime - timing->beginTime));
+				isFirst = false;
+			}
+		}
+		fprintf(file, "\n]}\n");
+		fclose(file);
+
+		result = true;
+	}
+	else
+	{
+		printf("Cannot open %s to export the job timings\n", fileName);
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Should only be called when no job is running
+static void
+ClearJobTimings(job_system *system)
+{
+	for (u32 workerIndex = 0;
+		workerIndex < system->workerCount;
+		++workerIndex)
+	{
+		system->workers[workerIndex].timings.clear();
+	}
+}
@@ -0,0 +1,103 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+
+// NOTE(joon) : [start, onePastEnd) is only meaningful for the jobs created by the parallel for,
+// every other job gets 0, 0
+typedef void job_callback(void *data, u32 start, u32 onePastEnd);
+
+#define MAX_JOB_CONTINUATION_COUNT 16
+// NOTE(joon) : Both of these should be power of 2
+#define JOB_DEQUE_CAPACITY 4096
+#define JOB_POOL_CAPACITY 4096
+
+struct job
+{
+	job_callback *callback;
+	void *data;
+	const char *name;
+
+	u32 start;
+	u32 onePastEnd;
+	// If this is not 0, the job will split [start, onePastEnd) into child jobs of this size
+	// instead of calling the callback by itself
+	u32 batchSize;
+
+	job *parent;
+
+	// NOTE(joon) : itself + children that are not finished yet
+	std::atomic<i32> unfinishedJobCount;
+	// NOTE(joon) : jobs that should be finished before this job can start, +1 until the job gets submitted
+	std::atomic<i32> pendingDependencyCount;
+
+	// NOTE(joon) : jobs that are waiting for this job to be finished
+	u32 continuationCount;
+	job *continuations[MAX_JOB_CONTINUATION_COUNT];
+};
+
+// NOTE(joon) : Chase-Lev work stealing deque.
+// Only the owner pushes & pops from the bottom, every other worker steals from the top.
+struct job_deque
+{
+	std::atomic<i64> top;
+	std::atomic<i64> bottom;
+	std::atomic<job *> entries[JOB_DEQUE_CAPACITY];
+};
+
+struct job_timing
+{
+	const char *name;
+	u32 workerIndex;
+
+	// NOTE(joon) : in microseconds, relative to the job system initialization
+	u64 beginTime;
+	u64 endTime;
+};
+
+typedef void job_timing_hook(void *userData, job_timing *timing);
+
+struct job_worker
+{
+	job_deque deque;
+
+	job *jobPool;
+	u32 allocatedJobCount;
+
+	std::thread thread;
+	u32 randomSeed;
+
+	std::vector<job_timing> timings;
+};
+
+struct job_system
+{
+	job_worker *workers;
+	u32 workerCount; // including the main thread, which is always the worker 0
+
+	std::atomic<bool> isRunning;
+	std::atomic<i32> queuedJobCount;
+
+	std::mutex sleepLock;
+	std::condition_variable sleepCondition;
+
+	// NOTE(joon) : Threads that are not part of the job system(i.e render thread)
+	// cannot use a deque, so they push here
+	std::mutex externalLock;
+	std::vector<job *> externalQueue;
+	job *externalJobPool;
+	u32 externalAllocatedJobCount;
+
+	// NOTE(joon) : instrumentation
+	std::atomic<bool> shouldRecordTimings;
+	job_timing_hook *timingHook;
+	void *timingHookUserData;
+	std::chrono::steady_clock::time_point initializedTime;
+};
+
+#endif
@@ -0,0 +1,219 @@
+#include "lighting_cache.h"
+
+// NOTE(joon) : Only the parts of the light that end up inside the cache are compared,
+// so changing the specular intensity doesn't need a bake
+static b32
+IsBakedLightEqual(light *a, light *b)
+{
+	b32 result = false;
+	if (!a->isEnabled && !b->isEnabled)
+	{
+		result = true;
+	}
+	else
+	{
+		result = a->isEnabled == b->isEnabled &&
+				a->type == b->type &&
+				a->p == b->p &&
+				a->IAmbient == b->IAmbient &&
+				a->IDiffuse == b->IDiffuse &&
+				a->c1 == b->c1 && a->c2 == b->c2 && a->c3 == b->c3 &&
+				a->innerConeAngleCos == b->innerConeAngleCos &&
+				a->outerConeAngleCos == b->outerConeAngleCos &&
+				a->fallOff == b->fallOff;
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Same math as the light loop inside the lighting shaders, without the material & the specular.
+// sign is -1 to take out the contribution that was baked before.
+static void
+AccumulateBakedLight(baked_vertex_lighting *baked, light *light, glm::vec3 p, glm::vec3 N, r32 sign)
+{
+	if (light->isEnabled)
+	{
+		r32 distance = glm::length(light->p - p);
+		r32 attenuation = Minimum(1.0f / (light->c1 + light->c2*distance + light->c3*distance*distance), 1.0f);
+
+		switch (light->type)
+		{
+			case LightType_Point:
+			{
+				glm::vec3 L = glm::normalize(light->p - p);
+				r32 NdotL = Maximum(glm::dot(N, L), 0.0f);
+
+				baked->ambient += (sign*attenuation)*light->IAmbient;
+				baked->diffuse += (sign*attenuation*NdotL)*light->IDiffuse;
+			}break;
+
+			case LightType_Directional:
+			{
+				glm::vec3 L = glm::normalize(light->p);
+				r32 NdotL = Maximum(glm::dot(N, L), 0.0f);
+
+				baked->ambient += sign*light->IAmbient;
+				baked->diffuse += (sign*NdotL)*light->IDiffuse;
+			}break;
+
+			case LightType_SpotLight:
+			{
+				glm::vec3 D = glm::normalize(p - light->p);
+				glm::vec3 L = -D;
+				r32 NdotL = Maximum(glm::dot(N, L), 0.0f);
+
+				// NOTE(joon) : pow of a negative number is undefined in GLSL, this is what the GPUs end up doing
+				r32 cosAlpha = glm::dot(D, -glm::normalize(light->p));
+				r32 spotlightBase = (cosAlpha - light->outerConeAngleCos) / (light->innerConeAngleCos - light->outerConeAngleCos);
+				r32 spotlightEffect = powf(Maximum(spotlightBase, 0.0f), light->fallOff);
+
+				baked->ambient += (sign*attenuation)*light->IAmbient;
+				baked->diffuse += (sign*attenuation*spotlightEffect*NdotL)*light->IDiffuse;
+			}break;
+		}
+	}
+}
+
+struct bake_lighting_job_data
+{
+	lighting_cache_slot *slot;
+	struct mesh *mesh;
+	glm::mat4 world;
+	glm::mat3 normal;
+
+	// NOTE(joon) : The old lights are taken out before the new ones are added
+	light *removedLights[16];
+	u32 removedLightCount;
+	light *addedLights[16];
+	u32 addedLightCount;
+	b32 shouldClear;
+};
+
+static void
+BakeLightingJob(void *data, u32 start, u32 onePastEnd)
+{
+	bake_lighting_job_data *jobData = (bake_lighting_job_data *)data;
+	vertex *vertices = jobData->mesh->vertexBuffer.data();
+	baked_vertex_lighting *bakedVertices = jobData->slot->bakedVertices.data();
+
+	for (u32 vertexIndex = start;
+		vertexIndex < onePastEnd;
+		++vertexIndex)
+	{
+		vertex *v = vertices + vertexIndex;
+		glm::vec3 p = glm::vec3(jobData->world*glm::vec4(v->p, 1.0f));
+		glm::vec3 N = glm::normalize(jobData->normal*v->normal);
+
+		baked_vertex_lighting *baked = bakedVertices + vertexIndex;
+		if (jobData->shouldClear)
+		{
+			*baked = {};
+		}
+
+		for (u32 lightIndex = 0;
+			lightIndex < jobData->removedLightCount;
+			++lightIndex)
+		{
+			AccumulateBakedLight(baked, jobData->removedLights[lightIndex], p, N, -1.0f);
+		}
+		for (u32 lightIndex = 0;
+			lightIndex < jobData->addedLightCount;
+			++lightIndex)
+		{
+			AccumulateBakedLight(baked, jobData->addedLights[lightIndex], p, N, 1.0f);
+		}
+	}
+}
+
+// NOTE(joon) : Brings the slot up to date with the lights, only baking the lights that have changed if possible.
+// Returns true when the slot was baked, which means that it should be uploaded again.
+static b32
+UpdateLightingCacheSlot(lighting_cache *cache, u32 slotIndex, job_system *jobSystem,
+						model *model, glm::mat4 *world, glm::mat4 *normal, light *lights, u32 lightCount)
+{
+	Assert(slotIndex < LIGHTING_CACHE_SLOT_COUNT);
+	lighting_cache_slot *slot = cache->slots + slotIndex;
+	Assert(lightCount == ArrayCount(slot->lights));
+
+	mesh *mesh = &model->mesh;
+	u32 vertexCount = (u32)mesh->vertexBuffer.size();
+
+	bake_lighting_job_data jobData = {};
+	jobData.slot = slot;
+	jobData.mesh = mesh;
+	jobData.world = *world;
+	jobData.normal = glm::mat3(*normal);
+
+	b32 shouldBakeAll = !slot->isValid || slot->model != model || slot->vertexCount != vertexCount ||
+						slot->world != *world || slot->incrementalUpdateCount >= LIGHTING_CACHE_MAX_INCREMENTAL_UPDATE_COUNT;
+	if (!shouldBakeAll)
+	{
+		for (u32 lightIndex = 0;
+			lightIndex < lightCount;
+			++lightIndex)
+		{
+			if (!IsBakedLightEqual(slot->lights + lightIndex, lights + lightIndex))
+			{
+				jobData.removedLights[jobData.removedLightCount++] = slot->lights + lightIndex;
+				jobData.addedLights[jobData.addedLightCount++] = lights + lightIndex;
+			}
+		}
+		shouldBakeAll = jobData.addedLightCount > LIGHTING_CACHE_MAX_INCREMENTAL_LIGHT_COUNT;
+	}
+
+	if (shouldBakeAll)
+	{
+		jobData.removedLightCount = 0;
+		jobData.addedLightCount = 0;
+		jobData.shouldClear = true;
+		for (u32 lightIndex = 0;
+			lightIndex < lightCount;
+			++lightIndex)
+		{
+			if (lights[lightIndex].isEnabled)
+			{
+				jobData.addedLights[jobData.addedLightCount++] = lights + lightIndex;
+			}
+		}
+	}
+
+	b32 result = false;
+	if (shouldBakeAll || jobData.addedLightCount)
+	{
+		std::chrono::steady_clock::time_point bakeStart = std::chrono::steady_clock::now();
+
+		slot->bakedVertices.resize(vertexCount);
+		ParallelFor(jobSystem, BakeLightingJob, &jobData, "BakeLighting", vertexCount, 256);
+
+		std::chrono::duration<r64, std::milli> bakeTime = std::chrono::steady_clock::now() - bakeStart;
+		cache->lastBakeTime = bakeTime.count();
+		cache->lastBakedLightCount = jobData.addedLightCount;
+
+		if (shouldBakeAll)
+		{
+			slot->model = model;
+			slot->vertexCount = vertexCount;
+			slot->world = *world;
+			slot->incrementalUpdateCount = 0;
+			slot->isValid = true;
+			++cache->fullBakeCount;
+		}
+		else
+		{
+			++slot->incrementalUpdateCount;
+			++cache->incrementalBakeCount;
+		}
+
+		// NOTE(joon) : The removed lights point into the slot, so this should come after the bake
+		for (u32 lightIndex = 0;
+			lightIndex < lightCount;
+			++lightIndex)
+		{
+			slot->lights[lightIndex] = lights[lightIndex];
+		}
+
+		result = true;
+	}
+
+	return result;
+}
@@ -0,0 +1,53 @@
+#ifndef LIGHTING_CACHE_H
+#define LIGHTING_CACHE_H
+
+// NOTE(joon) : When the lights are not moving, the ambient & diffuse part of the lighting only depends on the lights
+// and the vertex itself. The build stage bakes them per vertex whenever a light changes,
+// and the lighting shaders only add the view dependent specular on top of the cache.
+//
+// The material(kAmbient, kDiffuse, textures) and the global ambient are not baked, so changing them is free.
+// Only the lights that were changed since the last bake are updated, by taking out their old contribution
+// and adding the new one. The per vertex result is interpolated, so the meshes that are too coarse
+// (i.e the floor quad) are still lit per fragment.
+
+#define LIGHTING_CACHE_SLOT_COUNT 2 // floor & the selected model
+#define LIGHTING_CACHE_MIN_VERTEX_COUNT 256
+// NOTE(joon) : When more lights than this have changed, it's cheaper to bake everything again
+#define LIGHTING_CACHE_MAX_INCREMENTAL_LIGHT_COUNT 4
+// NOTE(joon) : The incremental updates slowly pile up the floating point error, so everything is baked again after this many
+#define LIGHTING_CACHE_MAX_INCREMENTAL_UPDATE_COUNT 256
+
+// NOTE(joon) : Two RGB32F texels of the buffer texture, fetched with gl_VertexID.
+// The build stage only touches the cache, the buffer textures are inside the render context.
+struct baked_vertex_lighting
+{
+	glm::vec3 ambient;
+	glm::vec3 diffuse;
+};
+
+struct lighting_cache_slot
+{
+	// NOTE(joon) : What the cache was baked with, a different model or matrix means that everything should be baked again
+	struct model *model;
+	u32 vertexCount;
+	glm::mat4 world;
+	light lights[16];
+	u32 incrementalUpdateCount;
+	b32 isValid;
+
+	std::vector<baked_vertex_lighting> bakedVertices;
+};
+
+struct lighting_cache
+{
+	b32 isSupported; // the buffer textures were created, should be set before the first build
+	lighting_cache_slot slots[LIGHTING_CACHE_SLOT_COUNT];
+
+	// NOTE(joon) : stats
+	u32 fullBakeCount;
+	u32 incrementalBakeCount;
+	u32 lastBakedLightCount;
+	r64 lastBakeTime; // in ms
+};
+
+#endif
@@ -37,15 +37,25 @@ typedef double r64;
 
 #define ArrayCount(Array) (sizeof(Array) / sizeof(Array[0]))
 
+#define Minimum(a, b) ((a < b) ? a : b)
+#define Maximum(a, b) ((a > b)? a : b)
+
 #define Pi32 3.1415926535897932384f
 #define Two_Pi32 6.2831853071795864768f
 
-#include "render.cpp"
-#include "obj_reader.cpp"
-
 #include "imgui/imgui_impl_glfw.h"
 #include "imgui/imgui_impl_opengl3.h"
 
+#include "job_system.cpp"
+#include "command_buffer.cpp"
+#include "render.cpp"
+#include "asset_pack.cpp"
+#include "async_io.cpp"
+#include "obj_reader.cpp"
+#include "ply_reader.cpp"
+#include "gltf_reader.cpp"
+#include "meshlet.cpp"
+
 static r32
 Clamp(r32 min, r32 value, r32 max)
 {
@@ -70,17 +80,11 @@ struct read_file_result
 static void
 ReadFile(std::vector<char>* buffer, const char* fileName)
 {
-	std::ifstream file(fileName, std::ios::ate | std::ios::binary);
-
-	if (file.is_open())
+	asset_file file;
+	if (ReadAssetFile(fileName, &file))
 	{
-		size_t fileSize = (size_t)file.tellg();
-		buffer->resize(fileSize);
-
-		file.seekg(0);
-		file.read(buffer->data(), fileSize);
-
-		file.close();
+		buffer->assign((char *)file.data, (char *)file.data + file.size);
+		CloseAssetFile(&file);
 	}
 	else
 	{
@@ -136,39 +140,11 @@ LoadShaderSpirV(const char* vertexShaderCodePath, const char* fragmentShaderCode
 }
 
 #include <string>
+// NOTE(joon) : The paths are only for the messages
 GLuint
-LoadShaders(const char* vertex_file_path, const char* fragment_file_path)
+CreateShaderProgram(const char* vertex_file_path, const char *VertexSourcePointer,
+					const char* fragment_file_path, const char *FragmentSourcePointer)
 {
-	// Read the Vertex Shader code from the file
-	std::string VertexShaderCode;
-	std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
-	if (VertexShaderStream.is_open()) {
-		std::string Line;
-		while (getline(VertexShaderStream, Line))
-			VertexShaderCode += "\n" + Line;
-		VertexShaderStream.close();
-	}
-	else 
-	{
-		printf("Impossible to open %s.\n", vertex_file_path);
-		return 0;
-	}
-
-	// Read the Fragment Shader code from the file
-	std::string FragmentShaderCode;
-	std::ifstream FragmentShaderStream(fragment_file_path, std::ios::in);
-	if (FragmentShaderStream.is_open()) {
-		std::string Line;
-		while (getline(FragmentShaderStream, Line))
-			FragmentShaderCode += "\n" + Line;
-		FragmentShaderStream.close();
-	}
-	else 
-	{
-		printf("Impossible to open %s.\n", fragment_file_path);
-		return 0;
-	}
-
 	// Create the shaders
 	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
 	GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
@@ -179,7 +155,6 @@ LoadShaders(const char* vertex_file_path, const char* fragment_file_path)
 
 	// Compile Vertex Shader
 	printf("Compiling shader : %s\n", vertex_file_path);
-	char const* VertexSourcePointer = VertexShaderCode.c_str();
 	glShaderSource(VertexShaderID, 1, &VertexSourcePointer, nullptr);
 	glCompileShader(VertexShaderID);
 
@@ -194,7 +169,6 @@ LoadShaders(const char* vertex_file_path, const char* fragment_file_path)
 
 	// Compile Fragment Shader
 	printf("Compiling shader : %s\n", fragment_file_path);
-	char const* FragmentSourcePointer = FragmentShaderCode.c_str();
 	glShaderSource(FragmentShaderID, 1, &FragmentSourcePointer, nullptr);
 	glCompileShader(FragmentShaderID);
 
@@ -243,6 +217,91 @@ LoadShaders(const char* vertex_file_path, const char* fragment_file_path)
 	return programID;
 }
 
+// NOTE(joon) : shouldReadLooseFiles skips the asset pack, so that the shaders that are being edited can be reloaded
+GLuint
+LoadShaders(const char* vertex_file_path, const char* fragment_file_path, b32 shouldReadLooseFiles = false)
+{
+	// Read the Vertex Shader code from the file
+	std::string VertexShaderCode;
+	if (!ReadAssetText(vertex_file_path, &VertexShaderCode, shouldReadLooseFiles))
+	{
+		printf("Impossible to open %s.\n", vertex_file_path);
+		return 0;
+	}
+
+	// Read the Fragment Shader code from the file
+	std::string FragmentShaderCode;
+	if (!ReadAssetText(fragment_file_path, &FragmentShaderCode, shouldReadLooseFiles))
+	{
+		printf("Impossible to open %s.\n", fragment_file_path);
+		return 0;
+	}
+
+	return CreateShaderProgram(vertex_file_path, VertexShaderCode.c_str(), fragment_file_path, FragmentShaderCode.c_str());
+}
+
+// NOTE(joon) : Returns 0 when it fails
+static GLuint
+LoadComputeShader(const char *computeShaderPath)
+{
+	std::string shaderCode;
+	if (!ReadAssetText(computeShaderPath, &shaderCode))
+	{
+		printf("Impossible to open %s.\n", computeShaderPath);
+		return 0;
+	}
+
+	printf("Compiling shader : %s\n", computeShaderPath);
+	GLuint shaderID = glCreateShader(GL_COMPUTE_SHADER);
+	char const *sourcePointer = shaderCode.c_str();
+	glShaderSource(shaderID, 1, &sourcePointer, nullptr);
+	glCompileShader(shaderID);
+
+	GLint isShaderValid = GL_FALSE;
+	int infoLogLength;
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &isShaderValid);
+	glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &infoLogLength);
+	if (infoLogLength > 0)
+	{
+		std::vector<char> errorMessage(infoLogLength + 1);
+		glGetShaderInfoLog(shaderID, infoLogLength, nullptr, &errorMessage[0]);
+		printf("%s\n", &errorMessage[0]);
+	}
+
+	GLuint programID = 0;
+	if (isShaderValid)
+	{
+		programID = glCreateProgram();
+		glAttachShader(programID, shaderID);
+		glLinkProgram(programID);
+
+		GLint isProgramValid = GL_FALSE;
+		glGetProgramiv(programID, GL_LINK_STATUS, &isProgramValid);
+		if (isProgramValid)
+		{
+			printf("Program succefully created and linked!\n\n");
+		}
+		else
+		{
+			glGetProgramiv(programID, GL_INFO_LOG_LENGTH, &infoLogLength);
+			std::vector<char> errorMessage(infoLogLength + 1);
+			glGetProgramInfoLog(programID, infoLogLength, nullptr, &errorMessage[0]);
+			printf("%s\n", &errorMessage[0]);
+
+			glDeleteProgram(programID);
+			programID = 0;
+		}
+	}
+	else
+	{
+		printf("compute shader is not valid, cannot make a program\n\n");
+	}
+
+	glDeleteShader(shaderID);
+
+	return programID;
+}
+
 // preset 1 : Every light is the same type
 static void 
 ConfigureLightPreset1(light *lights, u32 lightCount)
@@ -340,9 +399,354 @@ ConfigureLightPreset3(light *lights, u32 lightCount)
 	}
 }
 
-int main()
+// TODO(joon) : DO NOT HARD CODE THE MODEL COUNT!
+static const char *modelFileNames[] = { "4Sphere.obj",
+										"bunny.obj",
+										"bunny_high_poly.obj",
+										"cube.obj",
+										"cube2.obj",
+										"cup.obj",
+										"lucy_princeton.ply",
+										"quad.obj",
+										"rhino.obj",
+										"sphere.obj",
+										"sphere_modified.obj",
+										"starwars1.obj",
+										"triangle.obj" };
+
+struct load_model_job_data
+{
+	job_system *jobSystem;
+	struct model *model;
+	std::string filePath;
+	async_read *read;
+};
+
+// NOTE(joon) : Completion of the model file read
+static void
+LoadModelJob(void *data, u32 start, u32 onePastEnd)
+{
+	load_model_job_data *jobData = (load_model_job_data *)data;
+	async_read *read = jobData->read;
+	if (!read->isValid)
+	{
+		// NOTE(joon) : A failed read can still hold the storage or the mapping
+		printf("Failed to read %s\n", read->path);
+		CloseAssetFile(&read->file);
+		return;
+	}
+
+	// NOTE(joon) : Big scans are stored as the binary ply, the assets from the content pipeline are gltf,
+	// and everything else is obj
+	size_t extensionStart = jobData->filePath.rfind('.');
+	std::string extension = (extensionStart != std::string::npos) ? jobData->filePath.substr(extensionStart) : "";
+	if (extension == ".ply")
+	{
+		ParsePLYFile(jobData->jobSystem, &jobData->model->mesh, read->file.data, read->file.size, read->path);
+	}
+	else if (extension == ".gltf" || extension == ".glb")
+	{
+		ParseGLTFFile(jobData->jobSystem, &jobData->model->mesh, read->file.data, read->file.size, read->path);
+	}
+	else
+	{
+		ParseOBJFile(jobData->jobSystem, &jobData->model->mesh, (char *)read->file.data, read->file.size, read->path);
+	}
+	CloseAssetFile(&read->file);
+
+	jobData->model->boundingRadius = GetBoundingRadius(&jobData->model->mesh);
+	GetBoundingBox(&jobData->model->mesh, &jobData->model->boundsMin, &jobData->model->boundsMax);
+	BuildMeshlets(&jobData->model->mesh);
+}
+
+static void
+SetupModelRead(job_system *jobSystem, model *model, const char *fileName, load_model_job_data *data, async_read *read)
+{
+	std::string directoryPath = "textures/";
+
+	data->jobSystem = jobSystem;
+	data->model = model;
+	data->filePath = directoryPath + fileName;
+	data->read = read;
+
+	read->path = data->filePath.c_str();
+	read->completion = LoadModelJob;
+	read->completionData = data;
+}
+
+// NOTE(joon) : Every model is read in one batch, and each of them gets parsed as soon as its file is read.
+// The parsing is split further inside the loaders.
+static void
+LoadModels(job_system *jobSystem, model *models, const char **fileNames, u32 modelCount, async_io *io = 0)
+{
+	std::vector<load_model_job_data> loadModelJobData(modelCount);
+	std::vector<async_read> reads(modelCount);
+	for (u32 modelIndex = 0;
+		modelIndex < modelCount;
+		++modelIndex)
+	{
+		SetupModelRead(jobSystem, models + modelIndex, fileNames[modelIndex], loadModelJobData.data() + modelIndex, reads.data() + modelIndex);
+	}
+	ReadAssetFilesAsync(jobSystem, io, reads.data(), modelCount);
+}
+
+#include "model_registry.cpp"
+
+// NOTE(joon) : The models that the first frame draws(the floor & the model that is selected by default),
+// the others are loaded when they are selected
+static u32 startupModelIndices[] = { ModelType_quad, ModelType_4Sphere };
+
+// NOTE(joon) : vertex & fragment shader of each program that is created at the startup
+static const char *startupShaderFileNames[] = { "source/shaders/plain_shader.vert",
+												"source/shaders/plain_shader.frag",
+												"source/shaders/phong_shading_shader.vert",
+												"source/shaders/phong_shading_shader.frag",
+												"source/shaders/phong_lighting_shader.vert",
+												"source/shaders/phong_lighting_shader.frag",
+												"source/shaders/blinn_shader.vert",
+												"source/shaders/blinn_shader.frag",
+												"source/shaders/depth_only_shader.vert",
+												"source/shaders/depth_only_shader.frag" };
+
+static const char *startupTextureFileNames[] = { "textures/metal_roof_diff_512x512.png",
+												"textures/metal_roof_spec_512x512.png" };
+
+struct startup_texture
+{
+	async_read *read;
+
+	stbi_uc *texels; // 0 if it failed, should be freed with stbi_image_free
+	int width;
+	int height;
+};
+
+struct startup_assets
+{
+	startup_texture textures[ArrayCount(startupTextureFileNames)];
+	std::string shaderSources[ArrayCount(startupShaderFileNames)];
+};
+
+// NOTE(joon) : Completion of the texture file read
+static void
+DecodeStartupTextureJob(void *data, u32 start, u32 onePastEnd)
+{
+	startup_texture *texture = (startup_texture *)data;
+	async_read *read = texture->read;
+	if (read->isValid)
+	{
+		int channelCount = 0;
+		texture->texels = stbi_load_from_memory(read->file.data, (int)read->file.size, &texture->width, &texture->height,
+												&channelCount, STBI_rgb);
+	}
+	if (!texture->texels)
+	{
+		printf("Failed to load the texture %s\n", read->path);
+	}
+	CloseAssetFile(&read->file);
+}
+
+// NOTE(joon) : Everything that the app reads before the first frame goes in one batch, so that all the reads are in flight together.
+// The startup models are parsed into the registry & the textures are decoded as soon as each of them is read.
+// Shaders are only read, as they should be compiled on the GL thread.
+static void
+LoadStartupAssets(job_system *jobSystem, async_io *io, startup_assets *assets, model_registry *registry)
+{
+	u32 modelCount = ArrayCount(startupModelIndices);
+	u32 textureCount = ArrayCount(startupTextureFileNames);
+	u32 shaderCount = ArrayCount(startupShaderFileNames);
+
+	std::vector<async_read> reads(modelCount + textureCount + shaderCount);
+	async_read *textureReads = reads.data() + modelCount;
+	async_read *shaderReads = textureReads + textureCount;
+
+	for (u32 modelIndex = 0;
+		modelIndex < modelCount;
+		++modelIndex)
+	{
+		SetupRegistryModelRead(registry, startupModelIndices[modelIndex], reads.data() + modelIndex);
+	}
+	for (u32 textureIndex = 0;
+		textureIndex < textureCount;
+		++textureIndex)
+	{
+		startup_texture *texture = assets->textures + textureIndex;
+		*texture = {};
+		texture->read = textureReads + textureIndex;
+		texture->read->path = startupTextureFileNames[textureIndex];
+		texture->read->completion = DecodeStartupTextureJob;
+		texture->read->completionData = texture;
+	}
+	for (u32 shaderIndex = 0;
+		shaderIndex < shaderCount;
+		++shaderIndex)
+	{
+		shaderReads[shaderIndex].path = startupShaderFileNames[shaderIndex];
+	}
+
+	ReadAssetFilesAsync(jobSystem, io, reads.data(), (u32)reads.size());
+
+	for (u32 shaderIndex = 0;
+		shaderIndex < shaderCount;
+		++shaderIndex)
+	{
+		async_read *read = shaderReads + shaderIndex;
+		if (read->isValid)
+		{
+			assets->shaderSources[shaderIndex].assign((char *)read->file.data, read->file.size);
+		}
+		else
+		{
+			printf("Impossible to open %s.\n", read->path);
+		}
+		CloseAssetFile(&read->file);
+	}
+
+	for (u32 textureIndex = 0;
+		textureIndex < textureCount;
+		++textureIndex)
+	{
+		assets->textures[textureIndex].read = 0;
+	}
+}
+
+static void
+FreeStartupTextures(startup_assets *assets)
+{
+	for (u32 textureIndex = 0;
+		textureIndex < ArrayCount(assets->textures);
+		++textureIndex)
+	{
+		stbi_image_free(assets->textures[textureIndex].texels);
+		assets->textures[textureIndex].texels = 0;
+	}
+}
+
+// NOTE(joon) : Creates the startup program from the sources of startupShaderFileNames[2*programIndex], [2*programIndex + 1]
+static GLuint
+CreateStartupProgram(startup_assets *assets, u32 programIndex)
+{
+	GLuint result = 0;
+	u32 vertexShaderIndex = 2*programIndex;
+	u32 fragmentShaderIndex = vertexShaderIndex + 1;
+	if (!assets->shaderSources[vertexShaderIndex].empty() && !assets->shaderSources[fragmentShaderIndex].empty())
+	{
+		result = CreateShaderProgram(startupShaderFileNames[vertexShaderIndex], assets->shaderSources[vertexShaderIndex].c_str(),
+									startupShaderFileNames[fragmentShaderIndex], assets->shaderSources[fragmentShaderIndex].c_str());
+	}
+
+	return result;
+}
+
+#include "gpu_culling.cpp"
+#include "deferred_shading.cpp"
+#include "shadow_maps.cpp"
+#include "dynamic_resolution.cpp"
+#include "frame_capture.cpp"
+#include "render_thread.cpp"
+#include "occlusion.cpp"
+#include "lighting_cache.cpp"
+#include "frame_pipeline.cpp"
+#include "software_renderer.cpp"
+#include "benchmark.cpp"
+
+// NOTE(joon) : Renders a frame of the default scene with the software renderer into a PNG without creating a window,
+// so this also works on the machines without a GPU. Run with
+// openGL_playground.exe --software <output.png> [width] [height] [shader index]
+static int
+RunSoftwareRenderer(int argc, char **argv)
+{
+	const char *fileName = (argc > 0) ? argv[0] : "software.png";
+	i32 width = (argc > 1) ? Maximum(atoi(argv[1]), 1) : 1920;
+	i32 height = (argc > 2) ? Maximum(atoi(argv[2]), 1) : 1080;
+	i32 programIndex = (argc > 3) ? (i32)Clamp(0.0f, (r32)atoi(argv[3]), 2.0f) : 0;
+
+	job_system jobSystem;
+	InitializeJobSystem(&jobSystem, 0);
+
+	headless_scene headless = {};
+	InitializeHeadlessScene(&headless, &jobSystem, width, height);
+	headless.scene.selectedProgramIndex = programIndex;
+	frame_packet *packet = BuildHeadlessFrame(&headless);
+
+	software_renderer renderer = {};
+	InitializeSoftwareRenderer(&renderer, width, height);
+	LoadSoftwareTexture(&renderer.diffuseTexture, "textures/metal_roof_diff_512x512.png");
+	RenderFramePacketInSoftware(&renderer, &jobSystem, packet);
+	printf("%u/%u triangles, %llu pixels, vertex : %.2fms, setup : %.2fms, rasterize : %.2fms with %u workers\n",
+			renderer.rasterizedTriangleCount, renderer.submittedTriangleCount, (unsigned long long)renderer.shadedPixelCount,
+			renderer.vertexTime, renderer.setupTime, renderer.rasterizeTime, jobSystem.workerCount);
+
+	int result = WritePNG(fileName, renderer.color, width, height, renderer.stride) ? 0 : -1;
+
+	FreeSoftwareRenderer(&renderer);
+	FreeHeadlessScene(&headless);
+	ShutdownJobSystem(&jobSystem);
+
+	return result;
+}
+
+// NOTE(joon) : --pack [output] [directories...], packs the textures & the shaders by default.
+// The app mounts ASSET_PACK_DEFAULT_FILE_NAME from the working directory if it exists.
+static int
+RunAssetPackBuilder(int argc, char **argv)
+{
+	const char *outputFileName = (argc > 0) ? argv[0] : ASSET_PACK_DEFAULT_FILE_NAME;
+	std::vector<const char *> directories;
+	for (int argIndex = 1;
+		argIndex < argc;
+		++argIndex)
+	{
+		directories.push_back(argv[argIndex]);
+	}
+	if (directories.empty())
+	{
+		directories.push_back("textures");
+		directories.push_back("source/shaders");
+	}
+
+	job_system jobSystem;
+	InitializeJobSystem(&jobSystem, 0);
+	b32 isBuilt = BuildAssetPack(&jobSystem, outputFileName, directories.data(), (u32)directories.size());
+	ShutdownJobSystem(&jobSystem);
+
+	asset_pack pack;
+	if (!isBuilt || !OpenAssetPack(&pack, outputFileName))
+	{
+		return -1;
+	}
+	b32 isValid = VerifyAssetPack(&pack);
+	CloseAssetPack(&pack);
+
+	return isValid ? 0 : -1;
+}
+
+int main(int argc, char **argv)
 {
 	srand ((u32)time(NULL));
+
+	if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+	{
+		return RunBenchmarks(argc - 2, argv + 2);
+	}
+	if (argc > 1 && strcmp(argv[1], "--pack") == 0)
+	{
+		return RunAssetPackBuilder(argc - 2, argv + 2);
+	}
+
+	asset_pack assetPack = {};
+	if (OpenAssetPack(&assetPack, ASSET_PACK_DEFAULT_FILE_NAME))
+	{
+		MountAssetPack(&assetPack);
+		printf("Using %u assets from %s\n", assetPack.header->entryCount, ASSET_PACK_DEFAULT_FILE_NAME);
+	}
+
+	if (argc > 1 && strcmp(argv[1], "--software") == 0)
+	{
+		int result = RunSoftwareRenderer(argc - 2, argv + 2);
+		CloseAssetPack(&assetPack);
+		return result;
+	}
+
 	if (!glfwInit())
 	{
 		printf("Failed to initialize GLFW\n");
@@ -394,33 +798,20 @@ int main()
 
 	printf("Status: Using GLEW %s\n", glewGetString(GLEW_VERSION));
 
-	// TODO(joon) : DO NOT HARD CODE THE MODEL COUNT!
-	std::vector<std::string>textureNames = { "4Sphere.obj",
-											"bunny.obj",
-											"bunny_high_poly.obj",
-											"cube.obj",
-											"cube2.obj",
-											"cup.obj",
-											"lucy_princeton.obj",
-											"quad.obj",
-											"rhino.obj",
-											"sphere.obj",
-											"sphere_modified.obj",
-											"starwars1.obj",
-											"triangle.obj" };
-
-	std::vector<model> models(textureNames.size());
-	for (u32 textureNameIndex = 0;
-		textureNameIndex < textureNames.size();
-		++textureNameIndex)
-	{
-		model* model = models.data() + textureNameIndex;
-
-		std::string directoryPath = "textures/";
-		std::string filePath = directoryPath + textureNames[textureNameIndex].c_str();
-
-		ReadOBJFileLineByLine(&model->mesh, filePath.c_str());
-	}
+	// NOTE(joon) : main thread is also one of the workers
+	job_system jobSystem;
+	InitializeJobSystem(&jobSystem, 0);
+	printf("Job system is using %u workers\n", jobSystem.workerCount);
+
+	async_io asyncIO;
+	InitializeAsyncIO(&asyncIO);
+	printf("Assets are read with %s\n", GetAsyncIOBackendName(asyncIO.backend));
+
+	model_registry modelRegistry;
+	InitializeModelRegistry(&modelRegistry, &jobSystem, &asyncIO, true);
+
+	startup_assets startupAssets;
+	LoadStartupAssets(&jobSystem, &asyncIO, &startupAssets, &modelRegistry);
 	
 	std::vector<const char *>vertexShaderPaths = 
 	{
@@ -436,47 +827,14 @@ int main()
 		"source/shaders/blinn_shader.frag"
 	};
 
-	GLuint plainProgram = LoadShaders("source/shaders/plain_shader.vert", "source/shaders/plain_shader.frag");
+	GLuint plainProgram = CreateStartupProgram(&startupAssets, 0);
 
 	GLuint lightingPrograms[3] = {};
-	lightingPrograms[0] = LoadShaders(vertexShaderPaths[0], fragmentShaderPaths[0]);
-	lightingPrograms[1] = LoadShaders(vertexShaderPaths[1], fragmentShaderPaths[1]);
-	lightingPrograms[2] = LoadShaders(vertexShaderPaths[2], fragmentShaderPaths[2]);
-
-	for (u32 modelIndex = 0;
-		modelIndex < models.size();
-		++modelIndex)
-	{
-		model* model = models.data() + modelIndex;
+	lightingPrograms[0] = CreateStartupProgram(&startupAssets, 1);
+	lightingPrograms[1] = CreateStartupProgram(&startupAssets, 2);
+	lightingPrograms[2] = CreateStartupProgram(&startupAssets, 3);
 
-		glGenVertexArrays(1, &model->vertexArrayID);
-		glBindVertexArray(model->vertexArrayID);
-
-		glGenBuffers(1, &model->vertexBufferID);
-		glBindBuffer(GL_ARRAY_BUFFER, model->vertexBufferID);
-		glBufferData(GL_ARRAY_BUFFER,
-			model->mesh.vertexBuffer.size() * sizeof(vertex), model->mesh.vertexBuffer.data(),
-			GL_STATIC_DRAW);
-
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vertex), (void *)offsetof(vertex, p));
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(vertex), (void *)offsetof(vertex, normal));
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), (void *)offsetof(vertex, texCoord));
-		glEnableVertexAttribArray(2);
-
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
-
-		glGenBuffers(1, &model->indexBufferID);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model->indexBufferID);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, model->mesh.indexBuffer.size() * sizeof(unsigned int), model->mesh.indexBuffer.data(),
-			GL_STATIC_DRAW);
-
-		glBindVertexArray(0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-	}
+	GLuint depthOnlyProgram = CreateStartupProgram(&startupAssets, 4);
 
 	// NOTE(joon) : Create uniform buffer to pass information into shaders
 	GLuint perFrameUboID;
@@ -512,6 +870,8 @@ int main()
 	// NOTE(joon) : Generate custom sphere model
 	model sphereModel;
 	GenerateSphereModel(&sphereModel, 0.5f, 72, 24);
+	sphereModel.boundingRadius = GetBoundingRadius(&sphereModel.mesh);
+	GetBoundingBox(&sphereModel.mesh, &sphereModel.boundsMin, &sphereModel.boundsMax);
 	glGenVertexArrays(1, &sphereModel.vertexArrayID);
 	glEnableVertexAttribArray(0);
 	glEnableVertexAttribArray(1);
@@ -532,59 +892,152 @@ int main()
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sphereModel.mesh.indexBuffer.size() * sizeof(unsigned int), sphereModel.mesh.indexBuffer.data(),
 		GL_STATIC_DRAW);
 
+	sphereModel.uploadedVertexCount = (u32)sphereModel.mesh.vertexBuffer.size();
+	sphereModel.uploadedIndexCount = (u32)sphereModel.mesh.indexBuffer.size();
+
 	glBindVertexArray(0);
+	UploadModelPositions(&sphereModel);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	glDisableVertexAttribArray(0);
 	glDisableVertexAttribArray(1);
 
-	// NOTE(joon) : Create face normal buffer for GL_LINES
-	for (u32 modelIndex = 0;
-		modelIndex < models.size();
-		++modelIndex)
+	// NOTE(joon) : GPU culled instances of the sphere, needs GL 4.3
+	gpu_culling gpuCulling = {};
+	GLuint instancedProgram = 0;
+	b32 isGPUCullingSupported = GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object && GLEW_ARB_multi_draw_indirect;
+	if (isGPUCullingSupported)
+	{
+		isGPUCullingSupported = InitializeGPUCulling(&gpuCulling, &sphereModel, MAX_GPU_INSTANCE_COUNT);
+		instancedProgram = LoadShaders("source/shaders/instanced_shader.vert", "source/shaders/instanced_shader.frag");
+	}
+	else
 	{
-		model* model = models.data() + modelIndex;
+		printf("GPU culling is not supported\n");
+	}
 
-		glGenVertexArrays(1, &model->faceNormalArrayID);
-		glEnableVertexAttribArray(0);
-		glDisableVertexAttribArray(1);
-		glBindVertexArray(model->faceNormalArrayID);
+	// NOTE(joon) : Lights of each screen tile are culled by the compute shader, needs GL 4.3
+	deferred_shading deferredShading = {};
+	b32 isDeferredShadingSupported = GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object && GLEW_ARB_texture_storage;
+	if (isDeferredShadingSupported)
+	{
+		isDeferredShadingSupported = InitializeDeferredShading(&deferredShading);
+	}
+	else
+	{
+		printf("Deferred shading is not supported\n");
+	}
 
-		glGenBuffers(1, &model->faceNormalBufferID);
-		glBindBuffer(GL_ARRAY_BUFFER, model->faceNormalBufferID);
-		glBufferData(GL_ARRAY_BUFFER, model->mesh.faceNormalBuffer.size()*sizeof(line), model->mesh.faceNormalBuffer.data(),
-					GL_STATIC_DRAW);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+	// NOTE(joon) : The static depth of each shadow view is copied into the final atlas with glCopyImageSubData, needs GL 4.3
+	shadow_maps shadowMaps = {};
+	b32 isShadowMappingSupported = GLEW_ARB_copy_image && GLEW_ARB_texture_storage && depthOnlyProgram;
+	if (isShadowMappingSupported)
+	{
+		InitializeShadowMaps(&shadowMaps);
+	}
+	else
+	{
+		printf("Shadow mapping is not supported\n");
 	}
 
-	// NOTE(joon) : Create vertex normal buffer for GL_LINES
-	for (u32 modelIndex = 0;
-		modelIndex < models.size();
-		++modelIndex)
+	// NOTE(joon) : The frame is timed with the timestamp queries, which can wrap the GL_TIME_ELAPSED of the shadow passes
+	dynamic_resolution dynamicResolution = {};
+	b32 isDynamicResolutionSupported = GLEW_ARB_timer_query && GLEW_ARB_texture_storage;
+	if (isDynamicResolutionSupported)
+	{
+		isDynamicResolutionSupported = InitializeDynamicResolution(&dynamicResolution);
+	}
+	else
 	{
-		model* model = models.data() + modelIndex;
+		printf("Dynamic resolution is not supported\n");
+	}
 
-		glGenVertexArrays(1, &model->vertexNormalArrayID);
-		glEnableVertexAttribArray(0);
-		glDisableVertexAttribArray(1);
-		glBindVertexArray(model->vertexNormalArrayID);
+	// NOTE(joon) : The frames are read back into persistently mapped pixel buffers, needs GL 4.4
+	frame_capture frameCapture;
+	InitializeFrameCapture(&frameCapture);
+	b32 isFrameCaptureSupported = GLEW_ARB_buffer_storage;
+	if (!isFrameCaptureSupported)
+	{
+		printf("Frame capture is not supported\n");
+	}
 
-		glGenBuffers(1, &model->vertexNormalBufferID);
-		glBindBuffer(GL_ARRAY_BUFFER, model->vertexNormalBufferID);
-		glBufferData(GL_ARRAY_BUFFER, model->mesh.vertexNormalLineBuffer.size()*sizeof(line), model->mesh.vertexNormalLineBuffer.data(),
-					GL_STATIC_DRAW);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+	// NOTE(joon) : Always bound, the lighting programs see no shadows when it's zero
+	GLuint shadowUboID;
+	glGenBuffers(1, &shadowUboID);
+	glBindBuffer(GL_UNIFORM_BUFFER, shadowUboID);
+	shadow_ubo emptyShadowUbo = {};
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(shadow_ubo), &emptyShadowUbo, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, SHADOW_UBO_BINDING, shadowUboID);
+
+	// NOTE(joon) : Face & vertex normals are pulled from the model buffers inside the vertex shader, needs GL 4.3
+	GLuint normalLineProgram = 0;
+	b32 canDrawNormalLines = GLEW_ARB_shader_storage_buffer_object && GLEW_ARB_explicit_uniform_location;
+	if (canDrawNormalLines)
+	{
+		normalLineProgram = LoadShaders("source/shaders/normal_line_shader.vert", "source/shaders/plain_shader.frag");
+		canDrawNormalLines = (normalLineProgram != 0);
+	}
+	else
+	{
+		printf("Drawing the normals is not supported\n");
+	}
+
+	// NOTE(joon) : Texcoords of the GPU only meshes are written into their vertex buffers by the compute shader
+	GLuint texCoordMappingProgram = 0;
+	if (GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object && GLEW_ARB_explicit_uniform_location)
+	{
+		texCoordMappingProgram = LoadComputeShader("source/shaders/texcoord_mapping_shader.comp");
+	}
+	modelRegistry.canMapTexCoordsOnGPU = (texCoordMappingProgram != 0);
+	if (!modelRegistry.canMapTexCoordsOnGPU)
+	{
+		printf("GPU only meshes are not supported\n");
+	}
+
+	// NOTE(joon) : Visible meshlets are drawn with the indirect commands that the build stage uploads every frame
+	GLuint meshletIndirectBufferID = 0;
+	b32 isMeshletCullingSupported = GLEW_VERSION_4_0 || GLEW_ARB_draw_indirect;
+	if (isMeshletCullingSupported)
+	{
+		glGenBuffers(1, &meshletIndirectBufferID);
+	}
+	else
+	{
+		printf("Meshlet culling is not supported\n");
+	}
+
+	// NOTE(joon) : Baked lighting of the lighting cache slots, read by the lighting vertex shaders as buffer textures
+	GLuint bakedLightingBufferIDs[LIGHTING_CACHE_SLOT_COUNT] = {};
+	GLuint bakedLightingTextureIDs[LIGHTING_CACHE_SLOT_COUNT] = {};
+	b32 isLightingCacheSupported = GLEW_VERSION_4_0 || GLEW_ARB_texture_buffer_object_rgb32;
+	if (isLightingCacheSupported)
+	{
+		glGenBuffers(LIGHTING_CACHE_SLOT_COUNT, bakedLightingBufferIDs);
+		glGenTextures(LIGHTING_CACHE_SLOT_COUNT, bakedLightingTextureIDs);
+		for (u32 slotIndex = 0;
+			slotIndex < LIGHTING_CACHE_SLOT_COUNT;
+			++slotIndex)
+		{
+			// NOTE(joon) : The storage is created by the first upload, but the texture can already refer to the buffer
+			glBindBuffer(GL_TEXTURE_BUFFER, bakedLightingBufferIDs[slotIndex]);
+			glBufferData(GL_TEXTURE_BUFFER, sizeof(baked_vertex_lighting), 0, GL_STATIC_DRAW);
+			glBindTexture(GL_TEXTURE_BUFFER, bakedLightingTextureIDs[slotIndex]);
+			glTexBuffer(GL_TEXTURE_BUFFER, GL_RGB32F, bakedLightingBufferIDs[slotIndex]);
+		}
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	}
+	else
+	{
+		printf("Baked lighting is not supported\n");
 	}
 
 	// Generate diffuse texture
 	int textureWidth = 0;
 	int textureHeight = 0;
-	int textureChannels = 0;
-	stbi_uc *diffuseTexture = stbi_load("textures/metal_roof_diff_512x512.png", &textureWidth, &textureHeight, &textureChannels, STBI_rgb);
-	if (!diffuseTexture)
-	{
-		printf("Failed to load the texture \n");
-	}
+	stbi_uc *diffuseTexture = startupAssets.textures[0].texels;
+	textureWidth = startupAssets.textures[0].width;
+	textureHeight = startupAssets.textures[0].height;
 	GLuint diffuseTextureID = 0;
 	glGenTextures(1, &diffuseTextureID);
 	glBindTexture(GL_TEXTURE_2D, diffuseTextureID);
@@ -606,11 +1059,9 @@ int main()
 	stbi_image_free(diffuseTexture);
 
 	// Generate specular texture
-	stbi_uc *specularTexture = stbi_load("textures/metal_roof_spec_512x512.png", &textureWidth, &textureHeight, &textureChannels, STBI_rgb);
-	if (!specularTexture)
-	{
-		printf("Failed to load the texture\n");
-	}
+	stbi_uc *specularTexture = startupAssets.textures[1].texels;
+	textureWidth = startupAssets.textures[1].width;
+	textureHeight = startupAssets.textures[1].height;
 	GLuint specularTextureID = 0;
 	glGenTextures(1, &specularTextureID);
 	glBindTexture(GL_TEXTURE_2D, specularTextureID);
@@ -631,72 +1082,14 @@ int main()
 	}
 	stbi_image_free(specularTexture);
 
-	GenerateTexCoordForAllModels(&models, textureWidth, textureHeight, TextureMappingMethod_Planar, true);
-
-	camera camera;
-	camera.initP = { 13, 6, 0 };
-	camera.angle = 0.0f;
-	camera.lookAtP = { 0, 0, 0 };
-	camera.up = { 0, 1, 0 };
-	camera.fovInDegree = 45.0f;
-	camera.near = 0.1f;
-	camera.far = 100.0f;
-
-	// Initialize the lights
-	r32 lightRadius = 4.0f;
-	light lights[16] = {};
-	for (u32 lightIndex = 0;
-		lightIndex < ArrayCount(lights);
-		++lightIndex)
-	{
-		light *light = lights + lightIndex;
-		light->angle = (Two_Pi32 / ArrayCount(lights)) * lightIndex;
-
-		light->IAmbient = glm::vec3(0.8f, 0.8f, 0.8f);
-		light->IDiffuse = glm::vec3(0.8f, 0.8f, 0.8f);
-		light->ISpecular = glm::vec3(1.0f, 1.0f, 1.0f);
 
-		light->c1 = 0.2f;
-		light->c2 = 0.04f;
-		light->c3 = 0.015f;
+	scene_state scene = {};
+	InitializeScene(&scene, &modelRegistry, &sphereModel, &jobSystem, windowWidth, windowHeight);
+	scene.lightingCache.isSupported = isLightingCacheSupported;
+	scene.shadowCache.isSupported = isShadowMappingSupported;
+	scene.resolutionController.isSupported = isDynamicResolutionSupported;
 
-		// spotlight only
-		light->innerConeAngleCos = 0.9f;
-		light->outerConeAngleCos = 0.7f;
-		light->fallOff = 0.13f;
-	}
-	ConfigureLightPreset1(lights, ArrayCount(lights));
-
-	float angle = 0.0f;
 	bool isGameRunning = true;
-	bool shouldDrawVertexNormal = false;
-	bool shouldDrawFaceNormal = false;
-	bool shouldLightRotate = true;
-	i32 selectedProgramIndex = 0;
-
-	// imgui texture options
-	bool shouldRemapTexture = true;
-	int selectedMappingLocationIndex = TextureMappingLocation_CPU;
-	int selectedTextureEntity = 0;
-	bool didTextureEntityChanged = false;
-
-	int selectedPresetIndex = 0;
-	bool isPresetSelected = false;
-
-	int selectedModelIndex = 0;
-
-	per_frame_ubo perFrameUbo = {};
-	perFrameUbo.IFog = glm::vec3(0.2f, 0.5f, 0.7f);
-	perFrameUbo.zNear = 0.1f;
-	perFrameUbo.zFar = 20.0f;
-	perFrameUbo.shouldGenerateTexCoordInGPU = false;
-	perFrameUbo.textureMappingMethod = TextureMappingMethod_Planar;
-
-	per_object_ubo perObjectUbo = {};
-	perObjectUbo.kAmbient = 0.2f;
-	perObjectUbo.kDiffuse = 0.6f;
-	perObjectUbo.kSpecular = 0.9f;
-	perObjectUbo.ns = 10;
 
 	for (u32 programIndex = 0;
 		programIndex < ArrayCount(lightingPrograms);
@@ -707,279 +1100,261 @@ int main()
 		glUniform1i(glGetUniformLocation(lightingPrograms[programIndex], "specularTexture"), 1);
 	}
 
+	render_context renderContext = {};
+	renderContext.jobSystem = &jobSystem;
+	renderContext.sphereModel = &sphereModel;
+	renderContext.vertexShaderPaths = vertexShaderPaths.data();
+	renderContext.fragmentShaderPaths = fragmentShaderPaths.data();
+	renderContext.perFrameUboID = perFrameUboID;
+	renderContext.perObjectUboID = perObjectUboID;
+	renderContext.lineVertexArrayID = lineVertexArrayID;
+	renderContext.lineVertexBufferID = lineVertexBufferID;
+	renderContext.diffuseTextureID = diffuseTextureID;
+	renderContext.specularTextureID = specularTextureID;
+	renderContext.textureWidth = textureWidth;
+	renderContext.textureHeight = textureHeight;
+	renderContext.gpuCulling = isGPUCullingSupported ? &gpuCulling : 0;
+	renderContext.deferredShading = isDeferredShadingSupported ? &deferredShading : 0;
+	renderContext.meshletIndirectBufferID = meshletIndirectBufferID;
+	renderContext.canDrawNormalLines = canDrawNormalLines;
+	renderContext.shadowMaps = isShadowMappingSupported ? &shadowMaps : 0;
+	renderContext.shadowUboID = shadowUboID;
+	renderContext.dynamicResolution = isDynamicResolutionSupported ? &dynamicResolution : 0;
+	renderContext.frameCapture = isFrameCaptureSupported ? &frameCapture : 0;
+	for (u32 slotIndex = 0;
+		slotIndex < LIGHTING_CACHE_SLOT_COUNT;
+		++slotIndex)
+	{
+		renderContext.bakedLightingBufferIDs[slotIndex] = bakedLightingBufferIDs[slotIndex];
+		renderContext.bakedLightingTextureIDs[slotIndex] = bakedLightingTextureIDs[slotIndex];
+	}
+	renderContext.window = window;
+
+	frame_packet framePackets[FRAME_PACKET_COUNT] = {};
+	// NOTE(joon) : Each packet has its own command buffers, which should be alive until the render thread executes them.
+	// They will grow to the size they need during the first few frames.
+	std::vector<command_buffer> frameCommandBuffers(FRAME_PACKET_COUNT*MAX_COMMAND_BUFFER_PER_FRAME);
+
+	build_frame_job_data buildFrameJobData = {};
+	buildFrameJobData.scene = &scene;
+	buildFrameJobData.isStreamingUploadSupported = ImGui_ImplOpenGL3_IsStreamingUploadSupported();
+	buildFrameJobData.isGPUCullingSupported = isGPUCullingSupported;
+	buildFrameJobData.isMeshletCullingSupported = isMeshletCullingSupported;
+	buildFrameJobData.isDeferredShadingSupported = isDeferredShadingSupported;
+	buildFrameJobData.isFrameCaptureSupported = isFrameCaptureSupported;
+	scene.shouldStreamImGuiUpload = buildFrameJobData.isStreamingUploadSupported;
+	scene.shouldCullMeshlets = isMeshletCullingSupported;
+
+	// NOTE(joon) : The first packet is built right away, so that there's always a packet to submit.
+	// This also lets the imgui create its device objects while we still have the context.
+	u64 frameIndex = 0;
+	ImGui_ImplOpenGL3_NewFrame();
+	ImGui_ImplGlfw_NewFrame();
+	ImGui::NewFrame();
+	buildFrameJobData.packet = framePackets;
+	BuildFrameJob(&buildFrameJobData, 0, 0);
+
+	// NOTE(joon) : From now on, only the render thread can make GL calls
+	render_thread renderThread;
+	renderThread.programs[ProgramSlot_Plain] = plainProgram;
+	for (u32 programIndex = 0;
+		programIndex < ArrayCount(lightingPrograms);
+		++programIndex)
+	{
+		renderThread.programs[ProgramSlot_Lighting + programIndex] = lightingPrograms[programIndex];
+	}
+	renderThread.programs[ProgramSlot_Instanced] = instancedProgram;
+	renderThread.programs[ProgramSlot_NormalLine] = normalLineProgram;
+	renderThread.programs[ProgramSlot_DepthOnly] = depthOnlyProgram;
+	renderThread.texCoordMappingProgram = texCoordMappingProgram;
+	StartRenderThread(&renderThread, window);
+
+	// NOTE(joon) : for the on demand rendering
+	u64 skippedFrameCount = 0;
+	b32 hasSubmittedFrame = false;
+	u64 lastSubmittedContentHash = 0;
+	b32 isLastSubmitStatic = false;
+	u32 staticFrameCount = 0;
+	r64 lastStatsRefreshTime = 0.0;
+
 	while (!glfwWindowShouldClose(window) && isGameRunning)
 	{
-		glfwPollEvents();
+		frame_packet *packet = framePackets + (frameIndex % FRAME_PACKET_COUNT);
+		frame_packet *nextPacket = framePackets + ((frameIndex + 1) % FRAME_PACKET_COUNT);
+		command_buffer *commandBuffers = frameCommandBuffers.data() + (frameIndex % FRAME_PACKET_COUNT)*MAX_COMMAND_BUFFER_PER_FRAME;
+
+		// NOTE(joon) : Shader reload & the model residency changes are the only requests that can change the pixels
+		// without changing the packet. The baked lighting uploads & the shadow passes should never be skipped,
+		// as their caches assume that they are on the GPU.
+		b32 isPacketStatic = packet->shouldRenderOnDemand && hasSubmittedFrame &&
+							packet->contentHash == lastSubmittedContentHash && !packet->shouldReloadShader &&
+							!HasModelResidencyChanges(&packet->residencyChanges) && !HasBakedLightingUploads(packet) &&
+							packet->shadowPasses.empty();
+		// NOTE(joon) : Hi-Z culling uses the depth of the last frame, so a static packet should be submitted once more
+		// to draw the instances that were revealed by that frame
+		if (packet->shouldHiZCullInstances && !isLastSubmitStatic)
+		{
+			isPacketStatic = false;
+		}
+		// NOTE(joon) : The recording should have every frame, even the ones that look the same
+		if (packet->shouldCaptureFrames)
+		{
+			isPacketStatic = false;
+		}
+
+		// NOTE(joon) : The packet that we are about to submit is built with the previous events,
+		// so only sleep when that one is also static. Otherwise an event that woke us up would wait for another one.
+		// Also don't sleep while a model is loading, as nothing would wake us up when it's done.
+		if (isPacketStatic && staticFrameCount >= ON_DEMAND_STATIC_FRAME_COUNT && !packet->isWaitingForModels)
+		{
+			glfwWaitEventsTimeout(ON_DEMAND_WAIT_TIMEOUT);
+		}
+		else
+		{
+			glfwPollEvents();
+		}
 		if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 		{
 			isGameRunning = false;
 		}
 
-		for (u32 lightIndex = 0;
-			lightIndex < ArrayCount(lights);
-			++lightIndex)
+		// NOTE(joon) : The next packet(and its command buffers) might still be used by the render thread,
+		// so it should be done with it before we build on top of it.
+		if (nextPacket->isSubmitted)
 		{
-			light* light = lights + lightIndex;
-
-			if (shouldLightRotate)
-			{
-				light->angle += 0.015f;
-			}
-			light->p = lightRadius * glm::vec3(cos(light->angle), 0, sin(light->angle));
+			WaitForRenderFrame(&renderThread, nextPacket->renderFrameNumber);
+			nextPacket->isSubmitted = false;
 		}
+		nextPacket->frameIndex = frameIndex + 1;
 
-		glm::vec3 cameraP = glm::vec3(glm::rotate(camera.angle, glm::vec3(0, 1, 0)) * glm::vec4(camera.initP, 1.0f));
-		perFrameUbo.view = glm::lookAt(cameraP, camera.lookAtP, camera.up);
-		perFrameUbo.projection = glm::perspective(glm::radians(camera.fovInDegree), windowWidth / (float)windowHeight, camera.near, camera.far);
-		perFrameUbo.cameraP = cameraP;
-		perFrameUbo.cameraDir = glm::normalize(cameraP - glm::vec3(0, 0, 0));
-
-		// per object will be filled by imgui
-
+		// NOTE(joon) : The backends are reading the input from GLFW, so this should stay in the main thread.
+		// After this, only the build job touches the imgui context until we wait for it.
 		ImGui_ImplOpenGL3_NewFrame();
 		ImGui_ImplGlfw_NewFrame();
 		ImGui::NewFrame();
 
-		//symotion-prefix) NOTE(joon) : config imgui
-		ImGui::Begin("Options");
-		ImGui::Text("Preset");
-		const char* presets[3] = {"1", "2", "3"};
-        isPresetSelected = ImGui::Combo("Preset", (int *)&selectedPresetIndex, presets, ArrayCount(presets), 0);
-		ImGui::Separator();
-		ImGui::Text("Shaders");
-		const char* shaderTypes[3] = {"Phong Shading", "Phong Lighting", "Blinn"};
-        ImGui::Combo("Shader Types", (int *)&selectedProgramIndex, shaderTypes, ArrayCount(shaderTypes), 0);
-		bool shouldReloadShader = false;
-		shouldReloadShader = ImGui::Button("Reload", ImVec2(100, 0));
-		ImGui::Separator();
-		ImGui::Text("Texture Mapping");
-		const char* textureMappingTypes[] = {"Planar", "Cylindrical", "Spherical"};
-		shouldRemapTexture = 
-			ImGui::Combo("Texture Mapping Types", (int *)&perFrameUbo.textureMappingMethod, textureMappingTypes, ArrayCount(textureMappingTypes), 0);
-		const char* textureGenerateLocations[2] = {"CPU", "GPU"};
-		ImGui::Combo("TexCoord Generate Location", (int *)&selectedMappingLocationIndex, textureGenerateLocations, ArrayCount(textureGenerateLocations), 0);
-		const char* textureEntities[] = {"Position", "Normal"};
-		didTextureEntityChanged = ImGui::Combo("Texture Entity", (int *)&perFrameUbo.shouldUseNormal, textureEntities, ArrayCount(textureEntities), 0);
-		ImGui::Separator();
-		ImGui::Text("Global Constants");
-		ImGui::SliderFloat3("Global Ambient", (float *)&perFrameUbo.globalAmbient, 0.0f, 1.0f, "%.5f", 0);
-		ImGui::SliderFloat3("IFog", (float *)&perFrameUbo.IFog, 0.0f, 1.0f, "%.5f", 0);
-		ImGui::SliderFloat("Fog Near", (float *)&perFrameUbo.zNear, 0.0f, 100.0f, "%.5f", 0);
-		ImGui::SliderFloat("Fog Far", (float *)&perFrameUbo.zFar, 0, 100.0f, "%.5f", 0);
-		ImGui::Separator();
-		ImGui::Text("Model");
-		const char* modelNames[] = {"4Sphere", "Bunny", "BunnyHighPoly", "Cube", "Cube2", "Cup", "Lucy", "Quad", "Rhino", "Sphere", "SphereModified", "StarWars", "Triangle"};
-		ImGui::Combo("Models", (int *)&selectedModelIndex, modelNames, ArrayCount(modelNames), 0);
-		ImGui::SliderFloat3("IEmissive", (float *)&perObjectUbo.IEmissive, 0.0f, 1.0f, "%.5f", 0);
-		ImGui::SliderFloat("kAmbient", (float *)&perObjectUbo.kAmbient, 0.0f, 1.0f, "%.5f", 0);
-		ImGui::SliderFloat("kDiffuse", (float *)&perObjectUbo.kDiffuse, 0.0f, 1.0f, "%.5f", 0);
-		ImGui::SliderFloat("kSpecular", (float *)&perObjectUbo.kSpecular, 0.0f, 1.0f, "%.5f", 0);
-		//ImGui::SliderFloat("ns", (float *)&perObjectUbo.ns, 0.0f, 1.0f, "%.5f", 0);
-
-		static bool shouldDrawVertexNormal = false;
-		ImGui::Checkbox("Vertex Normal", &shouldDrawVertexNormal);
-		static bool shouldDrawFaceNormal = false;
-		ImGui::Checkbox("Face Normal", &shouldDrawFaceNormal);
-		ImGui::Separator();
-
-		ImGui::Text("Camera");
-		ImGui::SliderFloat("Orbit", (float *)&camera.angle, 0.0f, Two_Pi32, "%.5f", 0);
-		ImGui::Separator();
-
-		ImGui::Text("Lights");
-		ImGui::SliderFloat("Radius", (float *)&lightRadius, 2.0f, 8.0f, "%.5f", 0);
-		ImGui::Checkbox("Rotate", &shouldLightRotate);
-		ImGui::Separator();
-		for (u32 lightIndex = 0;
-			lightIndex < ArrayCount(lights);
-			++lightIndex)
-		{
-			ImGui::PushID(lightIndex);
-			light *light = lights + lightIndex;
-			ImGui::Text("Light %u", lightIndex);
-			ImGui::Checkbox("Enable", &light->isEnabled);
-
-			const char* lightTypes[3] = {"Point", "Directional", "SpotLight"};
-            ImGui::Combo("Light Types", (int *)&light->type, lightTypes, (int)ArrayCount(lightTypes), 0);
-
-			if (light->isEnabled)
-			{
-				ImGui::SliderFloat3("Ambient", (float *)&light->IAmbient, 0.0f, 1.0f, "%.5f", 0);
-				ImGui::SliderFloat3("Diffuse", (float *)&light->IDiffuse, 0.0f, 1.0f, "%.5f", 0);
-				ImGui::SliderFloat3("Specular", (float *)&light->ISpecular, 0.0f, 1.0f, "%.5f", 0);
-				ImGui::SliderFloat("C1", (float *)&light->c1, 0.0f, 1.0f, "%.5f", 0);
-				ImGui::SliderFloat("C2", (float *)&light->c2, 0.0f, 1.0f, "%.5f", 0);
-				ImGui::SliderFloat("C3", (float *)&light->c3, 0.0f, 1.0f, "%.5f", 0);
-
-				if (light->type == LightType_SpotLight)
-				{
-					ImGui::SliderFloat("Cos(Inner Cone Angle)", (float *)&light->innerConeAngleCos, 0.0f, 1.0f, "%.5f", 0);
-					ImGui::SliderFloat("Cos(Outer Cone Angle)", (float *)&light->outerConeAngleCos, 0.0f, 1.0f, "%.5f", 0);
-					ImGui::SliderFloat("FallOff", (float *)&light->fallOff, 0.0f, 10.0f, "%.5f", 0);
-
-					light->innerConeAngleCos = Clamp(light->outerConeAngleCos, light->innerConeAngleCos, 1.0f);
-					light->outerConeAngleCos = Clamp(0.0f, light->outerConeAngleCos, light->innerConeAngleCos);
-				}
-			}
-
-			ImGui::Spacing();
-			ImGui::Separator();
-			ImGui::PopID();
-		}
-		ImGui::End();
-
-		if (isPresetSelected)
-		{
-			switch (selectedPresetIndex)
-			{
-				case 0:
-				{
-					ConfigureLightPreset1(lights, ArrayCount(lights));
-				}break;
-				case 1:
-				{
-					ConfigureLightPreset2(lights, ArrayCount(lights));
-				}break;
-				case 2:
-				{
-					ConfigureLightPreset3(lights, ArrayCount(lights));
-				}break;
-			}
-		}
+		buildFrameJobData.packet = nextPacket;
+		job *buildFrameJob = CreateJob(&jobSystem, BuildFrameJob, &buildFrameJobData, "BuildFrame");
+		SubmitJob(&jobSystem, buildFrameJob);
 
-		if (selectedMappingLocationIndex == TextureMappingLocation_GPU)
+		if (isPacketStatic)
 		{
-			perFrameUbo.shouldGenerateTexCoordInGPU = true;
+			// NOTE(joon) : Whatever is on the screen is already what this packet would draw
+			++staticFrameCount;
+			++skippedFrameCount;
 		}
 		else
 		{
-			perFrameUbo.shouldGenerateTexCoordInGPU = false;
-			// As this modify shouldRemapTexture value, this should come before the if(shouldRemapTexture)
-			shouldRemapTexture = true;
+			u32 commandBufferCount = RecordFramePacket(&renderContext, packet, commandBuffers);
+			packet->renderFrameNumber = SubmitRenderFrame(&renderThread, commandBuffers, commandBufferCount, true);
+			packet->isSubmitted = true;
+
+			isLastSubmitStatic = hasSubmittedFrame && (packet->contentHash == lastSubmittedContentHash);
+			hasSubmittedFrame = true;
+			lastSubmittedContentHash = packet->contentHash;
+			staticFrameCount = 0;
 		}
 
-		if (shouldReloadShader)
-		{
-			GLuint newProgram = LoadShaders(vertexShaderPaths[selectedProgramIndex], fragmentShaderPaths[selectedProgramIndex]);
+		WaitForJob(&jobSystem, buildFrameJob);
 
-			if (newProgram)
-			{
-				glDeleteProgram(lightingPrograms[selectedProgramIndex]);
-				lightingPrograms[selectedProgramIndex] = newProgram;
-			}
+		if (packet->shouldExportJobTimings)
+		{
+			// NOTE(joon) : No job is running at this point, as the build job is the last one that we submitted
+			ExportJobTimings(&jobSystem, "job_timings.json");
+			ClearJobTimings(&jobSystem);
 		}
 
-		if (shouldRemapTexture || didTextureEntityChanged)
+		r64 time = glfwGetTime();
+		if (!isPacketStatic && time - lastStatsRefreshTime >= PIPELINE_STATS_REFRESH_INTERVAL)
 		{
-			b32 shouldUseP = true;
-			if (perFrameUbo.shouldUseNormal == 1)
+			buildFrameJobData.lastBuildTime = nextPacket->buildTime;
+			buildFrameJobData.lastCulledDrawCount = nextPacket->culledDrawCount;
+			buildFrameJobData.lastOccludedDrawCount = nextPacket->occludedDrawCount;
+			buildFrameJobData.lastOccluderTriangleCount = nextPacket->occluderTriangleCount;
+			buildFrameJobData.lastOcclusionRasterizeTime = nextPacket->occlusionRasterizeTime;
+			buildFrameJobData.lastOcclusionTestTime = nextPacket->occlusionTestTime;
+			buildFrameJobData.lastMeshletTriangleCount = nextPacket->meshletTriangleCount;
+			buildFrameJobData.lastFrustumCulledMeshletTriangleCount = nextPacket->frustumCulledMeshletTriangleCount;
+			buildFrameJobData.lastConeCulledMeshletTriangleCount = nextPacket->coneCulledMeshletTriangleCount;
+			buildFrameJobData.lastMeshletCommandCount = (u32)nextPacket->meshletCommands.size();
+			buildFrameJobData.lastMeshletCullTime = nextPacket->meshletCullTime;
+			buildFrameJobData.skippedFrameCount = skippedFrameCount;
 			{
-				shouldUseP = false;
+				std::lock_guard<std::mutex> lock(renderThread.lock);
+				buildFrameJobData.lastImGuiUploadBytes = renderThread.lastImGuiUploadBytes;
+				buildFrameJobData.lastGPUVisibleInstanceCount = renderThread.lastGPUVisibleInstanceCount;
+				buildFrameJobData.lastShadowGPUTime = renderThread.lastShadowGPUTime;
+				buildFrameJobData.lastFrameGPUTime = renderThread.lastFrameGPUTime.time;
 			}
-
-			GenerateTexCoordForAllModels(&models, textureWidth, textureHeight, perFrameUbo.textureMappingMethod, shouldUseP);
-			shouldRemapTexture = false;
-		}
-		
-		glClearColor(perFrameUbo.IFog.x, perFrameUbo.IFog.y, perFrameUbo.IFog.z, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		glEnable(GL_DEPTH_TEST);
-		glEnable(GL_CULL_FACE);
-
-		int displayWidth;
-		int displayHeight;
-		glfwGetFramebufferSize(window, &displayWidth, &displayHeight);
-		glViewport(0, 0, displayWidth, displayHeight);
-
-		glUseProgram(lightingPrograms[selectedProgramIndex]);
-
-		// update per frame uniform buffer
-		u32 lightSize = ArrayCount(lights)*sizeof(light);
-		u32 offsetOfLightInsideUniformBuffer = offsetof(per_frame_ubo, lights);
-		glBindBuffer(GL_UNIFORM_BUFFER, perFrameUboID);
-		glBindBufferBase(GL_UNIFORM_BUFFER, 0, perFrameUboID);
-		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(per_frame_ubo) - lightSize, &perFrameUbo);
-		glBufferSubData(GL_UNIFORM_BUFFER, offsetOfLightInsideUniformBuffer, lightSize, lights);
-
-		model* model = models.data() + selectedModelIndex;
-
-		// floor
-		RenderModel(&models[7], 
-					glm::vec3(7, 7, 7), -Pi32/2.0f, 0, 0, glm::vec3(0, -2, 0),
-					windowWidth, windowHeight, perObjectUboID, &perObjectUbo, sizeof(perObjectUbo), 0, 0);
-
-		RenderModel(model, 
-					glm::vec3(2, 2, 2), 0, 0, 0, glm::vec3(0, 0, 0),
-					windowWidth, windowHeight, perObjectUboID, &perObjectUbo, sizeof(perObjectUbo), diffuseTextureID, specularTextureID);
-#if 1
-		if (shouldDrawFaceNormal)
-		{
-			RenderFaceNormal(model, glm::vec3(1, 1, 1), 0, glm::vec3(0, 0, 0),
-							windowWidth, windowHeight, perObjectUboID);
+			{
+				std::lock_guard<std::mutex> lock(frameCapture.lock);
+				buildFrameJobData.capturedFrameCount = frameCapture.capturedFrameCount;
+				buildFrameJobData.encodedFrameCount = frameCapture.encodedFrameCount;
+				buildFrameJobData.captureStallCount = frameCapture.stallCount;
+				buildFrameJobData.lastCaptureEncodeTime = frameCapture.lastEncodeTime;
+				buildFrameJobData.failedCaptureStartCount = frameCapture.failedStartCount;
+			}
+			lastStatsRefreshTime = time;
 		}
-		if (shouldDrawVertexNormal)
 		{
-			RenderVertexNormal(model, glm::vec3(1, 1, 1), 0, glm::vec3(0, 0, 0),
-							windowWidth, windowHeight, perObjectUboID);
+			std::lock_guard<std::mutex> lock(renderThread.lock);
+			buildFrameJobData.frameGPUTime = renderThread.lastFrameGPUTime;
 		}
 
-		// NOTE(joon) : draw orbital line!
-		u32 lineDensity = 1000;
-		float angleForEachLine = Two_Pi32 / (r32)lineDensity;
-		for (u32 lineIndex = 0;
-			lineIndex < 1000;
-			++lineIndex)
-		{
-			glm::vec3 start = {};
-			start.x = lightRadius * cos(lineIndex * angleForEachLine);
-			start.y = 0;
-			start.z = lightRadius * sin(lineIndex * angleForEachLine);
+		++frameIndex;
+	}
 
-			glm::vec3 end = {};
-			end.x = lightRadius * cos((lineIndex+1) * angleForEachLine);
-			end.y = 0.0f;
-			end.z = lightRadius * sin((lineIndex+1) * angleForEachLine);
+	StopRenderThread(&renderThread);
 
-			glm::vec3 line[2] = {start, end};
-			RenderLine(line, lineVertexArrayID, lineVertexBufferID,
-				glm::vec3(1, 1, 1), 0, glm::vec3(0, 0, 0),
-				windowWidth, windowHeight, perObjectUboID);
+	if (isGPUCullingSupported)
+	{
+		FreeGPUCulling(&gpuCulling);
+	}
+	if (isDeferredShadingSupported)
+	{
+		FreeDeferredShading(&deferredShading);
+	}
+	if (isShadowMappingSupported)
+	{
+		FreeShadowMaps(&shadowMaps);
+	}
+	if (isDynamicResolutionSupported)
+	{
+		FreeDynamicResolution(&dynamicResolution);
+	}
+	FreeResolutionController(&scene.resolutionController);
+	// NOTE(joon) : Also writes the rest of the recording
+	FreeFrameCapture(&frameCapture);
 
-		}
-#endif
+	for (u32 bufferIndex = 0;
+		bufferIndex < frameCommandBuffers.size();
+		++bufferIndex)
+	{
+		FreeCommandBuffer(&frameCommandBuffers[bufferIndex]);
+	}
 
-		glUseProgram(plainProgram);
-		for (u32 lightIndex = 0;
-			lightIndex < ArrayCount(lights);
-			++lightIndex)
+	for (u32 packetIndex = 0;
+		packetIndex < FRAME_PACKET_COUNT;
+		++packetIndex)
+	{
+		frame_packet *packet = framePackets + packetIndex;
+		for (int listIndex = 0;
+			listIndex < packet->imguiDrawLists.Size;
+			++listIndex)
 		{
-			light *light = lights + lightIndex;
-
-			if (light->isEnabled)
-			{
-				plain_per_object_ubo ubo = {};
-				ubo.color = light->IDiffuse;
-				RenderModel(&sphereModel,
-					glm::vec3(0.5f, 0.5f, 0.5f), 0, 0, 0, light->p,
-					windowWidth, windowHeight, perObjectUboID, &ubo, sizeof(ubo), 0, 0);
-			}
+			IM_DELETE(packet->imguiDrawLists[listIndex]);
 		}
-
-		// NOTE(joon) : render imgui
-		ImGui::Render();
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-
-		angle += 0.00f;
-
-		// NOTE(joon) : cleanup
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-		glfwSwapBuffers(window);
 	}
 
+	FreeOcclusionBuffer(&scene.occlusionBuffer);
+
 	glfwDestroyWindow(window);
 	glfwTerminate();
 
+	FreeModelRegistry(&modelRegistry);
+	ShutdownAsyncIO(&asyncIO);
+	ShutdownJobSystem(&jobSystem);
+	CloseAssetPack(&assetPack);
+
 	return 0;
 }
@@ -0,0 +1,284 @@
+// NOTE(joon) : Meshlets are built once when the model is loaded, and the build stage
+// culls them every frame(see CullDrawItemMeshlets) so that only the visible ones are drawn.
+
+// NOTE(joon) : How much a candidate triangle is penalized for facing away from the meshlet,
+// compared to the number of the new vertices that it adds.
+// Higher value gives the tighter cones(more backface culling) but less vertex reuse.
+#define MESHLET_CONE_WEIGHT 1.0f
+
+// NOTE(joon) : Zero for the degenerate triangles, so that they don't affect the cone.
+// They don't produce any pixel anyway.
+static glm::vec3
+GetTriangleNormal(mesh *mesh, u32 *indices)
+{
+	glm::vec3 p0 = mesh->vertexBuffer[indices[0]].p;
+	glm::vec3 p1 = mesh->vertexBuffer[indices[1]].p;
+	glm::vec3 p2 = mesh->vertexBuffer[indices[2]].p;
+
+	glm::vec3 result = glm::cross(p1 - p0, p2 - p0);
+	r32 length = glm::length(result);
+	if (length > 1e-12f)
+	{
+		result /= length;
+	}
+	else
+	{
+		result = glm::vec3(0.0f, 0.0f, 0.0f);
+	}
+
+	return result;
+}
+
+// NOTE(joon) : indices should point to the triangles of this meshlet
+static void
+ComputeMeshletBounds(mesh *mesh, meshlet *meshlet, u32 *indices, glm::vec3 *triangleNormals, u32 *triangleIndices)
+{
+	glm::vec3 boundsMin = glm::vec3(FLT_MAX, FLT_MAX, FLT_MAX);
+	glm::vec3 boundsMax = glm::vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (u32 index = 0;
+		index < 3*meshlet->triangleCount;
+		++index)
+	{
+		glm::vec3 p = mesh->vertexBuffer[indices[index]].p;
+		boundsMin = glm::min(boundsMin, p);
+		boundsMax = glm::max(boundsMax, p);
+	}
+
+	meshlet->center = 0.5f*(boundsMin + boundsMax);
+	r32 maxDistanceSquared = 0.0f;
+	for (u32 index = 0;
+		index < 3*meshlet->triangleCount;
+		++index)
+	{
+		glm::vec3 d = mesh->vertexBuffer[indices[index]].p - meshlet->center;
+		maxDistanceSquared = Maximum(maxDistanceSquared, glm::dot(d, d));
+	}
+	meshlet->radius = sqrtf(maxDistanceSquared);
+
+	glm::vec3 normalSum = glm::vec3(0.0f, 0.0f, 0.0f);
+	for (u32 triangleIndex = 0;
+		triangleIndex < meshlet->triangleCount;
+		++triangleIndex)
+	{
+		normalSum += triangleNormals[triangleIndices[triangleIndex]];
+	}
+
+	r32 normalSumLength = glm::length(normalSum);
+	meshlet->coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+	meshlet->coneCutoff = -1.0f;
+	if (normalSumLength > 1e-6f)
+	{
+		meshlet->coneAxis = normalSum / normalSumLength;
+		meshlet->coneCutoff = 1.0f;
+		for (u32 triangleIndex = 0;
+			triangleIndex < meshlet->triangleCount;
+			++triangleIndex)
+		{
+			glm::vec3 normal = triangleNormals[triangleIndices[triangleIndex]];
+			if (normal != glm::vec3(0.0f, 0.0f, 0.0f))
+			{
+				meshlet->coneCutoff = Minimum(meshlet->coneCutoff, glm::dot(normal, meshlet->coneAxis));
+			}
+		}
+	}
+}
+
+// NOTE(joon) : Greedy clustering. Each meshlet starts from the first triangle that is not used yet,
+// and keeps adding the neighbouring triangle that adds the fewest new vertices & faces the same way as the meshlet,
+// until it runs out of the vertices, triangles or neighbours.
+// The index buffer is reordered so that each meshlet is contiguous, the vertex buffer stays the same.
+static void
+BuildMeshlets(mesh *mesh)
+{
+	mesh->meshlets.clear();
+
+	u32 vertexCount = (u32)mesh->vertexBuffer.size();
+	u32 indexCount = (u32)mesh->indexBuffer.size();
+	u32 triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+	u32 *indices = mesh->indexBuffer.data();
+
+	// NOTE(joon) : Triangles that use each vertex, adjacency[adjacencyOffsets[v]] ~ adjacency[adjacencyOffsets[v + 1]]
+	std::vector<u32> adjacencyOffsets(vertexCount + 1, 0);
+	for (u32 index = 0;
+		index < 3*triangleCount;
+		++index)
+	{
+		adjacencyOffsets[indices[index] + 1]++;
+	}
+	for (u32 vertexIndex = 0;
+		vertexIndex < vertexCount;
+		++vertexIndex)
+	{
+		adjacencyOffsets[vertexIndex + 1] += adjacencyOffsets[vertexIndex];
+	}
+	std::vector<u32> adjacency(3*triangleCount);
+	std::vector<u32> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for (u32 index = 0;
+		index < 3*triangleCount;
+		++index)
+	{
+		adjacency[adjacencyFill[indices[index]]++] = index / 3;
+	}
+
+	std::vector<glm::vec3> triangleNormals(triangleCount);
+	for (u32 triangleIndex = 0;
+		triangleIndex < triangleCount;
+		++triangleIndex)
+	{
+		triangleNormals[triangleIndex] = GetTriangleNormal(mesh, indices + 3*triangleIndex);
+	}
+
+	std::vector<u8> isTriangleUsed(triangleCount, 0);
+	// NOTE(joon) : meshlet index + 1 of the last meshlet that used the vertex, so that it never needs to be cleared
+	std::vector<u32> vertexMeshletTags(vertexCount, 0);
+
+	std::vector<u32> newIndexBuffer;
+	newIndexBuffer.reserve(3*triangleCount);
+	std::vector<u32> meshletTriangles; // original triangle index, for the bounds
+	std::vector<u32> candidates;
+
+	u32 seedTriangle = 0;
+	for (;;)
+	{
+		while (seedTriangle < triangleCount && isTriangleUsed[seedTriangle])
+		{
+			++seedTriangle;
+		}
+		if (seedTriangle == triangleCount)
+		{
+			break;
+		}
+
+		u32 meshletTag = (u32)mesh->meshlets.size() + 1;
+		meshlet meshlet = {};
+		meshlet.firstIndex = (u32)newIndexBuffer.size();
+		glm::vec3 normalSum = glm::vec3(0.0f, 0.0f, 0.0f);
+		meshletTriangles.clear();
+		candidates.clear();
+
+		u32 triangleIndex = seedTriangle;
+		for (;;)
+		{
+			isTriangleUsed[triangleIndex] = true;
+			meshletTriangles.push_back(triangleIndex);
+			for (u32 cornerIndex = 0;
+				cornerIndex < 3;
+				++cornerIndex)
+			{
+				u32 vertexIndex = indices[3*triangleIndex + cornerIndex];
+				newIndexBuffer.push_back(vertexIndex);
+
+				if (vertexMeshletTags[vertexIndex] != meshletTag)
+				{
+					vertexMeshletTags[vertexIndex] = meshletTag;
+					meshlet.vertexCount++;
+
+					for (u32 adjacencyIndex = adjacencyOffsets[vertexIndex];
+						adjacencyIndex < adjacencyOffsets[vertexIndex + 1];
+						++adjacencyIndex)
+					{
+						if (!isTriangleUsed[adjacency[adjacencyIndex]])
+						{
+							candidates.push_back(adjacency[adjacencyIndex]);
+						}
+					}
+				}
+			}
+			meshlet.triangleCount++;
+			normalSum += triangleNormals[triangleIndex];
+
+			if (meshlet.triangleCount == MESHLET_MAX_TRIANGLE_COUNT)
+			{
+				break;
+			}
+
+			glm::vec3 coneAxis = glm::vec3(0.0f, 0.0f, 0.0f);
+			r32 normalSumLength = glm::length(normalSum);
+			if (normalSumLength > 1e-6f)
+			{
+				coneAxis = normalSum / normalSumLength;
+			}
+
+			// NOTE(joon) : The used ones are removed from the candidates while we look for the best one.
+			// Same triangle can be inside the candidates more than once, which is fine.
+			u32 bestTriangle = triangleCount;
+			r32 bestScore = FLT_MAX;
+			u32 liveCandidateCount = 0;
+			for (u32 candidateIndex = 0;
+				candidateIndex < candidates.size();
+				++candidateIndex)
+			{
+				u32 candidate = candidates[candidateIndex];
+				if (isTriangleUsed[candidate])
+				{
+					continue;
+				}
+				candidates[liveCandidateCount++] = candidate;
+
+				u32 newVertexCount = 0;
+				for (u32 cornerIndex = 0;
+					cornerIndex < 3;
+					++cornerIndex)
+				{
+					newVertexCount += (vertexMeshletTags[indices[3*candidate + cornerIndex]] != meshletTag) ? 1 : 0;
+				}
+				if (meshlet.vertexCount + newVertexCount > MESHLET_MAX_VERTEX_COUNT)
+				{
+					continue;
+				}
+
+				r32 score = (r32)newVertexCount + MESHLET_CONE_WEIGHT*(1.0f - glm::dot(triangleNormals[candidate], coneAxis));
+				if (score < bestScore)
+				{
+					bestScore = score;
+					bestTriangle = candidate;
+				}
+			}
+			candidates.resize(liveCandidateCount);
+
+			if (bestTriangle == triangleCount)
+			{
+				break;
+			}
+			triangleIndex = bestTriangle;
+		}
+
+		ComputeMeshletBounds(mesh, &meshlet, newIndexBuffer.data() + meshlet.firstIndex, triangleNormals.data(), meshletTriangles.data());
+		mesh->meshlets.push_back(meshlet);
+	}
+
+	// NOTE(joon) : leftover indices that don't make a triangle are dropped, just like the GL would do
+	mesh->indexBuffer.swap(newIndexBuffer);
+}
+
+// NOTE(joon) : Conservative, true only when every triangle of the meshlet faces away from the camera.
+// cameraP should be in the model space, which works for any world matrix that doesn't mirror.
+static b32
+IsMeshletBackFacing(meshlet *meshlet, glm::vec3 cameraP)
+{
+	b32 result = false;
+	if (meshlet->coneCutoff > 0.0f)
+	{
+		// NOTE(joon) : A triangle faces away when dot(normal, p - cameraP) >= 0 for its points,
+		// and every point is inside the bounding sphere. So it's enough to see if the normal that is the closest to
+		// the camera direction still has dot(normal, center - cameraP) >= radius.
+		// That normal is at (angle between the axis & the camera direction + half angle of the cone) from the camera direction.
+		glm::vec3 toCenter = meshlet->center - cameraP;
+		r32 distance = glm::length(toCenter);
+		if (distance > meshlet->radius)
+		{
+			r32 cosAxis = glm::dot(toCenter, meshlet->coneAxis) / distance;
+			r32 sinAxis = sqrtf(Maximum(1.0f - cosAxis*cosAxis, 0.0f));
+			r32 sinCone = sqrtf(Maximum(1.0f - meshlet->coneCutoff*meshlet->coneCutoff, 0.0f));
+
+			r32 cosClosest = cosAxis*meshlet->coneCutoff - sinAxis*sinCone;
+			result = (distance*cosClosest >= meshlet->radius);
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,511 @@
+#include "model_registry.h"
+
+static const char *modelResidencyNames[] = {"Unloaded", "Loading", "Loaded", "Uploading", "Resident", "Failed"};
+
+static u64
+GetMeshGPUBytes(mesh *mesh)
+{
+	u64 result = mesh->vertexBuffer.size()*sizeof(vertex) +
+				mesh->indexBuffer.size()*sizeof(unsigned int) +
+				mesh->vertexBuffer.size()*sizeof(glm::vec3); // positions of the depth pre-pass
+
+	return result;
+}
+
+static u64
+GetMeshCPUBytes(mesh *mesh)
+{
+	u64 result = GetMeshGPUBytes(mesh) + mesh->meshlets.size()*sizeof(meshlet);
+
+	return result;
+}
+
+// NOTE(joon) : Every model starts as Unloaded, so nothing is read until the first request
+static void
+InitializeModelRegistry(model_registry *registry, job_system *jobSystem, async_io *io, b32 hasGPU)
+{
+	registry->jobSystem = jobSystem;
+	registry->io = io;
+	registry->hasGPU = hasGPU;
+
+	registry->modelCount = ArrayCount(modelFileNames);
+	registry->models = new model[registry->modelCount];
+	registry->entries = new model_registry_entry[registry->modelCount];
+	for (u32 modelIndex = 0;
+		modelIndex < registry->modelCount;
+		++modelIndex)
+	{
+		model_registry_entry *entry = registry->entries + modelIndex;
+		entry->model = registry->models + modelIndex;
+		entry->modelIndex = modelIndex;
+		entry->residency.store(ModelResidency_Unloaded);
+		entry->cpuBytes = 0;
+		entry->lastRequestedFrame = 0;
+		entry->meshBusyUntilFrame = 0;
+		entry->gpuBytes = 0;
+		entry->uploadCount = 0;
+		entry->isCPUMeshReleased = false;
+		entry->textureMappingMethod = TextureMappingMethod_Planar;
+		entry->shouldUseP = true;
+		entry->read = {};
+		entry->registry = registry;
+	}
+
+	registry->textureMappingMethod = TextureMappingMethod_Planar;
+	registry->shouldUseP = true;
+	registry->shouldMapTexCoords = true;
+	registry->shouldReleaseCPUMeshes = false;
+	registry->canMapTexCoordsOnGPU = false;
+	registry->frameIndex = 0;
+
+	registry->gpuBudget = MODEL_REGISTRY_DEFAULT_GPU_BUDGET;
+	registry->gpuBytes = 0;
+	registry->evictionCount = 0;
+	registry->pendingLoadCount.store(0);
+}
+
+// NOTE(joon) : Waits for the loads that are still in flight. The GL objects are not freed here,
+// they go away with the context.
+static void
+FreeModelRegistry(model_registry *registry)
+{
+	while (registry->pendingLoadCount.load() > 0)
+	{
+		job *nextJob = GetNextJob(registry->jobSystem);
+		if (nextJob)
+		{
+			ExecuteJob(registry->jobSystem, nextJob);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	delete[] registry->entries;
+	delete[] registry->models;
+	registry->entries = 0;
+	registry->models = 0;
+	registry->modelCount = 0;
+}
+
+// NOTE(joon) : Completion of the model file read, runs on any worker.
+// The entry belongs to this job until it's handed back as Loaded.
+static void
+FinishRegistryModelLoadJob(void *data, u32 start, u32 onePastEnd)
+{
+	model_registry_entry *entry = (model_registry_entry *)data;
+	model_registry *registry = entry->registry;
+
+	LoadModelJob(&entry->loadJobData, 0, 0);
+
+	model *model = entry->model;
+	u32 residency = ModelResidency_Failed;
+	if (!model->mesh.vertexBuffer.empty() && !model->mesh.indexBuffer.empty())
+	{
+		GenerateTexCoordForModels(registry->jobSystem, model, 1, entry->textureMappingMethod, entry->shouldUseP);
+		entry->cpuBytes = GetMeshCPUBytes(&model->mesh);
+		residency = ModelResidency_Loaded;
+	}
+
+	entry->residency.store(residency, std::memory_order_release);
+	registry->pendingLoadCount.fetch_sub(1);
+}
+
+// NOTE(joon) : The read can be a part of any batch, the entry stays Loading until the completion of that read
+static void
+SetupRegistryModelRead(model_registry *registry, u32 modelIndex, async_read *read)
+{
+	model_registry_entry *entry = registry->entries + modelIndex;
+	Assert(entry->residency.load() == ModelResidency_Unloaded);
+
+	entry->residency.store(ModelResidency_Loading);
+	entry->textureMappingMethod = registry->textureMappingMethod;
+	entry->shouldUseP = registry->shouldUseP;
+	registry->pendingLoadCount.fetch_add(1);
+
+	SetupModelRead(registry->jobSystem, entry->model, modelFileNames[modelIndex], &entry->loadJobData, read);
+	read->completion = FinishRegistryModelLoadJob;
+	read->completionData = entry;
+}
+
+// NOTE(joon) : The loads on request are always read by the worker jobs instead of the shared io.
+// This runs as a job and helps with the other jobs while it waits, which can be another load on request,
+// so it should never go through anything that holds a lock while the read is in flight.
+static void
+LoadRegistryModelJob(void *data, u32 start, u32 onePastEnd)
+{
+	model_registry_entry *entry = (model_registry_entry *)data;
+	ReadAssetFilesAsync(entry->registry->jobSystem, 0, &entry->read, 1);
+}
+
+// NOTE(joon) : Loads every model right away and waits for them, for the headless scene
+// that draws everything on the CPU
+static void
+LoadAllRegistryModels(model_registry *registry)
+{
+	std::vector<async_read> reads(registry->modelCount);
+	for (u32 modelIndex = 0;
+		modelIndex < registry->modelCount;
+		++modelIndex)
+	{
+		SetupRegistryModelRead(registry, modelIndex, reads.data() + modelIndex);
+	}
+	ReadAssetFilesAsync(registry->jobSystem, registry->io, reads.data(), registry->modelCount);
+}
+
+// NOTE(joon) : Should be called by the build stage before any request of the packet
+static void
+BeginModelRequests(model_registry *registry, u64 frameIndex, int textureMappingMethod, b32 shouldUseP, int textureMappingLocation)
+{
+	registry->frameIndex = frameIndex;
+	registry->textureMappingMethod = textureMappingMethod;
+	registry->shouldUseP = shouldUseP;
+	registry->shouldMapTexCoords = (textureMappingLocation != TextureMappingLocation_GPU);
+	registry->shouldReleaseCPUMeshes = registry->hasGPU && registry->canMapTexCoordsOnGPU &&
+										(textureMappingLocation == TextureMappingLocation_Compute);
+}
+
+static b32
+IsTexCoordMappingStale(model_registry *registry, model_registry_entry *entry)
+{
+	b32 result = registry->shouldMapTexCoords &&
+				(entry->textureMappingMethod != registry->textureMappingMethod || entry->shouldUseP != registry->shouldUseP);
+
+	return result;
+}
+
+static void
+RemapTexCoords(model_registry *registry, model_registry_entry *entry)
+{
+	GenerateTexCoordForModels(registry->jobSystem, entry->model, 1, registry->textureMappingMethod, registry->shouldUseP);
+	entry->textureMappingMethod = registry->textureMappingMethod;
+	entry->shouldUseP = registry->shouldUseP;
+}
+
+// NOTE(joon) : Called by the build stage for every model that the packet wants to draw.
+// Returns the model if it can be drawn by this packet, or 0 if the placeholder should be drawn instead.
+// A model that is not resident yet is moved one step closer to being resident.
+static model *
+RequestModel(model_registry *registry, model_residency_changes *changes, u32 modelIndex)
+{
+	model *result = 0;
+
+	Assert(modelIndex < registry->modelCount);
+	model_registry_entry *entry = registry->entries + modelIndex;
+	entry->lastRequestedFrame = registry->frameIndex;
+
+	b32 isMeshBusy = registry->frameIndex < entry->meshBusyUntilFrame;
+	switch (entry->residency.load(std::memory_order_acquire))
+	{
+		case ModelResidency_Unloaded:
+		{
+			SetupRegistryModelRead(registry, modelIndex, &entry->read);
+			if (registry->jobSystem->workerCount > 1)
+			{
+				job *loadJob = CreateJob(registry->jobSystem, LoadRegistryModelJob, entry, "LoadRegistryModel");
+				SubmitJob(registry->jobSystem, loadJob);
+			}
+			else
+			{
+				// NOTE(joon) : Nobody waits for the load job, so it only runs when someone steals it.
+				// With a single worker that never happens, and the job pool would wrap around it.
+				LoadRegistryModelJob(entry, 0, 0);
+			}
+		}break;
+
+		case ModelResidency_Loaded:
+		{
+			if (!isMeshBusy)
+			{
+				if (IsTexCoordMappingStale(registry, entry))
+				{
+					RemapTexCoords(registry, entry);
+				}
+
+				if (registry->hasGPU)
+				{
+					entry->gpuBytes = GetMeshGPUBytes(&entry->model->mesh);
+					registry->gpuBytes += entry->gpuBytes;
+					entry->meshBusyUntilFrame = registry->frameIndex + MODEL_MESH_BUSY_FRAME_COUNT;
+					++entry->uploadCount;
+					entry->residency.store(ModelResidency_Uploading);
+					changes->uploads.push_back(entry);
+				}
+				else
+				{
+					entry->residency.store(ModelResidency_Resident);
+					result = entry->model;
+				}
+			}
+		}break;
+
+		case ModelResidency_Resident:
+		{
+			if (entry->isCPUMeshReleased)
+			{
+				// NOTE(joon) : Nothing reads the vertex buffer on the CPU side, so the compute shader doesn't need to wait
+				if (IsTexCoordMappingStale(registry, entry))
+				{
+					model *model = entry->model;
+					if (!model->mesh.hasTexCoords)
+					{
+						gpu_texcoord_mapping mapping = {};
+						mapping.vertexBufferID = model->vertexBufferID;
+						mapping.vertexCount = model->uploadedVertexCount;
+						mapping.textureMappingMethod = registry->textureMappingMethod;
+						mapping.shouldUseP = registry->shouldUseP;
+						changes->gpuTexCoordMappings.push_back(mapping);
+					}
+					entry->textureMappingMethod = registry->textureMappingMethod;
+					entry->shouldUseP = registry->shouldUseP;
+				}
+			}
+			else if (!isMeshBusy && IsTexCoordMappingStale(registry, entry))
+			{
+				RemapTexCoords(registry, entry);
+				if (registry->hasGPU)
+				{
+					entry->meshBusyUntilFrame = registry->frameIndex + MODEL_MESH_BUSY_FRAME_COUNT;
+					changes->vertexBufferUpdates.push_back(entry);
+				}
+			}
+			result = entry->model;
+		}break;
+
+		default:
+		{
+			// NOTE(joon) : Loading, Uploading or Failed, nothing to do but waiting
+		}break;
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Should be called after every request of the packet.
+// Only the models that were not requested by this packet can be evicted, so the resident models can still go over the budget
+// when the requested ones alone don't fit. The models that were drawn by the older packets are fine to evict,
+// as their delete command is executed after those packets.
+static void
+EvictModels(model_registry *registry, model_residency_changes *changes)
+{
+	while (registry->gpuBytes > registry->gpuBudget)
+	{
+		model_registry_entry *leastRecentlyUsed = 0;
+		for (u32 modelIndex = 0;
+			modelIndex < registry->modelCount;
+			++modelIndex)
+		{
+			model_registry_entry *entry = registry->entries + modelIndex;
+			if (entry->residency.load(std::memory_order_acquire) == ModelResidency_Resident &&
+				entry->lastRequestedFrame < registry->frameIndex &&
+				(!leastRecentlyUsed || entry->lastRequestedFrame < leastRecentlyUsed->lastRequestedFrame))
+			{
+				leastRecentlyUsed = entry;
+			}
+		}
+
+		if (!leastRecentlyUsed)
+		{
+			break;
+		}
+
+		// NOTE(joon) : The IDs are left inside the model, as the older packets might be still recording with them
+		model *model = leastRecentlyUsed->model;
+		evicted_model_buffers buffers = {};
+		buffers.vertexArrayIDs[0] = model->vertexArrayID;
+		buffers.vertexArrayIDs[1] = model->positionVertexArrayID;
+		buffers.bufferIDs[0] = model->vertexBufferID;
+		buffers.bufferIDs[1] = model->indexBufferID;
+		buffers.bufferIDs[2] = model->positionBufferID;
+		changes->evictions.push_back(buffers);
+
+		registry->gpuBytes -= leastRecentlyUsed->gpuBytes;
+		leastRecentlyUsed->gpuBytes = 0;
+		if (leastRecentlyUsed->isCPUMeshReleased)
+		{
+			// NOTE(joon) : Nothing to upload again, so the next request reads the file.
+			// Only the build stage reads what's left(the meshlets), and the load job only starts after that request.
+			model->mesh = mesh();
+			leastRecentlyUsed->cpuBytes = 0;
+			leastRecentlyUsed->isCPUMeshReleased = false;
+			leastRecentlyUsed->residency.store(ModelResidency_Unloaded);
+		}
+		else
+		{
+			leastRecentlyUsed->residency.store(ModelResidency_Loaded);
+		}
+		++registry->evictionCount;
+	}
+}
+
+// NOTE(joon) : Should be called after every request of the packet, only does something with the GPU only meshes.
+// The meshlets are kept, as the build stage culls them on the CPU.
+// The models without the CPU mesh are also skipped by the occlusion culling, as it only rasterizes the CPU meshes.
+static void
+ReleaseCPUMeshes(model_registry *registry)
+{
+	if (registry->shouldReleaseCPUMeshes)
+	{
+		for (u32 modelIndex = 0;
+			modelIndex < registry->modelCount;
+			++modelIndex)
+		{
+			model_registry_entry *entry = registry->entries + modelIndex;
+			if (entry->residency.load(std::memory_order_acquire) == ModelResidency_Resident &&
+				!entry->isCPUMeshReleased && registry->frameIndex >= entry->meshBusyUntilFrame)
+			{
+				mesh *mesh = &entry->model->mesh;
+				std::vector<vertex>().swap(mesh->vertexBuffer);
+				std::vector<unsigned int>().swap(mesh->indexBuffer);
+
+				entry->cpuBytes = mesh->meshlets.size()*sizeof(meshlet);
+				entry->isCPUMeshReleased = true;
+			}
+		}
+	}
+}
+
+static void
+ClearModelResidencyChanges(model_residency_changes *changes)
+{
+	changes->uploads.clear();
+	changes->evictions.clear();
+	changes->vertexBufferUpdates.clear();
+	changes->gpuTexCoordMappings.clear();
+}
+
+static b32
+HasModelResidencyChanges(model_residency_changes *changes)
+{
+	b32 result = !changes->uploads.empty() || !changes->evictions.empty() || !changes->vertexBufferUpdates.empty() ||
+				!changes->gpuTexCoordMappings.empty();
+
+	return result;
+}
+
+// NOTE(joon) : Records the changes that the build stage made for the packet. The evictions come first,
+// so that the old buffers are gone before the new ones are created.
+static void
+RecordModelResidencyChanges(command_buffer *commandBuffer, model_residency_changes *changes)
+{
+	for (u32 evictionIndex = 0;
+		evictionIndex < changes->evictions.size();
+		++evictionIndex)
+	{
+		evicted_model_buffers *buffers = changes->evictions.data() + evictionIndex;
+		PushDeleteModelBuffers(commandBuffer, buffers->vertexArrayIDs, buffers->bufferIDs);
+	}
+
+	for (u32 uploadIndex = 0;
+		uploadIndex < changes->uploads.size();
+		++uploadIndex)
+	{
+		PushUploadModel(commandBuffer, changes->uploads[uploadIndex]);
+	}
+
+	for (u32 updateIndex = 0;
+		updateIndex < changes->vertexBufferUpdates.size();
+		++updateIndex)
+	{
+		model *model = changes->vertexBufferUpdates[updateIndex]->model;
+		PushUpdateVertexBuffer(commandBuffer, model->vertexBufferID,
+							model->mesh.vertexBuffer.data(), (u32)(model->mesh.vertexBuffer.size() * sizeof(vertex)));
+	}
+
+	for (u32 mappingIndex = 0;
+		mappingIndex < changes->gpuTexCoordMappings.size();
+		++mappingIndex)
+	{
+		gpu_texcoord_mapping *mapping = changes->gpuTexCoordMappings.data() + mappingIndex;
+		PushMapTexCoords(commandBuffer, mapping->vertexBufferID, mapping->vertexCount,
+						mapping->textureMappingMethod, mapping->shouldUseP);
+	}
+}
+
+// NOTE(joon) : Render thread only(or before it's started), and the CPU mesh should be still there.
+// The depth pre-pass only fetches the 12 bytes of the position for each vertex, instead of the whole vertex
+static void
+UploadModelPositions(model *model)
+{
+	u32 vertexCount = (u32)model->mesh.vertexBuffer.size();
+	std::vector<glm::vec3> positions(vertexCount);
+	for (u32 vertexIndex = 0;
+		vertexIndex < vertexCount;
+		++vertexIndex)
+	{
+		positions[vertexIndex] = model->mesh.vertexBuffer[vertexIndex].p;
+	}
+
+	glGenVertexArrays(1, &model->positionVertexArrayID);
+	glBindVertexArray(model->positionVertexArrayID);
+
+	glGenBuffers(1, &model->positionBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, model->positionBufferID);
+	glBufferData(GL_ARRAY_BUFFER, vertexCount*sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)0);
+	glEnableVertexAttribArray(0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+// NOTE(joon) : Render thread only
+static void
+UploadModelBuffers(model *model)
+{
+	glGenVertexArrays(1, &model->vertexArrayID);
+	glBindVertexArray(model->vertexArrayID);
+
+	glGenBuffers(1, &model->vertexBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, model->vertexBufferID);
+	glBufferData(GL_ARRAY_BUFFER,
+		model->mesh.vertexBuffer.size() * sizeof(vertex), model->mesh.vertexBuffer.data(),
+		GL_STATIC_DRAW);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vertex), (void *)offsetof(vertex, p));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(vertex), (void *)offsetof(vertex, normal));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), (void *)offsetof(vertex, texCoord));
+	glEnableVertexAttribArray(2);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	glGenBuffers(1, &model->indexBufferID);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model->indexBufferID);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, model->mesh.indexBuffer.size() * sizeof(unsigned int), model->mesh.indexBuffer.data(),
+		GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	UploadModelPositions(model);
+
+	model->uploadedVertexCount = (u32)model->mesh.vertexBuffer.size();
+	model->uploadedIndexCount = (u32)model->mesh.indexBuffer.size();
+}
+
+// NOTE(joon) : Render thread only, the build stage sees the model as Resident after this
+static void
+UploadRegistryModel(model_registry_entry *entry)
+{
+	UploadModelBuffers(entry->model);
+	entry->residency.store(ModelResidency_Resident, std::memory_order_release);
+}
+
+// NOTE(joon) : Render thread only, the program is the texcoord_mapping_shader.comp
+static void
+MapTexCoordsOnGPU(GLuint program, GLuint vertexBufferID, u32 vertexCount, int textureMappingMethod, b32 shouldUseP)
+{
+	glUseProgram(program);
+	glUniform1ui(TEXCOORD_MAPPING_VERTEX_COUNT_LOCATION, vertexCount);
+	glUniform1i(TEXCOORD_MAPPING_METHOD_LOCATION, textureMappingMethod);
+	glUniform1ui(TEXCOORD_MAPPING_SHOULD_USE_P_LOCATION, shouldUseP ? 1 : 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, vertexBufferID);
+
+	glDispatchCompute((vertexCount + TEXCOORD_MAPPING_GROUP_SIZE - 1) / TEXCOORD_MAPPING_GROUP_SIZE, 1, 1);
+	// NOTE(joon) : The next draw reads the texcoords as the vertex attribute
+	glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+}
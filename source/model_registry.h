@@ -0,0 +1,117 @@
+#ifndef MODEL_REGISTRY_H
+#define MODEL_REGISTRY_H
+
+// NOTE(joon) : Models are loaded & uploaded the first time the build stage asks for them, instead of at the startup.
+// The build stage owns the registry, and decides everything that happens to a model from there :
+// Unloaded -> Loading(job reads & parses the file) -> Loaded(only on the CPU) -> Uploading(packet records the upload) -> Resident
+// The load job & the render thread only move the model to the next state when they are done with it.
+//
+// When the resident models go over the GPU budget, the least recently requested ones lose their GL objects
+// and go back to Loaded, so that the next request only needs the upload.
+//
+// With the compute texture mapping(GPU only meshes), the CPU mesh of a resident model is released once the render thread
+// is done with it, and the texcoords are remapped by a compute shader that writes into the vertex buffer.
+// Those models go back to Unloaded when they are evicted, as there's nothing left to upload.
+
+#define MODEL_REGISTRY_DEFAULT_GPU_BUDGET (64*1024*1024) // in bytes
+// NOTE(joon) : The upload & the texcoord update read the CPU mesh while the packet is recorded & executed,
+// and a packet slot is only reused after its frame is executed. Should not be smaller than FRAME_PACKET_COUNT!
+#define MODEL_MESH_BUSY_FRAME_COUNT 3
+
+// NOTE(joon) : Should match the ones inside texcoord_mapping_shader.comp
+#define TEXCOORD_MAPPING_GROUP_SIZE 64
+#define TEXCOORD_MAPPING_VERTEX_COUNT_LOCATION 0
+#define TEXCOORD_MAPPING_METHOD_LOCATION 1
+#define TEXCOORD_MAPPING_SHOULD_USE_P_LOCATION 2
+
+enum model_residency
+{
+	ModelResidency_Unloaded,
+	ModelResidency_Loading,
+	ModelResidency_Loaded,
+	ModelResidency_Uploading,
+	ModelResidency_Resident,
+	ModelResidency_Failed, // the file couldn't be read or was empty, never loaded again
+};
+
+struct model_registry_entry
+{
+	struct model *model;
+	u32 modelIndex;
+
+	// NOTE(joon) : The load job & the render thread only write this to hand the model back to the build stage
+	std::atomic<u32> residency;
+
+	u64 cpuBytes; // written by the load job before it's Loaded
+
+	// NOTE(joon) : Everything else is only touched by the build stage
+	u64 lastRequestedFrame; // for the LRU
+	u64 meshBusyUntilFrame; // the CPU mesh can be still read by the render thread or the recording before this frame
+	u64 gpuBytes; // 0 unless it's uploading or resident
+	u32 uploadCount;
+	b32 isCPUMeshReleased; // only the meshlets are left on the CPU, the texcoords can only be remapped by the GPU
+
+	// NOTE(joon) : The texcoords were generated with these, both the CPU mesh(if it's not released) and the vertex buffer
+	int textureMappingMethod;
+	b32 shouldUseP;
+
+	// NOTE(joon) : Only used by the load job
+	load_model_job_data loadJobData;
+	async_read read;
+	struct model_registry *registry;
+};
+
+// NOTE(joon) : IDs of the model that was evicted, copied by the build stage
+// because the model can be uploaded again before the delete command is executed
+struct evicted_model_buffers
+{
+	GLuint vertexArrayIDs[2]; // all the attributes, positions only
+	GLuint bufferIDs[3]; // vertex, index, positions
+};
+
+// NOTE(joon) : Texcoords of a resident model without the CPU mesh, regenerated by the compute shader
+struct gpu_texcoord_mapping
+{
+	GLuint vertexBufferID;
+	u32 vertexCount;
+	int textureMappingMethod;
+	b32 shouldUseP;
+};
+
+// NOTE(joon) : What the build stage decided for a packet, recorded before any draw of that packet
+struct model_residency_changes
+{
+	std::vector<model_registry_entry *> uploads;
+	std::vector<evicted_model_buffers> evictions;
+	std::vector<model_registry_entry *> vertexBufferUpdates; // texcoords of the resident models were regenerated
+	std::vector<gpu_texcoord_mapping> gpuTexCoordMappings;
+};
+
+struct model_registry
+{
+	job_system *jobSystem;
+	async_io *io; // only for LoadAllRegistryModels, 0 to read with the worker jobs. The loads on request never use it
+
+	// NOTE(joon) : Without the GL context(headless), the models become resident as soon as they are loaded
+	b32 hasGPU;
+
+	model *models; // one per modelFileNames, the mesh is empty until it gets loaded
+	model_registry_entry *entries;
+	u32 modelCount;
+
+	// NOTE(joon) : Texture mapping of the scene, the texcoords of the loaded models are regenerated when it changes
+	int textureMappingMethod;
+	b32 shouldUseP;
+	b32 shouldMapTexCoords; // false while the texcoords are generated by the vertex shader
+	b32 shouldReleaseCPUMeshes; // the texcoords are mapped by the compute shader
+	b32 canMapTexCoordsOnGPU; // the compute shader is available, should be set before the first request
+	u64 frameIndex; // of the packet that is being built
+
+	u64 gpuBudget; // in bytes
+	u64 gpuBytes; // of the uploading & resident models
+	u32 evictionCount;
+
+	std::atomic<i32> pendingLoadCount;
+};
+
+#endif
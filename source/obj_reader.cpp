@@ -6,9 +6,6 @@ struct vertex_hit
 	u32 hitCount = 0;
 };
 
-#define Minimum(a, b) ((a < b) ? a : b)
-#define Maximum(a, b) ((a > b)? a : b)
-
 static void
 UpdateBoundingBox(glm::vec3 *min, glm::vec3 *max, glm::vec3 value)
 {
@@ -21,18 +18,23 @@ UpdateBoundingBox(glm::vec3 *min, glm::vec3 *max, glm::vec3 value)
 	max->z = Maximum(max->z, value.z);
 }
 
+struct generate_normals_job_data
+{
+	struct mesh *mesh;
+	glm::vec3 *faceNormals;
+	vertex_hit *vertexHits;
+};
+
 static void
-GenerateVertexAndFaceNormals(mesh *mesh)
+GenerateFaceNormalsJob(void *data, u32 start, u32 onePastEnd)
 {
-	std::vector<vertex_hit>vertexHitCount(mesh->vertexBuffer.size());
-	u32 faceCount = (u32)mesh->indexBuffer.size()/3;
-	mesh->faceNormalBuffer.resize(faceCount);
-	for (u32 faceIndex = 0;
-		faceIndex < faceCount;
+	generate_normals_job_data *jobData = (generate_normals_job_data *)data;
+	mesh *mesh = jobData->mesh;
+
+	for (u32 faceIndex = start;
+		faceIndex < onePastEnd;
 		++faceIndex)
 	{
-		line* line = mesh->faceNormalBuffer.data() + faceIndex;
-
 		GLuint firstIndex = mesh->indexBuffer[3*(u64)faceIndex + 0];
 		GLuint secondIndex = mesh->indexBuffer[3*(u64)faceIndex + 1];
 		GLuint thirdIndex = mesh->indexBuffer[3*(u64)faceIndex + 2];
@@ -44,59 +46,162 @@ GenerateVertexAndFaceNormals(mesh *mesh)
 		glm::vec3 v01 = secondVertex - firstVertex;
 		glm::vec3 v02 = thirdVertex - firstVertex;
 
-		glm::vec3 faceNormal = glm::normalize(glm::cross(v01, v02));
-		line->start = (firstVertex + secondVertex + thirdVertex)/3.0f;
-		line->end = line->start + faceNormal;
-
-		++vertexHitCount[firstIndex].hitCount;
-		vertexHitCount[firstIndex].normalSum += faceNormal;
+		jobData->faceNormals[faceIndex] = glm::normalize(glm::cross(v01, v02));
+	}
+}
 
-		++vertexHitCount[secondIndex].hitCount;
-		vertexHitCount[secondIndex].normalSum += faceNormal;
+static void
+GenerateVertexNormalsJob(void *data, u32 start, u32 onePastEnd)
+{
+	generate_normals_job_data *jobData = (generate_normals_job_data *)data;
+	mesh *mesh = jobData->mesh;
 
-		++vertexHitCount[thirdIndex].hitCount;
-		vertexHitCount[thirdIndex].normalSum += faceNormal;
+	for (u32 vertexIndex = start;
+		vertexIndex < onePastEnd;
+		++vertexIndex)
+	{
+		vertex_hit *hit = jobData->vertexHits + vertexIndex;
+		mesh->vertexBuffer[vertexIndex].normal = glm::normalize((hit->normalSum / (r32)hit->hitCount));
 	}
+}
 
-	mesh->vertexNormalLineBuffer.resize(mesh->vertexBuffer.size());
-	for (u32 vertexIndex = 0;
-		vertexIndex < mesh->vertexBuffer.size();
-		++vertexIndex)
+// NOTE(joon) : When shouldGenerateVertexNormals is false, the vertex normals that are already inside the mesh
+// (i.e from the obj file) are kept, and there's nothing else to generate.
+// The face normals are only needed for the vertex normals, the lines that visualize them are generated by the GPU.
+static void
+GenerateVertexAndFaceNormals(job_system *jobSystem, mesh *mesh, b32 shouldGenerateVertexNormals = true)
+{
+	if (!shouldGenerateVertexNormals)
 	{
-		mesh->vertexBuffer[vertexIndex].normal = glm::normalize((vertexHitCount[vertexIndex].normalSum / (r32)vertexHitCount[vertexIndex].hitCount));
+		return;
+	}
+
+	std::vector<vertex_hit>vertexHitCount(mesh->vertexBuffer.size());
+	u32 faceCount = (u32)mesh->indexBuffer.size()/3;
+	std::vector<glm::vec3>faceNormals(faceCount);
+
+	generate_normals_job_data jobData = {};
+	jobData.mesh = mesh;
+	jobData.faceNormals = faceNormals.data();
+	jobData.vertexHits = vertexHitCount.data();
 
-		mesh->vertexNormalLineBuffer[vertexIndex].start = mesh->vertexBuffer[vertexIndex].p;
-		mesh->vertexNormalLineBuffer[vertexIndex].end = mesh->vertexBuffer[vertexIndex].p + mesh->vertexBuffer[vertexIndex].normal;
+	ParallelFor(jobSystem, GenerateFaceNormalsJob, &jobData, "GenerateFaceNormals", faceCount, 1024);
+
+	// NOTE(joon) : Faces are scattering into the shared vertices, so this part stays serial.
+	// This is just a few adds per face, the expensive part(cross & normalize) is done above.
+	for (u32 faceIndex = 0;
+		faceIndex < faceCount;
+		++faceIndex)
+	{
+		glm::vec3 faceNormal = faceNormals[faceIndex];
+		for (u32 cornerIndex = 0;
+			cornerIndex < 3;
+			++cornerIndex)
+		{
+			vertex_hit *hit = vertexHitCount.data() + mesh->indexBuffer[3*(u64)faceIndex + cornerIndex];
+			++hit->hitCount;
+			hit->normalSum += faceNormal;
+		}
 	}
+
+	ParallelFor(jobSystem, GenerateVertexNormalsJob, &jobData, "GenerateVertexNormals", (u32)mesh->vertexBuffer.size(), 1024);
 }
 
-void
-ReadOBJFileLineByLine(mesh *mesh, const char* fileName)
+// NOTE(joon) : strtok is not thread safe, and each chunk of the file is parsed by a different worker
+#if defined(_WIN32)
+#define strtok_r strtok_s
+#endif
+
+// NOTE(joon) : Position, texcoord and normal index of a single face corner.
+// Positive obj indices are stored as they are(starting from 0), but the negative ones are relative to
+// what was read so far. That count is only known inside the chunk, so those are stored as the index inside the chunk
+// and the matching relativeMask bit is set, the chunk bases are added when the chunks are merged.
+#define OBJ_MISSING_INDEX INT32_MIN
+struct obj_corner
 {
-	glm::vec3 min(FLT_MAX, FLT_MAX, FLT_MAX);
-	glm::vec3 max(FLT_MIN, FLT_MIN, FLT_MIN);
+	i32 indices[3]; // p, t, n
+	u32 relativeMask;
+};
 
-	std::vector< glm::vec3> vertexNormalBuffer;
+// NOTE(joon) : Part of the obj file that ends with a line, parsed by a single job
+struct obj_chunk
+{
+	char *start;
+	char *end;
 
-	glm::vec3 verticesAverage = {};
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> texCoords;
+	std::vector<glm::vec3> normals;
+	std::vector<obj_corner> corners; // 3 per triangle, polygons are already fan triangulated
+
+	b32 hasTexCoordIndices;
+	b32 hasNormalIndices;
+};
+
+struct parse_obj_job_data
+{
+	obj_chunk *chunks;
+};
 
-	std::ifstream file;
-	file.open(fileName);
+// NOTE(joon) : Parses v, v/vt, v//vn or v/vt/vn
+static obj_corner
+ParseOBJCorner(obj_chunk *chunk, char *token)
+{
+	i32 localCounts[3] = {(i32)chunk->positions.size(), (i32)chunk->texCoords.size(), (i32)chunk->normals.size()};
 
-	if (file.bad() || file.eof() || file.fail())
+	obj_corner result = {};
+	char *at = token;
+	for (u32 componentIndex = 0;
+		componentIndex < 3;
+		++componentIndex)
 	{
-		printf("Invalid OBJ file!\n");
+		char *numberEnd = at;
+		i32 index = (at && *at != '/') ? (i32)strtol(at, &numberEnd, 10) : 0;
+		if (index > 0)
+		{
+			result.indices[componentIndex] = index - 1; // NOTE(joon) : obj file index starts from 1, but ours start from 0
+		}
+		else if (index < 0)
+		{
+			result.indices[componentIndex] = localCounts[componentIndex] + index;
+			result.relativeMask |= (1 << componentIndex);
+		}
+		else
+		{
+			result.indices[componentIndex] = OBJ_MISSING_INDEX;
+		}
+
+		at = (at && *numberEnd == '/') ? numberEnd + 1 : 0;
 	}
 
-	while (!file.eof())
+	chunk->hasTexCoordIndices |= (result.indices[1] != OBJ_MISSING_INDEX);
+	chunk->hasNormalIndices |= (result.indices[2] != OBJ_MISSING_INDEX);
+
+	return result;
+}
+
+static void
+ParseOBJChunk(obj_chunk *chunk)
+{
+	char *at = chunk->start;
+	while (at < chunk->end)
 	{
+		char *lineEnd = (char *)memchr(at, '\n', chunk->end - at);
+		if (!lineEnd)
+		{
+			lineEnd = chunk->end;
+		}
+
 		char buffer[256] = "\0";
-		file.getline(buffer, ArrayCount(buffer), 
-						'\n'); // NOTE(joon) : stop when this character appears
+		size_t lineLength = Minimum((size_t)(lineEnd - at), ArrayCount(buffer) - 1);
+		memcpy(buffer, at, lineLength);
+		buffer[lineLength] = '\0';
+		at = lineEnd + 1;
 
 		const char* delimit = " \r\n\t";
 
-		char* token = strtok(buffer, delimit);
+		char *context = 0;
+		char* token = strtok_r(buffer, delimit, &context);
 
 		if (token)
 		{
@@ -107,101 +212,103 @@ ReadOBJFileLineByLine(mesh *mesh, const char* fileName)
 				{
 					if (token[1] == '\0')
 					{
-						vertex vertex;
-						token = strtok(nullptr, delimit);
-						vertex.p.x = (GLfloat)atof(token);
+						glm::vec3 p;
+						token = strtok_r(nullptr, delimit, &context);
+						p.x = token ? (GLfloat)atof(token) : 0.0f;
 
-						token = strtok(nullptr, delimit);
-						vertex.p.y = (GLfloat)atof(token);
+						token = strtok_r(nullptr, delimit, &context);
+						p.y = token ? (GLfloat)atof(token) : 0.0f;
 
-						token = strtok(0, delimit);
-						vertex.p.z = (GLfloat)atof(token);
+						token = strtok_r(0, delimit, &context);
+						p.z = token ? (GLfloat)atof(token) : 0.0f;
 
-						UpdateBoundingBox(&min, &max, vertex.p);
-						verticesAverage += vertex.p;
-						mesh->vertexBuffer.push_back(vertex);
+						chunk->positions.push_back(p);
 					}
+					else if (token[1] == 't')
+					{
+						// NOTE(joon) : vertex texcoord, the third component is ignored
+						glm::vec2 texCoord;
+						token = strtok_r(0, delimit, &context);
+						texCoord.x = token ? (GLfloat)atof(token) : 0.0f;
 
-					// We don't load vertex normal from the file,
-					// we generate it ourselves.
-#if 0
+						token = strtok_r(0, delimit, &context);
+						texCoord.y = token ? (GLfloat)atof(token) : 0.0f;
+
+						// NOTE(joon) : obj texcoord starts from the bottom of the image,
+						// but the first row of our textures is t = 0(see how the textures are loaded)
+						texCoord.y = 1.0f - texCoord.y;
+
+						chunk->texCoords.push_back(texCoord);
+					}
 					else if (token[1] == 'n')
 					{
 						// NOTE(joon) : vertex normal
 						glm::vec3 normal;
+						token = strtok_r(0, delimit, &context);
+						normal.x = token ? (GLfloat)atof(token) : 0.0f;
 
-						token = strtok(0, delimit);
-						if (token == nullptr)
-						{
-							break;
-						}
-						normal.x = (GLfloat)atof(token);
+						token = strtok_r(0, delimit, &context);
+						normal.y = token ? (GLfloat)atof(token) : 0.0f;
 
-						token = strtok(0, delimit);
-						if (token == nullptr)
-						{
-							break;
-						}
-						normal.y = (GLfloat)atof(token);
+						token = strtok_r(0, delimit, &context);
+						normal.z = token ? (GLfloat)atof(token) : 0.0f;
 
-						token = strtok(0, delimit);
-						if (token == nullptr)
+						r32 length = glm::length(normal);
+						if (length > 0.0f)
 						{
-							break;
+							normal /= length;
 						}
-						normal.z = (GLfloat)atof(token);
 
-						vertexNormalBuffer.push_back(glm::normalize(normal));
+						chunk->normals.push_back(normal);
 					}
-#endif
 				}break;
 
 				// NOTE(joon) : face
 				case 'f':
 				{
-					GLuint firstIndex;
+					obj_corner firstCorner;
 
-					GLuint secondIndex;
+					obj_corner secondCorner;
 
-					GLuint thirdIndex;
+					obj_corner thirdCorner;
 
-					token = strtok(0, delimit);
+					token = strtok_r(0, delimit, &context);
 					if (token == nullptr)
 					{
 						break;
 					}
-					firstIndex = (unsigned int)(atoi(token) - 1); // NOTE(joon) : obj file index starts from 1, but ours start from 0
+					firstCorner = ParseOBJCorner(chunk, token);
 
-					token = strtok(0, delimit);
+					token = strtok_r(0, delimit, &context);
 					if (token == nullptr)
 					{
 						break;
 					}
-					secondIndex = (unsigned int)(atoi(token) - 1);
+					secondCorner = ParseOBJCorner(chunk, token);
 
-					token = strtok(0, delimit);
+					token = strtok_r(0, delimit, &context);
 					if (token == nullptr)
 					{
 						break;
 					}
-					thirdIndex = (unsigned int)(atoi(token) - 1);
+					thirdCorner = ParseOBJCorner(chunk, token);
 
-					mesh->indexBuffer.push_back(firstIndex);
-					mesh->indexBuffer.push_back(secondIndex);
-					mesh->indexBuffer.push_back(thirdIndex);
+					chunk->corners.push_back(firstCorner);
+					chunk->corners.push_back(secondCorner);
+					chunk->corners.push_back(thirdCorner);
 
 					// NOTE(joon) : Get all the indexes inside the line 'face'
-					token = strtok(nullptr, delimit);
+					token = strtok_r(nullptr, delimit, &context);
 					while (token != nullptr)
 					{
-						secondIndex = thirdIndex;
-						thirdIndex = static_cast<unsigned int&&>(atoi(token) - 1);
+						secondCorner = thirdCorner;
+						thirdCorner = ParseOBJCorner(chunk, token);
 
-						mesh->indexBuffer.push_back(firstIndex);
-						mesh->indexBuffer.push_back(secondIndex);
-						mesh->indexBuffer.push_back(thirdIndex);
+						chunk->corners.push_back(firstCorner);
+						chunk->corners.push_back(secondCorner);
+						chunk->corners.push_back(thirdCorner);
 
-						token = strtok(nullptr, delimit);
+						token = strtok_r(nullptr, delimit, &context);
 					}
 				}break;
 
@@ -211,33 +318,394 @@ ReadOBJFileLineByLine(mesh *mesh, const char* fileName)
 			}
 		}
 	}
+}
 
-	// NOTE(joon) : Center the model to (0, 0)
-	verticesAverage /= mesh->vertexBuffer.size();
-	for (u32 vertexIndex = 0;
-		vertexIndex < mesh->vertexBuffer.size();
+static void
+ParseOBJChunkJob(void *data, u32 start, u32 onePastEnd)
+{
+	parse_obj_job_data *jobData = (parse_obj_job_data *)data;
+	for (u32 chunkIndex = start;
+		chunkIndex < onePastEnd;
+		++chunkIndex)
+	{
+		ParseOBJChunk(jobData->chunks + chunkIndex);
+	}
+}
+
+struct normalize_vertices_job_data
+{
+	vertex *vertices;
+	glm::vec3 verticesAverage;
+	r32 maxDiff;
+};
+
+static void
+NormalizeVerticesJob(void *data, u32 start, u32 onePastEnd)
+{
+	normalize_vertices_job_data *jobData = (normalize_vertices_job_data *)data;
+	for (u32 vertexIndex = start;
+		vertexIndex < onePastEnd;
 		++vertexIndex)
 	{
-		mesh->vertexBuffer[vertexIndex].p -= verticesAverage;
+		// NOTE(joon) : Center the model to (0, 0), and resize it so that it can fit inside the [-1, 1] bounding box
+		vertex *vertex = jobData->vertices + vertexIndex;
+		vertex->p -= jobData->verticesAverage;
+		vertex->p.x /= jobData->maxDiff;
+		vertex->p.y /= jobData->maxDiff;
+		vertex->p.z /= jobData->maxDiff;
+	}
+}
+
+struct vertex_bounds_chunk
+{
+	glm::vec3 min;
+	glm::vec3 max;
+	glm::vec3 positionSum;
+};
+
+struct vertex_bounds_job_data
+{
+	vertex *vertices;
+	u32 vertexCount;
+	u32 chunkCount;
+	vertex_bounds_chunk *chunks;
+};
+
+static void
+GetVertexBoundsJob(void *data, u32 start, u32 onePastEnd)
+{
+	vertex_bounds_job_data *jobData = (vertex_bounds_job_data *)data;
+	for (u32 chunkIndex = start;
+		chunkIndex < onePastEnd;
+		++chunkIndex)
+	{
+		vertex_bounds_chunk *chunk = jobData->chunks + chunkIndex;
+		chunk->min = glm::vec3(FLT_MAX, FLT_MAX, FLT_MAX);
+		chunk->max = glm::vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		chunk->positionSum = glm::vec3(0.0f, 0.0f, 0.0f);
+
+		u32 firstVertex = (u32)(((u64)jobData->vertexCount*chunkIndex)/jobData->chunkCount);
+		u32 onePastLastVertex = (u32)(((u64)jobData->vertexCount*(chunkIndex + 1))/jobData->chunkCount);
+		for (u32 vertexIndex = firstVertex;
+			vertexIndex < onePastLastVertex;
+			++vertexIndex)
+		{
+			glm::vec3 p = jobData->vertices[vertexIndex].p;
+			UpdateBoundingBox(&chunk->min, &chunk->max, p);
+			chunk->positionSum += p;
+		}
+	}
+}
+
+// NOTE(joon) : Centers every loaded mesh(obj, ply, gltf) and fits it inside [-1, 1].
+// The workers reduce the bounds & the sum of their own part of the vertices.
+static void
+NormalizeMeshVertices(job_system *jobSystem, mesh *mesh)
+{
+	if (mesh->vertexBuffer.empty())
+	{
+		return;
 	}
 
+	// NOTE(joon) : An empty chunk would merge its FLT_MAX bounds, so there are never more chunks than the vertices
+	u32 chunkCount = Minimum(4*jobSystem->workerCount, (u32)mesh->vertexBuffer.size());
+	std::vector<vertex_bounds_chunk> boundsChunks(chunkCount);
+	vertex_bounds_job_data boundsData = {};
+	boundsData.vertices = mesh->vertexBuffer.data();
+	boundsData.vertexCount = (u32)mesh->vertexBuffer.size();
+	boundsData.chunkCount = chunkCount;
+	boundsData.chunks = boundsChunks.data();
+	ParallelFor(jobSystem, GetVertexBoundsJob, &boundsData, "GetVertexBounds", chunkCount, 1);
+
+	glm::vec3 min(FLT_MAX, FLT_MAX, FLT_MAX);
+	glm::vec3 max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	glm::vec3 verticesAverage = {};
+	for (u32 chunkIndex = 0;
+		chunkIndex < chunkCount;
+		++chunkIndex)
+	{
+		UpdateBoundingBox(&min, &max, boundsChunks[chunkIndex].min);
+		UpdateBoundingBox(&min, &max, boundsChunks[chunkIndex].max);
+		verticesAverage += boundsChunks[chunkIndex].positionSum;
+	}
+	verticesAverage /= mesh->vertexBuffer.size();
+
 	r32 xDiff = (max.x - min.x)/2.0f;
 	r32 yDiff = (max.y - min.y)/2.0f;
 	r32 zDiff = (max.z - min.z)/2.0f;
 
-	r32 maxDiff = Maximum(Maximum(xDiff, yDiff), zDiff);
-	
-	// NOTE(joon) : Resize the model so that it can fit inside the [-1, 1] bounding box
-	for (u32 vertexIndex = 0;
-		vertexIndex < mesh->vertexBuffer.size();
-		++vertexIndex)
+	normalize_vertices_job_data normalizeData = {};
+	normalizeData.vertices = mesh->vertexBuffer.data();
+	normalizeData.verticesAverage = verticesAverage;
+	normalizeData.maxDiff = Maximum(Maximum(xDiff, yDiff), zDiff);
+	ParallelFor(jobSystem, NormalizeVerticesJob, &normalizeData, "NormalizeVertices", (u32)mesh->vertexBuffer.size(), 4096);
+}
+
+#define OBJ_RESOLVED_MISSING_INDEX 0xffffffff
+
+// NOTE(joon) : Returns OBJ_RESOLVED_MISSING_INDEX for the missing or out of range indices
+static u32
+ResolveOBJIndex(obj_corner *corner, u32 componentIndex, u32 chunkBase, u32 count)
+{
+	u32 result = OBJ_RESOLVED_MISSING_INDEX;
+
+	i32 index = corner->indices[componentIndex];
+	if (index != OBJ_MISSING_INDEX)
 	{
-		mesh->vertexBuffer[vertexIndex].p.x /= maxDiff;
-		mesh->vertexBuffer[vertexIndex].p.y /= maxDiff;
-		mesh->vertexBuffer[vertexIndex].p.z /= maxDiff;
+		i64 resolved = (i64)index;
+		if (corner->relativeMask & (1 << componentIndex))
+		{
+			resolved += chunkBase;
+		}
+
+		if (resolved >= 0 && resolved < (i64)count)
+		{
+			result = (u32)resolved;
+		}
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Open addressing(linear probing) hash map from the p/t/n triple to the welded vertex.
+// The capacity is at least twice the corner count, so it never needs to grow and the probes stay short.
+struct obj_weld_entry
+{
+	u32 indices[3];
+	u32 vertexIndex; // OBJ_RESOLVED_MISSING_INDEX if the entry is empty
+};
+
+static u32
+HashOBJIndices(u32 *indices)
+{
+	u32 result = indices[0]*0x9e3779b1;
+	result = (result ^ (result >> 15)) + indices[1]*0x85ebca77;
+	result = (result ^ (result >> 13)) + indices[2]*0xc2b2ae3d;
+	result ^= result >> 16;
+
+	return result;
+}
+
+static u32
+WeldOBJVertex(std::vector<obj_weld_entry> *weldTable, mesh *mesh, u32 *indices, 
+			glm::vec3 *positions, glm::vec2 *texCoords, glm::vec3 *normals)
+{
+	u32 mask = (u32)weldTable->size() - 1;
+	u32 entryIndex = HashOBJIndices(indices) & mask;
+	for (;;)
+	{
+		obj_weld_entry *entry = weldTable->data() + entryIndex;
+		if (entry->vertexIndex == OBJ_RESOLVED_MISSING_INDEX)
+		{
+			entry->indices[0] = indices[0];
+			entry->indices[1] = indices[1];
+			entry->indices[2] = indices[2];
+			entry->vertexIndex = (u32)mesh->vertexBuffer.size();
+
+			vertex vertex = {};
+			vertex.p = positions[indices[0]];
+			if (indices[1] != OBJ_RESOLVED_MISSING_INDEX)
+			{
+				vertex.texCoord = texCoords[indices[1]];
+			}
+			if (indices[2] != OBJ_RESOLVED_MISSING_INDEX)
+			{
+				vertex.normal = normals[indices[2]];
+			}
+			mesh->vertexBuffer.push_back(vertex);
+
+			return entry->vertexIndex;
+		}
+
+		if (entry->indices[0] == indices[0] && 
+			entry->indices[1] == indices[1] && 
+			entry->indices[2] == indices[2])
+		{
+			return entry->vertexIndex;
+		}
+
+		entryIndex = (entryIndex + 1) & mask;
+	}
+}
+
+// NOTE(joon) : The whole file is split into chunks at the line boundaries so that each worker can parse its own chunk.
+// Chunks are merged in order afterwards. Lines are copied out before they get tokenized, so the file is never written.
+// fileName is only for the messages.
+static void
+ParseOBJFile(job_system *jobSystem, mesh *mesh, char *fileContents, size_t fileSize, const char *fileName)
+{
+
+	// NOTE(joon) : Don't bother splitting small files
+	size_t minChunkSize = 256*1024;
+	u32 chunkCount = (u32)Minimum(fileSize/minChunkSize + 1, (size_t)(4*jobSystem->workerCount));
+	std::vector<obj_chunk> chunks(chunkCount);
+
+	char *fileStart = fileContents;
+	char *fileEnd = fileStart + fileSize;
+	char *chunkStart = fileStart;
+	for (u32 chunkIndex = 0;
+		chunkIndex < chunkCount;
+		++chunkIndex)
+	{
+		char *chunkEnd = fileEnd;
+		if (chunkIndex != chunkCount - 1)
+		{
+			chunkEnd = Minimum(fileStart + (fileSize*(chunkIndex + 1))/chunkCount, fileEnd);
+			if (chunkEnd < chunkStart)
+			{
+				chunkEnd = chunkStart;
+			}
+			// NOTE(joon) : Chunk should always end right after the line
+			while (chunkEnd < fileEnd && chunkEnd[-1] != '\n')
+			{
+				++chunkEnd;
+			}
+		}
+
+		chunks[chunkIndex].start = chunkStart;
+		chunks[chunkIndex].end = chunkEnd;
+		chunkStart = chunkEnd;
+	}
+
+	parse_obj_job_data parseData = {};
+	parseData.chunks = chunks.data();
+	ParallelFor(jobSystem, ParseOBJChunkJob, &parseData, "ParseOBJChunk", chunkCount, 1);
+
+	// NOTE(joon) : Indices inside the chunks are global, except the relative ones(see obj_corner)
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> texCoords;
+	std::vector<glm::vec3> normals;
+	std::vector<u32> positionBases(chunkCount);
+	std::vector<u32> texCoordBases(chunkCount);
+	std::vector<u32> normalBases(chunkCount);
+
+	size_t cornerCount = 0;
+	b32 hasTexCoordIndices = false;
+	b32 hasNormalIndices = false;
+	for (u32 chunkIndex = 0;
+		chunkIndex < chunkCount;
+		++chunkIndex)
+	{
+		obj_chunk *chunk = chunks.data() + chunkIndex;
+		positionBases[chunkIndex] = (u32)positions.size();
+		texCoordBases[chunkIndex] = (u32)texCoords.size();
+		normalBases[chunkIndex] = (u32)normals.size();
+		positions.insert(positions.end(), chunk->positions.begin(), chunk->positions.end());
+		texCoords.insert(texCoords.end(), chunk->texCoords.begin(), chunk->texCoords.end());
+		normals.insert(normals.end(), chunk->normals.begin(), chunk->normals.end());
+
+		cornerCount += chunk->corners.size();
+		hasTexCoordIndices |= chunk->hasTexCoordIndices;
+		hasNormalIndices |= chunk->hasNormalIndices;
+	}
+
+	// NOTE(joon) : Files without any texcoord or normal index can use the positions as they are,
+	// otherwise each unique p/t/n triple becomes a vertex.
+	b32 shouldWeld = hasTexCoordIndices || hasNormalIndices;
+	std::vector<obj_weld_entry> weldTable;
+	if (shouldWeld)
+	{
+		size_t weldTableSize = 16;
+		while (weldTableSize < 2*cornerCount)
+		{
+			weldTableSize *= 2;
+		}
+		obj_weld_entry emptyEntry = {};
+		emptyEntry.vertexIndex = OBJ_RESOLVED_MISSING_INDEX;
+		weldTable.resize(weldTableSize, emptyEntry);
+
+		mesh->vertexBuffer.reserve(mesh->vertexBuffer.size() + Minimum(positions.size() + texCoords.size() + normals.size(), cornerCount));
+	}
+	else
+	{
+		mesh->vertexBuffer.reserve(mesh->vertexBuffer.size() + positions.size());
+		for (u32 positionIndex = 0;
+			positionIndex < positions.size();
+			++positionIndex)
+		{
+			vertex vertex;
+			vertex.p = positions[positionIndex];
+			mesh->vertexBuffer.push_back(vertex);
+		}
+	}
+	mesh->indexBuffer.reserve(mesh->indexBuffer.size() + cornerCount);
+
+	b32 hasAllTexCoords = hasTexCoordIndices;
+	b32 hasAllNormals = hasNormalIndices;
+	u32 invalidTriangleCount = 0;
+	for (u32 chunkIndex = 0;
+		chunkIndex < chunkCount;
+		++chunkIndex)
+	{
+		obj_chunk *chunk = chunks.data() + chunkIndex;
+		for (u32 cornerIndex = 0;
+			cornerIndex + 3 <= chunk->corners.size();
+			cornerIndex += 3)
+		{
+			u32 triangleIndices[3][3];
+			b32 isValid = true;
+			for (u32 triangleCornerIndex = 0;
+				triangleCornerIndex < 3;
+				++triangleCornerIndex)
+			{
+				obj_corner *corner = chunk->corners.data() + cornerIndex + triangleCornerIndex;
+				u32 *indices = triangleIndices[triangleCornerIndex];
+				indices[0] = ResolveOBJIndex(corner, 0, positionBases[chunkIndex], (u32)positions.size());
+				indices[1] = ResolveOBJIndex(corner, 1, texCoordBases[chunkIndex], (u32)texCoords.size());
+				indices[2] = ResolveOBJIndex(corner, 2, normalBases[chunkIndex], (u32)normals.size());
+
+				isValid &= (indices[0] != OBJ_RESOLVED_MISSING_INDEX);
+			}
+
+			if (!isValid)
+			{
+				++invalidTriangleCount;
+				continue;
+			}
+
+			for (u32 triangleCornerIndex = 0;
+				triangleCornerIndex < 3;
+				++triangleCornerIndex)
+			{
+				u32 *indices = triangleIndices[triangleCornerIndex];
+				if (shouldWeld)
+				{
+					hasAllTexCoords &= (indices[1] != OBJ_RESOLVED_MISSING_INDEX);
+					hasAllNormals &= (indices[2] != OBJ_RESOLVED_MISSING_INDEX);
+					mesh->indexBuffer.push_back(WeldOBJVertex(&weldTable, mesh, indices, positions.data(), texCoords.data(), normals.data()));
+				}
+				else
+				{
+					mesh->indexBuffer.push_back(indices[0]);
+				}
+			}
+		}
+	}
+
+	if (invalidTriangleCount)
+	{
+		printf("%u triangles with the invalid indices were dropped from %s\n", invalidTriangleCount, fileName);
+	}
+
+	NormalizeMeshVertices(jobSystem, mesh);
+
+	// NOTE(joon) : The normals from the file are kept only when every corner has one,
+	// the uniform scale of the normalization above doesn't change their direction.
+	mesh->hasTexCoords = hasAllTexCoords;
+	GenerateVertexAndFaceNormals(jobSystem, mesh, !hasAllNormals);
+}
+
+void
+ReadOBJFileLineByLine(job_system *jobSystem, mesh *mesh, const char* fileName)
+{
+	asset_file file;
+	if (!ReadAssetFile(fileName, &file))
+	{
+		printf("Invalid OBJ file!\n");
+		return;
 	}
-	
-	GenerateVertexAndFaceNormals(mesh);
+	ParseOBJFile(jobSystem, mesh, (char *)file.data, file.size, fileName);
+	CloseAssetFile(&file);
 }
 
 void
@@ -0,0 +1,559 @@
+#include "occlusion.h"
+
+// NOTE(joon) : The AVX2 path is compiled whenever the compiler can emit it, and gets picked at runtime
+// only if the CPU supports it, so the build itself doesn't need /arch:AVX2.
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#define OCCLUSION_HAS_AVX2 1
+#define OCCLUSION_TARGET_AVX2
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define OCCLUSION_HAS_AVX2 1
+#define OCCLUSION_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+static b32
+IsAVX2Supported()
+{
+	b32 result = false;
+#if OCCLUSION_HAS_AVX2
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	// NOTE(joon) : OS should also save the ymm registers
+	b32 isOSXSaveEnabled = (info[2] & (1 << 27)) != 0;
+	if (isOSXSaveEnabled && (_xgetbv(0) & 6) == 6)
+	{
+		__cpuidex(info, 7, 0);
+		result = (info[1] & (1 << 5)) != 0;
+	}
+#else
+	result = __builtin_cpu_supports("avx2");
+#endif
+#endif
+
+	return result;
+}
+
+static void
+InitializeOcclusionBuffer(occlusion_buffer *buffer, i32 width, i32 height)
+{
+	Assert(width % OCCLUSION_TILE_WIDTH == 0 && height % OCCLUSION_BAND_HEIGHT == 0);
+
+	buffer->width = width;
+	buffer->height = height;
+	buffer->depth = (r32 *)malloc(sizeof(r32)*width*height);
+
+	buffer->tileCountX = width / OCCLUSION_TILE_WIDTH;
+	buffer->tileCountY = height / OCCLUSION_TILE_HEIGHT;
+	buffer->tileMaxDepth = (r32 *)malloc(sizeof(r32)*buffer->tileCountX*buffer->tileCountY);
+
+	buffer->useAVX2 = IsAVX2Supported();
+}
+
+static void
+FreeOcclusionBuffer(occlusion_buffer *buffer)
+{
+	free(buffer->depth);
+	free(buffer->tileMaxDepth);
+	buffer->depth = 0;
+	buffer->tileMaxDepth = 0;
+}
+
+static void
+BeginOcclusionFrame(occlusion_buffer *buffer, glm::mat4 *viewProjection)
+{
+	buffer->viewProjection = *viewProjection;
+	buffer->triangles.clear();
+	buffer->occluderTriangleCount = 0;
+	buffer->testedCount = 0;
+	buffer->occludedCount = 0;
+	buffer->setupTime = 0.0;
+	buffer->rasterizeTime = 0.0;
+	buffer->testTime = 0.0;
+}
+
+// NOTE(joon) : Two triangles that share an edge only stay watertight when their edge functions are exactly
+// the negation of each other, which breaks when the compiler contracts a*b + c into an FMA(/arch:AVX2, -mfma).
+// So the contraction is turned off from the triangle setup to the rasterizers.
+#if defined(_MSC_VER) || defined(__clang__)
+#pragma float_control(push)
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#else
+#pragma fp_contract(off)
+#endif
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+// NOTE(joon) : Expects the vertices in the screen space(x, y in pixels, z in [0, 1])
+static void
+SetupOccluderTriangle(occlusion_buffer *buffer, glm::vec3 v0, glm::vec3 v1, glm::vec3 v2)
+{
+	r32 area = (v1.x - v0.x)*(v2.y - v0.y) - (v2.x - v0.x)*(v1.y - v0.y);
+	if (area < 0.0f)
+	{
+		// NOTE(joon) : Occluders are treated as two sided, so just flip it
+		glm::vec3 temp = v1;
+		v1 = v2;
+		v2 = temp;
+		area = -area;
+	}
+
+	if (area > 1e-6f)
+	{
+		occluder_triangle triangle;
+		triangle.minX = Maximum((i32)floorf(Minimum(Minimum(v0.x, v1.x), v2.x)), 0);
+		triangle.minY = Maximum((i32)floorf(Minimum(Minimum(v0.y, v1.y), v2.y)), 0);
+		triangle.maxX = Minimum((i32)ceilf(Maximum(Maximum(v0.x, v1.x), v2.x)), buffer->width - 1);
+		triangle.maxY = Minimum((i32)ceilf(Maximum(Maximum(v0.y, v1.y), v2.y)), buffer->height - 1);
+
+		if (triangle.minX <= triangle.maxX && triangle.minY <= triangle.maxY)
+		{
+			glm::vec3 *vertices[3] = {&v0, &v1, &v2};
+			for (u32 edgeIndex = 0;
+				edgeIndex < 3;
+				++edgeIndex)
+			{
+				// NOTE(joon) : edge from vertex i to vertex i+1, positive inside as the triangle is counter clockwise
+				glm::vec3 a = *vertices[edgeIndex];
+				glm::vec3 b = *vertices[(edgeIndex + 1) % 3];
+				triangle.edgeA[edgeIndex] = a.y - b.y;
+				triangle.edgeB[edgeIndex] = b.x - a.x;
+				triangle.edgeC[edgeIndex] = a.x*b.y - a.y*b.x;
+			}
+
+			// NOTE(joon) : The barycentric weight of the vertex i is the edge function of the opposite edge(i+1, i+2) / area
+			r32 oneOverArea = 1.0f / area;
+			triangle.depthA = (triangle.edgeA[1]*v0.z + triangle.edgeA[2]*v1.z + triangle.edgeA[0]*v2.z)*oneOverArea;
+			triangle.depthB = (triangle.edgeB[1]*v0.z + triangle.edgeB[2]*v1.z + triangle.edgeB[0]*v2.z)*oneOverArea;
+			triangle.depthC = (triangle.edgeC[1]*v0.z + triangle.edgeC[2]*v1.z + triangle.edgeC[0]*v2.z)*oneOverArea;
+
+			buffer->triangles.push_back(triangle);
+		}
+	}
+}
+
+static glm::vec3
+ClipToScreen(occlusion_buffer *buffer, glm::vec4 clip)
+{
+	r32 oneOverW = 1.0f / clip.w;
+	glm::vec3 result;
+	result.x = (clip.x*oneOverW*0.5f + 0.5f)*buffer->width;
+	result.y = (clip.y*oneOverW*0.5f + 0.5f)*buffer->height;
+	result.z = clip.z*oneOverW*0.5f + 0.5f;
+
+	return result;
+}
+
+// NOTE(joon) : Clips against the near plane(z > -w), which can make up to 2 triangles
+static void
+AddClipSpaceOccluderTriangle(occlusion_buffer *buffer, glm::vec4 *clip)
+{
+	glm::vec4 clipped[4];
+	u32 clippedCount = 0;
+	for (u32 vertexIndex = 0;
+		vertexIndex < 3;
+		++vertexIndex)
+	{
+		glm::vec4 a = clip[vertexIndex];
+		glm::vec4 b = clip[(vertexIndex + 1) % 3];
+		r32 distanceA = a.z + a.w;
+		r32 distanceB = b.z + b.w;
+
+		if (distanceA >= 0.0f)
+		{
+			clipped[clippedCount++] = a;
+		}
+		if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+		{
+			r32 t = distanceA / (distanceA - distanceB);
+			clipped[clippedCount++] = a + t*(b - a);
+		}
+	}
+
+	for (u32 vertexIndex = 2;
+		vertexIndex < clippedCount;
+		++vertexIndex)
+	{
+		SetupOccluderTriangle(buffer,
+							ClipToScreen(buffer, clipped[0]),
+							ClipToScreen(buffer, clipped[vertexIndex - 1]),
+							ClipToScreen(buffer, clipped[vertexIndex]));
+	}
+}
+
+// NOTE(joon) : Returns false when the mesh was skipped because of the triangle budget
+static b32
+AddOccluder(occlusion_buffer *buffer, mesh *mesh, glm::mat4 *world)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	u32 triangleCount = (u32)mesh->indexBuffer.size() / 3;
+	b32 result = (buffer->occluderTriangleCount + triangleCount <= MAX_OCCLUDER_TRIANGLE_COUNT);
+	if (result)
+	{
+		glm::mat4 mvp;
+		MultiplyMatrix4x4(&mvp, &buffer->viewProjection, world);
+
+		buffer->clipPositions.resize(mesh->vertexBuffer.size());
+		for (u32 vertexIndex = 0;
+			vertexIndex < mesh->vertexBuffer.size();
+			++vertexIndex)
+		{
+			buffer->clipPositions[vertexIndex] = mvp * glm::vec4(mesh->vertexBuffer[vertexIndex].p, 1.0f);
+		}
+
+		for (u32 triangleIndex = 0;
+			triangleIndex < triangleCount;
+			++triangleIndex)
+		{
+			u32 *indices = &mesh->indexBuffer[3*triangleIndex];
+			glm::vec4 clip[3] = {buffer->clipPositions[indices[0]], buffer->clipPositions[indices[1]], buffer->clipPositions[indices[2]]};
+			AddClipSpaceOccluderTriangle(buffer, clip);
+		}
+		buffer->occluderTriangleCount += triangleCount;
+	}
+
+	std::chrono::duration<r64, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	buffer->setupTime += elapsed.count();
+
+	return result;
+}
+
+static void
+RasterizeOccluderRowsScalar(occlusion_buffer *buffer, occluder_triangle *triangle, i32 minY, i32 maxY)
+{
+	for (i32 y = minY;
+		y <= maxY;
+		++y)
+	{
+		r32 py = (r32)y + 0.5f;
+		r32 rowEdge0 = triangle->edgeB[0]*py + triangle->edgeC[0];
+		r32 rowEdge1 = triangle->edgeB[1]*py + triangle->edgeC[1];
+		r32 rowEdge2 = triangle->edgeB[2]*py + triangle->edgeC[2];
+		r32 rowDepth = triangle->depthB*py + triangle->depthC;
+
+		r32 *depthRow = buffer->depth + y*buffer->width;
+		for (i32 x = triangle->minX;
+			x <= triangle->maxX;
+			++x)
+		{
+			r32 px = (r32)x + 0.5f;
+			r32 edge0 = triangle->edgeA[0]*px + rowEdge0;
+			r32 edge1 = triangle->edgeA[1]*px + rowEdge1;
+			r32 edge2 = triangle->edgeA[2]*px + rowEdge2;
+			if (edge0 >= 0.0f && edge1 >= 0.0f && edge2 >= 0.0f)
+			{
+				r32 depth = triangle->depthA*px + rowDepth;
+				depthRow[x] = Minimum(depthRow[x], depth);
+			}
+		}
+	}
+}
+
+static void
+ReduceOcclusionTilesScalar(occlusion_buffer *buffer, i32 tileMinY, i32 tileMaxY)
+{
+	for (i32 tileY = tileMinY;
+		tileY <= tileMaxY;
+		++tileY)
+	{
+		for (i32 tileX = 0;
+			tileX < buffer->tileCountX;
+			++tileX)
+		{
+			r32 maxDepth = 0.0f;
+			for (i32 y = tileY*OCCLUSION_TILE_HEIGHT;
+				y < (tileY + 1)*OCCLUSION_TILE_HEIGHT;
+				++y)
+			{
+				r32 *depthRow = buffer->depth + y*buffer->width + tileX*OCCLUSION_TILE_WIDTH;
+				for (i32 x = 0;
+					x < OCCLUSION_TILE_WIDTH;
+					++x)
+				{
+					maxDepth = Maximum(maxDepth, depthRow[x]);
+				}
+			}
+			buffer->tileMaxDepth[tileY*buffer->tileCountX + tileX] = maxDepth;
+		}
+	}
+}
+
+#if OCCLUSION_HAS_AVX2
+// NOTE(joon) : Same math as the scalar version(no FMA), so both of them produce the exact same depth buffer
+OCCLUSION_TARGET_AVX2 static void
+RasterizeOccluderRowsAVX2(occlusion_buffer *buffer, occluder_triangle *triangle, i32 minY, i32 maxY)
+{
+	__m256 zero = _mm256_setzero_ps();
+	__m256 half = _mm256_set1_ps(0.5f);
+	__m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	__m256i minX = _mm256_set1_epi32(triangle->minX - 1);
+	__m256i maxX = _mm256_set1_epi32(triangle->maxX + 1);
+
+	__m256 edgeA0 = _mm256_set1_ps(triangle->edgeA[0]);
+	__m256 edgeA1 = _mm256_set1_ps(triangle->edgeA[1]);
+	__m256 edgeA2 = _mm256_set1_ps(triangle->edgeA[2]);
+	__m256 depthA = _mm256_set1_ps(triangle->depthA);
+
+	i32 startX = triangle->minX & ~(OCCLUSION_TILE_WIDTH - 1);
+	for (i32 y = minY;
+		y <= maxY;
+		++y)
+	{
+		r32 py = (r32)y + 0.5f;
+		__m256 rowEdge0 = _mm256_set1_ps(triangle->edgeB[0]*py + triangle->edgeC[0]);
+		__m256 rowEdge1 = _mm256_set1_ps(triangle->edgeB[1]*py + triangle->edgeC[1]);
+		__m256 rowEdge2 = _mm256_set1_ps(triangle->edgeB[2]*py + triangle->edgeC[2]);
+		__m256 rowDepth = _mm256_set1_ps(triangle->depthB*py + triangle->depthC);
+
+		r32 *depthRow = buffer->depth + y*buffer->width;
+		for (i32 x = startX;
+			x <= triangle->maxX;
+			x += 8)
+		{
+			__m256i xs = _mm256_add_epi32(_mm256_set1_epi32(x), laneOffsets);
+			__m256 px = _mm256_add_ps(_mm256_cvtepi32_ps(xs), half);
+
+			__m256 edge0 = _mm256_add_ps(_mm256_mul_ps(edgeA0, px), rowEdge0);
+			__m256 edge1 = _mm256_add_ps(_mm256_mul_ps(edgeA1, px), rowEdge1);
+			__m256 edge2 = _mm256_add_ps(_mm256_mul_ps(edgeA2, px), rowEdge2);
+
+			__m256 mask = _mm256_and_ps(_mm256_cmp_ps(edge0, zero, _CMP_GE_OQ), _mm256_cmp_ps(edge1, zero, _CMP_GE_OQ));
+			mask = _mm256_and_ps(mask, _mm256_cmp_ps(edge2, zero, _CMP_GE_OQ));
+			// NOTE(joon) : Lanes outside of the bounding box should be left alone, just like the scalar version
+			__m256i insideX = _mm256_and_si256(_mm256_cmpgt_epi32(xs, minX), _mm256_cmpgt_epi32(maxX, xs));
+			mask = _mm256_and_ps(mask, _mm256_castsi256_ps(insideX));
+
+			if (!_mm256_testz_ps(mask, mask))
+			{
+				__m256 depth = _mm256_add_ps(_mm256_mul_ps(depthA, px), rowDepth);
+				__m256 oldDepth = _mm256_loadu_ps(depthRow + x);
+				__m256 newDepth = _mm256_blendv_ps(oldDepth, _mm256_min_ps(depth, oldDepth), mask);
+				_mm256_storeu_ps(depthRow + x, newDepth);
+			}
+		}
+	}
+}
+
+OCCLUSION_TARGET_AVX2 static void
+ReduceOcclusionTilesAVX2(occlusion_buffer *buffer, i32 tileMinY, i32 tileMaxY)
+{
+	for (i32 tileY = tileMinY;
+		tileY <= tileMaxY;
+		++tileY)
+	{
+		for (i32 tileX = 0;
+			tileX < buffer->tileCountX;
+			++tileX)
+		{
+			r32 *depthRow = buffer->depth + tileY*OCCLUSION_TILE_HEIGHT*buffer->width + tileX*OCCLUSION_TILE_WIDTH;
+			__m256 maxDepth = _mm256_loadu_ps(depthRow);
+			for (i32 y = 1;
+				y < OCCLUSION_TILE_HEIGHT;
+				++y)
+			{
+				maxDepth = _mm256_max_ps(maxDepth, _mm256_loadu_ps(depthRow + y*buffer->width));
+			}
+
+			__m128 max4 = _mm_max_ps(_mm256_castps256_ps128(maxDepth), _mm256_extractf128_ps(maxDepth, 1));
+			max4 = _mm_max_ps(max4, _mm_movehl_ps(max4, max4));
+			max4 = _mm_max_ss(max4, _mm_shuffle_ps(max4, max4, 1));
+			buffer->tileMaxDepth[tileY*buffer->tileCountX + tileX] = _mm_cvtss_f32(max4);
+		}
+	}
+}
+#endif
+
+#if defined(_MSC_VER) || defined(__clang__)
+#pragma float_control(pop)
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+// NOTE(joon) : Clears, rasterizes and reduces the rows [bandIndex*OCCLUSION_BAND_HEIGHT, (bandIndex+1)*OCCLUSION_BAND_HEIGHT).
+// Bands don't share any pixel or tile, so they can be done in parallel without any synchronization.
+static void
+RasterizeOcclusionBand(occlusion_buffer *buffer, i32 bandIndex)
+{
+	i32 bandMinY = bandIndex*OCCLUSION_BAND_HEIGHT;
+	i32 bandMaxY = bandMinY + OCCLUSION_BAND_HEIGHT - 1;
+
+	r32 *bandDepth = buffer->depth + bandMinY*buffer->width;
+	for (i32 pixelIndex = 0;
+		pixelIndex < OCCLUSION_BAND_HEIGHT*buffer->width;
+		++pixelIndex)
+	{
+		bandDepth[pixelIndex] = 1.0f;
+	}
+
+	for (u32 triangleIndex = 0;
+		triangleIndex < buffer->triangles.size();
+		++triangleIndex)
+	{
+		occluder_triangle *triangle = &buffer->triangles[triangleIndex];
+		i32 minY = Maximum(triangle->minY, bandMinY);
+		i32 maxY = Minimum(triangle->maxY, bandMaxY);
+		if (minY <= maxY)
+		{
+#if OCCLUSION_HAS_AVX2
+			if (buffer->useAVX2)
+			{
+				RasterizeOccluderRowsAVX2(buffer, triangle, minY, maxY);
+			}
+			else
+#endif
+			{
+				RasterizeOccluderRowsScalar(buffer, triangle, minY, maxY);
+			}
+		}
+	}
+
+	i32 tileMinY = bandMinY / OCCLUSION_TILE_HEIGHT;
+	i32 tileMaxY = bandMaxY / OCCLUSION_TILE_HEIGHT;
+#if OCCLUSION_HAS_AVX2
+	if (buffer->useAVX2)
+	{
+		ReduceOcclusionTilesAVX2(buffer, tileMinY, tileMaxY);
+	}
+	else
+#endif
+	{
+		ReduceOcclusionTilesScalar(buffer, tileMinY, tileMaxY);
+	}
+}
+
+static void
+RasterizeOcclusionBandsJob(void *data, u32 start, u32 onePastEnd)
+{
+	occlusion_buffer *buffer = (occlusion_buffer *)data;
+	for (u32 bandIndex = start;
+		bandIndex < onePastEnd;
+		++bandIndex)
+	{
+		RasterizeOcclusionBand(buffer, (i32)bandIndex);
+	}
+}
+
+static void
+RasterizeOccluders(occlusion_buffer *buffer, job_system *jobSystem)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	u32 bandCount = (u32)(buffer->height / OCCLUSION_BAND_HEIGHT);
+	ParallelFor(jobSystem, RasterizeOcclusionBandsJob, buffer, "RasterizeOccluders", bandCount, 1);
+
+	std::chrono::duration<r64, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	buffer->rasterizeTime += elapsed.count();
+}
+
+// NOTE(joon) : Conservative, anything that we are not sure about is treated as visible
+static b32
+IsBoundingBoxOccluded(occlusion_buffer *buffer, glm::vec3 boundsMin, glm::vec3 boundsMax, glm::mat4 *world)
+{
+	glm::mat4 mvp;
+	MultiplyMatrix4x4(&mvp, &buffer->viewProjection, world);
+
+	r32 minX = FLT_MAX;
+	r32 minY = FLT_MAX;
+	r32 maxX = -FLT_MAX;
+	r32 maxY = -FLT_MAX;
+	r32 minDepth = FLT_MAX;
+	for (u32 cornerIndex = 0;
+		cornerIndex < 8;
+		++cornerIndex)
+	{
+		glm::vec3 corner = glm::vec3((cornerIndex & 1) ? boundsMax.x : boundsMin.x,
+									(cornerIndex & 2) ? boundsMax.y : boundsMin.y,
+									(cornerIndex & 4) ? boundsMax.z : boundsMin.z);
+		glm::vec4 clip = mvp * glm::vec4(corner, 1.0f);
+		if (clip.z + clip.w < 0.0f)
+		{
+			// NOTE(joon) : crossing the near plane
+			return false;
+		}
+
+		glm::vec3 screen = ClipToScreen(buffer, clip);
+		minX = Minimum(minX, screen.x);
+		minY = Minimum(minY, screen.y);
+		maxX = Maximum(maxX, screen.x);
+		maxY = Maximum(maxY, screen.y);
+		minDepth = Minimum(minDepth, screen.z);
+	}
+
+	// NOTE(joon) : Every pixel center that the box might cover
+	i32 pixelMinX = Maximum((i32)floorf(minX), 0);
+	i32 pixelMinY = Maximum((i32)floorf(minY), 0);
+	i32 pixelMaxX = Minimum((i32)ceilf(maxX), buffer->width - 1);
+	i32 pixelMaxY = Minimum((i32)ceilf(maxY), buffer->height - 1);
+	if (pixelMinX > pixelMaxX || pixelMinY > pixelMaxY)
+	{
+		// NOTE(joon) : outside of the screen, which is the job of the frustum culling
+		return false;
+	}
+
+	b32 result = true;
+	for (i32 tileY = pixelMinY / OCCLUSION_TILE_HEIGHT;
+		tileY <= pixelMaxY / OCCLUSION_TILE_HEIGHT && result;
+		++tileY)
+	{
+		r32 *tileRow = buffer->tileMaxDepth + tileY*buffer->tileCountX;
+		for (i32 tileX = pixelMinX / OCCLUSION_TILE_WIDTH;
+			tileX <= pixelMaxX / OCCLUSION_TILE_WIDTH;
+			++tileX)
+		{
+			if (minDepth <= tileRow[tileX])
+			{
+				result = false;
+				break;
+			}
+		}
+	}
+
+	return result;
+}
+
+struct test_occludees_job_data
+{
+	occlusion_buffer *buffer;
+	occludee *occludees;
+};
+
+static void
+TestOccludeesJob(void *data, u32 start, u32 onePastEnd)
+{
+	test_occludees_job_data *jobData = (test_occludees_job_data *)data;
+	for (u32 occludeeIndex = start;
+		occludeeIndex < onePastEnd;
+		++occludeeIndex)
+	{
+		occludee *occludee = jobData->occludees + occludeeIndex;
+		occludee->isOccluded = IsBoundingBoxOccluded(jobData->buffer, occludee->boundsMin, occludee->boundsMax, occludee->world);
+	}
+}
+
+static void
+TestOccludees(occlusion_buffer *buffer, job_system *jobSystem, occludee *occludees, u32 occludeeCount)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	test_occludees_job_data jobData = {buffer, occludees};
+	ParallelFor(jobSystem, TestOccludeesJob, &jobData, "TestOccludees", occludeeCount, 64);
+
+	u32 occludedCount = 0;
+	for (u32 occludeeIndex = 0;
+		occludeeIndex < occludeeCount;
+		++occludeeIndex)
+	{
+		occludedCount += occludees[occludeeIndex].isOccluded ? 1 : 0;
+	}
+	buffer->testedCount += occludeeCount;
+	buffer->occludedCount += occludedCount;
+
+	std::chrono::duration<r64, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	buffer->testTime += elapsed.count();
+}
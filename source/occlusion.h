@@ -0,0 +1,73 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+// NOTE(joon) : Software occlusion culling, in the style of masked occlusion culling.
+// A few large occluders get rasterized into a low resolution depth buffer on the CPU,
+// which is then reduced to the farthest depth of each tile. Occludees are tested
+// by comparing the nearest depth of their screen space bounding box against those tiles.
+// Depth is in [0, 1], 0 being the near plane.
+
+#define OCCLUSION_BUFFER_WIDTH 256 // should be a multiple of OCCLUSION_TILE_WIDTH
+#define OCCLUSION_BUFFER_HEIGHT 128 // should be a multiple of OCCLUSION_BAND_HEIGHT
+#define OCCLUSION_TILE_WIDTH 8 // one AVX2 register
+#define OCCLUSION_TILE_HEIGHT 8
+#define OCCLUSION_BAND_HEIGHT 16 // rows rasterized by one job, should be a multiple of OCCLUSION_TILE_HEIGHT
+
+// NOTE(joon) : Meshes that would go over this are not used as occluders
+#define MAX_OCCLUDER_TRIANGLE_COUNT 4096
+
+// NOTE(joon) : Screen space triangle, ready to be rasterized.
+// Edge functions and the depth are planes that should be evaluated at the pixel centers : a*x + (b*y + c)
+struct occluder_triangle
+{
+	r32 edgeA[3];
+	r32 edgeB[3];
+	r32 edgeC[3];
+
+	r32 depthA;
+	r32 depthB;
+	r32 depthC;
+
+	// NOTE(joon) : inclusive, already clamped to the buffer
+	i32 minX;
+	i32 minY;
+	i32 maxX;
+	i32 maxY;
+};
+
+struct occludee
+{
+	// NOTE(joon) : model space bounding box
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+	glm::mat4 *world;
+
+	b32 isOccluded; // result
+};
+
+struct occlusion_buffer
+{
+	i32 width;
+	i32 height;
+	r32 *depth;
+
+	i32 tileCountX;
+	i32 tileCountY;
+	r32 *tileMaxDepth; // farthest depth inside the tile
+
+	glm::mat4 viewProjection;
+	std::vector<occluder_triangle> triangles;
+	std::vector<glm::vec4> clipPositions; // scratch for the occluder vertices
+
+	b32 useAVX2;
+
+	// NOTE(joon) : stats of the last frame
+	u32 occluderTriangleCount;
+	u32 testedCount;
+	u32 occludedCount;
+	r64 setupTime; // in ms
+	r64 rasterizeTime;
+	r64 testTime;
+};
+
+#endif
@@ -0,0 +1,741 @@
+// NOTE(joon) : Binary ply loader, for the big scanned models(i.e the Stanford scans) that are too slow to parse as text.
+// The header is parsed as text, and then the element data is read straight from the asset mapping in big blocks.
+// Vertices have the same size, so each block is decoded by the workers straight into the vertex buffer.
+// Faces have the variable length lists, so they are walked serially, which is just a few loads per face.
+// Only the properties that we use are read(x y z, nx ny nz, u v), and the others are skipped.
+
+#define PLY_VERTEX_BLOCK_COUNT 65536 // vertices decoded together
+
+enum ply_type
+{
+	PLYType_None,
+	PLYType_Int8,
+	PLYType_UInt8,
+	PLYType_Int16,
+	PLYType_UInt16,
+	PLYType_Int32,
+	PLYType_UInt32,
+	PLYType_Float32,
+	PLYType_Float64,
+};
+
+struct ply_property
+{
+	char name[64];
+	ply_type type; // type of the list elements, if this is a list
+	ply_type countType; // PLYType_None if this is not a list
+
+	u32 offset; // inside the element, only valid when the element has no list
+};
+
+struct ply_element
+{
+	char name[64];
+	u64 count;
+	std::vector<ply_property> properties;
+
+	b32 hasList;
+	u32 size; // only valid when the element has no list
+};
+
+// NOTE(joon) : Cursor over the whole file(see ReadAssetFile)
+struct ply_stream
+{
+	u8 *data;
+	size_t at;
+	size_t end;
+};
+
+static ply_type
+GetPLYType(const char *name)
+{
+	ply_type result = PLYType_None;
+	if (strcmp(name, "char") == 0 || strcmp(name, "int8") == 0)
+	{
+		result = PLYType_Int8;
+	}
+	else if (strcmp(name, "uchar") == 0 || strcmp(name, "uint8") == 0)
+	{
+		result = PLYType_UInt8;
+	}
+	else if (strcmp(name, "short") == 0 || strcmp(name, "int16") == 0)
+	{
+		result = PLYType_Int16;
+	}
+	else if (strcmp(name, "ushort") == 0 || strcmp(name, "uint16") == 0)
+	{
+		result = PLYType_UInt16;
+	}
+	else if (strcmp(name, "int") == 0 || strcmp(name, "int32") == 0)
+	{
+		result = PLYType_Int32;
+	}
+	else if (strcmp(name, "uint") == 0 || strcmp(name, "uint32") == 0)
+	{
+		result = PLYType_UInt32;
+	}
+	else if (strcmp(name, "float") == 0 || strcmp(name, "float32") == 0)
+	{
+		result = PLYType_Float32;
+	}
+	else if (strcmp(name, "double") == 0 || strcmp(name, "float64") == 0)
+	{
+		result = PLYType_Float64;
+	}
+
+	return result;
+}
+
+static u32
+GetPLYTypeSize(ply_type type)
+{
+	u32 result = 0;
+	switch (type)
+	{
+		case PLYType_Int8:
+		case PLYType_UInt8:
+		{
+			result = 1;
+		}break;
+		case PLYType_Int16:
+		case PLYType_UInt16:
+		{
+			result = 2;
+		}break;
+		case PLYType_Int32:
+		case PLYType_UInt32:
+		case PLYType_Float32:
+		{
+			result = 4;
+		}break;
+		case PLYType_Float64:
+		{
+			result = 8;
+		}break;
+		default:
+		break;
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Copies the value so that it doesn't have to be aligned, and swaps the bytes if the file has the other endianness.
+// We only run on the little endian machines, so only the big endian files are swapped.
+static void
+LoadPLYBytes(void *dest, u8 *at, u32 size, b32 shouldSwap)
+{
+	if (shouldSwap)
+	{
+		u8 *destBytes = (u8 *)dest;
+		for (u32 byteIndex = 0;
+			byteIndex < size;
+			++byteIndex)
+		{
+			destBytes[byteIndex] = at[size - 1 - byteIndex];
+		}
+	}
+	else
+	{
+		memcpy(dest, at, size);
+	}
+}
+
+static r64
+ReadPLYValue(u8 *at, ply_type type, b32 shouldSwap)
+{
+	r64 result = 0.0;
+	switch (type)
+	{
+		case PLYType_Int8:
+		{
+			result = (r64)*(i8 *)at;
+		}break;
+		case PLYType_UInt8:
+		{
+			result = (r64)*at;
+		}break;
+		case PLYType_Int16:
+		{
+			i16 value;
+			LoadPLYBytes(&value, at, sizeof(value), shouldSwap);
+			result = (r64)value;
+		}break;
+		case PLYType_UInt16:
+		{
+			u16 value;
+			LoadPLYBytes(&value, at, sizeof(value), shouldSwap);
+			result = (r64)value;
+		}break;
+		case PLYType_Int32:
+		{
+			i32 value;
+			LoadPLYBytes(&value, at, sizeof(value), shouldSwap);
+			result = (r64)value;
+		}break;
+		case PLYType_UInt32:
+		{
+			u32 value;
+			LoadPLYBytes(&value, at, sizeof(value), shouldSwap);
+			result = (r64)value;
+		}break;
+		case PLYType_Float32:
+		{
+			r32 value;
+			LoadPLYBytes(&value, at, sizeof(value), shouldSwap);
+			result = (r64)value;
+		}break;
+		case PLYType_Float64:
+		{
+			LoadPLYBytes(&result, at, sizeof(result), shouldSwap);
+		}break;
+		default:
+		break;
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Most of the files store the attributes as float, so that one skips the conversion
+static r32
+ReadPLYFloat(u8 *at, ply_type type, b32 shouldSwap)
+{
+	r32 result;
+	if (type == PLYType_Float32)
+	{
+		LoadPLYBytes(&result, at, sizeof(result), shouldSwap);
+	}
+	else
+	{
+		result = (r32)ReadPLYValue(at, type, shouldSwap);
+	}
+
+	return result;
+}
+
+static i64
+ReadPLYInteger(u8 *at, ply_type type, b32 shouldSwap)
+{
+	i64 result;
+	switch (type)
+	{
+		case PLYType_UInt8:
+		{
+			result = *at;
+		}break;
+		case PLYType_Int32:
+		{
+			i32 value;
+			LoadPLYBytes(&value, at, sizeof(value), shouldSwap);
+			result = value;
+		}break;
+		case PLYType_UInt32:
+		{
+			u32 value;
+			LoadPLYBytes(&value, at, sizeof(value), shouldSwap);
+			result = value;
+		}break;
+		default:
+		{
+			result = (i64)ReadPLYValue(at, type, shouldSwap);
+		}break;
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Returns the pointer to the next byteCount bytes of the file, or 0 if the file ends before that.
+static u8 *
+GetPLYBytes(ply_stream *stream, size_t byteCount)
+{
+	u8 *result = 0;
+	if (stream->end - stream->at >= byteCount)
+	{
+		result = stream->data + stream->at;
+		stream->at += byteCount;
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Returns false at the end of the file. The line doesn't include the '\n'.
+static b32
+GetPLYLine(ply_stream *stream, std::string *line)
+{
+	if (stream->at >= stream->end)
+	{
+		return false;
+	}
+
+	char *lineStart = (char *)stream->data + stream->at;
+	char *lineEnd = (char *)memchr(lineStart, '\n', stream->end - stream->at);
+	size_t lineLength = lineEnd ? (size_t)(lineEnd - lineStart) : stream->end - stream->at;
+	line->assign(lineStart, lineLength);
+	stream->at += lineLength + (lineEnd ? 1 : 0);
+
+	return true;
+}
+
+// NOTE(joon) : Returns false if the header is not a binary ply that we can read
+static b32
+ReadPLYHeader(ply_stream *stream, std::vector<ply_element> *elements, b32 *isBigEndian)
+{
+	b32 isFormatValid = false;
+	b32 isHeaderEnded = false;
+
+	std::string line;
+	GetPLYLine(stream, &line);
+	if (line.compare(0, 3, "ply") != 0)
+	{
+		return false;
+	}
+
+	while (!isHeaderEnded && GetPLYLine(stream, &line))
+	{
+		char buffer[256] = "\0";
+		size_t lineLength = Minimum(line.size(), ArrayCount(buffer) - 1);
+		memcpy(buffer, line.data(), lineLength);
+		buffer[lineLength] = '\0';
+
+		const char* delimit = " \r\n\t";
+		char *context = 0;
+		char *token = strtok_r(buffer, delimit, &context);
+		if (!token)
+		{
+			continue;
+		}
+
+		if (strcmp(token, "format") == 0)
+		{
+			token = strtok_r(0, delimit, &context);
+			if (token && strcmp(token, "binary_little_endian") == 0)
+			{
+				isFormatValid = true;
+				*isBigEndian = false;
+			}
+			else if (token && strcmp(token, "binary_big_endian") == 0)
+			{
+				isFormatValid = true;
+				*isBigEndian = true;
+			}
+		}
+		else if (strcmp(token, "element") == 0)
+		{
+			ply_element element = {};
+			token = strtok_r(0, delimit, &context);
+			strncpy(element.name, token ? token : "", ArrayCount(element.name) - 1);
+			token = strtok_r(0, delimit, &context);
+			element.count = token ? strtoull(token, 0, 10) : 0;
+
+			elements->push_back(element);
+		}
+		else if (strcmp(token, "property") == 0)
+		{
+			if (elements->empty())
+			{
+				return false;
+			}
+			ply_element *element = &elements->back();
+
+			ply_property property = {};
+			token = strtok_r(0, delimit, &context);
+			if (token && strcmp(token, "list") == 0)
+			{
+				token = strtok_r(0, delimit, &context);
+				property.countType = token ? GetPLYType(token) : PLYType_None;
+				if (property.countType == PLYType_None)
+				{
+					return false;
+				}
+				token = strtok_r(0, delimit, &context);
+				element->hasList = true;
+			}
+			property.type = token ? GetPLYType(token) : PLYType_None;
+			if (property.type == PLYType_None)
+			{
+				return false;
+			}
+
+			token = strtok_r(0, delimit, &context);
+			strncpy(property.name, token ? token : "", ArrayCount(property.name) - 1);
+			property.offset = element->size;
+			element->size += GetPLYTypeSize(property.type);
+
+			element->properties.push_back(property);
+		}
+		else if (strcmp(token, "end_header") == 0)
+		{
+			isHeaderEnded = true;
+		}
+	}
+
+	return isFormatValid && isHeaderEnded;
+}
+
+// NOTE(joon) : Returns -1 if the element doesn't have the property
+static i32
+FindPLYProperty(ply_element *element, const char *name, const char *alternativeName = 0)
+{
+	i32 result = -1;
+	for (u32 propertyIndex = 0;
+		propertyIndex < element->properties.size();
+		++propertyIndex)
+	{
+		const char *propertyName = element->properties[propertyIndex].name;
+		if (strcmp(propertyName, name) == 0 ||
+			(alternativeName && strcmp(propertyName, alternativeName) == 0))
+		{
+			result = (i32)propertyIndex;
+			break;
+		}
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Property indices of each attribute, -1 if the file doesn't have it
+enum ply_vertex_attribute
+{
+	PLYVertexAttribute_X,
+	PLYVertexAttribute_Y,
+	PLYVertexAttribute_Z,
+	PLYVertexAttribute_NX,
+	PLYVertexAttribute_NY,
+	PLYVertexAttribute_NZ,
+	PLYVertexAttribute_U,
+	PLYVertexAttribute_V,
+	PLYVertexAttribute_count,
+};
+
+struct decode_ply_vertices_job_data
+{
+	ply_element *element;
+	i32 *attributeProperties; // PLYVertexAttribute_count
+	b32 shouldSwap;
+
+	u8 *source;
+	vertex *vertices;
+};
+
+static void
+DecodePLYVerticesJob(void *data, u32 start, u32 onePastEnd)
+{
+	decode_ply_vertices_job_data *jobData = (decode_ply_vertices_job_data *)data;
+	ply_element *element = jobData->element;
+
+	r32 attributes[PLYVertexAttribute_count];
+	for (u32 vertexIndex = start;
+		vertexIndex < onePastEnd;
+		++vertexIndex)
+	{
+		u8 *source = jobData->source + (u64)vertexIndex*element->size;
+		for (u32 attributeIndex = 0;
+			attributeIndex < PLYVertexAttribute_count;
+			++attributeIndex)
+		{
+			i32 propertyIndex = jobData->attributeProperties[attributeIndex];
+			attributes[attributeIndex] = 0.0f;
+			if (propertyIndex >= 0)
+			{
+				ply_property *property = element->properties.data() + propertyIndex;
+				attributes[attributeIndex] = ReadPLYFloat(source + property->offset, property->type, jobData->shouldSwap);
+			}
+		}
+
+		vertex *vertex = jobData->vertices + vertexIndex;
+		vertex->p = glm::vec3(attributes[PLYVertexAttribute_X], attributes[PLYVertexAttribute_Y], attributes[PLYVertexAttribute_Z]);
+
+		vertex->normal = glm::vec3(attributes[PLYVertexAttribute_NX], attributes[PLYVertexAttribute_NY], attributes[PLYVertexAttribute_NZ]);
+		r32 normalLength = glm::length(vertex->normal);
+		if (normalLength > 0.0f)
+		{
+			vertex->normal /= normalLength;
+		}
+
+		// NOTE(joon) : Same as the obj, the texcoord starts from the bottom of the image
+		vertex->texCoord = glm::vec2(attributes[PLYVertexAttribute_U], 1.0f - attributes[PLYVertexAttribute_V]);
+	}
+}
+
+static b32
+ReadPLYVertices(job_system *jobSystem, ply_stream *stream, ply_element *element, b32 shouldSwap, mesh *mesh,
+				b32 *hasNormals, b32 *hasTexCoords)
+{
+	if (element->hasList)
+	{
+		printf("ply vertex with a list property is not supported!\n");
+		return false;
+	}
+
+	i32 attributeProperties[PLYVertexAttribute_count];
+	attributeProperties[PLYVertexAttribute_X] = FindPLYProperty(element, "x");
+	attributeProperties[PLYVertexAttribute_Y] = FindPLYProperty(element, "y");
+	attributeProperties[PLYVertexAttribute_Z] = FindPLYProperty(element, "z");
+	attributeProperties[PLYVertexAttribute_NX] = FindPLYProperty(element, "nx");
+	attributeProperties[PLYVertexAttribute_NY] = FindPLYProperty(element, "ny");
+	attributeProperties[PLYVertexAttribute_NZ] = FindPLYProperty(element, "nz");
+	attributeProperties[PLYVertexAttribute_U] = FindPLYProperty(element, "u", "s");
+	attributeProperties[PLYVertexAttribute_V] = FindPLYProperty(element, "v", "t");
+	if (attributeProperties[PLYVertexAttribute_U] < 0 && attributeProperties[PLYVertexAttribute_V] < 0)
+	{
+		attributeProperties[PLYVertexAttribute_U] = FindPLYProperty(element, "texture_u", "texture_s");
+		attributeProperties[PLYVertexAttribute_V] = FindPLYProperty(element, "texture_v", "texture_t");
+	}
+
+	*hasNormals = (attributeProperties[PLYVertexAttribute_NX] >= 0 &&
+					attributeProperties[PLYVertexAttribute_NY] >= 0 &&
+					attributeProperties[PLYVertexAttribute_NZ] >= 0);
+	*hasTexCoords = (attributeProperties[PLYVertexAttribute_U] >= 0 &&
+					attributeProperties[PLYVertexAttribute_V] >= 0);
+
+	size_t firstVertex = mesh->vertexBuffer.size();
+	mesh->vertexBuffer.resize(firstVertex + element->count);
+
+	decode_ply_vertices_job_data decodeData = {};
+	decodeData.element = element;
+	decodeData.attributeProperties = attributeProperties;
+	decodeData.shouldSwap = shouldSwap;
+	for (u64 blockStart = 0;
+		blockStart < element->count;
+		blockStart += PLY_VERTEX_BLOCK_COUNT)
+	{
+		u32 blockCount = (u32)Minimum(element->count - blockStart, (u64)PLY_VERTEX_BLOCK_COUNT);
+		decodeData.source = GetPLYBytes(stream, (size_t)blockCount*element->size);
+		if (!decodeData.source)
+		{
+			return false;
+		}
+		decodeData.vertices = mesh->vertexBuffer.data() + firstVertex + blockStart;
+
+		ParallelFor(jobSystem, DecodePLYVerticesJob, &decodeData, "DecodePLYVertices", blockCount, 4096);
+	}
+
+	return true;
+}
+
+// NOTE(joon) : vertexCount is the one from the header, because the faces can come before the vertices
+static b32
+ReadPLYFaces(ply_stream *stream, ply_element *element, b32 shouldSwap, u32 vertexCount, mesh *mesh, u32 *invalidTriangleCount)
+{
+	i32 indexProperty = FindPLYProperty(element, "vertex_indices", "vertex_index");
+	if (indexProperty < 0 || element->properties[indexProperty].countType == PLYType_None)
+	{
+		printf("ply face without the vertex indices!\n");
+		return false;
+	}
+
+	mesh->indexBuffer.reserve(mesh->indexBuffer.size() + 3*element->count);
+
+	for (u64 faceIndex = 0;
+		faceIndex < element->count;
+		++faceIndex)
+	{
+		for (u32 propertyIndex = 0;
+			propertyIndex < element->properties.size();
+			++propertyIndex)
+		{
+			ply_property *property = element->properties.data() + propertyIndex;
+			u32 typeSize = GetPLYTypeSize(property->type);
+
+			i64 count = 1;
+			if (property->countType != PLYType_None)
+			{
+				u8 *countAt = GetPLYBytes(stream, GetPLYTypeSize(property->countType));
+				if (!countAt)
+				{
+					return false;
+				}
+				count = ReadPLYInteger(countAt, property->countType, shouldSwap);
+				if (count < 0)
+				{
+					return false;
+				}
+			}
+
+			u8 *at = GetPLYBytes(stream, (size_t)count*typeSize);
+			if (!at)
+			{
+				return false;
+			}
+			if ((i32)propertyIndex != indexProperty)
+			{
+				continue;
+			}
+
+			// NOTE(joon) : Polygons are fan triangulated, just like the obj faces.
+			// Out of range index is replaced with vertexCount, so that the triangles using it can be dropped.
+			u32 firstIndex = vertexCount;
+			u32 previousIndex = vertexCount;
+			for (u32 cornerIndex = 0;
+				cornerIndex < count;
+				++cornerIndex)
+			{
+				i64 index = ReadPLYInteger(at + cornerIndex*typeSize, property->type, shouldSwap);
+				u32 vertexIndex = (index >= 0 && index < vertexCount) ? (u32)index : vertexCount;
+
+				if (cornerIndex == 0)
+				{
+					firstIndex = vertexIndex;
+				}
+				else if (cornerIndex >= 2)
+				{
+					if (firstIndex == vertexCount || previousIndex == vertexCount || vertexIndex == vertexCount)
+					{
+						++*invalidTriangleCount;
+					}
+					else
+					{
+						mesh->indexBuffer.push_back(firstIndex);
+						mesh->indexBuffer.push_back(previousIndex);
+						mesh->indexBuffer.push_back(vertexIndex);
+					}
+				}
+				previousIndex = vertexIndex;
+			}
+		}
+	}
+
+	return true;
+}
+
+// NOTE(joon) : Skips the elements that we don't use, i.e the edges or the materials
+static b32
+SkipPLYElement(ply_stream *stream, ply_element *element, b32 shouldSwap)
+{
+	if (!element->hasList)
+	{
+		for (u64 skipped = 0;
+			skipped < element->count;
+			skipped += PLY_VERTEX_BLOCK_COUNT)
+		{
+			u64 count = Minimum(element->count - skipped, (u64)PLY_VERTEX_BLOCK_COUNT);
+			if (!GetPLYBytes(stream, (size_t)count*element->size))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	for (u64 itemIndex = 0;
+		itemIndex < element->count;
+		++itemIndex)
+	{
+		for (u32 propertyIndex = 0;
+			propertyIndex < element->properties.size();
+			++propertyIndex)
+		{
+			ply_property *property = element->properties.data() + propertyIndex;
+			size_t byteCount = GetPLYTypeSize(property->type);
+			if (property->countType != PLYType_None)
+			{
+				u8 *countAt = GetPLYBytes(stream, GetPLYTypeSize(property->countType));
+				if (!countAt)
+				{
+					return false;
+				}
+				byteCount *= (size_t)ReadPLYInteger(countAt, property->countType, shouldSwap);
+			}
+
+			if (!GetPLYBytes(stream, byteCount))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+// NOTE(joon) : The mesh ends up the same as ReadOBJFileLineByLine would make it, centered & resized to fit inside [-1, 1].
+// The normals from the file are kept if every vertex has one.
+// fileName is only for the messages.
+static void
+ParsePLYFile(job_system *jobSystem, mesh *mesh, u8 *fileContents, size_t fileSize, const char *fileName)
+{
+	ply_stream stream = {};
+	stream.data = fileContents;
+	stream.end = fileSize;
+
+	std::vector<ply_element> elements;
+	b32 isBigEndian = false;
+	if (!ReadPLYHeader(&stream, &elements, &isBigEndian))
+	{
+		printf("%s is not a binary ply file that we can read!\n", fileName);
+		return;
+	}
+
+	b32 hasNormals = false;
+	b32 hasTexCoords = false;
+	u32 invalidTriangleCount = 0;
+	b32 isValid = true;
+
+	u64 vertexCount = 0;
+	for (u32 elementIndex = 0;
+		elementIndex < elements.size();
+		++elementIndex)
+	{
+		if (strcmp(elements[elementIndex].name, "vertex") == 0)
+		{
+			vertexCount = elements[elementIndex].count;
+		}
+	}
+	if (vertexCount > 0xffffffff)
+	{
+		printf("%s has too many vertices!\n", fileName);
+		return;
+	}
+	mesh->vertexBuffer.reserve((size_t)vertexCount);
+
+	for (u32 elementIndex = 0;
+		isValid && elementIndex < elements.size();
+		++elementIndex)
+	{
+		ply_element *element = elements.data() + elementIndex;
+		if (strcmp(element->name, "vertex") == 0)
+		{
+			isValid = ReadPLYVertices(jobSystem, &stream, element, isBigEndian, mesh, &hasNormals, &hasTexCoords);
+		}
+		else if (strcmp(element->name, "face") == 0)
+		{
+			isValid = ReadPLYFaces(&stream, element, isBigEndian, (u32)vertexCount, mesh, &invalidTriangleCount);
+		}
+		else
+		{
+			isValid = SkipPLYElement(&stream, element, isBigEndian);
+		}
+	}
+
+	if (!isValid || mesh->vertexBuffer.size() != vertexCount)
+	{
+		printf("%s ended before all the elements were read!\n", fileName);
+		mesh->vertexBuffer.clear();
+		mesh->indexBuffer.clear();
+		return;
+	}
+	if (invalidTriangleCount)
+	{
+		printf("%u triangles with the invalid indices were dropped from %s\n", invalidTriangleCount, fileName);
+	}
+	if (mesh->vertexBuffer.empty())
+	{
+		return;
+	}
+
+	NormalizeMeshVertices(jobSystem, mesh);
+
+	mesh->hasTexCoords = hasTexCoords;
+	GenerateVertexAndFaceNormals(jobSystem, mesh, !hasNormals);
+}
+
+void
+ReadPLYFile(job_system *jobSystem, mesh *mesh, const char *fileName)
+{
+	asset_file file;
+	if (!ReadAssetFile(fileName, &file))
+	{
+		printf("Invalid PLY file!\n");
+		return;
+	}
+	ParsePLYFile(jobSystem, mesh, file.data, file.size, fileName);
+	CloseAssetFile(&file);
+}
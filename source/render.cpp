@@ -7,138 +7,274 @@ GetMeshFromModel(std::vector<model>* models, model_type type)
 	return &model->mesh;
 }
 
+static r32
+GetBoundingRadius(mesh *mesh)
+{
+	r32 maxLengthSquared = 0.0f;
+	for (u32 vertexIndex = 0;
+		vertexIndex < mesh->vertexBuffer.size();
+		++vertexIndex)
+	{
+		glm::vec3 p = mesh->vertexBuffer[vertexIndex].p;
+		maxLengthSquared = Maximum(maxLengthSquared, glm::dot(p, p));
+	}
+
+	return sqrtf(maxLengthSquared);
+}
+
 static void
-RenderModel(model *model,
-			glm::vec3 scale, r32 angleX, r32 angleY, r32 angleZ, glm::vec3 translate, 
-			int windowWidth, int windowHeight, GLuint perObjectUbo, void *ubo, u32 uboSize, 
-			GLuint diffuseTextureID, GLuint specularTextureID)
+GetBoundingBox(mesh *mesh, glm::vec3 *boundsMin, glm::vec3 *boundsMax)
 {
-	glBindTexture(GL_TEXTURE_2D, 0);
-	if (diffuseTextureID)
+	*boundsMin = glm::vec3(FLT_MAX, FLT_MAX, FLT_MAX);
+	*boundsMax = glm::vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (u32 vertexIndex = 0;
+		vertexIndex < mesh->vertexBuffer.size();
+		++vertexIndex)
 	{
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, diffuseTextureID);
+		glm::vec3 p = mesh->vertexBuffer[vertexIndex].p;
+		*boundsMin = glm::min(*boundsMin, p);
+		*boundsMax = glm::max(*boundsMax, p);
 	}
-	if (specularTextureID)
+}
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define TRANSFORM_USE_SSE 1
+#endif
+
+// NOTE(joon) : result = a*b, column major just like glm.
+// result is allowed to be the same as a or b.
+static void
+MultiplyMatrix4x4(glm::mat4 *result, glm::mat4 *a, glm::mat4 *b)
+{
+#if TRANSFORM_USE_SSE
+	r32 *aColumns = (r32 *)a;
+	r32 *bColumns = (r32 *)b;
+
+	__m128 a0 = _mm_loadu_ps(aColumns + 0);
+	__m128 a1 = _mm_loadu_ps(aColumns + 4);
+	__m128 a2 = _mm_loadu_ps(aColumns + 8);
+	__m128 a3 = _mm_loadu_ps(aColumns + 12);
+
+	__m128 resultColumns[4];
+	for (u32 columnIndex = 0;
+		columnIndex < 4;
+		++columnIndex)
 	{
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, specularTextureID);
+		r32 *bColumn = bColumns + 4*columnIndex;
+
+		__m128 column = _mm_mul_ps(a0, _mm_set1_ps(bColumn[0]));
+		column = _mm_add_ps(column, _mm_mul_ps(a1, _mm_set1_ps(bColumn[1])));
+		column = _mm_add_ps(column, _mm_mul_ps(a2, _mm_set1_ps(bColumn[2])));
+		column = _mm_add_ps(column, _mm_mul_ps(a3, _mm_set1_ps(bColumn[3])));
+
+		resultColumns[columnIndex] = column;
 	}
 
-	// NOTE(joon) : Bind vertex buffer
-	glBindVertexArray(model->vertexArrayID);
-	glBindBuffer(GL_ARRAY_BUFFER, model->vertexBufferID);
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
+	r32 *resultColumn = (r32 *)result;
+	_mm_storeu_ps(resultColumn + 0, resultColumns[0]);
+	_mm_storeu_ps(resultColumn + 4, resultColumns[1]);
+	_mm_storeu_ps(resultColumn + 8, resultColumns[2]);
+	_mm_storeu_ps(resultColumn + 12, resultColumns[3]);
+#else
+	*result = (*a) * (*b);
+#endif
+}
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model->indexBufferID);
+// NOTE(joon) : Same as translate * rotateZ * rotateY * rotateX * scale,
+// but without building & multiplying five matrices
+static glm::mat4
+ComposeLocalMatrix(glm::vec3 scale, glm::vec3 rotation, glm::vec3 translate)
+{
+	r32 sinX = sinf(rotation.x);
+	r32 cosX = cosf(rotation.x);
+	r32 sinY = sinf(rotation.y);
+	r32 cosY = cosf(rotation.y);
+	r32 sinZ = sinf(rotation.z);
+	r32 cosZ = cosf(rotation.z);
+
+	glm::mat4 result;
+	result[0] = scale.x * glm::vec4(cosZ*cosY, sinZ*cosY, -sinY, 0.0f);
+	result[1] = scale.y * glm::vec4(cosZ*sinY*sinX - sinZ*cosX, sinZ*sinY*sinX + cosZ*cosX, cosY*sinX, 0.0f);
+	result[2] = scale.z * glm::vec4(cosZ*sinY*cosX + sinZ*sinX, sinZ*sinY*cosX - cosZ*sinX, cosY*cosX, 0.0f);
+	result[3] = glm::vec4(translate, 1.0f);
+
+	return result;
+}
 
-	// NOTE(joon) : Update uniform buffer
-	glm::mat4 *modelMatrix = (glm::mat4 *)ubo;
-	*modelMatrix = glm::translate(glm::mat4(1.0f), translate)*
-					glm::rotate(angleZ, glm::vec3(0.0f, 0.0f, 1.0f)) * 
-					glm::rotate(angleY, glm::vec3(0.0f, 1.0f, 0.0f)) * 
-					glm::rotate(angleX, glm::vec3(1.0f, 0.0f, 0.0f)) * 
-					glm::scale(scale);
-
-	glBindBuffer(GL_UNIFORM_BUFFER, perObjectUbo);
-	glBindBufferBase(GL_UNIFORM_BUFFER, 1, perObjectUbo);
-	glBufferSubData(GL_UNIFORM_BUFFER, 0, uboSize, ubo);
-
-	glDrawElements(GL_TRIANGLES, (u32)model->mesh.indexBuffer.size(), GL_UNSIGNED_INT, 0);
-
-	// NOTE(joon) : cleanup
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-	glActiveTexture(0);
-	glBindTexture(GL_TEXTURE_2D, 0);
+static void
+SetTransform(transform *transform, glm::vec3 scale, glm::vec3 rotation, glm::vec3 translate)
+{
+	if (transform->scale != scale ||
+		transform->rotation != rotation ||
+		transform->translate != translate)
+	{
+		transform->scale = scale;
+		transform->rotation = rotation;
+		transform->translate = translate;
+		transform->isDirty = true;
+	}
 }
 
+// NOTE(joon) : Recomputes only the dirty transforms(and their children).
+// Parents should always come before their children inside the array.
 static void
-RenderFaceNormal(model *model, glm::vec3 scale, r32 angle, glm::vec3 translate, 
-			int windowWidth, int windowHeight, GLuint perObjectUbo)
+UpdateTransforms(transform *transforms, u32 transformCount)
 {
+	for (u32 transformIndex = 0;
+		transformIndex < transformCount;
+		++transformIndex)
+	{
+		transform *transform = transforms + transformIndex;
+		struct transform *parent = 0;
+		if (transform->parentIndex >= 0)
+		{
+			Assert((u32)transform->parentIndex < transformIndex);
+			parent = transforms + transform->parentIndex;
+			if (parent->isDirty)
+			{
+				transform->isDirty = true;
+			}
+		}
+
+		if (transform->isDirty)
+		{
+			transform->local = ComposeLocalMatrix(transform->scale, transform->rotation, transform->translate);
+			if (parent)
+			{
+				MultiplyMatrix4x4(&transform->world, &parent->world, &transform->local);
+			}
+			else
+			{
+				transform->world = transform->local;
+			}
 
-	glBindVertexArray(model->faceNormalArrayID);
-	glEnableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
+			transform->normal = glm::mat4(glm::transpose(glm::inverse(glm::mat3(transform->world))));
+		}
+	}
 
-	glBindBuffer(GL_ARRAY_BUFFER, model->faceNormalBufferID);
+	// NOTE(joon) : Children should see the dirty flag of their parents, so clear them after everything is updated
+	for (u32 transformIndex = 0;
+		transformIndex < transformCount;
+		++transformIndex)
+	{
+		transforms[transformIndex].isDirty = false;
+	}
+}
 
-	// NOTE(joon) : Update uniform buffer
-	per_object_ubo ubo = {};
-	ubo.model = glm::translate(glm::mat4(1.0f), translate)*glm::rotate(angle, glm::vec3(0.0f, 0.0f, 1.0f)) * glm::scale(scale);
+static void
+FillObjectMatrices(object_matrices *matrices, transform *transform, glm::mat4 *viewProjection)
+{
+	matrices->model = transform->world;
+	MultiplyMatrix4x4(&matrices->mvp, viewProjection, &transform->world);
+	matrices->normal = transform->normal;
+}
 
-	glBindBuffer(GL_UNIFORM_BUFFER, perObjectUbo);
-	glBindBufferBase(GL_UNIFORM_BUFFER, 1, perObjectUbo);
-	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(per_object_ubo), &ubo);
+// NOTE(joon) : The Render* functions only record the commands,
+// which will be executed later by the render thread.
+static void
+RenderModel(command_buffer *commandBuffer, model *model, object_matrices *matrices,
+			GLuint perObjectUbo, void *ubo, u32 uboSize, 
+			GLuint diffuseTextureID, GLuint specularTextureID)
+{
+	PushBindTextures(commandBuffer, diffuseTextureID, specularTextureID);
 
-	glDrawArrays(GL_LINES, 0, 2*(u32)model->mesh.faceNormalBuffer.size());
+	// NOTE(joon) : Update uniform buffer
+	*(object_matrices *)ubo = *matrices;
+	PushUpdateUniformBuffer(commandBuffer, perObjectUbo, 1, ubo, uboSize);
 
-	// NOTE(joon) : cleanup
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	PushDrawElements(commandBuffer, model->vertexArrayID, model->vertexBufferID, model->indexBufferID,
+					model->uploadedIndexCount);
 }
 
+// NOTE(joon) : Same as RenderModel, but only draws the visible meshlets
+// that the build stage wrote into the indirect buffer
 static void
-RenderVertexNormal(model *model, glm::vec3 scale, r32 angle, glm::vec3 translate, 
-			int windowWidth, int windowHeight, GLuint perObjectUbo)
+RenderModelMeshlets(command_buffer *commandBuffer, model *model, object_matrices *matrices,
+					GLuint perObjectUbo, void *ubo, u32 uboSize,
+					GLuint diffuseTextureID, GLuint specularTextureID,
+					GLuint indirectBufferID, u32 firstCommand, u32 commandCount)
 {
+	PushBindTextures(commandBuffer, diffuseTextureID, specularTextureID);
 
-	glBindVertexArray(model->vertexNormalArrayID);
-	glEnableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
+	*(object_matrices *)ubo = *matrices;
+	PushUpdateUniformBuffer(commandBuffer, perObjectUbo, 1, ubo, uboSize);
 
-	glBindBuffer(GL_ARRAY_BUFFER, model->vertexNormalBufferID);
+	if (commandCount)
+	{
+		PushDrawElementsIndirect(commandBuffer, model->vertexArrayID, model->vertexBufferID, model->indexBufferID,
+								indirectBufferID, firstCommand, commandCount);
+	}
+}
 
-	// NOTE(joon) : Update uniform buffer
-	per_object_ubo ubo = {};
-	ubo.model = glm::translate(glm::mat4(1.0f), translate)*glm::rotate(angle, glm::vec3(0.0f, 1.0f, 0.0f)) * glm::scale(scale);
+// NOTE(joon) : Depth only version of RenderModel for the depth pre-pass & the shadow maps, should be recorded with the depth only program.
+// Only the matrices are needed, so nothing else inside the ubo is touched.
+static void
+RenderModelDepthOnly(command_buffer *commandBuffer, model *model, object_matrices *matrices, GLuint perObjectUbo)
+{
+	PushUpdateUniformBuffer(commandBuffer, perObjectUbo, 1, matrices, sizeof(object_matrices));
 
-	glBindBuffer(GL_UNIFORM_BUFFER, perObjectUbo);
-	glBindBufferBase(GL_UNIFORM_BUFFER, 1, perObjectUbo);
-	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(per_object_ubo), &ubo);
+	PushDrawElements(commandBuffer, model->positionVertexArrayID, model->positionBufferID, model->indexBufferID,
+					model->uploadedIndexCount, true);
+}
 
-	glDrawArrays(GL_LINES, 0, 2*(u32)model->mesh.vertexNormalLineBuffer.size());
+static void
+RenderModelMeshletsDepthOnly(command_buffer *commandBuffer, model *model, object_matrices *matrices, GLuint perObjectUbo,
+							GLuint indirectBufferID, u32 firstCommand, u32 commandCount)
+{
+	PushUpdateUniformBuffer(commandBuffer, perObjectUbo, 1, matrices, sizeof(object_matrices));
 
-	// NOTE(joon) : cleanup
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	if (commandCount)
+	{
+		PushDrawElementsIndirect(commandBuffer, model->positionVertexArrayID, model->positionBufferID, model->indexBufferID,
+								indirectBufferID, firstCommand, commandCount, true);
+	}
 }
 
-// NOTE(joon) : THIS ROUTINE IS EXTREMELY SLOW, as it updates the buffer every time you draw the line.
-// Only use this for small amount of lines!
+// NOTE(joon) : The normal lines are generated by the normal line shader from the buffers of the model,
+// so this should be recorded with the normal line program
 static void
-RenderLine(glm::vec3 *line, GLuint lineVertexArrayID, GLuint lineVertexBufferID, 
-			glm::vec3 scale, r32 angle, glm::vec3 translate, 
-			int windowWidth, int windowHeight, GLuint perObjectUbo)
+RenderFaceNormal(command_buffer *commandBuffer, model *model, object_matrices *matrices, GLuint perObjectUbo)
 {
-	glBindVertexArray(lineVertexArrayID);
-	glDisableVertexAttribArray(1);
+	// NOTE(joon) : Update uniform buffer
+	plain_per_object_ubo ubo = {};
+	*(object_matrices *)&ubo = *matrices;
+	ubo.color = glm::vec3(1.0f, 1.0f, 0.0f);
+	PushUpdateUniformBuffer(commandBuffer, perObjectUbo, 1, &ubo, sizeof(plain_per_object_ubo));
 
-	glBindBuffer(GL_ARRAY_BUFFER, lineVertexBufferID);
+	PushDrawNormalLines(commandBuffer, model->vertexArrayID, model->vertexBufferID, model->indexBufferID,
+						model->uploadedIndexCount/3, true);
+}
 
-#if 1
-	glBufferData(GL_ARRAY_BUFFER,
-				2 * sizeof(glm::vec3), line,
-				GL_STATIC_DRAW);
-#endif
+static void
+RenderVertexNormal(command_buffer *commandBuffer, model *model, object_matrices *matrices, GLuint perObjectUbo)
+{
+	// NOTE(joon) : Update uniform buffer
+	plain_per_object_ubo ubo = {};
+	*(object_matrices *)&ubo = *matrices;
+	ubo.color = glm::vec3(0.0f, 1.0f, 1.0f);
+	PushUpdateUniformBuffer(commandBuffer, perObjectUbo, 1, &ubo, sizeof(plain_per_object_ubo));
 
-	glm::vec3 start = line[0];
-	glm::vec3 end = line[1];
+	PushDrawNormalLines(commandBuffer, model->vertexArrayID, model->vertexBufferID, model->indexBufferID,
+						model->uploadedVertexCount, false);
+}
+
+// NOTE(joon) : This routine updates the whole line buffer every time you draw the lines,
+// so only use this for small amount of lines!
+// points should be the pairs of start & end.
+static void
+RenderLines(command_buffer *commandBuffer, glm::vec3 *points, u32 pointCount, 
+			GLuint lineVertexArrayID, GLuint lineVertexBufferID, 
+			object_matrices *matrices, GLuint perObjectUbo)
+{
+	PushUpdateVertexBuffer(commandBuffer, lineVertexBufferID, points, pointCount*sizeof(glm::vec3));
 
 	// NOTE(joon) : Update uniform buffer
 	per_object_ubo ubo = {};
-	ubo.model = glm::translate(glm::mat4(1.0f), translate)*glm::rotate(angle, glm::vec3(0.0f, 1.0f, 0.0f)) * glm::scale(scale);
-
-	glBindBuffer(GL_UNIFORM_BUFFER, perObjectUbo);
-	glBindBufferBase(GL_UNIFORM_BUFFER, 1, perObjectUbo);
-	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(per_object_ubo), &ubo);
+	*(object_matrices *)&ubo = *matrices;
+	PushUpdateUniformBuffer(commandBuffer, perObjectUbo, 1, &ubo, sizeof(per_object_ubo));
 
-	glDrawArrays(GL_LINES, 0, 2);
+	PushDrawLines(commandBuffer, lineVertexArrayID, lineVertexBufferID, pointCount);
 }
 
 static void
@@ -244,37 +380,65 @@ SphericalTextureMapping(vertex *vertices, u32 vertexCount, b32 shouldUseP)
 }
 
 
+struct texture_mapping_job_data
+{
+	vertex *vertices;
+	int method;
+	b32 shouldUseP;
+};
+
+static void
+TextureMappingJob(void *data, u32 start, u32 onePastEnd)
+{
+	texture_mapping_job_data *jobData = (texture_mapping_job_data *)data;
+	vertex *vertices = jobData->vertices + start;
+	u32 vertexCount = onePastEnd - start;
+
+	switch (jobData->method)
+	{
+		case TextureMappingMethod_Planar:
+		{
+			PlanarTextureMapping(vertices, vertexCount, jobData->shouldUseP);
+		}break;
+		case TextureMappingMethod_Cylindrical:
+		{
+			CylindricalTextureMapping(vertices, vertexCount, jobData->shouldUseP);
+		}break;
+		case TextureMappingMethod_Spherical:
+		{
+			SphericalTextureMapping(vertices, vertexCount, jobData->shouldUseP);
+		}break;
+	}
+}
+
+// NOTE(joon) : Only generates the texcoords inside the CPU side vertex buffer,
+// does not touch any of the GL objects so that it can be used without the context
 static void
-GenerateTexCoordForAllModels(std::vector<model> *models, i32 textureWidth, i32 textureHeight, int method, b32 shouldUseP)
+GenerateTexCoordForModels(job_system *jobSystem, model *models, u32 modelCount, int method, b32 shouldUseP)
 {
+	std::vector<texture_mapping_job_data> jobData(modelCount);
+
+	// NOTE(joon) : One parallel for per model, all of them grouped under a single job
+	// so that the small models don't have to wait for the big ones
+	job *group = CreateJob(jobSystem, 0, 0, "TextureMappingGroup");
 	for (u32 modelIndex = 0;
-		modelIndex < (u32)models->size();
+		modelIndex < modelCount;
 		++modelIndex)
 	{
-		model *model = models->data() + modelIndex;
-		switch (method)
+		model *model = models + modelIndex;
+
+		texture_mapping_job_data *data = jobData.data() + modelIndex;
+		data->vertices = model->mesh.vertexBuffer.data();
+		data->method = method;
+		data->shouldUseP = shouldUseP;
+
+		if (!model->mesh.vertexBuffer.empty() && !model->mesh.hasTexCoords)
 		{
-			case TextureMappingMethod_Planar:
-			{
-				PlanarTextureMapping(model->mesh.vertexBuffer.data(),
-									(u32)model->mesh.vertexBuffer.size(), shouldUseP);
-			}break;
-			case TextureMappingMethod_Cylindrical:
-			{
-				CylindricalTextureMapping(model->mesh.vertexBuffer.data(),
-									(u32)model->mesh.vertexBuffer.size(), shouldUseP);
-			}break;
-			case TextureMappingMethod_Spherical:
-			{
-				SphericalTextureMapping(model->mesh.vertexBuffer.data(),
-									(u32)model->mesh.vertexBuffer.size(), shouldUseP);
-			}break;
+			job *mappingJob = CreateParallelForJob(jobSystem, TextureMappingJob, data, "TextureMapping", 
+												(u32)model->mesh.vertexBuffer.size(), 2048, group);
+			SubmitJob(jobSystem, mappingJob);
 		}
-		// update the buffer. otherwise, opengl will not know the change inside the vertex buffer
-		glBindBuffer(GL_ARRAY_BUFFER, model->vertexBufferID);
-		glBufferData(GL_ARRAY_BUFFER,
-					model->mesh.vertexBuffer.size() * sizeof(vertex), model->mesh.vertexBuffer.data(),
-				GL_STATIC_DRAW);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
-}
+	SubmitJob(jobSystem, group);
+	WaitForJob(jobSystem, group);
+}
\ No newline at end of file
@@ -12,12 +12,6 @@ struct camera
 	r32 near = 0.0f;
 	r32 far = 0.0f;
 };
-struct line
-{
-	glm::vec3 start;
-	glm::vec3 end;
-};
-
 struct vertex
 {
 	glm::vec3 p; // -1 to 1
@@ -25,13 +19,38 @@ struct vertex
 	glm::vec2 texCoord;
 };
 
+#define MESHLET_MAX_VERTEX_COUNT 64
+#define MESHLET_MAX_TRIANGLE_COUNT 124
+
+// NOTE(joon) : Cluster of the neighbouring triangles, which gets culled as a whole.
+// The triangles of each meshlet are contiguous inside the index buffer, so a meshlet
+// can be drawn with an index range of the same buffer.
+struct meshlet
+{
+	u32 firstIndex;
+	u32 triangleCount;
+	u32 vertexCount;
+
+	// NOTE(joon) : model space
+	glm::vec3 center;
+	r32 radius;
+
+	// NOTE(joon) : Every face normal is inside this cone, coneCutoff is the cos of the half angle.
+	// The cone is too wide to be culled when coneCutoff <= 0.
+	glm::vec3 coneAxis;
+	r32 coneCutoff;
+};
+
 struct mesh
 {
 	std::vector < vertex > vertexBuffer;
 	std::vector < unsigned int > indexBuffer;
 
-	std::vector < line > faceNormalBuffer;
-	std::vector < line > vertexNormalLineBuffer;
+	// NOTE(joon) : The texcoords came from the model file, so the texture mapping should not overwrite them
+	b32 hasTexCoords = false;
+
+	// NOTE(joon) : see BuildMeshlets, empty for the meshes that are always drawn as a whole
+	std::vector < meshlet > meshlets;
 };
 
 enum light_type
@@ -87,10 +106,36 @@ struct per_frame_ubo
 	light lights[16];
 };
 
+// NOTE(joon) : local and world matrices are cached, and only get recomputed when the transform is dirty.
+struct transform
+{
+	glm::vec3 scale = glm::vec3(1.0f, 1.0f, 1.0f);
+	glm::vec3 rotation = glm::vec3(0.0f, 0.0f, 0.0f); // euler angles in radian, applied in X -> Y -> Z order
+	glm::vec3 translate = glm::vec3(0.0f, 0.0f, 0.0f);
+
+	// parent should always come before the child inside the transform array
+	i32 parentIndex = -1;
+	b32 isDirty = true;
+
+	glm::mat4 local = glm::mat4(1.0f);
+	glm::mat4 world = glm::mat4(1.0f);
+	glm::mat4 normal = glm::mat4(1.0f); // inverse transpose of the world matrix
+};
+
+// NOTE(joon) : every object ubo _must_ start with these three matrices, like the header!
+struct object_matrices
+{
+	alignas(16) glm::mat4 model;
+	alignas(16) glm::mat4 mvp;
+	alignas(16) glm::mat4 normal;
+};
+
 struct per_object_ubo
 {
-	// for object ubo, model _must_ be at the top of the struct, like the header!
+	// for object ubo, model, mvp and normal _must_ be at the top of the struct, like the header!
 	alignas(16) glm::mat4 model;
+	alignas(16) glm::mat4 mvp;
+	alignas(16) glm::mat4 normal;
 
 	alignas(16) glm::vec3 IEmissive;
 
@@ -99,14 +144,25 @@ struct per_object_ubo
 	alignas(4) r32 kSpecular;
 
 	alignas(4) r32 ns;
+
+	alignas(4) b32 hasBakedLighting; // ambient & diffuse of the lights come from the baked lighting, see lighting_cache.h
 };
 
 struct plain_per_object_ubo
 {
 	alignas(16) glm::mat4 model;
+	alignas(16) glm::mat4 mvp;
+	alignas(16) glm::mat4 normal;
 	alignas(16) glm::vec3 color;
 };
 
+// NOTE(joon) : Face & vertex normals are drawn with the plain fragment shader, see normal_line_shader.vert.
+// The uniform location should match the one inside that shader.
+#define NORMAL_LINE_IS_FACE_NORMAL_LOCATION 0
+
+// NOTE(joon) : Should match the binding of the baked lighting inside the lighting shaders
+#define BAKED_LIGHTING_TEXTURE_UNIT 2
+
 enum model_type
 { 
 	ModelType_4Sphere,
@@ -132,14 +188,18 @@ struct model
 	GLuint vertexArrayID = 0;
 	GLuint vertexBufferID = 0;
 	GLuint indexBufferID = 0;
-
-	// NOTE(joon) : only for drawing face normal using GL_LINES!
-	GLuint faceNormalArrayID = 0;
-	GLuint faceNormalBufferID = 0;
-
-	// NOTE(joon) : only for drawing vertex normal using GL_LINES!
-	GLuint vertexNormalArrayID = 0;
-	GLuint vertexNormalBufferID = 0;
+	// NOTE(joon) : Tightly packed copy of the positions for the depth pre-pass, shares the index buffer
+	GLuint positionVertexArrayID = 0;
+	GLuint positionBufferID = 0;
+	// NOTE(joon) : What's inside the buffers, as the CPU mesh can be released after the upload(see model_registry)
+	u32 uploadedVertexCount = 0;
+	u32 uploadedIndexCount = 0;
+
+	// NOTE(joon) : Radius of the sphere centered at the model space origin, used for the culling
+	r32 boundingRadius = 0.0f;
+	// NOTE(joon) : Model space bounding box, used for the occlusion culling
+	glm::vec3 boundsMin = glm::vec3(0.0f, 0.0f, 0.0f);
+	glm::vec3 boundsMax = glm::vec3(0.0f, 0.0f, 0.0f);
 
 	// NOTE : Light properties
 	glm::vec3 IEmissive;
@@ -159,7 +219,9 @@ enum texture_mapping_method
 enum texture_mapping_location
 {
 	TextureMappingLocation_CPU = 0,
-	TextureMappingLocation_GPU = 1,
+	TextureMappingLocation_GPU = 1, // vertex shader, every frame
+	TextureMappingLocation_Compute = 2, // compute shader, once per change. The CPU meshes are released after the upload
+
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,551 @@
+#include "render_thread.h"
+
+static void
+ExecuteCommandBuffer(render_thread *renderThread, command_buffer *buffer)
+{
+	u8 *at = buffer->base;
+	u8 *end = buffer->base + buffer->used;
+	while (at < end)
+	{
+		render_command_header *header = (render_command_header *)at;
+		switch (header->type)
+		{
+			case RenderCommandType_Clear:
+			{
+				render_command_clear *command = (render_command_clear *)header;
+				glClearColor(command->color.r, command->color.g, command->color.b, command->color.a);
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			}break;
+
+			case RenderCommandType_SetRenderState:
+			{
+				render_command_set_render_state *command = (render_command_set_render_state *)header;
+				if (command->isDepthTestEnabled)
+				{
+					glEnable(GL_DEPTH_TEST);
+				}
+				else
+				{
+					glDisable(GL_DEPTH_TEST);
+				}
+				renderThread->glState.DepthTest = (command->isDepthTestEnabled != 0);
+
+				if (command->isCullFaceEnabled)
+				{
+					glEnable(GL_CULL_FACE);
+				}
+				else
+				{
+					glDisable(GL_CULL_FACE);
+				}
+				renderThread->glState.CullFace = (command->isCullFaceEnabled != 0);
+			}break;
+
+			case RenderCommandType_SetViewport:
+			{
+				render_command_set_viewport *command = (render_command_set_viewport *)header;
+				glViewport(command->x, command->y, command->width, command->height);
+				renderThread->glState.Viewport[0] = command->x;
+				renderThread->glState.Viewport[1] = command->y;
+				renderThread->glState.Viewport[2] = command->width;
+				renderThread->glState.Viewport[3] = command->height;
+			}break;
+
+			case RenderCommandType_UseProgram:
+			{
+				render_command_use_program *command = (render_command_use_program *)header;
+				Assert(command->programSlot < RENDER_PROGRAM_SLOT_COUNT);
+				glUseProgram(renderThread->programs[command->programSlot]);
+				renderThread->glState.Program = renderThread->programs[command->programSlot];
+			}break;
+
+			case RenderCommandType_ReloadProgram:
+			{
+				render_command_reload_program *command = (render_command_reload_program *)header;
+				Assert(command->programSlot < RENDER_PROGRAM_SLOT_COUNT);
+				// NOTE(joon) : Reloads are for the edited shaders, so they never come from the asset pack
+				GLuint newProgram = LoadShaders(command->vertexShaderPath, command->fragmentShaderPath, true);
+
+				if (newProgram)
+				{
+					if (renderThread->glState.Program == renderThread->programs[command->programSlot])
+					{
+						// NOTE(joon) : deleting the current program doesn't unbind it, but the handle can be reused
+						renderThread->glState.Program = 0;
+						glUseProgram(0);
+					}
+					glDeleteProgram(renderThread->programs[command->programSlot]);
+					renderThread->programs[command->programSlot] = newProgram;
+				}
+			}break;
+
+			case RenderCommandType_UpdateUniformBuffer:
+			{
+				render_command_update_uniform_buffer *command = (render_command_update_uniform_buffer *)header;
+				glBindBuffer(GL_UNIFORM_BUFFER, command->bufferID);
+				glBindBufferBase(GL_UNIFORM_BUFFER, command->bindingIndex, command->bufferID);
+				glBufferSubData(GL_UNIFORM_BUFFER, 0, command->dataSize, GetRenderCommandPayload(command, sizeof(*command)));
+			}break;
+
+			case RenderCommandType_UpdateVertexBuffer:
+			{
+				render_command_update_vertex_buffer *command = (render_command_update_vertex_buffer *)header;
+				glBindBuffer(GL_ARRAY_BUFFER, command->bufferID);
+				glBufferData(GL_ARRAY_BUFFER, command->dataSize, GetRenderCommandPayload(command, sizeof(*command)), GL_STATIC_DRAW);
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				renderThread->glState.ArrayBuffer = 0;
+			}break;
+
+			case RenderCommandType_BindTextures:
+			{
+				render_command_bind_textures *command = (render_command_bind_textures *)header;
+				glActiveTexture(GL_TEXTURE0);
+				glBindTexture(GL_TEXTURE_2D, command->diffuseTextureID);
+				glActiveTexture(GL_TEXTURE1);
+				glBindTexture(GL_TEXTURE_2D, command->specularTextureID);
+				glActiveTexture(GL_TEXTURE0);
+				renderThread->glState.ActiveTexture = GL_TEXTURE0;
+				renderThread->glState.Texture = command->diffuseTextureID;
+			}break;
+
+			case RenderCommandType_DrawElements:
+			{
+				render_command_draw_elements *command = (render_command_draw_elements *)header;
+
+				// NOTE(joon) : Bind vertex buffer
+				glBindVertexArray(command->vertexArrayID);
+				glBindBuffer(GL_ARRAY_BUFFER, command->vertexBufferID);
+				glEnableVertexAttribArray(0);
+				if (!command->isPositionOnly)
+				{
+					glEnableVertexAttribArray(1);
+					glEnableVertexAttribArray(2);
+				}
+
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, command->indexBufferID);
+
+				glDrawElements(GL_TRIANGLES, command->indexCount, GL_UNSIGNED_INT, 0);
+
+				// NOTE(joon) : cleanup
+				glBindVertexArray(0);
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+				renderThread->glState.VertexArray = 0;
+				renderThread->glState.ArrayBuffer = 0;
+			}break;
+
+			case RenderCommandType_DrawLines:
+			{
+				render_command_draw_lines *command = (render_command_draw_lines *)header;
+
+				glBindVertexArray(command->vertexArrayID);
+				glEnableVertexAttribArray(0);
+				glDisableVertexAttribArray(1);
+				glBindBuffer(GL_ARRAY_BUFFER, command->vertexBufferID);
+
+				glDrawArrays(GL_LINES, 0, command->vertexCount);
+
+				// NOTE(joon) : cleanup
+				glBindVertexArray(0);
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				renderThread->glState.VertexArray = 0;
+				renderThread->glState.ArrayBuffer = 0;
+			}break;
+
+			case RenderCommandType_DrawNormalLines:
+			{
+				render_command_draw_normal_lines *command = (render_command_draw_normal_lines *)header;
+
+				// NOTE(joon) : The shader doesn't use any attribute, but the core profile still needs a vertex array to draw
+				glBindVertexArray(command->vertexArrayID);
+				glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, command->vertexBufferID);
+				glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, command->indexBufferID);
+				glUniform1ui(NORMAL_LINE_IS_FACE_NORMAL_LOCATION, command->isFaceNormal ? 1 : 0);
+
+				glDrawArrays(GL_LINES, 0, 2*command->lineCount);
+
+				// NOTE(joon) : cleanup
+				glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+				glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+				glBindVertexArray(0);
+				renderThread->glState.VertexArray = 0;
+			}break;
+
+			case RenderCommandType_RenderImGui:
+			{
+				render_command_render_imgui *command = (render_command_render_imgui *)header;
+				ImGui_ImplOpenGL3_SetStreamingUpload(command->useStreamingUpload);
+				// NOTE(joon) : The backend restores everything it changed, so glState stays valid after this
+				ImGui_ImplOpenGL3_SetKnownState(command->useKnownState ? &renderThread->glState : 0);
+				ImGui_ImplOpenGL3_RenderDrawData(command->drawData);
+
+				std::lock_guard<std::mutex> lock(renderThread->lock);
+				renderThread->lastImGuiUploadBytes = (u64)ImGui_ImplOpenGL3_GetLastUploadBytes();
+			}break;
+
+			case RenderCommandType_CullInstances:
+			{
+				render_command_cull_instances *command = (render_command_cull_instances *)header;
+				CullGPUInstances(command->culling, command->instanceCount, command->useHiZ);
+				glUseProgram(renderThread->glState.Program);
+				renderThread->glState.ActiveTexture = GL_TEXTURE0;
+
+				std::lock_guard<std::mutex> lock(renderThread->lock);
+				renderThread->lastGPUVisibleInstanceCount = command->culling->lastVisibleCount;
+			}break;
+
+			case RenderCommandType_DrawInstancesIndirect:
+			{
+				render_command_draw_instances_indirect *command = (render_command_draw_instances_indirect *)header;
+				DrawGPUInstances(command->culling, command->instanceCount);
+				renderThread->glState.VertexArray = 0;
+			}break;
+
+			case RenderCommandType_BuildHiZ:
+			{
+				render_command_build_hi_z *command = (render_command_build_hi_z *)header;
+				BuildHiZ(command->culling, command->width, command->height, &command->viewProjection);
+				glUseProgram(renderThread->glState.Program);
+				renderThread->glState.ActiveTexture = GL_TEXTURE0;
+			}break;
+
+			case RenderCommandType_DrawElementsIndirect:
+			{
+				render_command_draw_elements_indirect *command = (render_command_draw_elements_indirect *)header;
+
+				glBindVertexArray(command->vertexArrayID);
+				glBindBuffer(GL_ARRAY_BUFFER, command->vertexBufferID);
+				glEnableVertexAttribArray(0);
+				if (!command->isPositionOnly)
+				{
+					glEnableVertexAttribArray(1);
+					glEnableVertexAttribArray(2);
+				}
+
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, command->indexBufferID);
+				glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command->indirectBufferID);
+
+				u8 *offset = (u8 *)0 + command->firstCommand*sizeof(draw_elements_indirect_command);
+				if (GLEW_ARB_multi_draw_indirect)
+				{
+					glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, offset, command->commandCount, 0);
+				}
+				else
+				{
+					// NOTE(joon) : GL 4.0 only has the single indirect draw
+					for (u32 commandIndex = 0;
+						commandIndex < command->commandCount;
+						++commandIndex)
+					{
+						glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, offset + commandIndex*sizeof(draw_elements_indirect_command));
+					}
+				}
+
+				// NOTE(joon) : cleanup
+				glBindVertexArray(0);
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+				glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+				renderThread->glState.VertexArray = 0;
+				renderThread->glState.ArrayBuffer = 0;
+			}break;
+
+			case RenderCommandType_UploadModel:
+			{
+				render_command_upload_model *command = (render_command_upload_model *)header;
+				UploadRegistryModel(command->entry);
+				renderThread->glState.VertexArray = 0;
+				renderThread->glState.ArrayBuffer = 0;
+			}break;
+
+			case RenderCommandType_DeleteModelBuffers:
+			{
+				render_command_delete_model_buffers *command = (render_command_delete_model_buffers *)header;
+				glDeleteVertexArrays(ArrayCount(command->vertexArrayIDs), command->vertexArrayIDs);
+				glDeleteBuffers(ArrayCount(command->bufferIDs), command->bufferIDs);
+			}break;
+
+			case RenderCommandType_MapTexCoords:
+			{
+				render_command_map_tex_coords *command = (render_command_map_tex_coords *)header;
+				MapTexCoordsOnGPU(renderThread->texCoordMappingProgram, command->vertexBufferID, command->vertexCount,
+								command->textureMappingMethod, command->shouldUseP);
+				glUseProgram(renderThread->glState.Program);
+			}break;
+
+			case RenderCommandType_BindBakedLighting:
+			{
+				render_command_bind_baked_lighting *command = (render_command_bind_baked_lighting *)header;
+				glActiveTexture(GL_TEXTURE0 + BAKED_LIGHTING_TEXTURE_UNIT);
+				glBindTexture(GL_TEXTURE_BUFFER, command->textureID);
+				glActiveTexture(GL_TEXTURE0);
+				renderThread->glState.ActiveTexture = GL_TEXTURE0;
+			}break;
+
+			case RenderCommandType_BeginGBuffer:
+			{
+				render_command_begin_g_buffer *command = (render_command_begin_g_buffer *)header;
+				glActiveTexture(GL_TEXTURE0);
+				BeginGBuffer(command->deferred, command->width, command->height);
+				renderThread->glState.ActiveTexture = GL_TEXTURE0;
+				renderThread->glState.Program = command->deferred->geometryProgram;
+				// NOTE(joon) : Every model binds its own textures, so this is only to keep the state right after a resize
+				glBindTexture(GL_TEXTURE_2D, 0);
+				renderThread->glState.Texture = 0;
+			}break;
+
+			case RenderCommandType_ShadeDeferred:
+			{
+				render_command_shade_deferred *command = (render_command_shade_deferred *)header;
+				ShadeDeferred(command->deferred, command->targetFramebufferID, &command->inverseProjection, &command->inverseViewProjection);
+				glUseProgram(renderThread->glState.Program);
+				renderThread->glState.ActiveTexture = GL_TEXTURE0;
+				renderThread->glState.Texture = 0;
+				renderThread->glState.VertexArray = 0;
+			}break;
+
+			case RenderCommandType_SetDepthState:
+			{
+				render_command_set_depth_state *command = (render_command_set_depth_state *)header;
+				glDepthFunc(command->depthFunc);
+				glDepthMask(command->isDepthWriteEnabled ? GL_TRUE : GL_FALSE);
+				GLboolean isColorWriteEnabled = command->isColorWriteEnabled ? GL_TRUE : GL_FALSE;
+				glColorMask(isColorWriteEnabled, isColorWriteEnabled, isColorWriteEnabled, isColorWriteEnabled);
+			}break;
+
+			case RenderCommandType_BeginShadowPasses:
+			{
+				render_command_begin_shadow_passes *command = (render_command_begin_shadow_passes *)header;
+				BeginShadowPasses(command->shadowMaps);
+				renderThread->glState.DepthTest = true;
+				renderThread->glState.ScissorTest = true;
+
+				std::lock_guard<std::mutex> lock(renderThread->lock);
+				renderThread->lastShadowGPUTime = command->shadowMaps->lastGPUTime;
+			}break;
+
+			case RenderCommandType_BeginShadowView:
+			{
+				render_command_begin_shadow_view *command = (render_command_begin_shadow_view *)header;
+				BeginShadowView(command->shadowMaps, command->rect, command->isStatic, command->shouldClear);
+			}break;
+
+			case RenderCommandType_CopyShadowView:
+			{
+				render_command_copy_shadow_view *command = (render_command_copy_shadow_view *)header;
+				CopyShadowView(command->shadowMaps, command->rect);
+			}break;
+
+			case RenderCommandType_EndShadowPasses:
+			{
+				render_command_end_shadow_passes *command = (render_command_end_shadow_passes *)header;
+				EndShadowPasses(command->shadowMaps);
+				renderThread->glState.ScissorTest = false;
+				GLint *viewport = renderThread->glState.Viewport;
+				GLint *scissorBox = renderThread->glState.ScissorBox;
+				glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+				glScissor(scissorBox[0], scissorBox[1], scissorBox[2], scissorBox[3]);
+			}break;
+
+			case RenderCommandType_BindShadowAtlas:
+			{
+				render_command_bind_shadow_atlas *command = (render_command_bind_shadow_atlas *)header;
+				glActiveTexture(GL_TEXTURE0 + SHADOW_ATLAS_TEXTURE_UNIT);
+				glBindTexture(GL_TEXTURE_2D, command->textureID);
+				glActiveTexture(GL_TEXTURE0);
+				renderThread->glState.ActiveTexture = GL_TEXTURE0;
+			}break;
+
+			case RenderCommandType_BeginFrameTimer:
+			{
+				render_command_begin_frame_timer *command = (render_command_begin_frame_timer *)header;
+				BeginFrameTimer(command->dynamicResolution, command->renderScale);
+
+				std::lock_guard<std::mutex> lock(renderThread->lock);
+				renderThread->lastFrameGPUTime = command->dynamicResolution->lastFrameGPUTime;
+			}break;
+
+			case RenderCommandType_EndFrameTimer:
+			{
+				render_command_end_frame_timer *command = (render_command_end_frame_timer *)header;
+				EndFrameTimer(command->dynamicResolution);
+			}break;
+
+			case RenderCommandType_BeginSceneTarget:
+			{
+				render_command_begin_scene_target *command = (render_command_begin_scene_target *)header;
+				glActiveTexture(GL_TEXTURE0);
+				BeginSceneTarget(command->dynamicResolution, command->width, command->height);
+				// NOTE(joon) : Only to keep the state right after a resize
+				glBindTexture(GL_TEXTURE_2D, renderThread->glState.Texture);
+				renderThread->glState.ActiveTexture = GL_TEXTURE0;
+			}break;
+
+			case RenderCommandType_ResolveSceneTarget:
+			{
+				render_command_resolve_scene_target *command = (render_command_resolve_scene_target *)header;
+				ResolveSceneTarget(command->dynamicResolution, command->sourceWidth, command->sourceHeight,
+								command->targetWidth, command->targetHeight, (upscale_filter)command->filter);
+				glUseProgram(renderThread->glState.Program);
+				renderThread->glState.DepthTest = false;
+				renderThread->glState.ActiveTexture = GL_TEXTURE0;
+				renderThread->glState.Texture = 0;
+				renderThread->glState.VertexArray = 0;
+				renderThread->glState.Viewport[0] = 0;
+				renderThread->glState.Viewport[1] = 0;
+				renderThread->glState.Viewport[2] = command->targetWidth;
+				renderThread->glState.Viewport[3] = command->targetHeight;
+			}break;
+
+			case RenderCommandType_CaptureFrame:
+			{
+				render_command_capture_frame *command = (render_command_capture_frame *)header;
+				glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+				UpdateFrameCapture(command->capture, command->shouldRecord, (frame_capture_format)command->format,
+								command->width, command->height);
+			}break;
+
+			default:
+			{
+				// NOTE(joon) : corrupted command buffer
+				Assert(0);
+			}break;
+		}
+
+		at += header->size;
+	}
+}
+
+static void
+RenderThreadProc(render_thread *renderThread)
+{
+	glfwMakeContextCurrent(renderThread->window);
+	// NOTE(joon) : benchmarks can run the render thread without the imgui
+	if (ImGui::GetCurrentContext())
+	{
+		ImGui_ImplOpenGL3_QueryState(&renderThread->glState);
+	}
+
+	for (;;)
+	{
+		render_frame frame;
+		{
+			std::unique_lock<std::mutex> lock(renderThread->lock);
+			renderThread->submitCondition.wait(lock, [renderThread]
+			{
+				return !renderThread->isRunning ||
+					renderThread->executedFrameCount < renderThread->submittedFrameCount;
+			});
+
+			if (renderThread->executedFrameCount == renderThread->submittedFrameCount)
+			{
+				// NOTE(joon) : not running anymore, and every submitted frame is executed
+				break;
+			}
+
+			frame = renderThread->frames[renderThread->executedFrameCount % MAX_QUEUED_RENDER_FRAME_COUNT];
+		}
+
+		std::chrono::steady_clock::time_point executeStart = std::chrono::steady_clock::now();
+		u64 commandCount = 0;
+		for (u32 bufferIndex = 0;
+			bufferIndex < frame.commandBufferCount;
+			++bufferIndex)
+		{
+			command_buffer *buffer = frame.commandBuffers + bufferIndex;
+			ExecuteCommandBuffer(renderThread, buffer);
+			commandCount += buffer->commandCount;
+		}
+
+		if (frame.shouldSwapBuffers)
+		{
+			glfwSwapBuffers(renderThread->window);
+		}
+		else
+		{
+			// NOTE(joon) : Nothing else will flush the commands for us
+			glFinish();
+		}
+		std::chrono::duration<r64, std::milli> executeTime = std::chrono::steady_clock::now() - executeStart;
+
+		{
+			std::lock_guard<std::mutex> lock(renderThread->lock);
+			renderThread->executedFrameCount++;
+			renderThread->executedCommandCount += commandCount;
+			renderThread->lastExecuteTime = executeTime.count();
+		}
+		renderThread->executeCondition.notify_all();
+	}
+
+	glfwMakeContextCurrent(0);
+}
+
+// NOTE(joon) : The context will be moved from the calling thread to the render thread,
+// so the calling thread should not make any GL calls after this.
+static void
+StartRenderThread(render_thread *renderThread, GLFWwindow *window)
+{
+	renderThread->window = window;
+	renderThread->isRunning = true;
+	renderThread->submittedFrameCount = 0;
+	renderThread->executedFrameCount = 0;
+	renderThread->executedCommandCount = 0;
+	renderThread->lastExecuteTime = 0.0;
+	renderThread->lastImGuiUploadBytes = 0;
+	renderThread->lastGPUVisibleInstanceCount = 0;
+	renderThread->lastShadowGPUTime = 0;
+	renderThread->lastFrameGPUTime = {};
+
+	glfwMakeContextCurrent(0);
+	renderThread->thread = std::thread(RenderThreadProc, renderThread);
+}
+
+// NOTE(joon) : Executes every frame that was submitted, and gives the context back to the calling thread
+static void
+StopRenderThread(render_thread *renderThread)
+{
+	{
+		std::lock_guard<std::mutex> lock(renderThread->lock);
+		renderThread->isRunning = false;
+	}
+	renderThread->submitCondition.notify_all();
+	renderThread->thread.join();
+
+	glfwMakeContextCurrent(renderThread->window);
+}
+
+// NOTE(joon) : Returns the number of the frame, which can be used to wait for it.
+// Blocks when there are already too many frames waiting to be executed.
+static u64
+SubmitRenderFrame(render_thread *renderThread, command_buffer *commandBuffers, u32 commandBufferCount, b32 shouldSwapBuffers)
+{
+	u64 result = 0;
+	{
+		std::unique_lock<std::mutex> lock(renderThread->lock);
+		renderThread->executeCondition.wait(lock, [renderThread]
+		{
+			return renderThread->submittedFrameCount - renderThread->executedFrameCount < MAX_QUEUED_RENDER_FRAME_COUNT;
+		});
+
+		render_frame *frame = renderThread->frames + (renderThread->submittedFrameCount % MAX_QUEUED_RENDER_FRAME_COUNT);
+		frame->commandBuffers = commandBuffers;
+		frame->commandBufferCount = commandBufferCount;
+		frame->shouldSwapBuffers = shouldSwapBuffers;
+
+		result = renderThread->submittedFrameCount++;
+	}
+	renderThread->submitCondition.notify_one();
+
+	return result;
+}
+
+// NOTE(joon) : Waits until the frame and every frame submitted before it are executed
+static void
+WaitForRenderFrame(render_thread *renderThread, u64 frameNumber)
+{
+	std::unique_lock<std::mutex> lock(renderThread->lock);
+	renderThread->executeCondition.wait(lock, [renderThread, frameNumber]
+	{
+		return renderThread->executedFrameCount > frameNumber;
+	});
+}
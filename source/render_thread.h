@@ -0,0 +1,51 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+// NOTE(joon) : The render thread owns the GL context, and it's the only thread that can make GL calls.
+// Other threads record command buffers and submit them as a frame.
+
+#define MAX_QUEUED_RENDER_FRAME_COUNT 2
+#define RENDER_PROGRAM_SLOT_COUNT 9
+
+struct render_frame
+{
+	// NOTE(joon) : executed in this order, and should be alive until the frame gets executed
+	command_buffer *commandBuffers;
+	u32 commandBufferCount;
+
+	b32 shouldSwapBuffers;
+};
+
+struct render_thread
+{
+	GLFWwindow *window;
+	std::thread thread;
+
+	std::mutex lock;
+	std::condition_variable submitCondition;
+	std::condition_variable executeCondition;
+	b32 isRunning;
+
+	// NOTE(joon) : ring buffer of frames, protected by the lock
+	render_frame frames[MAX_QUEUED_RENDER_FRAME_COUNT];
+	u64 submittedFrameCount;
+	u64 executedFrameCount;
+
+	// NOTE(joon) : only touched by the render thread after it's started
+	GLuint programs[RENDER_PROGRAM_SLOT_COUNT];
+	GLuint texCoordMappingProgram; // compute, 0 when it's not supported
+
+	// NOTE(joon) : GL state that the imgui backend cares about, queried once when the thread starts
+	// and then updated by every command that changes it. Any new command that touches one of these should update this, too!
+	ImGui_ImplOpenGL3_State glState;
+
+	// NOTE(joon) : stats, protected by the lock
+	u64 executedCommandCount;
+	r64 lastExecuteTime; // in ms
+	u64 lastImGuiUploadBytes; // vertices & indices uploaded by the imgui backend
+	u32 lastGPUVisibleInstanceCount; // read back from the GPU a few frames later
+	r64 lastShadowGPUTime; // in ms, also a few frames later
+	frame_gpu_time lastFrameGPUTime; // also a few frames later
+};
+
+#endif
@@ -0,0 +1,89 @@
+#version 450
+
+struct light
+{
+    bool isEnabled;
+
+	float angle;
+	uint type;
+
+	vec3 p;
+
+	vec3 IAmbient;
+	vec3 IDiffuse;
+	vec3 ISpecular;
+
+	float c1;
+	float c2;
+	float c3;
+
+	float innerConeAngleCos;
+	float outerConeAngleCos;
+	float fallOff;
+};
+
+layout(binding = 0) uniform per_frame_ubo
+{
+    mat4 view;
+	mat4 projection;
+
+	vec3 cameraP;
+	vec3 cameraDir;
+	vec3 IFog;
+	vec3 globalAmbient;
+
+	float zNear;
+	float zFar;
+
+	bool shouldGenerateTexCoordInGPU;
+	int textureMappingMethod;
+	bool shouldUseNormal;
+
+	light lights[16];
+}perFrameUbo;
+
+layout(binding = 1) uniform per_object_ubo
+{
+    mat4 model;
+	mat4 mvp;
+	mat4 normalMatrix; // inverse transpose of the model
+
+	vec3 IEmissive;
+
+	float kAmbient;
+	float kDiffuse;
+	float kSpecular;
+
+	float ns;
+
+	bool hasBakedLighting;
+}perObjectUbo;
+
+uniform sampler2D diffuseTexture;
+
+layout (location = 0) in vec3 fragWorldNormal;
+layout (location = 2) in vec2 texCoord;
+
+layout (location = 0) out vec4 gAlbedo;
+layout (location = 1) out vec2 gNormal;
+
+// NOTE(joon) : Folds the unit sphere into the [-1, 1] square, so that the normal fits inside two channels
+vec2
+OctahedralEncode(vec3 N)
+{
+	N /= abs(N.x) + abs(N.y) + abs(N.z);
+	vec2 result = N.xy;
+	if(N.z < 0.0f)
+	{
+		result = (1.0f - abs(N.yx)) * vec2(N.x >= 0.0f ? 1.0f : -1.0f, N.y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	return result;
+}
+
+// NOTE(joon) : See deferred_shading.h for the layout of the G-buffer
+void main()
+{
+	gAlbedo = vec4(texture(diffuseTexture, texCoord).xyz, perObjectUbo.kSpecular);
+	gNormal = 0.5f*OctahedralEncode(normalize(fragWorldNormal)) + 0.5f;
+}
\ No newline at end of file
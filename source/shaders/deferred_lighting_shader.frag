@@ -0,0 +1,250 @@
+#version 450
+
+struct light
+{
+    bool isEnabled;
+
+	float angle;
+	uint type;
+
+	vec3 p;
+
+	vec3 IAmbient;
+	vec3 IDiffuse;
+	vec3 ISpecular;
+
+	float c1;
+	float c2;
+	float c3;
+
+	float innerConeAngleCos;
+	float outerConeAngleCos;
+	float fallOff;
+};
+
+layout(binding = 0) uniform per_frame_ubo
+{
+    mat4 view;
+	mat4 projection;
+
+	vec3 cameraP;
+	vec3 cameraDir;
+	vec3 IFog;
+	vec3 globalAmbient;
+
+	float zNear;
+	float zFar;
+
+	bool shouldGenerateTexCoordInGPU;
+	int textureMappingMethod;
+	bool shouldUseNormal;
+
+	light lights[16];
+}perFrameUbo;
+
+layout(binding = 1) uniform per_object_ubo
+{
+    mat4 model;
+	mat4 mvp;
+	mat4 normalMatrix; // inverse transpose of the model
+
+	vec3 IEmissive;
+
+	float kAmbient;
+	float kDiffuse;
+	float kSpecular;
+
+	float ns;
+
+	bool hasBakedLighting;
+}perObjectUbo;
+
+// NOTE(joon) : See deferred_shading.h for the layout of the G-buffer
+layout(binding = 0) uniform sampler2D albedoTexture;
+layout(binding = 1) uniform sampler2D normalTexture;
+layout(binding = 2) uniform sampler2D depthTexture;
+
+struct shadow_view
+{
+	mat4 viewProjection;
+	vec4 atlasRect; // xy : min, zw : size, in uv
+	vec4 normalOffset; // x + y*distance to the light, in world space
+};
+
+// NOTE(joon) : See shadow_maps.h, the view count of the light is 0 when it doesn't cast shadows
+layout(binding = 2) uniform shadow_ubo
+{
+	ivec4 lightViews[16]; // x : first view, y : view count
+	shadow_view views[96];
+	vec4 atlasTexelSize;
+}shadowUbo;
+
+layout(binding = 4) uniform sampler2DShadow shadowAtlas;
+
+// NOTE(joon) : 1 when the point is lit by the light, 0 when it's in the shadow.
+// The point lights pick the face of the cube from the major axis, in the same order as the views.
+float
+GetShadow(uint lightIndex, vec3 worldP, vec3 N)
+{
+	ivec4 lightViews = shadowUbo.lightViews[lightIndex];
+	if(lightViews.y == 0)
+	{
+		return 1.0f;
+	}
+
+	vec3 toP = worldP - perFrameUbo.lights[lightIndex].p;
+	int viewIndex = lightViews.x;
+	if(lightViews.y == 6)
+	{
+		vec3 absToP = abs(toP);
+		if(absToP.x >= absToP.y && absToP.x >= absToP.z)
+		{
+			viewIndex += (toP.x > 0.0f) ? 0 : 1;
+		}
+		else if(absToP.y >= absToP.z)
+		{
+			viewIndex += (toP.y > 0.0f) ? 2 : 3;
+		}
+		else
+		{
+			viewIndex += (toP.z > 0.0f) ? 4 : 5;
+		}
+	}
+	shadow_view view = shadowUbo.views[viewIndex];
+
+	// NOTE(joon) : Moving the receiver along the normal by about a texel gets rid of most of the acne
+	vec3 offsetP = worldP + (view.normalOffset.x + view.normalOffset.y*length(toP))*N;
+	vec4 clipP = view.viewProjection*vec4(offsetP, 1.0f);
+	vec3 ndcP = clipP.xyz/clipP.w;
+	// NOTE(joon) : The offset can push the point out of the cube face, which is fine after the clamp below
+	if(clipP.w <= 0.0f || abs(ndcP.z) > 1.0f ||
+	   (lightViews.y != 6 && (abs(ndcP.x) > 1.0f || abs(ndcP.y) > 1.0f)))
+	{
+		return 1.0f;
+	}
+
+	// NOTE(joon) : Clamped so that the filtering never reads the tile next to it
+	vec2 halfTexel = 0.5f*shadowUbo.atlasTexelSize.xx;
+	vec2 uv = view.atlasRect.xy + (0.5f*ndcP.xy + 0.5f)*view.atlasRect.zw;
+	uv = clamp(uv, view.atlasRect.xy + halfTexel, view.atlasRect.xy + view.atlasRect.zw - halfTexel);
+
+	return texture(shadowAtlas, vec3(uv, 0.5f*ndcP.z + 0.5f));
+}
+
+layout(std430, binding = 0) readonly buffer tile_light_mask_buffer
+{
+	uint tileLightMasks[];
+};
+
+uniform mat4 inverseViewProjection;
+uniform ivec2 screenSize;
+uniform int tileCountX;
+
+#define TILE_SIZE 16
+
+layout (location = 0) out vec4 fragColor;
+
+vec3
+OctahedralDecode(vec2 e)
+{
+	vec3 N = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+	if(N.z < 0.0f)
+	{
+		N.xy = (1.0f - abs(N.yx)) * vec2(N.x >= 0.0f ? 1.0f : -1.0f, N.y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	return normalize(N);
+}
+
+// NOTE(joon) : Same lighting as the phong shading, with the lights of the tile
+void main()
+{
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	float depth = texelFetch(depthTexture, pixel, 0).x;
+	if(depth == 1.0f)
+	{
+		// NOTE(joon) : Nothing was drawn here
+		discard;
+	}
+
+	vec4 clipP = vec4(2.0f*gl_FragCoord.xy/vec2(screenSize) - 1.0f, 2.0f*depth - 1.0f, 1.0f);
+	vec4 worldP = inverseViewProjection*clipP;
+	vec3 fragWorldP = worldP.xyz/worldP.w;
+
+	vec4 albedo = texelFetch(albedoTexture, pixel, 0);
+	vec3 N = OctahedralDecode(2.0f*texelFetch(normalTexture, pixel, 0).xy - 1.0f);
+	vec3 V = normalize(perFrameUbo.cameraP - fragWorldP);
+	float distanceToCamera = length(perFrameUbo.cameraP - fragWorldP);
+
+	vec3 IEmissive =  perObjectUbo.IEmissive;
+	vec3 IGlobalAmbient = perFrameUbo.globalAmbient;
+	vec3 kAmbient = perObjectUbo.kAmbient*albedo.xyz;
+	vec3 kDiffuse = perObjectUbo.kDiffuse*albedo.xyz;
+	float kSpecular = albedo.w;
+
+	vec3 ILocal = IEmissive + kAmbient*IGlobalAmbient;
+
+	uint lightMask = tileLightMasks[(pixel.y/TILE_SIZE)*tileCountX + pixel.x/TILE_SIZE];
+	while(lightMask != 0)
+	{
+		int lightIndex = findLSB(lightMask);
+		lightMask &= lightMask - 1;
+
+		vec3 IAmbient = perFrameUbo.lights[lightIndex].IAmbient * kAmbient;
+
+		float distance = length(perFrameUbo.lights[lightIndex].p - fragWorldP);
+		float attenuationDenom = perFrameUbo.lights[lightIndex].c1 + 
+								 perFrameUbo.lights[lightIndex].c2*distance + 
+								 perFrameUbo.lights[lightIndex].c3*distance*distance;
+
+		float attenuation = min(1.0f/attenuationDenom, 1.0f);
+
+		uint type = perFrameUbo.lights[lightIndex].type;
+		float shadow = GetShadow(uint(lightIndex), fragWorldP, N);
+		if(type == 0)
+		{
+			// point light
+			vec3 L = normalize(perFrameUbo.lights[lightIndex].p - fragWorldP);
+			vec3 R = 2.0f*dot(N, L)*N - L;
+
+			vec3 IDiffuse = perFrameUbo.lights[lightIndex].IDiffuse * kDiffuse * max(dot(N, L), 0.0f);
+			vec3 ISpecular = perFrameUbo.lights[lightIndex].ISpecular * kSpecular * pow(max(dot(R, V), 0), perObjectUbo.ns);
+			ILocal += attenuation*(IAmbient + shadow*(IDiffuse + ISpecular));
+		}
+		else if(type == 1)
+		{
+			// directional light
+			vec3 L = normalize(perFrameUbo.lights[lightIndex].p);
+			vec3 R = 2.0f*dot(N, L)*N - L;
+
+			vec3 IDiffuse = perFrameUbo.lights[lightIndex].IDiffuse * kDiffuse * max(dot(N, L), 0.0f);
+			vec3 ISpecular = perFrameUbo.lights[lightIndex].ISpecular * kSpecular * pow(max(dot(R, V), 0), perObjectUbo.ns);
+			ILocal += IAmbient + shadow*(IDiffuse + ISpecular);
+		}
+		else if(type == 2)
+		{
+			// spotlight, always facing at (0, 0, 0)
+			vec3 D = normalize(fragWorldP - perFrameUbo.lights[lightIndex].p);
+			vec3 L = normalize(perFrameUbo.lights[lightIndex].p -fragWorldP);
+			vec3 R = 2.0f*dot(N, L)*N - L;
+
+			float cosAlpha = dot(D, -normalize(perFrameUbo.lights[lightIndex].p));
+			float nom = cosAlpha - perFrameUbo.lights[lightIndex].outerConeAngleCos;
+			float denom = perFrameUbo.lights[lightIndex].innerConeAngleCos - perFrameUbo.lights[lightIndex].outerConeAngleCos;
+
+			float spotlightEffect = max(pow(nom/denom, perFrameUbo.lights[lightIndex].fallOff), 0.0f);
+
+			vec3 IDiffuse = perFrameUbo.lights[lightIndex].IDiffuse * kDiffuse * max(dot(N, L), 0.0f);
+			vec3 ISpecular = perFrameUbo.lights[lightIndex].ISpecular * kSpecular * pow(max(dot(R, V), 0), perObjectUbo.ns);
+			ILocal += attenuation*IAmbient + attenuation*spotlightEffect*shadow*(IDiffuse + ISpecular);
+		}
+	}
+
+	float S = min(max((perFrameUbo.zFar - distanceToCamera)/(perFrameUbo.zFar - perFrameUbo.zNear), 0), 1.0f);
+
+	vec3 IFinal = S*ILocal + (1.0f-S)*perFrameUbo.IFog;
+
+	fragColor = vec4(IFinal, 1.0f);
+	// NOTE(joon) : So that the things drawn into the default framebuffer are still depth tested against the models
+	gl_FragDepth = depth;
+}
\ No newline at end of file
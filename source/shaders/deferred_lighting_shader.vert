@@ -0,0 +1,8 @@
+#version 450
+
+// NOTE(joon) : One triangle that covers the whole screen, without any vertex buffer
+void main()
+{
+	vec2 p = vec2((gl_VertexID == 1) ? 3.0f : -1.0f, (gl_VertexID == 2) ? 3.0f : -1.0f);
+	gl_Position = vec4(p, 0.0f, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,6 @@
+#version 450
+
+// NOTE(joon) : Only the depth is written, the color writes are masked by the pre-pass
+void main()
+{
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#version 450
+
+// NOTE(joon) : Depth pre-pass, only reads the tightly packed positions of the model.
+// gl_Position should be computed exactly like the lighting shaders do, so that the lit pass passes GL_EQUAL
+layout(binding = 1) uniform per_object_ubo
+{
+    mat4 model;
+	mat4 mvp;
+	mat4 normalMatrix; // inverse transpose of the model
+}perObjectUbo;
+
+layout(location = 0) in vec3 p;
+
+invariant gl_Position;
+
+void main()
+{
+    gl_Position = perObjectUbo.mvp*vec4(p, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#version 450
+
+layout(binding = 0) uniform per_frame_ubo
+{
+    mat4 view;
+	mat4 projection;
+
+	vec3 cameraP;
+	vec3 cameraDir;
+	vec3 IFog;
+	vec3 globalAmbient;
+
+	float zNear;
+	float zFar;
+
+	//light lights[16];
+}perFrameUbo;
+
+in vec3 worldNormal;
+in vec3 instanceColor;
+
+layout (location = 0) out vec4 fragColor;
+
+void main()
+{
+	// NOTE(joon) : Just enough shading to see the shape, the instances are not lit by the scene lights
+	float diffuse = max(dot(normalize(worldNormal), normalize(perFrameUbo.cameraDir)), 0.0);
+	fragColor = vec4(instanceColor*(0.3 + 0.7*diffuse), 1.0);
+} 
@@ -0,0 +1,35 @@
+#version 450
+
+layout(binding = 0) uniform per_frame_ubo
+{
+    mat4 view;
+	mat4 projection;
+
+	vec3 cameraP;
+	vec3 cameraDir;
+	vec3 IFog;
+	vec3 globalAmbient;
+
+	float zNear;
+	float zFar;
+
+	//light lights[16];
+}perFrameUbo;
+
+layout(location = 0) in vec3 p;  
+layout(location = 1) in vec3 normal;  
+
+// NOTE(joon) : per instance, offset by the base instance of the indirect command
+layout(location = 3) in mat4 world;  
+layout(location = 7) in vec4 color;  
+
+out vec3 worldNormal;
+out vec3 instanceColor;
+
+void main()
+{
+	// NOTE(joon) : instances are only translated & uniformly scaled
+	worldNormal = mat3(world)*normal;
+	instanceColor = color.rgb;
+    gl_Position = perFrameUbo.projection*perFrameUbo.view*world*vec4(p, 1.0);
+}
@@ -0,0 +1,63 @@
+#version 450
+
+// NOTE(joon) : Draws the face or vertex normals of a model without any line buffer.
+// Each line is two vertices(gl_VertexID/2 is the face or vertex, gl_VertexID&1 is the end of the line),
+// and they are pulled from the vertex & index buffer of the model.
+
+layout(binding = 1) uniform per_object_ubo
+{
+    mat4 model;
+	mat4 mvp;
+	mat4 normalMatrix; // inverse transpose of the model
+	vec3 color;
+}perObjectUbo;
+
+// NOTE(joon) : Same layout as the vertex struct, arrays of float so that there's no padding
+struct vertex
+{
+	float p[3];
+	float normal[3];
+	float texCoord[2];
+};
+
+layout(std430, binding = 0) readonly buffer vertex_buffer
+{
+	vertex vertices[];
+};
+
+layout(std430, binding = 1) readonly buffer index_buffer
+{
+	uint indices[];
+};
+
+layout(location = 0) uniform uint isFaceNormal;
+
+vec3 GetP(uint vertexIndex)
+{
+	return vec3(vertices[vertexIndex].p[0], vertices[vertexIndex].p[1], vertices[vertexIndex].p[2]);
+}
+
+void main()
+{
+	uint lineIndex = uint(gl_VertexID) / 2;
+	float end = float(gl_VertexID & 1);
+
+	vec3 p;
+	vec3 normal;
+	if (isFaceNormal != 0)
+	{
+		vec3 first = GetP(indices[3*lineIndex + 0]);
+		vec3 second = GetP(indices[3*lineIndex + 1]);
+		vec3 third = GetP(indices[3*lineIndex + 2]);
+
+		p = (first + second + third)/3.0;
+		normal = normalize(cross(second - first, third - first));
+	}
+	else
+	{
+		p = GetP(lineIndex);
+		normal = vec3(vertices[lineIndex].normal[0], vertices[lineIndex].normal[1], vertices[lineIndex].normal[2]);
+	}
+
+    gl_Position = perObjectUbo.mvp*vec4(p + end*normal, 1.0);
+}
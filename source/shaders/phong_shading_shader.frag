@@ -45,6 +45,8 @@ layout(binding = 0) uniform per_frame_ubo
 layout(binding = 1) uniform per_object_ubo
 {
     mat4 model;
+	mat4 mvp;
+	mat4 normalMatrix; // inverse transpose of the model
 
 	vec3 IEmissive;
 
@@ -53,14 +55,85 @@ layout(binding = 1) uniform per_object_ubo
 	float kSpecular;
 
 	float ns;
+
+	bool hasBakedLighting;
 }perObjectUbo;
 
 uniform sampler2D diffuseTexture;
 uniform sampler2D specularTexture;
 
+struct shadow_view
+{
+	mat4 viewProjection;
+	vec4 atlasRect; // xy : min, zw : size, in uv
+	vec4 normalOffset; // x + y*distance to the light, in world space
+};
+
+// NOTE(joon) : See shadow_maps.h, the view count of the light is 0 when it doesn't cast shadows
+layout(binding = 2) uniform shadow_ubo
+{
+	ivec4 lightViews[16]; // x : first view, y : view count
+	shadow_view views[96];
+	vec4 atlasTexelSize;
+}shadowUbo;
+
+layout(binding = 4) uniform sampler2DShadow shadowAtlas;
+
+// NOTE(joon) : 1 when the point is lit by the light, 0 when it's in the shadow.
+// The point lights pick the face of the cube from the major axis, in the same order as the views.
+float
+GetShadow(uint lightIndex, vec3 worldP, vec3 N)
+{
+	ivec4 lightViews = shadowUbo.lightViews[lightIndex];
+	if(lightViews.y == 0)
+	{
+		return 1.0f;
+	}
+
+	vec3 toP = worldP - perFrameUbo.lights[lightIndex].p;
+	int viewIndex = lightViews.x;
+	if(lightViews.y == 6)
+	{
+		vec3 absToP = abs(toP);
+		if(absToP.x >= absToP.y && absToP.x >= absToP.z)
+		{
+			viewIndex += (toP.x > 0.0f) ? 0 : 1;
+		}
+		else if(absToP.y >= absToP.z)
+		{
+			viewIndex += (toP.y > 0.0f) ? 2 : 3;
+		}
+		else
+		{
+			viewIndex += (toP.z > 0.0f) ? 4 : 5;
+		}
+	}
+	shadow_view view = shadowUbo.views[viewIndex];
+
+	// NOTE(joon) : Moving the receiver along the normal by about a texel gets rid of most of the acne
+	vec3 offsetP = worldP + (view.normalOffset.x + view.normalOffset.y*length(toP))*N;
+	vec4 clipP = view.viewProjection*vec4(offsetP, 1.0f);
+	vec3 ndcP = clipP.xyz/clipP.w;
+	// NOTE(joon) : The offset can push the point out of the cube face, which is fine after the clamp below
+	if(clipP.w <= 0.0f || abs(ndcP.z) > 1.0f ||
+	   (lightViews.y != 6 && (abs(ndcP.x) > 1.0f || abs(ndcP.y) > 1.0f)))
+	{
+		return 1.0f;
+	}
+
+	// NOTE(joon) : Clamped so that the filtering never reads the tile next to it
+	vec2 halfTexel = 0.5f*shadowUbo.atlasTexelSize.xx;
+	vec2 uv = view.atlasRect.xy + (0.5f*ndcP.xy + 0.5f)*view.atlasRect.zw;
+	uv = clamp(uv, view.atlasRect.xy + halfTexel, view.atlasRect.xy + view.atlasRect.zw - halfTexel);
+
+	return texture(shadowAtlas, vec3(uv, 0.5f*ndcP.z + 0.5f));
+}
+
 layout (location = 0) in vec3 fragWorldNormal;
 layout (location = 1) in vec3 fragWorldP;
 layout (location = 2) in vec2 texCoord;
+layout (location = 3) in vec3 fragBakedAmbient;
+layout (location = 4) in vec3 fragBakedDiffuse;
 
 layout (location = 0) out vec4 fragColor;
 
@@ -78,6 +151,13 @@ void main()
 
     vec3 ILocal = IEmissive + kAmbient*IGlobalAmbient;
 
+    // NOTE(joon) : With the baked lighting, only the specular is computed for each light
+    bool hasBakedLighting = perObjectUbo.hasBakedLighting;
+    if(hasBakedLighting)
+    {
+        ILocal += kAmbient*fragBakedAmbient + kDiffuse*fragBakedDiffuse;
+    }
+
     for(uint lightIndex = 0; lightIndex < 16; ++lightIndex)
     {
         if(perFrameUbo.lights[lightIndex].isEnabled)
@@ -92,16 +172,24 @@ void main()
 			float attenuation = min(1.0f/attenuationDenom, 1.0f);
 
 			uint type = perFrameUbo.lights[lightIndex].type;
+			float shadow = GetShadow(lightIndex, fragWorldP, N);
 			if(type == 0)
 			{
 				// point light
 				vec3 L = normalize(perFrameUbo.lights[lightIndex].p - fragWorldP); // Assume that the light is looking at the center
 				vec3 R = 2.0f*dot(N, L)*N - L;
 
-				vec3 IDiffuse = perFrameUbo.lights[lightIndex].IDiffuse * kDiffuse * max(dot(N, L), 0.0f);
 				vec3 ISpecular = perFrameUbo.lights[lightIndex].ISpecular * perObjectUbo.kSpecular * pow(max(dot(R, V), 0), perObjectUbo.ns);
 
-				ILocal += attenuation*(IAmbient + IDiffuse + ISpecular);
+				if(hasBakedLighting)
+				{
+					ILocal += attenuation*shadow*ISpecular;
+				}
+				else
+				{
+					vec3 IDiffuse = perFrameUbo.lights[lightIndex].IDiffuse * kDiffuse * max(dot(N, L), 0.0f);
+					ILocal += attenuation*(IAmbient + shadow*(IDiffuse + ISpecular));
+				}
 			}
 			else if(type == 1)
 			{
@@ -109,9 +197,16 @@ void main()
 				vec3 L = normalize(perFrameUbo.lights[lightIndex].p);
 				vec3 R = 2.0f*dot(N, L)*N - L;
 				
-				vec3 IDiffuse = perFrameUbo.lights[lightIndex].IDiffuse * kDiffuse * max(dot(N, L), 0.0f);
 				vec3 ISpecular = perFrameUbo.lights[lightIndex].ISpecular * perObjectUbo.kSpecular * pow(max(dot(R, V), 0), perObjectUbo.ns);
-				ILocal += IAmbient + IDiffuse + ISpecular;
+				if(hasBakedLighting)
+				{
+					ILocal += shadow*ISpecular;
+				}
+				else
+				{
+					vec3 IDiffuse = perFrameUbo.lights[lightIndex].IDiffuse * kDiffuse * max(dot(N, L), 0.0f);
+					ILocal += IAmbient + shadow*(IDiffuse + ISpecular);
+				}
 			}
 			else if(type == 2)
 			{
@@ -129,10 +224,17 @@ void main()
 
 				float spotlightEffect = max(pow(nom/denom, perFrameUbo.lights[lightIndex].fallOff), 0.0f);
 
-				vec3 IDiffuse = perFrameUbo.lights[lightIndex].IDiffuse * kDiffuse * max(dot(N, L), 0.0f);
 				vec3 ISpecular = perFrameUbo.lights[lightIndex].ISpecular * perObjectUbo.kSpecular * pow(max(dot(R, V), 0), perObjectUbo.ns);
 
-				ILocal += attenuation*IAmbient + attenuation*spotlightEffect*(IDiffuse + ISpecular);
+				if(hasBakedLighting)
+				{
+					ILocal += attenuation*spotlightEffect*shadow*ISpecular;
+				}
+				else
+				{
+					vec3 IDiffuse = perFrameUbo.lights[lightIndex].IDiffuse * kDiffuse * max(dot(N, L), 0.0f);
+					ILocal += attenuation*IAmbient + attenuation*spotlightEffect*shadow*(IDiffuse + ISpecular);
+				}
 			}
         }
     }
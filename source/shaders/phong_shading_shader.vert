@@ -45,6 +45,8 @@ layout(binding = 0) uniform per_frame_ubo
 layout(binding = 1) uniform per_object_ubo
 {
     mat4 model;
+	mat4 mvp;
+	mat4 normalMatrix; // inverse transpose of the model
 
 	vec3 IEmissive;
 
@@ -53,8 +55,13 @@ layout(binding = 1) uniform per_object_ubo
 	float kSpecular;
 
 	float ns;
+
+	bool hasBakedLighting;
 }perObjectUbo;
 
+// NOTE(joon) : ambient & diffuse of the lights for each vertex, see lighting_cache.h
+layout(binding = 2) uniform samplerBuffer bakedLighting;
+
 vec2
 PlanarTextureMapping(vec3 p)
 {
@@ -155,14 +162,30 @@ layout(location = 2) in vec2 texCoord;
 layout (location = 0) out vec3 fragNormal;
 layout (location = 1) out vec3 fragWorldP;
 layout (location = 2) out vec2 fragTexCoord;
+layout (location = 3) out vec3 fragBakedAmbient;
+layout (location = 4) out vec3 fragBakedDiffuse;
+
+// NOTE(joon) : Same as the depth pre-pass, see depth_only_shader.vert
+invariant gl_Position;
 
 void main()
 {
-    gl_Position = perFrameUbo.projection*perFrameUbo.view*perObjectUbo.model*vec4(p, 1.0);
+    gl_Position = perObjectUbo.mvp*vec4(p, 1.0);
 
-    fragNormal = vec3((perObjectUbo.model*vec4(normal, 0.0f)));
+    fragNormal = mat3(perObjectUbo.normalMatrix)*normal;
     fragWorldP = vec3((perObjectUbo.model*vec4(p, 1.0f)));
 
+	if(perObjectUbo.hasBakedLighting)
+	{
+		fragBakedAmbient = texelFetch(bakedLighting, 2*gl_VertexID).xyz;
+		fragBakedDiffuse = texelFetch(bakedLighting, 2*gl_VertexID + 1).xyz;
+	}
+	else
+	{
+		fragBakedAmbient = vec3(0);
+		fragBakedDiffuse = vec3(0);
+	}
+
 	if(perFrameUbo.shouldGenerateTexCoordInGPU)
 	{
 		vec3 pToUse = p;
@@ -3,6 +3,8 @@
 layout(binding = 1) uniform per_object_ubo
 {
     mat4 model;
+	mat4 mvp;
+	mat4 normalMatrix; // inverse transpose of the model
 	vec3 color;
 }perObjectUbo;
 
@@ -19,6 +19,8 @@ layout(binding = 0) uniform per_frame_ubo
 layout(binding = 1) uniform per_object_ubo
 {
     mat4 model;
+	mat4 mvp;
+	mat4 normalMatrix; // inverse transpose of the model
 	vec3 color;
 }perObjectUbo;
 
@@ -28,5 +30,5 @@ layout(location = 2) in vec2 texCoord;
 
 void main()
 {
-    gl_Position = perFrameUbo.projection*perFrameUbo.view*perObjectUbo.model*vec4(p, 1.0);
+    gl_Position = perObjectUbo.mvp*vec4(p, 1.0);
 }
\ No newline at end of file
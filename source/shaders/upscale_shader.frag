@@ -0,0 +1,61 @@
+#version 450
+
+// NOTE(joon) : The scene was rendered into the lower left sourceSize of the scene texture,
+// the rest of it is whatever a bigger scale has left there
+layout(binding = 0) uniform sampler2D sceneTexture;
+
+uniform ivec2 sourceSize;
+uniform ivec2 targetSize;
+uniform int filterType; // see upscale_filter
+
+out vec4 color;
+
+// NOTE(joon) : p is in texels, with the centers at .5
+vec3 SampleScene(vec2 p)
+{
+	p = clamp(p, vec2(0.5f), vec2(sourceSize) - vec2(0.5f));
+	return textureLod(sceneTexture, p / vec2(textureSize(sceneTexture, 0)), 0).rgb;
+}
+
+void main()
+{
+	vec2 p = gl_FragCoord.xy * (vec2(sourceSize) / vec2(targetSize));
+
+	if (filterType == 0)
+	{
+		color = vec4(SampleScene(p), 1.0f);
+		return;
+	}
+
+	// NOTE(joon) : Catmull-Rom over the 4x4 texels around p. The two texels in the middle of each axis
+	// have weights with the same sign, so each pair is read with one bilinear tap at the right offset,
+	// which turns the 16 taps into 9.
+	vec2 center = floor(p - 0.5f) + 0.5f;
+	vec2 f = p - center;
+
+	vec2 w0 = f*(-0.5f + f*(1.0f - 0.5f*f));
+	vec2 w1 = 1.0f + f*f*(-2.5f + 1.5f*f);
+	vec2 w2 = f*(0.5f + f*(2.0f - 1.5f*f));
+	vec2 w3 = f*f*(-0.5f + 0.5f*f);
+
+	vec2 w12 = w1 + w2;
+	vec2 p0 = center - 1.0f;
+	vec2 p12 = center + w2/w12;
+	vec2 p3 = center + 2.0f;
+
+	vec3 result = vec3(0.0f);
+	result += SampleScene(vec2(p0.x, p0.y)) * w0.x * w0.y;
+	result += SampleScene(vec2(p12.x, p0.y)) * w12.x * w0.y;
+	result += SampleScene(vec2(p3.x, p0.y)) * w3.x * w0.y;
+
+	result += SampleScene(vec2(p0.x, p12.y)) * w0.x * w12.y;
+	result += SampleScene(vec2(p12.x, p12.y)) * w12.x * w12.y;
+	result += SampleScene(vec2(p3.x, p12.y)) * w3.x * w12.y;
+
+	result += SampleScene(vec2(p0.x, p3.y)) * w0.x * w3.y;
+	result += SampleScene(vec2(p12.x, p3.y)) * w12.x * w3.y;
+	result += SampleScene(vec2(p3.x, p3.y)) * w3.x * w3.y;
+
+	// NOTE(joon) : The negative lobes can overshoot around the edges
+	color = vec4(max(result, vec3(0.0f)), 1.0f);
+}
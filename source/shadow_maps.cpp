@@ -0,0 +1,453 @@
+#include "shadow_maps.h"
+
+static GLuint
+CreateShadowAtlasTexture(b32 isSampledWithCompare)
+{
+	GLuint textureID;
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, SHADOW_ATLAS_SIZE, SHADOW_ATLAS_SIZE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	if (isSampledWithCompare)
+	{
+		// NOTE(joon) : Linear filtering of the compared results, which is a 2x2 PCF on most GPUs
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	}
+	else
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	}
+
+	return textureID;
+}
+
+// NOTE(joon) : Should be called while we have the context, before the render thread is started.
+// Both atlases are cleared to the far plane, so a tile that was never rendered doesn't shadow anything.
+// Leaves nothing bound to the texture unit 0.
+static void
+InitializeShadowMaps(shadow_maps *shadowMaps)
+{
+	*shadowMaps = {};
+
+	glActiveTexture(GL_TEXTURE0);
+	shadowMaps->staticAtlasTextureID = CreateShadowAtlasTexture(false);
+	shadowMaps->atlasTextureID = CreateShadowAtlasTexture(true);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(ArrayCount(shadowMaps->framebufferIDs), shadowMaps->framebufferIDs);
+	GLuint textureIDs[] = { shadowMaps->staticAtlasTextureID, shadowMaps->atlasTextureID };
+	for (u32 framebufferIndex = 0;
+		framebufferIndex < ArrayCount(shadowMaps->framebufferIDs);
+		++framebufferIndex)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, shadowMaps->framebufferIDs[framebufferIndex]);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, textureIDs[framebufferIndex], 0);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			printf("Shadow atlas is not complete\n");
+		}
+		glClear(GL_DEPTH_BUFFER_BIT);
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	glGenQueries(SHADOW_TIMER_QUERY_COUNT, shadowMaps->timerQueryIDs);
+}
+
+static void
+FreeShadowMaps(shadow_maps *shadowMaps)
+{
+	glDeleteTextures(1, &shadowMaps->staticAtlasTextureID);
+	glDeleteTextures(1, &shadowMaps->atlasTextureID);
+	glDeleteFramebuffers(ArrayCount(shadowMaps->framebufferIDs), shadowMaps->framebufferIDs);
+	glDeleteQueries(SHADOW_TIMER_QUERY_COUNT, shadowMaps->timerQueryIDs);
+}
+
+// NOTE(joon) : Starts timing the shadow passes, and picks up the time of the oldest passes if the GPU is done with them.
+// Leaves the depth test enabled & the color writes masked.
+static void
+BeginShadowPasses(shadow_maps *shadowMaps)
+{
+	u32 queryIndex = shadowMaps->timerQueryIndex;
+	GLuint queryID = shadowMaps->timerQueryIDs[queryIndex];
+	if (shadowMaps->isTimerQueryIssued[queryIndex])
+	{
+		// NOTE(joon) : Never waits, the query is simply reused when it's not ready yet
+		GLint isAvailable = 0;
+		glGetQueryObjectiv(queryID, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+		if (isAvailable)
+		{
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(queryID, GL_QUERY_RESULT, &elapsed);
+			shadowMaps->lastGPUTime = elapsed / 1000000.0;
+		}
+	}
+	glBeginQuery(GL_TIME_ELAPSED, queryID);
+	shadowMaps->isTimerQueryIssued[queryIndex] = true;
+
+	glEnable(GL_DEPTH_TEST);
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glEnable(GL_SCISSOR_TEST);
+	// NOTE(joon) : Slope scaled bias against the acne, the lighting shaders also move the receiver along the normal
+	glEnable(GL_POLYGON_OFFSET_FILL);
+	glPolygonOffset(2.0f, 4.0f);
+}
+
+// NOTE(joon) : Everything that is drawn after this goes into the tile of rect, inside the static or the final atlas.
+// Leaves the framebuffer, the viewport & the scissor box changed.
+static void
+BeginShadowView(shadow_maps *shadowMaps, glm::ivec4 rect, b32 isStatic, b32 shouldClear)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, shadowMaps->framebufferIDs[isStatic ? 0 : 1]);
+	glViewport(rect.x, rect.y, rect.z, rect.w);
+	glScissor(rect.x, rect.y, rect.z, rect.w);
+	if (shouldClear)
+	{
+		glClear(GL_DEPTH_BUFFER_BIT);
+	}
+}
+
+// NOTE(joon) : Static depth of the tile into the final atlas, which also erases the dynamic casters of the last time
+static void
+CopyShadowView(shadow_maps *shadowMaps, glm::ivec4 rect)
+{
+	glCopyImageSubData(shadowMaps->staticAtlasTextureID, GL_TEXTURE_2D, 0, rect.x, rect.y, 0,
+					shadowMaps->atlasTextureID, GL_TEXTURE_2D, 0, rect.x, rect.y, 0,
+					rect.z, rect.w, 1);
+}
+
+// NOTE(joon) : Leaves the default framebuffer bound, with the scissor test & the polygon offset disabled.
+// The viewport & the scissor box should be restored by the caller.
+static void
+EndShadowPasses(shadow_maps *shadowMaps)
+{
+	glEndQuery(GL_TIME_ELAPSED);
+	shadowMaps->timerQueryIndex = (shadowMaps->timerQueryIndex + 1) % SHADOW_TIMER_QUERY_COUNT;
+
+	glDisable(GL_POLYGON_OFFSET_FILL);
+	glDisable(GL_SCISSOR_TEST);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// NOTE(joon) : Distance where the light drops below 1/256 of its brightest diffuse channel, 0 when it never gets there.
+// Directional lights are not attenuated, and always cover the whole box.
+static r32
+GetShadowLightRange(light *light)
+{
+	r32 result = SHADOW_MAX_LIGHT_RANGE;
+	if (light->type != LightType_Directional)
+	{
+		r32 intensity = Maximum(Maximum(light->IDiffuse.x, light->IDiffuse.y), light->IDiffuse.z);
+		// NOTE(joon) : c3*d^2 + c2*d + c1 = 256*intensity
+		r32 c = light->c1 - 256.0f*intensity;
+		if (c >= 0.0f)
+		{
+			result = 0.0f;
+		}
+		else if (light->c3 > 0.0f)
+		{
+			r32 d = (-light->c2 + sqrtf(light->c2*light->c2 - 4.0f*light->c3*c)) / (2.0f*light->c3);
+			result = Minimum(d, SHADOW_MAX_LIGHT_RANGE);
+		}
+		else if (light->c2 > 0.0f)
+		{
+			result = Minimum(-c / light->c2, SHADOW_MAX_LIGHT_RANGE);
+		}
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Height of the bounding sphere of the light on the screen, relative to the height of the screen
+static r32
+GetShadowScreenCoverage(light *light, r32 range, glm::vec3 cameraP, r32 tanHalfFovY)
+{
+	r32 result = 1.0f;
+	if (light->type != LightType_Directional)
+	{
+		r32 distance = glm::length(light->p - cameraP);
+		if (distance > range)
+		{
+			r32 projectedRadius = range / (sqrtf(distance*distance - range*range)*tanHalfFovY);
+			result = Minimum(projectedRadius, 1.0f);
+		}
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Fills the view projection & the normal offset of each view of the light, and returns the view count.
+// Should match the face selection inside the lighting shaders.
+static u32
+GetShadowViews(light *light, r32 range, i32 tileSize, glm::mat4 *viewProjections, glm::vec4 *normalOffsets)
+{
+	u32 result = 0;
+	r32 zNear = 0.05f;
+	switch (light->type)
+	{
+		case LightType_Point:
+		{
+			glm::vec3 faceDirections[6] = { {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1} };
+			glm::vec3 faceUps[6] = { {0, -1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}, {0, -1, 0}, {0, -1, 0} };
+			glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, zNear, range);
+			for (u32 faceIndex = 0;
+				faceIndex < ArrayCount(faceDirections);
+				++faceIndex)
+			{
+				glm::mat4 view = glm::lookAt(light->p, light->p + faceDirections[faceIndex], faceUps[faceIndex]);
+				MultiplyMatrix4x4(viewProjections + faceIndex, &projection, &view);
+				normalOffsets[faceIndex] = glm::vec4(0.0f, SHADOW_NORMAL_OFFSET*2.0f / tileSize, 0.0f, 0.0f);
+			}
+			result = 6;
+		}break;
+
+		case LightType_SpotLight:
+		{
+			// NOTE(joon) : Same as the lighting, the spot light is always facing at (0, 0, 0)
+			glm::vec3 direction = glm::vec3(0, -1, 0);
+			if (glm::length(light->p) > 0.0f)
+			{
+				direction = -glm::normalize(light->p);
+			}
+			glm::vec3 up = (fabsf(direction.y) > 0.99f) ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+
+			r32 halfFov = Minimum(acosf(Clamp(-1.0f, light->outerConeAngleCos, 1.0f)) + glm::radians(2.0f), glm::radians(85.0f));
+			glm::mat4 projection = glm::perspective(2.0f*halfFov, 1.0f, zNear, range);
+			glm::mat4 view = glm::lookAt(light->p, light->p + direction, up);
+			MultiplyMatrix4x4(viewProjections, &projection, &view);
+			normalOffsets[0] = glm::vec4(0.0f, SHADOW_NORMAL_OFFSET*2.0f*tanf(halfFov) / tileSize, 0.0f, 0.0f);
+			result = 1;
+		}break;
+
+		case LightType_Directional:
+		{
+			glm::vec3 L = glm::vec3(0, 1, 0);
+			if (glm::length(light->p) > 0.0f)
+			{
+				L = glm::normalize(light->p);
+			}
+			glm::vec3 up = (fabsf(L.y) > 0.99f) ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+
+			r32 extent = SHADOW_DIRECTIONAL_EXTENT;
+			glm::mat4 projection = glm::ortho(-extent, extent, -extent, extent, 0.0f, 4.0f*extent);
+			glm::mat4 view = glm::lookAt(2.0f*extent*L, glm::vec3(0, 0, 0), up);
+			MultiplyMatrix4x4(viewProjections, &projection, &view);
+			normalOffsets[0] = glm::vec4(SHADOW_NORMAL_OFFSET*2.0f*extent / tileSize, 0.0f, 0.0f, 0.0f);
+			result = 1;
+		}break;
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Only what changes the views, the color of the light doesn't matter
+static b32
+IsShadowLightEqual(light *a, light *b)
+{
+	b32 result = a->isEnabled == b->isEnabled &&
+				a->type == b->type &&
+				a->p == b->p &&
+				a->IDiffuse == b->IDiffuse &&
+				a->c1 == b->c1 && a->c2 == b->c2 && a->c3 == b->c3 &&
+				a->outerConeAngleCos == b->outerConeAngleCos;
+
+	return result;
+}
+
+struct shadow_tile
+{
+	u32 lightIndex;
+	u32 viewIndex;
+	i32 size;
+};
+
+// NOTE(joon) : Decides the tiles & the views of the lights, and fills the shadow ubo.
+// shouldRenderStatic is set for the lights that should render their static casters again,
+// which happens when the light, its tile or any of the static casters(staticCasterHash) have changed.
+static void
+UpdateShadowCache(shadow_cache *cache, light *lights, u32 lightCount, glm::vec3 cameraP, r32 fovYInDegree,
+				u64 staticCasterHash, shadow_ubo *ubo, b32 *shouldRenderStatic)
+{
+	Assert(lightCount == ArrayCount(cache->lights));
+	b32 haveStaticCastersChanged = (staticCasterHash != cache->staticCasterHash);
+	cache->staticCasterHash = staticCasterHash;
+
+	// NOTE(joon) : Tile size that each light wants from its screen coverage
+	r32 tanHalfFovY = tanf(0.5f*glm::radians(fovYInDegree));
+	r32 ranges[ArrayCount(cache->lights)];
+	r32 coverages[ArrayCount(cache->lights)];
+	i32 tileSizes[ArrayCount(cache->lights)];
+	u32 viewCounts[ArrayCount(cache->lights)];
+	u64 totalTexelCount = 0;
+	for (u32 lightIndex = 0;
+		lightIndex < lightCount;
+		++lightIndex)
+	{
+		light *light = lights + lightIndex;
+		shadow_light_cache *lightCache = cache->lights + lightIndex;
+
+		ranges[lightIndex] = light->isEnabled ? GetShadowLightRange(light) : 0.0f;
+		coverages[lightIndex] = 0.0f;
+		tileSizes[lightIndex] = 0;
+		viewCounts[lightIndex] = 0;
+		if (ranges[lightIndex] > 0.0f)
+		{
+			coverages[lightIndex] = GetShadowScreenCoverage(light, ranges[lightIndex], cameraP, tanHalfFovY);
+
+			i32 desiredTileSize = SHADOW_MIN_TILE_SIZE;
+			while (desiredTileSize < cache->maxTileSize && desiredTileSize < coverages[lightIndex]*cache->maxTileSize)
+			{
+				desiredTileSize *= 2;
+			}
+			// NOTE(joon) : Only shrinks when the tile could be 4 times smaller,
+			// so that a small camera movement doesn't keep rendering the static casters again
+			if (desiredTileSize > lightCache->requestedTileSize || 2*desiredTileSize < lightCache->requestedTileSize ||
+				lightCache->requestedTileSize > cache->maxTileSize)
+			{
+				lightCache->requestedTileSize = desiredTileSize;
+			}
+
+			tileSizes[lightIndex] = lightCache->requestedTileSize;
+			viewCounts[lightIndex] = (light->type == LightType_Point) ? 6 : 1;
+			totalTexelCount += (u64)tileSizes[lightIndex]*tileSizes[lightIndex]*viewCounts[lightIndex];
+		}
+		else
+		{
+			lightCache->requestedTileSize = 0;
+		}
+	}
+
+	// NOTE(joon) : Halve the biggest tile until everything fits, the one with the smallest coverage first.
+	// Even the smallest tiles of every view fit inside the atlas, so this always ends.
+	u64 atlasTexelCount = (u64)SHADOW_ATLAS_SIZE*SHADOW_ATLAS_SIZE;
+	while (totalTexelCount > atlasTexelCount)
+	{
+		u32 biggestLightIndex = 0;
+		for (u32 lightIndex = 1;
+			lightIndex < lightCount;
+			++lightIndex)
+		{
+			if (tileSizes[lightIndex] > tileSizes[biggestLightIndex] ||
+				(tileSizes[lightIndex] == tileSizes[biggestLightIndex] && coverages[lightIndex] < coverages[biggestLightIndex]))
+			{
+				biggestLightIndex = lightIndex;
+			}
+		}
+		Assert(tileSizes[biggestLightIndex] > SHADOW_MIN_TILE_SIZE);
+
+		i32 size = tileSizes[biggestLightIndex];
+		totalTexelCount -= (u64)(size*size - (size/2)*(size/2))*viewCounts[biggestLightIndex];
+		tileSizes[biggestLightIndex] = size / 2;
+	}
+
+	// NOTE(joon) : Shelf packing from the biggest tile. Every size is a power of two that divides the atlas size,
+	// so each shelf is completely filled before the next one starts and anything that fits by the area also fits here.
+	shadow_tile tiles[SHADOW_MAX_VIEW_COUNT];
+	u32 tileCount = 0;
+	for (u32 lightIndex = 0;
+		lightIndex < lightCount;
+		++lightIndex)
+	{
+		for (u32 viewIndex = 0;
+			viewIndex < viewCounts[lightIndex];
+			++viewIndex)
+		{
+			tiles[tileCount++] = {lightIndex, viewIndex, tileSizes[lightIndex]};
+		}
+	}
+	std::stable_sort(tiles, tiles + tileCount, [](const shadow_tile &a, const shadow_tile &b)
+	{
+		return a.size > b.size;
+	});
+
+	glm::ivec2 tileOrigins[ArrayCount(cache->lights)][6] = {};
+	i32 x = 0;
+	i32 y = 0;
+	i32 shelfHeight = 0;
+	for (u32 tileIndex = 0;
+		tileIndex < tileCount;
+		++tileIndex)
+	{
+		shadow_tile *tile = tiles + tileIndex;
+		if (x + tile->size > SHADOW_ATLAS_SIZE)
+		{
+			x = 0;
+			y += shelfHeight;
+			shelfHeight = 0;
+		}
+		Assert(y + tile->size <= SHADOW_ATLAS_SIZE);
+		tileOrigins[tile->lightIndex][tile->viewIndex] = glm::ivec2(x, y);
+		x += tile->size;
+		shelfHeight = Maximum(shelfHeight, tile->size);
+	}
+
+	*ubo = {};
+	ubo->atlasTexelSize = glm::vec4(1.0f / SHADOW_ATLAS_SIZE, 0.0f, 0.0f, 0.0f);
+	cache->totalViewCount = 0;
+	cache->usedAtlasTexelCount = totalTexelCount;
+	for (u32 lightIndex = 0;
+		lightIndex < lightCount;
+		++lightIndex)
+	{
+		light *light = lights + lightIndex;
+		shadow_light_cache *lightCache = cache->lights + lightIndex;
+
+		b32 hasTileChanged = (lightCache->tileSize != tileSizes[lightIndex]);
+		for (u32 viewIndex = 0;
+			viewIndex < viewCounts[lightIndex];
+			++viewIndex)
+		{
+			hasTileChanged |= (lightCache->tileOrigins[viewIndex] != tileOrigins[lightIndex][viewIndex]);
+			lightCache->tileOrigins[viewIndex] = tileOrigins[lightIndex][viewIndex];
+		}
+		lightCache->tileSize = tileSizes[lightIndex];
+		lightCache->viewCount = viewCounts[lightIndex];
+		lightCache->firstView = cache->totalViewCount;
+
+		shouldRenderStatic[lightIndex] = false;
+		if (lightCache->viewCount)
+		{
+			shouldRenderStatic[lightIndex] = !lightCache->isStaticValid || hasTileChanged || haveStaticCastersChanged ||
+											!IsShadowLightEqual(&lightCache->light, light);
+
+			glm::vec4 normalOffsets[6];
+			GetShadowViews(light, ranges[lightIndex], lightCache->tileSize, lightCache->viewProjections, normalOffsets);
+
+			ubo->lightViews[lightIndex] = glm::ivec4(lightCache->firstView, lightCache->viewCount, 0, 0);
+			for (u32 viewIndex = 0;
+				viewIndex < lightCache->viewCount;
+				++viewIndex)
+			{
+				shadow_view *view = ubo->views + lightCache->firstView + viewIndex;
+				view->viewProjection = lightCache->viewProjections[viewIndex];
+				view->atlasRect = glm::vec4(glm::vec2(lightCache->tileOrigins[viewIndex]), (r32)lightCache->tileSize, (r32)lightCache->tileSize) /
+								(r32)SHADOW_ATLAS_SIZE;
+				view->normalOffset = normalOffsets[viewIndex];
+			}
+			cache->totalViewCount += lightCache->viewCount;
+
+			// NOTE(joon) : The packet that is built with this will render them
+			lightCache->light = *light;
+			lightCache->isStaticValid = true;
+		}
+		else
+		{
+			lightCache->isStaticValid = false;
+			for (u32 viewIndex = 0;
+				viewIndex < ArrayCount(lightCache->hasDynamicCasters);
+				++viewIndex)
+			{
+				lightCache->hasDynamicCasters[viewIndex] = false;
+			}
+		}
+	}
+}
@@ -0,0 +1,105 @@
+#ifndef SHADOW_MAPS_H
+#define SHADOW_MAPS_H
+
+// NOTE(joon) : Every shadow map lives inside one depth atlas, as square tiles :
+//   spot light : one perspective tile covering the outer cone
+//   point light : six 90 degree tiles, one for each face of the cube(+x, -x, +y, -y, +z, -z)
+//   directional light : one orthographic tile with a fixed box around the scene
+//
+// The casters are split into static(floor, model that is not rotating) and dynamic ones.
+// The static casters are rendered into the static atlas only when the light, the tile or one of the static casters has changed.
+// Every frame that has anything to change, the static depth of the tile is copied into the final atlas
+// and the dynamic casters are drawn on top of it, so a light that doesn't move only pays for its dynamic casters.
+//
+// The size of each tile comes from the screen coverage of the light, and the tiles are shrunk
+// when they don't fit inside the atlas. The lighting shaders find the tile of each light from the shadow ubo.
+
+#define SHADOW_ATLAS_SIZE 4096
+#define SHADOW_MIN_TILE_SIZE 128
+#define SHADOW_MAX_VIEW_COUNT 96 // 6 for each of the 16 lights
+#define SHADOW_TIMER_QUERY_COUNT 4 // the GPU time is read back this many frames later, so that we never stall
+// NOTE(joon) : Should match the bindings inside the lighting shaders
+#define SHADOW_UBO_BINDING 2
+#define SHADOW_ATLAS_TEXTURE_UNIT 4
+
+// NOTE(joon) : The lights are not allowed to cast shadows further than this, otherwise the range of the point lights
+// (where the attenuation goes below 1/256) would be a lot bigger than the scene
+#define SHADOW_MAX_LIGHT_RANGE 16.0f
+#define SHADOW_DIRECTIONAL_EXTENT 10.0f // half size of the orthographic box, centered at the origin
+#define SHADOW_NORMAL_OFFSET 1.5f // in texels, the receiver is moved along the normal before the lookup
+
+// NOTE(joon) : std140, should match the ones inside the lighting shaders
+struct shadow_view
+{
+	alignas(16) glm::mat4 viewProjection;
+	alignas(16) glm::vec4 atlasRect; // xy : min, zw : size, in uv
+	alignas(16) glm::vec4 normalOffset; // x + y*distance to the light, in world space
+};
+
+struct shadow_ubo
+{
+	alignas(16) glm::ivec4 lightViews[16]; // x : first view, y : view count(0 when the light doesn't cast shadows)
+	shadow_view views[SHADOW_MAX_VIEW_COUNT];
+	alignas(16) glm::vec4 atlasTexelSize; // x
+};
+
+// NOTE(joon) : Build stage only
+struct shadow_light_cache
+{
+	struct light light; // what the static views were rendered with
+	u32 viewCount;
+	u32 firstView; // inside the shadow ubo
+	i32 requestedTileSize; // from the screen coverage, before it's shrunk to fit
+	i32 tileSize; // 0 when the light doesn't cast shadows
+	glm::ivec2 tileOrigins[6]; // in texels
+	glm::mat4 viewProjections[6];
+	b32 isStaticValid;
+	b32 hasDynamicCasters[6]; // inside the final atlas, so they should be erased even when there's nothing dynamic anymore
+};
+
+struct shadow_cache
+{
+	b32 isSupported; // the atlases were created, should be set before the first build
+	int maxTileSize; // per light budget before it gets shrunk to fit inside the atlas
+
+	shadow_light_cache lights[16];
+	u64 staticCasterHash; // of the static casters that the static atlas was rendered with
+
+	// NOTE(joon) : stats of the last build
+	u32 staticViewCount; // rendered into the static atlas
+	u32 compositedViewCount; // copied into the final atlas, with or without the dynamic casters
+	u32 totalViewCount;
+	u64 usedAtlasTexelCount;
+};
+
+// NOTE(joon) : Depth only draw of a caster into a view, the mvp already has the view projection of the light
+struct shadow_caster
+{
+	struct model *model;
+	object_matrices matrices;
+};
+
+// NOTE(joon) : One view that the render thread should update this frame
+struct shadow_pass
+{
+	glm::ivec4 rect; // x, y, width, height in texels of the atlas
+	b32 shouldRenderStatic; // into the static atlas, before it's copied
+	u32 firstCaster; // frame_packet::shadowCasters, the static ones come first
+	u32 staticCasterCount;
+	u32 dynamicCasterCount;
+};
+
+// NOTE(joon) : Every GL object here is owned by the render thread after it's started
+struct shadow_maps
+{
+	GLuint staticAtlasTextureID;
+	GLuint atlasTextureID; // static depth + the dynamic casters, sampled by the lighting shaders
+	GLuint framebufferIDs[2]; // static, final
+
+	GLuint timerQueryIDs[SHADOW_TIMER_QUERY_COUNT];
+	b32 isTimerQueryIssued[SHADOW_TIMER_QUERY_COUNT];
+	u32 timerQueryIndex;
+	r64 lastGPUTime; // in ms, of the shadow passes a few frames ago
+};
+
+#endif
@@ -0,0 +1,1022 @@
+#include "software_renderer.h"
+
+// NOTE(joon) : 4 wide lanes, SSE2 when we have it(which is always the case on x64),
+// and plain arrays otherwise so that the same shading code compiles everywhere.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SOFTWARE_USE_SSE 1
+#endif
+
+struct lane_r32
+{
+#if SOFTWARE_USE_SSE
+	__m128 v;
+#else
+	r32 e[SOFTWARE_LANE_WIDTH];
+#endif
+};
+
+// NOTE(joon) : The comparisons return the masks with all the bits set, like SSE does
+#if SOFTWARE_USE_SSE
+inline lane_r32 LaneR32(r32 value) {lane_r32 result; result.v = _mm_set1_ps(value); return result;}
+inline lane_r32 LaneR32(r32 a, r32 b, r32 c, r32 d) {lane_r32 result; result.v = _mm_setr_ps(a, b, c, d); return result;}
+inline lane_r32 LoadLane(r32 *source) {lane_r32 result; result.v = _mm_loadu_ps(source); return result;}
+inline void StoreLane(r32 *dest, lane_r32 a) {_mm_storeu_ps(dest, a.v);}
+inline lane_r32 operator+(lane_r32 a, lane_r32 b) {lane_r32 result; result.v = _mm_add_ps(a.v, b.v); return result;}
+inline lane_r32 operator-(lane_r32 a, lane_r32 b) {lane_r32 result; result.v = _mm_sub_ps(a.v, b.v); return result;}
+inline lane_r32 operator*(lane_r32 a, lane_r32 b) {lane_r32 result; result.v = _mm_mul_ps(a.v, b.v); return result;}
+inline lane_r32 operator/(lane_r32 a, lane_r32 b) {lane_r32 result; result.v = _mm_div_ps(a.v, b.v); return result;}
+inline lane_r32 LaneMin(lane_r32 a, lane_r32 b) {lane_r32 result; result.v = _mm_min_ps(a.v, b.v); return result;}
+inline lane_r32 LaneMax(lane_r32 a, lane_r32 b) {lane_r32 result; result.v = _mm_max_ps(a.v, b.v); return result;}
+inline lane_r32 LaneSqrt(lane_r32 a) {lane_r32 result; result.v = _mm_sqrt_ps(a.v); return result;}
+inline lane_r32 LaneRound(lane_r32 a) {lane_r32 result; result.v = _mm_cvtepi32_ps(_mm_cvtps_epi32(a.v)); return result;}
+inline lane_r32 LaneGreater(lane_r32 a, lane_r32 b) {lane_r32 result; result.v = _mm_cmpgt_ps(a.v, b.v); return result;}
+inline lane_r32 LaneGreaterEqual(lane_r32 a, lane_r32 b) {lane_r32 result; result.v = _mm_cmpge_ps(a.v, b.v); return result;}
+inline lane_r32 LaneLess(lane_r32 a, lane_r32 b) {lane_r32 result; result.v = _mm_cmplt_ps(a.v, b.v); return result;}
+inline lane_r32 LaneAnd(lane_r32 a, lane_r32 b) {lane_r32 result; result.v = _mm_and_ps(a.v, b.v); return result;}
+inline lane_r32 LaneOr(lane_r32 a, lane_r32 b) {lane_r32 result; result.v = _mm_or_ps(a.v, b.v); return result;}
+// NOTE(joon) : mask ? a : b
+inline lane_r32 LaneSelect(lane_r32 mask, lane_r32 a, lane_r32 b) {lane_r32 result; result.v = _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); return result;}
+inline u32 LaneMaskBits(lane_r32 mask) {return (u32)_mm_movemask_ps(mask.v);}
+#else
+inline lane_r32 LaneR32(r32 value) {lane_r32 result; for (u32 i = 0; i < 4; ++i) {result.e[i] = value;} return result;}
+inline lane_r32 LaneR32(r32 a, r32 b, r32 c, r32 d) {lane_r32 result = {{a, b, c, d}}; return result;}
+inline lane_r32 LoadLane(r32 *source) {lane_r32 result; memcpy(result.e, source, sizeof(result.e)); return result;}
+inline void StoreLane(r32 *dest, lane_r32 a) {memcpy(dest, a.e, sizeof(a.e));}
+inline lane_r32 operator+(lane_r32 a, lane_r32 b) {lane_r32 result; for (u32 i = 0; i < 4; ++i) {result.e[i] = a.e[i] + b.e[i];} return result;}
+inline lane_r32 operator-(lane_r32 a, lane_r32 b) {lane_r32 result; for (u32 i = 0; i < 4; ++i) {result.e[i] = a.e[i] - b.e[i];} return result;}
+inline lane_r32 operator*(lane_r32 a, lane_r32 b) {lane_r32 result; for (u32 i = 0; i < 4; ++i) {result.e[i] = a.e[i] * b.e[i];} return result;}
+inline lane_r32 operator/(lane_r32 a, lane_r32 b) {lane_r32 result; for (u32 i = 0; i < 4; ++i) {result.e[i] = a.e[i] / b.e[i];} return result;}
+inline lane_r32 LaneMin(lane_r32 a, lane_r32 b) {lane_r32 result; for (u32 i = 0; i < 4; ++i) {result.e[i] = (a.e[i] < b.e[i]) ? a.e[i] : b.e[i];} return result;}
+inline lane_r32 LaneMax(lane_r32 a, lane_r32 b) {lane_r32 result; for (u32 i = 0; i < 4; ++i) {result.e[i] = (a.e[i] > b.e[i]) ? a.e[i] : b.e[i];} return result;}
+inline lane_r32 LaneSqrt(lane_r32 a) {lane_r32 result; for (u32 i = 0; i < 4; ++i) {result.e[i] = sqrtf(a.e[i]);} return result;}
+inline lane_r32 LaneRound(lane_r32 a) {lane_r32 result; for (u32 i = 0; i < 4; ++i) {result.e[i] = nearbyintf(a.e[i]);} return result;}
+inline lane_r32 LaneFromBools(b32 a, b32 b, b32 c, b32 d)
+{
+	u32 bits[4] = {a ? 0xffffffff : 0, b ? 0xffffffff : 0, c ? 0xffffffff : 0, d ? 0xffffffff : 0};
+	lane_r32 result;
+	memcpy(result.e, bits, sizeof(bits));
+	return result;
+}
+inline lane_r32 LaneGreater(lane_r32 a, lane_r32 b) {return LaneFromBools(a.e[0] > b.e[0], a.e[1] > b.e[1], a.e[2] > b.e[2], a.e[3] > b.e[3]);}
+inline lane_r32 LaneGreaterEqual(lane_r32 a, lane_r32 b) {return LaneFromBools(a.e[0] >= b.e[0], a.e[1] >= b.e[1], a.e[2] >= b.e[2], a.e[3] >= b.e[3]);}
+inline lane_r32 LaneLess(lane_r32 a, lane_r32 b) {return LaneFromBools(a.e[0] < b.e[0], a.e[1] < b.e[1], a.e[2] < b.e[2], a.e[3] < b.e[3]);}
+inline lane_r32 LaneAnd(lane_r32 a, lane_r32 b)
+{
+	u32 aBits[4], bBits[4];
+	memcpy(aBits, a.e, sizeof(aBits));
+	memcpy(bBits, b.e, sizeof(bBits));
+	for (u32 i = 0; i < 4; ++i) {aBits[i] &= bBits[i];}
+	lane_r32 result;
+	memcpy(result.e, aBits, sizeof(aBits));
+	return result;
+}
+inline lane_r32 LaneOr(lane_r32 a, lane_r32 b)
+{
+	u32 aBits[4], bBits[4];
+	memcpy(aBits, a.e, sizeof(aBits));
+	memcpy(bBits, b.e, sizeof(bBits));
+	for (u32 i = 0; i < 4; ++i) {aBits[i] |= bBits[i];}
+	lane_r32 result;
+	memcpy(result.e, aBits, sizeof(aBits));
+	return result;
+}
+inline u32 LaneMaskBits(lane_r32 mask)
+{
+	u32 bits[4];
+	memcpy(bits, mask.e, sizeof(bits));
+	return (bits[0] >> 31) | ((bits[1] >> 31) << 1) | ((bits[2] >> 31) << 2) | ((bits[3] >> 31) << 3);
+}
+inline lane_r32 LaneSelect(lane_r32 mask, lane_r32 a, lane_r32 b)
+{
+	u32 maskBits = LaneMaskBits(mask);
+	lane_r32 result;
+	for (u32 i = 0; i < 4; ++i) {result.e[i] = (maskBits & (1 << i)) ? a.e[i] : b.e[i];}
+	return result;
+}
+#endif
+
+struct lane_v3
+{
+	lane_r32 x;
+	lane_r32 y;
+	lane_r32 z;
+};
+
+inline lane_v3 LaneV3(lane_r32 x, lane_r32 y, lane_r32 z) {lane_v3 result = {x, y, z}; return result;}
+inline lane_v3 LaneV3(glm::vec3 a) {return LaneV3(LaneR32(a.x), LaneR32(a.y), LaneR32(a.z));}
+inline lane_v3 operator+(lane_v3 a, lane_v3 b) {return LaneV3(a.x + b.x, a.y + b.y, a.z + b.z);}
+inline lane_v3 operator-(lane_v3 a, lane_v3 b) {return LaneV3(a.x - b.x, a.y - b.y, a.z - b.z);}
+inline lane_v3 operator*(lane_v3 a, lane_v3 b) {return LaneV3(a.x*b.x, a.y*b.y, a.z*b.z);}
+inline lane_v3 operator*(lane_r32 a, lane_v3 b) {return LaneV3(a*b.x, a*b.y, a*b.z);}
+inline lane_v3 &operator+=(lane_v3 &a, lane_v3 b) {a = a + b; return a;}
+inline lane_r32 Dot(lane_v3 a, lane_v3 b) {return a.x*b.x + a.y*b.y + a.z*b.z;}
+inline lane_r32 Length(lane_v3 a) {return LaneSqrt(Dot(a, a));}
+inline lane_v3 Normalize(lane_v3 a) {return (LaneR32(1.0f) / Length(a))*a;}
+
+// NOTE(joon) : There's no pow in SSE, and an approximation would change the highlights
+static lane_r32
+LanePow(lane_r32 base, r32 exponent)
+{
+	r32 values[SOFTWARE_LANE_WIDTH];
+	StoreLane(values, base);
+	for (u32 laneIndex = 0;
+		laneIndex < SOFTWARE_LANE_WIDTH;
+		++laneIndex)
+	{
+		values[laneIndex] = powf(values[laneIndex], exponent);
+	}
+
+	return LoadLane(values);
+}
+
+static void
+InitializeSoftwareRenderer(software_renderer *renderer, i32 width, i32 height)
+{
+	renderer->width = width;
+	renderer->height = height;
+	renderer->tileCountX = (width + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+	renderer->tileCountY = (height + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+	renderer->stride = renderer->tileCountX*SOFTWARE_TILE_SIZE;
+
+	u32 pixelCount = renderer->stride*renderer->tileCountY*SOFTWARE_TILE_SIZE;
+	renderer->color = (u32 *)malloc(sizeof(u32)*pixelCount);
+	renderer->depth = (r32 *)malloc(sizeof(r32)*pixelCount);
+
+	renderer->tileTriangles.resize(renderer->tileCountX*renderer->tileCountY);
+	renderer->tileShadedPixelCounts.resize(renderer->tileCountX*renderer->tileCountY);
+}
+
+static void
+FreeSoftwareRenderer(software_renderer *renderer)
+{
+	free(renderer->color);
+	free(renderer->depth);
+	renderer->color = 0;
+	renderer->depth = 0;
+
+	stbi_image_free(renderer->diffuseTexture.texels);
+	renderer->diffuseTexture.texels = 0;
+}
+
+static b32
+LoadSoftwareTexture(software_texture *texture, const char *fileName)
+{
+	int channelCount = 0;
+	texture->texels = LoadImageAsset(fileName, &texture->width, &texture->height, &channelCount, STBI_rgb);
+	if (!texture->texels)
+	{
+		printf("Failed to load the texture %s\n", fileName);
+	}
+
+	return texture->texels != 0;
+}
+
+// NOTE(joon) : GL_LINEAR & GL_REPEAT, texel centers are at the half
+static glm::vec3
+SampleTexture(software_texture *texture, r32 u, r32 v)
+{
+	r32 x = u*texture->width - 0.5f;
+	r32 y = v*texture->height - 0.5f;
+	r32 floorX = floorf(x);
+	r32 floorY = floorf(y);
+	r32 tx = x - floorX;
+	r32 ty = y - floorY;
+
+	i32 x0 = (i32)fmodf(floorX, (r32)texture->width);
+	i32 y0 = (i32)fmodf(floorY, (r32)texture->height);
+	x0 += (x0 < 0) ? texture->width : 0;
+	y0 += (y0 < 0) ? texture->height : 0;
+	i32 x1 = (x0 + 1 == texture->width) ? 0 : x0 + 1;
+	i32 y1 = (y0 + 1 == texture->height) ? 0 : y0 + 1;
+
+	u8 *t00 = texture->texels + 3*(y0*texture->width + x0);
+	u8 *t10 = texture->texels + 3*(y0*texture->width + x1);
+	u8 *t01 = texture->texels + 3*(y1*texture->width + x0);
+	u8 *t11 = texture->texels + 3*(y1*texture->width + x1);
+
+	glm::vec3 result;
+	for (u32 channel = 0;
+		channel < 3;
+		++channel)
+	{
+		r32 bottom = t00[channel] + tx*(t10[channel] - t00[channel]);
+		r32 top = t01[channel] + tx*(t11[channel] - t01[channel]);
+		result[channel] = (bottom + ty*(top - bottom)) / 255.0f;
+	}
+
+	return result;
+}
+
+// NOTE(joon) : There's no gather in SSE, so each active lane is sampled on its own.
+// Inactive lanes can have any garbage in them, which is why they are skipped.
+static lane_v3
+SampleTextureLanes(software_texture *texture, lane_r32 u, lane_r32 v, u32 activeMask)
+{
+	r32 us[SOFTWARE_LANE_WIDTH];
+	r32 vs[SOFTWARE_LANE_WIDTH];
+	StoreLane(us, u);
+	StoreLane(vs, v);
+
+	r32 results[3][SOFTWARE_LANE_WIDTH] = {};
+	for (u32 laneIndex = 0;
+		laneIndex < SOFTWARE_LANE_WIDTH;
+		++laneIndex)
+	{
+		if (activeMask & (1 << laneIndex))
+		{
+			glm::vec3 texel = SampleTexture(texture, us[laneIndex], vs[laneIndex]);
+			results[0][laneIndex] = texel.x;
+			results[1][laneIndex] = texel.y;
+			results[2][laneIndex] = texel.z;
+		}
+	}
+
+	return LaneV3(LoadLane(results[0]), LoadLane(results[1]), LoadLane(results[2]));
+}
+
+// NOTE(joon) : Same as the texture mapping functions inside the shaders,
+// used when the tex coords should be generated in the 'GPU'
+static glm::vec2
+GenerateShaderTexCoord(glm::vec3 p, int method)
+{
+	glm::vec2 result = glm::vec2(0, 0);
+	if (method == TextureMappingMethod_Planar)
+	{
+		r32 absX = fabsf(p.x);
+		r32 absY = fabsf(p.y);
+		r32 absZ = fabsf(p.z);
+		r32 u = 0.0f;
+		r32 v = 0.0f;
+		if (absX >= absY && absX >= absZ)
+		{
+			u = (p.x < 0.0f) ? p.z : -p.z;
+			v = p.y;
+		}
+		else if (absY >= absX && absY >= absZ)
+		{
+			v = (p.y < 0.0f) ? p.z : -p.z;
+			u = p.x;
+		}
+		else
+		{
+			u = (p.z < 0.0f) ? -p.x : p.x;
+			v = p.y;
+		}
+
+		result.x = 0.5f*(u + 1.0f);
+		result.y = 0.5f*(v + 1.0f);
+	}
+	else if (method == TextureMappingMethod_Cylindrical)
+	{
+		result.x = atanf(p.y/p.x) / Two_Pi32;
+		result.y = (p.z + 1.0f) / 2.0f;
+	}
+	else if (method == TextureMappingMethod_Spherical)
+	{
+		r32 r = sqrtf(3.0f);
+		result.x = atanf(p.y/p.x) / Two_Pi32;
+		result.y = acosf(p.z/r) / Pi32;
+	}
+
+	return result;
+}
+
+// NOTE(joon) : Lighting of the phong_shading, phong_lighting & blinn shaders for 4 points at once,
+// including the fog. activeMask only decides which lanes sample the texture.
+static lane_v3
+ShadeLanes(software_renderer *renderer, software_draw *draw, b32 isBlinn,
+			lane_v3 worldP, lane_v3 normal, lane_r32 u, lane_r32 v, u32 activeMask)
+{
+	per_frame_ubo *perFrameUbo = &renderer->perFrameUbo;
+	per_object_ubo *ubo = &draw->ubo;
+
+	lane_v3 N = Normalize(normal);
+	lane_v3 toCamera = LaneV3(perFrameUbo->cameraP) - worldP;
+	lane_r32 distanceToCamera = Length(toCamera);
+	lane_v3 V = (LaneR32(1.0f) / distanceToCamera)*toCamera;
+
+	lane_v3 diffuseTexel = LaneV3(glm::vec3(0, 0, 0));
+	if (draw->isTextured && renderer->diffuseTexture.texels)
+	{
+		diffuseTexel = SampleTextureLanes(&renderer->diffuseTexture, u, v, activeMask);
+	}
+	lane_v3 kAmbient = LaneR32(ubo->kAmbient)*diffuseTexel;
+	lane_v3 kDiffuse = LaneR32(ubo->kDiffuse)*diffuseTexel;
+	lane_r32 kSpecular = LaneR32(ubo->kSpecular);
+	lane_r32 zero = LaneR32(0.0f);
+	lane_r32 one = LaneR32(1.0f);
+	lane_r32 two = LaneR32(2.0f);
+
+	lane_v3 ILocal = LaneV3(ubo->IEmissive) + kAmbient*LaneV3(perFrameUbo->globalAmbient);
+	for (u32 lightIndex = 0;
+		lightIndex < ArrayCount(perFrameUbo->lights);
+		++lightIndex)
+	{
+		light *light = perFrameUbo->lights + lightIndex;
+		if (light->isEnabled)
+		{
+			lane_v3 IAmbient = LaneV3(light->IAmbient)*kAmbient;
+
+			lane_v3 toLight = LaneV3(light->p) - worldP;
+			lane_r32 distance = Length(toLight);
+			lane_r32 attenuationDenom = LaneR32(light->c1) + LaneR32(light->c2)*distance + LaneR32(light->c3)*distance*distance;
+			lane_r32 attenuation = LaneMin(one / attenuationDenom, one);
+
+			// NOTE(joon) : The directional light always uses the reflection vector, even in the blinn shader
+			lane_v3 L;
+			if (light->type == LightType_Directional)
+			{
+				L = LaneV3(glm::normalize(light->p));
+			}
+			else
+			{
+				L = (one / distance)*toLight;
+			}
+			lane_r32 NDotL = Dot(N, L);
+
+			lane_r32 specularBase;
+			if (isBlinn && light->type != LightType_Directional)
+			{
+				lane_v3 H = Normalize(L + V);
+				specularBase = LaneMax(Dot(N, H), zero);
+			}
+			else
+			{
+				lane_v3 R = (two*NDotL)*N - L;
+				specularBase = LaneMax(Dot(R, V), zero);
+			}
+
+			lane_v3 IDiffuse = LaneV3(light->IDiffuse)*(LaneMax(NDotL, zero)*kDiffuse);
+			lane_v3 ISpecular = (kSpecular*LanePow(specularBase, ubo->ns))*LaneV3(light->ISpecular);
+
+			if (light->type == LightType_Point)
+			{
+				ILocal += attenuation*(IAmbient + IDiffuse + ISpecular);
+			}
+			else if (light->type == LightType_Directional)
+			{
+				ILocal += IAmbient + IDiffuse + ISpecular;
+			}
+			else if (light->type == LightType_SpotLight)
+			{
+				// NOTE(joon) : The spotlight is always looking at the origin, so cos(alpha) = dot(-L, -normalize(p)).
+				// pow of a negative number is a NaN in GLSL, which max(NaN, 0) turns into 0.
+				lane_r32 cosAlpha = Dot(L, LaneV3(glm::normalize(light->p)));
+				lane_r32 spotlightRatio = (cosAlpha - LaneR32(light->outerConeAngleCos)) /
+										LaneR32(light->innerConeAngleCos - light->outerConeAngleCos);
+				lane_r32 spotlightEffect = LanePow(LaneMax(spotlightRatio, zero), light->fallOff);
+
+				ILocal += attenuation*IAmbient + (attenuation*spotlightEffect)*(IDiffuse + ISpecular);
+			}
+		}
+	}
+
+	lane_r32 S = (LaneR32(perFrameUbo->zFar) - distanceToCamera) / LaneR32(perFrameUbo->zFar - perFrameUbo->zNear);
+	S = LaneMin(LaneMax(S, zero), one);
+
+	return S*ILocal + (one - S)*LaneV3(perFrameUbo->IFog);
+}
+
+struct software_vertex_job_data
+{
+	software_renderer *renderer;
+	software_draw *draw;
+};
+
+// NOTE(joon) : The vertex shaders, 4 vertices at a time so that the gouraud lighting can use the lanes
+static void
+SoftwareVertexJob(void *data, u32 start, u32 onePastEnd)
+{
+	software_vertex_job_data *jobData = (software_vertex_job_data *)data;
+	software_renderer *renderer = jobData->renderer;
+	software_draw *draw = jobData->draw;
+	per_frame_ubo *perFrameUbo = &renderer->perFrameUbo;
+	vertex *vertices = draw->model->mesh.vertexBuffer.data();
+
+	glm::mat3 normalMatrix = glm::mat3(draw->ubo.normal);
+	for (u32 vertexIndex = start;
+		vertexIndex < onePastEnd;
+		vertexIndex += SOFTWARE_LANE_WIDTH)
+	{
+		r32 worldP[3][SOFTWARE_LANE_WIDTH];
+		r32 normal[3][SOFTWARE_LANE_WIDTH];
+		r32 texCoord[2][SOFTWARE_LANE_WIDTH];
+		u32 laneCount = Minimum(onePastEnd - vertexIndex, (u32)SOFTWARE_LANE_WIDTH);
+		for (u32 laneIndex = 0;
+			laneIndex < SOFTWARE_LANE_WIDTH;
+			++laneIndex)
+		{
+			// NOTE(joon) : The tail lanes just repeat the last vertex
+			vertex *in = vertices + vertexIndex + Minimum(laneIndex, laneCount - 1);
+
+			glm::vec4 p = glm::vec4(in->p, 1.0f);
+			glm::vec3 laneWorldP = glm::vec3(draw->ubo.model*p);
+			glm::vec3 laneNormal = normalMatrix*in->normal;
+			glm::vec2 laneTexCoord = in->texCoord;
+			if (perFrameUbo->shouldGenerateTexCoordInGPU)
+			{
+				laneTexCoord = GenerateShaderTexCoord(perFrameUbo->shouldUseNormal ? in->normal : in->p, perFrameUbo->textureMappingMethod);
+			}
+
+			for (u32 i = 0;
+				i < 3;
+				++i)
+			{
+				worldP[i][laneIndex] = laneWorldP[i];
+				normal[i][laneIndex] = laneNormal[i];
+			}
+			texCoord[0][laneIndex] = laneTexCoord.x;
+			texCoord[1][laneIndex] = laneTexCoord.y;
+
+			if (laneIndex < laneCount)
+			{
+				software_vertex *out = renderer->vertices.data() + draw->firstVertex + vertexIndex + laneIndex;
+				out->clipP = draw->ubo.mvp*p;
+				if (draw->shadingModel == SoftwareShading_Phong || draw->shadingModel == SoftwareShading_Blinn)
+				{
+					out->attributes[0] = laneWorldP.x;
+					out->attributes[1] = laneWorldP.y;
+					out->attributes[2] = laneWorldP.z;
+					out->attributes[3] = laneNormal.x;
+					out->attributes[4] = laneNormal.y;
+					out->attributes[5] = laneNormal.z;
+					out->attributes[6] = laneTexCoord.x;
+					out->attributes[7] = laneTexCoord.y;
+				}
+			}
+		}
+
+		if (draw->shadingModel == SoftwareShading_Gouraud)
+		{
+			lane_v3 color = ShadeLanes(renderer, draw, false,
+										LaneV3(LoadLane(worldP[0]), LoadLane(worldP[1]), LoadLane(worldP[2])),
+										LaneV3(LoadLane(normal[0]), LoadLane(normal[1]), LoadLane(normal[2])),
+										LoadLane(texCoord[0]), LoadLane(texCoord[1]), (1 << laneCount) - 1);
+			r32 colors[3][SOFTWARE_LANE_WIDTH];
+			StoreLane(colors[0], color.x);
+			StoreLane(colors[1], color.y);
+			StoreLane(colors[2], color.z);
+			for (u32 laneIndex = 0;
+				laneIndex < laneCount;
+				++laneIndex)
+			{
+				software_vertex *out = renderer->vertices.data() + draw->firstVertex + vertexIndex + laneIndex;
+				out->attributes[0] = colors[0][laneIndex];
+				out->attributes[1] = colors[1][laneIndex];
+				out->attributes[2] = colors[2][laneIndex];
+			}
+		}
+	}
+}
+
+// NOTE(joon) : Expects the triangle to be inside the near & far plane
+static void
+SetupSoftwareTriangle(software_renderer *renderer, std::vector<software_triangle> *triangles,
+					software_draw *draw, u32 drawIndex, software_vertex *v0, software_vertex *v1, software_vertex *v2)
+{
+	// NOTE(joon) : Window space, relative to the center of the framebuffer to keep the edge functions precise
+	software_vertex *vertices[3] = {v0, v1, v2};
+	glm::vec3 p[3];
+	r32 oneOverW[3];
+	r32 subpixelScale = (r32)(1 << SOFTWARE_SUBPIXEL_BITS);
+	for (u32 vertexIndex = 0;
+		vertexIndex < 3;
+		++vertexIndex)
+	{
+		glm::vec4 clipP = vertices[vertexIndex]->clipP;
+		oneOverW[vertexIndex] = 1.0f / clipP.w;
+		r32 x = 0.5f*clipP.x*oneOverW[vertexIndex]*renderer->width;
+		r32 y = 0.5f*clipP.y*oneOverW[vertexIndex]*renderer->height;
+		p[vertexIndex].x = roundf(x*subpixelScale) / subpixelScale;
+		p[vertexIndex].y = roundf(y*subpixelScale) / subpixelScale;
+		p[vertexIndex].z = 0.5f*clipP.z*oneOverW[vertexIndex] + 0.5f;
+	}
+
+	// NOTE(joon) : counter clockwise is the front face, and the back faces are culled
+	r32 area = (p[1].x - p[0].x)*(p[2].y - p[0].y) - (p[2].x - p[0].x)*(p[1].y - p[0].y);
+	if (area > 0.0f)
+	{
+		r32 centerX = 0.5f*renderer->width;
+		r32 centerY = 0.5f*renderer->height;
+
+		// NOTE(joon) : pixel i is covered when its center i + 0.5 is inside
+		software_triangle triangle;
+		r32 minX = Minimum(Minimum(p[0].x, p[1].x), p[2].x) + centerX;
+		r32 minY = Minimum(Minimum(p[0].y, p[1].y), p[2].y) + centerY;
+		r32 maxX = Maximum(Maximum(p[0].x, p[1].x), p[2].x) + centerX;
+		r32 maxY = Maximum(Maximum(p[0].y, p[1].y), p[2].y) + centerY;
+		triangle.minX = Maximum((i32)ceilf(Maximum(minX - 0.5f, -1.0f)), 0);
+		triangle.minY = Maximum((i32)ceilf(Maximum(minY - 0.5f, -1.0f)), 0);
+		triangle.maxX = Minimum((i32)floorf(Minimum(maxX - 0.5f, (r32)renderer->width)), renderer->width - 1);
+		triangle.maxY = Minimum((i32)floorf(Minimum(maxY - 0.5f, (r32)renderer->height)), renderer->height - 1);
+
+		if (triangle.minX <= triangle.maxX && triangle.minY <= triangle.maxY)
+		{
+			triangle.inclusiveEdgeMask = 0;
+			for (u32 edgeIndex = 0;
+				edgeIndex < 3;
+				++edgeIndex)
+			{
+				// NOTE(joon) : edge from the vertex i to the vertex i+1, positive inside.
+				// The neighbor that shares the edge gets the exact negation, so exactly one of them owns the pixels on it.
+				glm::vec3 a = p[edgeIndex];
+				glm::vec3 b = p[(edgeIndex + 1) % 3];
+				triangle.edgeA[edgeIndex] = a.y - b.y;
+				triangle.edgeB[edgeIndex] = b.x - a.x;
+				triangle.edgeC[edgeIndex] = a.x*b.y - a.y*b.x;
+				if (triangle.edgeA[edgeIndex] > 0.0f || (triangle.edgeA[edgeIndex] == 0.0f && triangle.edgeB[edgeIndex] < 0.0f))
+				{
+					triangle.inclusiveEdgeMask |= (1 << edgeIndex);
+				}
+			}
+
+			// NOTE(joon) : The barycentric weight of the vertex i is the edge function of the opposite edge(i+1, i+2) / area
+			r32 oneOverArea = 1.0f / area;
+			r32 weightA[3] = {triangle.edgeA[1]*oneOverArea, triangle.edgeA[2]*oneOverArea, triangle.edgeA[0]*oneOverArea};
+			r32 weightB[3] = {triangle.edgeB[1]*oneOverArea, triangle.edgeB[2]*oneOverArea, triangle.edgeB[0]*oneOverArea};
+			r32 weightC[3] = {triangle.edgeC[1]*oneOverArea, triangle.edgeC[2]*oneOverArea, triangle.edgeC[0]*oneOverArea};
+
+#define SetupPlane(plane, value0, value1, value2) \
+			plane[0] = weightA[0]*(value0) + weightA[1]*(value1) + weightA[2]*(value2); \
+			plane[1] = weightB[0]*(value0) + weightB[1]*(value1) + weightB[2]*(value2); \
+			plane[2] = weightC[0]*(value0) + weightC[1]*(value1) + weightC[2]*(value2);
+
+			SetupPlane(triangle.depth, p[0].z, p[1].z, p[2].z);
+			SetupPlane(triangle.oneOverW, oneOverW[0], oneOverW[1], oneOverW[2]);
+			for (u32 attributeIndex = 0;
+				attributeIndex < draw->attributeCount;
+				++attributeIndex)
+			{
+				SetupPlane(triangle.attributes[attributeIndex],
+							v0->attributes[attributeIndex]*oneOverW[0],
+							v1->attributes[attributeIndex]*oneOverW[1],
+							v2->attributes[attributeIndex]*oneOverW[2]);
+			}
+#undef SetupPlane
+
+			triangle.drawIndex = drawIndex;
+			triangles->push_back(triangle);
+		}
+	}
+}
+
+// NOTE(joon) : Clips against the near(z >= -w) & far(z <= w) plane, and sets up whatever is left as a fan.
+// x & y are not clipped, the bounding box takes care of them.
+static void
+ClipAndSetupSoftwareTriangle(software_renderer *renderer, std::vector<software_triangle> *triangles,
+							software_draw *draw, u32 drawIndex, software_vertex *v0, software_vertex *v1, software_vertex *v2)
+{
+	software_vertex *vertices[3] = {v0, v1, v2};
+	u32 outsideNearCount = 0;
+	u32 outsideFarCount = 0;
+	u32 outsideXYMask = 0xf;
+	for (u32 vertexIndex = 0;
+		vertexIndex < 3;
+		++vertexIndex)
+	{
+		glm::vec4 clipP = vertices[vertexIndex]->clipP;
+		outsideNearCount += (clipP.z < -clipP.w) ? 1 : 0;
+		outsideFarCount += (clipP.z > clipP.w) ? 1 : 0;
+
+		u32 outsideXY = ((clipP.x < -clipP.w) ? 1 : 0) | ((clipP.x > clipP.w) ? 2 : 0) |
+						((clipP.y < -clipP.w) ? 4 : 0) | ((clipP.y > clipP.w) ? 8 : 0);
+		outsideXYMask &= outsideXY;
+	}
+
+	if (outsideNearCount == 3 || outsideFarCount == 3 || outsideXYMask)
+	{
+		// NOTE(joon) : completely outside of one of the planes
+	}
+	else if (outsideNearCount == 0 && outsideFarCount == 0)
+	{
+		SetupSoftwareTriangle(renderer, triangles, draw, drawIndex, v0, v1, v2);
+	}
+	else
+	{
+		// NOTE(joon) : Each plane can add at most one vertex
+		software_vertex polygons[2][5];
+		u32 vertexCount = 3;
+		polygons[0][0] = *v0;
+		polygons[0][1] = *v1;
+		polygons[0][2] = *v2;
+
+		u32 current = 0;
+		for (u32 planeIndex = 0;
+			planeIndex < 2;
+			++planeIndex)
+		{
+			software_vertex *in = polygons[current];
+			software_vertex *out = polygons[1 - current];
+			u32 outCount = 0;
+			for (u32 vertexIndex = 0;
+				vertexIndex < vertexCount;
+				++vertexIndex)
+			{
+				software_vertex *a = in + vertexIndex;
+				software_vertex *b = in + (vertexIndex + 1) % vertexCount;
+				// NOTE(joon) : signed distance to the plane, positive inside
+				r32 distanceA = (planeIndex == 0) ? (a->clipP.z + a->clipP.w) : (a->clipP.w - a->clipP.z);
+				r32 distanceB = (planeIndex == 0) ? (b->clipP.z + b->clipP.w) : (b->clipP.w - b->clipP.z);
+
+				if (distanceA >= 0.0f)
+				{
+					out[outCount++] = *a;
+				}
+				if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+				{
+					r32 t = distanceA / (distanceA - distanceB);
+					software_vertex *intersection = out + outCount++;
+					intersection->clipP = a->clipP + t*(b->clipP - a->clipP);
+					for (u32 attributeIndex = 0;
+						attributeIndex < draw->attributeCount;
+						++attributeIndex)
+					{
+						intersection->attributes[attributeIndex] = a->attributes[attributeIndex] +
+																t*(b->attributes[attributeIndex] - a->attributes[attributeIndex]);
+					}
+				}
+			}
+
+			vertexCount = outCount;
+			current = 1 - current;
+		}
+
+		for (u32 vertexIndex = 1;
+			vertexIndex + 1 < vertexCount;
+			++vertexIndex)
+		{
+			software_vertex *polygon = polygons[current];
+			SetupSoftwareTriangle(renderer, triangles, draw, drawIndex, polygon, polygon + vertexIndex, polygon + vertexIndex + 1);
+		}
+	}
+}
+
+struct software_setup_job_data
+{
+	software_renderer *renderer;
+	software_draw *draw;
+	u32 drawIndex;
+	u32 batchSize; // each batch writes into its own batchTriangles
+};
+
+static void
+SoftwareSetupJob(void *data, u32 start, u32 onePastEnd)
+{
+	software_setup_job_data *jobData = (software_setup_job_data *)data;
+	software_renderer *renderer = jobData->renderer;
+	software_draw *draw = jobData->draw;
+
+	std::vector<software_triangle> *triangles = &renderer->batchTriangles[start / jobData->batchSize];
+	triangles->clear();
+
+	u32 *indices = draw->model->mesh.indexBuffer.data();
+	software_vertex *vertices = renderer->vertices.data() + draw->firstVertex;
+	for (u32 triangleIndex = start;
+		triangleIndex < onePastEnd;
+		++triangleIndex)
+	{
+		ClipAndSetupSoftwareTriangle(renderer, triangles, draw, jobData->drawIndex,
+									vertices + indices[3*triangleIndex + 0],
+									vertices + indices[3*triangleIndex + 1],
+									vertices + indices[3*triangleIndex + 2]);
+	}
+}
+
+static u32
+PackColor(r32 r, r32 g, r32 b)
+{
+	r = Clamp(0.0f, r, 1.0f);
+	g = Clamp(0.0f, g, 1.0f);
+	b = Clamp(0.0f, b, 1.0f);
+
+	u32 result = ((u32)(r*255.0f + 0.5f) << 0) |
+				((u32)(g*255.0f + 0.5f) << 8) |
+				((u32)(b*255.0f + 0.5f) << 16) |
+				(255u << 24);
+
+	return result;
+}
+
+// NOTE(joon) : Rasterizes & shades the part of the triangle inside the tile, 4 pixels in a row at a time.
+// Returns the number of the pixels that passed the depth test.
+static u64
+RasterizeSoftwareTriangle(software_renderer *renderer, software_triangle *triangle,
+						i32 tileMinX, i32 tileMinY, i32 tileMaxX, i32 tileMaxY)
+{
+	u64 shadedPixelCount = 0;
+	software_draw *draw = renderer->draws.data() + triangle->drawIndex;
+	b32 isBlinn = (draw->shadingModel == SoftwareShading_Blinn);
+
+	i32 minX = Maximum(triangle->minX, tileMinX);
+	i32 minY = Maximum(triangle->minY, tileMinY);
+	i32 maxX = Minimum(triangle->maxX, tileMaxX);
+	i32 maxY = Minimum(triangle->maxY, tileMaxY);
+	minX &= ~(SOFTWARE_LANE_WIDTH - 1);
+
+	r32 centerX = 0.5f*renderer->width;
+	r32 centerY = 0.5f*renderer->height;
+	lane_r32 zero = LaneR32(0.0f);
+	lane_r32 laneOffsets = LaneR32(0.5f, 1.5f, 2.5f, 3.5f);
+	lane_r32 width = LaneR32((r32)renderer->width);
+
+	lane_r32 inclusiveMasks[3];
+	for (u32 edgeIndex = 0;
+		edgeIndex < 3;
+		++edgeIndex)
+	{
+		b32 isInclusive = (triangle->inclusiveEdgeMask & (1 << edgeIndex)) != 0;
+		// NOTE(joon) : all bits set or cleared
+		inclusiveMasks[edgeIndex] = LaneGreater(LaneR32(isInclusive ? 1.0f : 0.0f), zero);
+	}
+
+	for (i32 y = minY;
+		y <= maxY;
+		++y)
+	{
+		r32 py = (y + 0.5f) - centerY;
+		lane_r32 edgeRows[3];
+		for (u32 edgeIndex = 0;
+			edgeIndex < 3;
+			++edgeIndex)
+		{
+			edgeRows[edgeIndex] = LaneR32(triangle->edgeB[edgeIndex]*py + triangle->edgeC[edgeIndex]);
+		}
+
+		u32 *colorRow = renderer->color + y*renderer->stride;
+		r32 *depthRow = renderer->depth + y*renderer->stride;
+		for (i32 x = minX;
+			x <= maxX;
+			x += SOFTWARE_LANE_WIDTH)
+		{
+			lane_r32 pixelX = LaneR32((r32)x) + laneOffsets;
+			lane_r32 px = pixelX - LaneR32(centerX);
+
+			lane_r32 mask = LaneLess(pixelX, width);
+			for (u32 edgeIndex = 0;
+				edgeIndex < 3;
+				++edgeIndex)
+			{
+				lane_r32 edge = LaneR32(triangle->edgeA[edgeIndex])*px + edgeRows[edgeIndex];
+				lane_r32 isInside = LaneOr(LaneGreater(edge, zero), LaneAnd(LaneGreaterEqual(edge, zero), inclusiveMasks[edgeIndex]));
+				mask = LaneAnd(mask, isInside);
+			}
+
+			if (LaneMaskBits(mask))
+			{
+				// NOTE(joon) : Rounded to the 24 bit depth buffer that the GPU uses, otherwise the coplanar surfaces
+				// would not tie the same way
+				lane_r32 depth = LaneR32(triangle->depth[0])*px + LaneR32(triangle->depth[1]*py + triangle->depth[2]);
+				depth = LaneRound(depth*LaneR32(SOFTWARE_MAX_DEPTH));
+				lane_r32 oldDepth = LoadLane(depthRow + x);
+				mask = LaneAnd(mask, LaneLess(depth, oldDepth));
+
+				u32 maskBits = LaneMaskBits(mask);
+				if (maskBits)
+				{
+					lane_r32 oneOverW = LaneR32(triangle->oneOverW[0])*px + LaneR32(triangle->oneOverW[1]*py + triangle->oneOverW[2]);
+					lane_r32 w = LaneR32(1.0f) / oneOverW;
+					lane_r32 attributes[SOFTWARE_ATTRIBUTE_COUNT];
+					for (u32 attributeIndex = 0;
+						attributeIndex < draw->attributeCount;
+						++attributeIndex)
+					{
+						r32 *plane = triangle->attributes[attributeIndex];
+						attributes[attributeIndex] = (LaneR32(plane[0])*px + LaneR32(plane[1]*py + plane[2]))*w;
+					}
+
+					lane_v3 color;
+					switch (draw->shadingModel)
+					{
+						case SoftwareShading_Phong:
+						case SoftwareShading_Blinn:
+						{
+							color = ShadeLanes(renderer, draw, isBlinn,
+												LaneV3(attributes[0], attributes[1], attributes[2]),
+												LaneV3(attributes[3], attributes[4], attributes[5]),
+												attributes[6], attributes[7], maskBits);
+						}break;
+
+						case SoftwareShading_Gouraud:
+						{
+							color = LaneV3(attributes[0], attributes[1], attributes[2]);
+						}break;
+
+						default:
+						{
+							color = LaneV3(draw->color);
+						}break;
+					}
+
+					r32 reds[SOFTWARE_LANE_WIDTH];
+					r32 greens[SOFTWARE_LANE_WIDTH];
+					r32 blues[SOFTWARE_LANE_WIDTH];
+					StoreLane(reds, color.x);
+					StoreLane(greens, color.y);
+					StoreLane(blues, color.z);
+					for (u32 laneIndex = 0;
+						laneIndex < SOFTWARE_LANE_WIDTH;
+						++laneIndex)
+					{
+						if (maskBits & (1 << laneIndex))
+						{
+							colorRow[x + laneIndex] = PackColor(reds[laneIndex], greens[laneIndex], blues[laneIndex]);
+							++shadedPixelCount;
+						}
+					}
+					StoreLane(depthRow + x, LaneSelect(mask, depth, oldDepth));
+				}
+			}
+		}
+	}
+
+	return shadedPixelCount;
+}
+
+static void
+SoftwareRasterizeTileJob(void *data, u32 start, u32 onePastEnd)
+{
+	software_renderer *renderer = (software_renderer *)data;
+	u32 clearColor = PackColor(renderer->clearColor.r, renderer->clearColor.g, renderer->clearColor.b);
+
+	for (u32 tileIndex = start;
+		tileIndex < onePastEnd;
+		++tileIndex)
+	{
+		i32 tileMinX = (tileIndex % renderer->tileCountX)*SOFTWARE_TILE_SIZE;
+		i32 tileMinY = (tileIndex / renderer->tileCountX)*SOFTWARE_TILE_SIZE;
+		i32 tileMaxX = tileMinX + SOFTWARE_TILE_SIZE - 1;
+		i32 tileMaxY = tileMinY + SOFTWARE_TILE_SIZE - 1;
+
+		// NOTE(joon) : Each tile clears itself, so the clear also scales with the workers
+		for (i32 y = tileMinY;
+			y <= tileMaxY;
+			++y)
+		{
+			u32 *colorRow = renderer->color + y*renderer->stride;
+			r32 *depthRow = renderer->depth + y*renderer->stride;
+			for (i32 x = tileMinX;
+				x <= tileMaxX;
+				++x)
+			{
+				colorRow[x] = clearColor;
+				depthRow[x] = SOFTWARE_MAX_DEPTH;
+			}
+		}
+
+		u64 shadedPixelCount = 0;
+		std::vector<u32> *tileTriangles = &renderer->tileTriangles[tileIndex];
+		for (u32 index = 0;
+			index < tileTriangles->size();
+			++index)
+		{
+			software_triangle *triangle = renderer->triangles.data() + (*tileTriangles)[index];
+			shadedPixelCount += RasterizeSoftwareTriangle(renderer, triangle, tileMinX, tileMinY, tileMaxX, tileMaxY);
+		}
+		renderer->tileShadedPixelCounts[tileIndex] = shadedPixelCount;
+	}
+}
+
+static void
+BinSoftwareTriangles(software_renderer *renderer, u32 firstTriangle)
+{
+	for (u32 triangleIndex = firstTriangle;
+		triangleIndex < renderer->triangles.size();
+		++triangleIndex)
+	{
+		software_triangle *triangle = renderer->triangles.data() + triangleIndex;
+		i32 minTileX = triangle->minX / SOFTWARE_TILE_SIZE;
+		i32 minTileY = triangle->minY / SOFTWARE_TILE_SIZE;
+		i32 maxTileX = triangle->maxX / SOFTWARE_TILE_SIZE;
+		i32 maxTileY = triangle->maxY / SOFTWARE_TILE_SIZE;
+		for (i32 tileY = minTileY;
+			tileY <= maxTileY;
+			++tileY)
+		{
+			for (i32 tileX = minTileX;
+				tileX <= maxTileX;
+				++tileX)
+			{
+				renderer->tileTriangles[tileY*renderer->tileCountX + tileX].push_back(triangleIndex);
+			}
+		}
+	}
+}
+
+// NOTE(joon) : Draws the packet the same way RecordFramePacket would, with the lighting program that the packet selected.
+static void
+RenderFramePacketInSoftware(software_renderer *renderer, job_system *jobSystem, frame_packet *packet)
+{
+	renderer->perFrameUbo = packet->perFrameUbo;
+	renderer->clearColor = glm::vec4(packet->perFrameUbo.IFog, 1.0f);
+	renderer->draws.clear();
+	renderer->triangles.clear();
+	renderer->submittedTriangleCount = 0;
+
+	u32 vertexCount = 0;
+	for (u32 itemIndex = 0;
+		itemIndex < packet->drawItems.size();
+		++itemIndex)
+	{
+		draw_item *item = packet->drawItems.data() + itemIndex;
+
+		software_draw draw = {};
+		draw.model = item->model;
+		draw.firstVertex = vertexCount;
+		draw.ubo = packet->perObjectUbo;
+		*(object_matrices *)&draw.ubo = item->matrices;
+		if (item->type == DrawItemType_Model)
+		{
+			// NOTE(joon) : The deferred shading has the same lighting as the phong shading
+			draw.shadingModel = (packet->selectedProgramIndex == DEFERRED_SHADER_TYPE_INDEX) ?
+								SoftwareShading_Phong : (software_shading_model)packet->selectedProgramIndex;
+			draw.attributeCount = (draw.shadingModel == SoftwareShading_Gouraud) ? 3 : SOFTWARE_ATTRIBUTE_COUNT;
+			draw.isTextured = item->isTextured;
+		}
+		else if (item->type == DrawItemType_LightSphere)
+		{
+			draw.shadingModel = SoftwareShading_Plain;
+			draw.attributeCount = 0;
+			draw.color = item->color;
+		}
+		else
+		{
+			// NOTE(joon) : lines are not supported
+			continue;
+		}
+
+		renderer->draws.push_back(draw);
+		vertexCount += (u32)draw.model->mesh.vertexBuffer.size();
+		renderer->submittedTriangleCount += (u32)draw.model->mesh.indexBuffer.size() / 3;
+	}
+	if (renderer->vertices.size() < vertexCount)
+	{
+		renderer->vertices.resize(vertexCount);
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (u32 drawIndex = 0;
+		drawIndex < renderer->draws.size();
+		++drawIndex)
+	{
+		software_vertex_job_data jobData = {renderer, renderer->draws.data() + drawIndex};
+		ParallelFor(jobSystem, SoftwareVertexJob, &jobData, "SoftwareVertex",
+					(u32)jobData.draw->model->mesh.vertexBuffer.size(), 256);
+	}
+	std::chrono::duration<r64, std::milli> vertexTime = std::chrono::steady_clock::now() - start;
+	renderer->vertexTime = vertexTime.count();
+
+	start = std::chrono::steady_clock::now();
+	for (u32 tileIndex = 0;
+		tileIndex < renderer->tileTriangles.size();
+		++tileIndex)
+	{
+		renderer->tileTriangles[tileIndex].clear();
+	}
+	for (u32 drawIndex = 0;
+		drawIndex < renderer->draws.size();
+		++drawIndex)
+	{
+		software_draw *draw = renderer->draws.data() + drawIndex;
+		u32 triangleCount = (u32)draw->model->mesh.indexBuffer.size() / 3;
+		if (triangleCount)
+		{
+			software_setup_job_data jobData = {renderer, draw, drawIndex, GetParallelForBatchSize(jobSystem, triangleCount, 256)};
+			job *setupJob = CreateParallelForJob(jobSystem, SoftwareSetupJob, &jobData, "SoftwareSetup", triangleCount, 256);
+			Assert(setupJob->batchSize == jobData.batchSize);
+			u32 batchCount = (triangleCount + jobData.batchSize - 1) / jobData.batchSize;
+			if (renderer->batchTriangles.size() < batchCount)
+			{
+				renderer->batchTriangles.resize(batchCount);
+			}
+			SubmitJob(jobSystem, setupJob);
+			WaitForJob(jobSystem, setupJob);
+
+			u32 firstTriangle = (u32)renderer->triangles.size();
+			for (u32 batchIndex = 0;
+				batchIndex < batchCount;
+				++batchIndex)
+			{
+				std::vector<software_triangle> *triangles = &renderer->batchTriangles[batchIndex];
+				renderer->triangles.insert(renderer->triangles.end(), triangles->begin(), triangles->end());
+			}
+			BinSoftwareTriangles(renderer, firstTriangle);
+		}
+	}
+	renderer->rasterizedTriangleCount = (u32)renderer->triangles.size();
+	std::chrono::duration<r64, std::milli> setupTime = std::chrono::steady_clock::now() - start;
+	renderer->setupTime = setupTime.count();
+
+	start = std::chrono::steady_clock::now();
+	ParallelFor(jobSystem, SoftwareRasterizeTileJob, renderer, "SoftwareRasterize", (u32)renderer->tileTriangles.size(), 1);
+	std::chrono::duration<r64, std::milli> rasterizeTime = std::chrono::steady_clock::now() - start;
+	renderer->rasterizeTime = rasterizeTime.count();
+
+	renderer->shadedPixelCount = 0;
+	for (u32 tileIndex = 0;
+		tileIndex < renderer->tileShadedPixelCounts.size();
+		++tileIndex)
+	{
+		renderer->shadedPixelCount += renderer->tileShadedPixelCounts[tileIndex];
+	}
+}
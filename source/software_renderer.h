@@ -0,0 +1,115 @@
+#ifndef SOFTWARE_RENDERER_H
+#define SOFTWARE_RENDERER_H
+
+// NOTE(joon) : CPU renderer for the frame packet, for the machines without a GPU and as a reference
+// for the image regression checks. It follows what GL does with our shaders :
+// the vertices are transformed(and lit, for gouraud) in parallel, the triangles are clipped against the near & far plane,
+// back face culled and binned into the screen tiles, and then each tile is rasterized & shaded by its own job,
+// 4 pixels at a time.
+// Only the triangles are drawn, the debug lines(normals & orbit) and the GPU instances are skipped.
+// Like the GL framebuffer, the first row of the color buffer is the bottom one.
+
+#define SOFTWARE_TILE_SIZE 64 // in pixels, should be a multiple of SOFTWARE_LANE_WIDTH
+#define SOFTWARE_LANE_WIDTH 4 // pixels shaded together
+#define SOFTWARE_ATTRIBUTE_COUNT 8 // interpolated per pixel, see software_shading_model
+#define SOFTWARE_SUBPIXEL_BITS 8 // the vertices are snapped like the GPU does, so the shared edges stay watertight
+#define SOFTWARE_MAX_DEPTH 16777215.0f // depth is stored like a 24 bit depth buffer, in [0, 2^24 - 1]
+
+// NOTE(joon) : Same order as the lighting programs, so that selectedProgramIndex can be used as it is
+enum software_shading_model
+{
+	SoftwareShading_Phong, // phong_shading_shader, attributes : world p(3), normal(3), tex coord(2)
+	SoftwareShading_Gouraud, // phong_lighting_shader, attributes : color(3)
+	SoftwareShading_Blinn, // blinn_shader, same attributes as the phong
+	SoftwareShading_Plain, // plain_shader, no attributes
+};
+
+// NOTE(joon) : RGB8, sampled with GL_LINEAR & GL_REPEAT.
+// The first row is t = 0, just like what glTexImage2D does with the stbi output.
+struct software_texture
+{
+	i32 width;
+	i32 height;
+	u8 *texels;
+};
+
+struct software_draw
+{
+	software_shading_model shadingModel;
+	u32 attributeCount;
+
+	b32 isTextured; // untextured draws sample black, like the unbound texture in GL
+	per_object_ubo ubo;
+	glm::vec3 color; // plain only
+
+	struct model *model;
+	u32 firstVertex; // inside software_renderer::vertices
+};
+
+// NOTE(joon) : output of the vertex stage
+struct software_vertex
+{
+	glm::vec4 clipP;
+	r32 attributes[SOFTWARE_ATTRIBUTE_COUNT];
+};
+
+// NOTE(joon) : Screen space triangle, ready to be rasterized.
+// Every plane should be evaluated at the pixel centers : a*x + (b*y + c)
+struct software_triangle
+{
+	r32 edgeA[3];
+	r32 edgeB[3];
+	r32 edgeC[3];
+	u32 inclusiveEdgeMask; // edges that own the pixels exactly on them, so that the shared edges are only drawn once
+
+	r32 depth[3]; // window space z in [0, 1]
+	r32 oneOverW[3];
+	r32 attributes[SOFTWARE_ATTRIBUTE_COUNT][3]; // attribute/w, for the perspective correct interpolation
+
+	// NOTE(joon) : inclusive, already clamped to the framebuffer
+	i32 minX;
+	i32 minY;
+	i32 maxX;
+	i32 maxY;
+
+	u32 drawIndex;
+};
+
+struct software_renderer
+{
+	i32 width;
+	i32 height;
+	i32 stride; // in pixels, the framebuffer is padded to the whole tiles
+
+	i32 tileCountX;
+	i32 tileCountY;
+
+	u32 *color; // RGBA8
+	r32 *depth; // see SOFTWARE_MAX_DEPTH
+
+	// NOTE(joon) : The shaders sample the specular texture but never use it, so there's only the diffuse one
+	software_texture diffuseTexture;
+
+	per_frame_ubo perFrameUbo;
+	glm::vec4 clearColor;
+
+	std::vector<software_draw> draws;
+	std::vector<software_vertex> vertices;
+	std::vector<software_triangle> triangles;
+
+	// NOTE(joon) : Each setup batch has its own triangles, which get appended in order
+	// so that the triangles are still drawn in the submission order inside each tile
+	std::vector<std::vector<software_triangle>> batchTriangles;
+	std::vector<std::vector<u32>> tileTriangles; // indices into the triangles
+	std::vector<u64> tileShadedPixelCounts;
+
+	// NOTE(joon) : stats of the last frame
+	u32 submittedTriangleCount;
+	u32 rasterizedTriangleCount; // after the clipping & culling
+	u64 shadedPixelCount; // pixels that passed the depth test
+	r64 vertexTime; // in ms
+	r64 setupTime; // including the binning
+	r64 rasterizeTime;
+};
+
+#endif